@@ -0,0 +1,1238 @@
+/**
+ * @file bench_pipeline.cpp
+ * @brief Benchmarks of configuration loading and the publish path
+ *
+ * Covers loading the JSON configuration, protocol and calibration data (parsed and from
+ * the binary config cache), the time from boot to the first reading with
+ * and without the cache, encoding MQTT payloads and topics, fanning a
+ * reading out through the publish bus, packing BLE live data into
+ * MTU-sized packets, and decoding inbound MQTT messages.
+ * The publish bus also runs inside a trace scope, to measure the cost of
+ * the latency stage timers. Benchmarks of the per-reading and per-message
+ * paths report their heap allocations per iteration as "allocs"; the
+ * reading-cycle benchmarks compare heap temporaries with the cycle arena
+ * and object pools. The calibration benchmarks fit reference pairs with
+ * the streaming fitter, directly and from a buffer of readings as
+ * CalibrationManager methods take them, and evaluate temperature
+ * compensation tables. The latest-value benchmarks read cached values
+ * while one thread keeps writing them. The node table benchmarks resolve
+ * frame senders by MAC in a full table, with and without node churn. The
+ * ESP-NOW decode benchmarks compare a node report sent as a binary reading
+ * frame with the same report sent as JSON, in frames per second.
+ */
+
+#include "communication/espnow/espnow_frame.hpp"
+#include "communication/gateway/command_parser.hpp"
+#include "communication/gateway/publish_bus.hpp"
+#include "communication/mqtt/topic_registry.hpp"
+#include "communication/wireless/node_table.hpp"
+#include "core/boot/boot_sequencer.hpp"
+#include "core/managers/calibration_manager/compensation_table.hpp"
+#include "core/managers/calibration_manager/streaming_fitter.hpp"
+#include "core/managers/discovery_manager/i2c_topology_scanner.hpp"
+#include "core/utils/alloc_tracker.hpp"
+#include "core/utils/cycle_arena.hpp"
+#include "core/utils/latency_trace.hpp"
+#include "core/utils/latest_value_cache.hpp"
+#include "core/utils/object_pool.hpp"
+#include "storage/config_cache.hpp"
+#include "live_data_codec.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const int TOPIC_SENSORS = 32;
+const size_t CYCLE_ARENA_SIZE = 4096;     // Arena bytes for one reading cycle's temporaries
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+std::string dataFile(const std::string& name) {
+    return std::string(SENSORHUB_DATA_DIR) + "/" + name;
+}
+
+sensors::SensorReading sampleReading() {
+    sensors::SensorReading reading;
+    reading.sensorId = "industrial_temp_1";
+    reading.timestamp = 1700000000000LL;
+    reading.value = 72.43;
+    reading.rawValue = 72.94;
+    reading.unit = "°C";
+    reading.isValid = true;
+    return reading;
+}
+
+uint32_t steadyMicros() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void setAllocCounter(benchmark::State& state, uint64_t allocations) {
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+std::vector<std::string> sensorIds() {
+    std::vector<std::string> ids;
+    for (int i = 0; i < TOPIC_SENSORS; i++) {
+        ids.push_back("bme280_" + std::to_string(0x40 + i));
+    }
+    return ids;
+}
+
+//---------- Configuration Loading ----------//
+
+void BM_ConfigLoad_Json(benchmark::State& state, const char* name) {
+    std::string text = readFile(dataFile(name));
+    if (text.empty()) {
+        state.SkipWithError("Data file not found");
+        return;
+    }
+
+    for (auto _ : state) {
+        auto config = sensors::json::parse(text);
+        benchmark::DoNotOptimize(config);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK_CAPTURE(BM_ConfigLoad_Json, instance, "configs/industrial_temp_sensor_instance.json");
+BENCHMARK_CAPTURE(BM_ConfigLoad_Json, protocol, "protocols/industrial_temp_sensor.json");
+
+// Image read and check alone, and followed by decoding the protocol's detection rules
+void BM_ConfigLoad_Cache(benchmark::State& state, bool decode) {
+    std::string text = readFile(dataFile("protocols/industrial_temp_sensor.json"));
+    if (text.empty()) {
+        state.SkipWithError("Data file not found");
+        return;
+    }
+
+    std::string path = std::string(SENSORHUB_BENCH_TMP_DIR) + "/bench_config.cache";
+    storage::ConfigCache writer(path);
+    writer.setDetectionRules("protocols", sensors::I2CTopologyScanner::compileProtocols(
+        sensors::json::array({sensors::json::parse(text)})));
+    if (!writer.save(1)) {
+        state.SkipWithError("Could not write config cache");
+        return;
+    }
+
+    for (auto _ : state) {
+        storage::ConfigCache cache(path);
+        if (!cache.load(1)) {
+            state.SkipWithError("Could not load config cache");
+            break;
+        }
+        if (decode) {
+            std::vector<sensors::I2CDetectionRule> rules;
+            cache.getDetectionRules("protocols", rules);
+            benchmark::DoNotOptimize(rules);
+        }
+    }
+    remove(path.c_str());
+}
+BENCHMARK_CAPTURE(BM_ConfigLoad_Cache, image, false);
+BENCHMARK_CAPTURE(BM_ConfigLoad_Cache, protocol, true);
+
+// Calibration data of TOPIC_SENSORS sensors, parsed from JSON text or
+// decoded from the compiled cache section
+void BM_ConfigLoad_Calibration(benchmark::State& state, bool cached) {
+    auto instance = sensors::json::parse(readFile(dataFile("configs/industrial_temp_sensor_instance.json")), nullptr, false);
+    if (instance.is_discarded()) {
+        state.SkipWithError("Data file not found");
+        return;
+    }
+
+    auto calibration = sensors::json::object();
+    for (const auto& id : sensorIds()) {
+        calibration[id] = instance["sensorConfig"]["calibrationConfig"];
+    }
+    std::string text = calibration.dump();
+
+    storage::ConfigCache cache;
+    cache.setCalibration("calibration", calibration.get<std::map<std::string, sensors::json>>());
+
+    for (auto _ : state) {
+        std::map<std::string, sensors::json> loaded;
+        if (cached) {
+            cache.getCalibration("calibration", loaded);
+        } else {
+            auto document = sensors::json::parse(text);
+            for (auto it = document.begin(); it != document.end(); ++it) {
+                loaded[it.key()] = std::move(it.value());
+            }
+        }
+        benchmark::DoNotOptimize(loaded);
+    }
+    state.SetItemsProcessed(state.iterations() * calibration.size());
+}
+BENCHMARK_CAPTURE(BM_ConfigLoad_Calibration, json, false);
+BENCHMARK_CAPTURE(BM_ConfigLoad_Calibration, cached, true);
+
+//---------- Boot ----------//
+
+const int BOOT_SENSORS = 60;
+
+// Source tree of a device with BOOT_SENSORS configured sensors
+struct BootData {
+    std::string root;
+    std::vector<std::string> configFiles;
+    std::vector<std::string> protocolFiles;
+
+    std::vector<std::string> sources() const {
+        return {root + "/configs", root + "/protocols"};
+    }
+};
+
+bool writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream file(path);
+    file << contents;
+    return file.good();
+}
+
+bool makeBootData(BootData& data) {
+    data.root = std::string(SENSORHUB_BENCH_TMP_DIR) + "/boot_data";
+    mkdir(data.root.c_str(), 0755);
+    mkdir((data.root + "/configs").c_str(), 0755);
+    mkdir((data.root + "/protocols").c_str(), 0755);
+
+    auto instance = sensors::json::parse(readFile(dataFile("configs/industrial_temp_sensor_instance.json")), nullptr, false);
+    if (instance.is_discarded()) return false;
+    for (int i = 0; i < BOOT_SENSORS; i++) {
+        instance["sensorConfig"]["id"] = "industrial_temp_" + std::to_string(i);
+        data.configFiles.push_back(data.root + "/configs/industrial_temp_" + std::to_string(i) + ".json");
+        if (!writeFile(data.configFiles.back(), instance.dump(4))) return false;
+    }
+
+    for (const char* name : {"dht22.json", "industrial_temp_sensor.json"}) {
+        data.protocolFiles.push_back(data.root + "/protocols/" + name);
+        if (!writeFile(data.protocolFiles.back(), readFile(dataFile(std::string("protocols/") + name)))) return false;
+    }
+    return true;
+}
+
+void removeBootData(const BootData& data) {
+    for (const auto& path : data.configFiles) remove(path.c_str());
+    for (const auto& path : data.protocolFiles) remove(path.c_str());
+    rmdir((data.root + "/configs").c_str());
+    rmdir((data.root + "/protocols").c_str());
+    rmdir(data.root.c_str());
+}
+
+// Configuration file to SensorConfig, as ConfigManager reads the instance files
+bool parseConfig(const sensors::json& record, sensors::SensorConfig& config) {
+    if (!record.is_object() || !record.contains("sensorConfig") || !record["sensorConfig"].is_object()) {
+        return false;
+    }
+
+    const sensors::json& sensorConfig = record["sensorConfig"];
+    if (!sensorConfig.contains("id") || !sensorConfig["id"].is_string()) {
+        return false;
+    }
+
+    config = sensors::SensorConfig();
+    config.id = sensorConfig["id"].get<std::string>();
+    config.name = sensorConfig.value("name", config.id);
+    config.type = sensors::stringToSensorType(sensorConfig.value("type", ""));
+    config.bus = sensors::stringToSensorBus(sensorConfig.value("bus", ""));
+    config.enabled = sensorConfig.value("enabled", true);
+    config.busConfig = sensorConfig.value("busConfig", sensors::json());
+    config.sensorConfig = sensorConfig.value("sensorConfig", sensors::json());
+    config.calibrationConfig = sensorConfig.value("calibrationConfig", sensors::json());
+
+    if (sensorConfig.contains("wireless") && sensorConfig["wireless"].is_object()) {
+        const sensors::json& wireless = sensorConfig["wireless"];
+        config.wireless.isWireless = true;
+        config.wireless.nodeId = wireless.value("nodeId", "");
+        config.wireless.communicationType = wireless.value("communicationType", "");
+        config.wireless.communicationConfig = wireless.value("communicationConfig", sensors::json());
+    }
+    return true;
+}
+
+uint32_t steadyMillis() {
+    return steadyMicros() / 1000;
+}
+
+// Time to first reading: the boot stage graph of main.cpp, reduced to the
+// stages on the host, timed until the acquisition stage is released. As on
+// the device, protocol loading runs beside it and is not waited for.
+void BM_Boot_FirstReading(benchmark::State& state) {
+    bool cached = state.range(0) != 0;
+    BootData data;
+    if (!makeBootData(data)) {
+        state.SkipWithError("Could not write boot data");
+        removeBootData(data);
+        return;
+    }
+
+    std::string imagePath = data.root + "/config.cache";
+    if (cached) {
+        storage::ConfigCache writer(imagePath);
+        std::vector<sensors::SensorConfig> configs;
+        for (const auto& path : data.configFiles) {
+            sensors::SensorConfig config;
+            parseConfig(sensors::json::parse(readFile(path)), config);
+            configs.push_back(config);
+        }
+        sensors::json protocols = sensors::json::array();
+        for (const auto& path : data.protocolFiles) {
+            protocols.push_back(sensors::json::parse(readFile(path)));
+        }
+        writer.setConfigs("configs", configs);
+        writer.setDetectionRules("protocols", sensors::I2CTopologyScanner::compileProtocols(protocols));
+        if (!writer.save(storage::ConfigCache::computeSourceHash(data.sources()))) {
+            state.SkipWithError("Could not write config cache");
+            removeBootData(data);
+            return;
+        }
+    }
+
+    size_t sensorCount = 0;
+    for (auto _ : state) {
+        storage::ConfigCache cache(imagePath);
+        bool cacheValid = false;
+        std::vector<sensors::SensorConfig> configs;
+        std::vector<sensors::I2CDetectionRule> rules;
+
+        auto start = std::chrono::steady_clock::now();
+        sensors::BootSequencer boot(steadyMillis, 2);
+        boot.addStage("config_cache", {}, [&]() {
+            cacheValid = cached && cache.load(storage::ConfigCache::computeSourceHash(data.sources()));
+            return true;
+        });
+        boot.addStage("config", {"config_cache"}, [&]() {
+            if (cacheValid) return cache.getConfigs("configs", configs);
+            for (const auto& path : data.configFiles) {
+                sensors::SensorConfig config;
+                if (parseConfig(sensors::json::parse(readFile(path), nullptr, false), config)) {
+                    configs.push_back(std::move(config));
+                }
+            }
+            return true;
+        });
+        boot.addStage("protocols", {"config_cache"}, [&]() {
+            if (cacheValid) {
+                return cache.getDetectionRules("protocols", rules);
+            }
+            auto protocols = sensors::json::array();
+            for (const auto& path : data.protocolFiles) {
+                protocols.push_back(sensors::json::parse(readFile(path), nullptr, false));
+            }
+            rules = sensors::I2CTopologyScanner::compileProtocols(protocols);
+            return true;
+        });
+        boot.addStage("acquisition", {"config"}, []() { return true; });
+        boot.start();
+        bool started = boot.waitFor("acquisition");
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        boot.join();
+
+        if (!started || (cached && !cacheValid)) {
+            state.SkipWithError(cached ? "Config cache rejected" : "Configurations not loaded");
+            break;
+        }
+        sensorCount = configs.size();
+        state.SetIterationTime(std::chrono::duration<double>(elapsed).count());
+    }
+    state.counters["sensors"] = static_cast<double>(sensorCount);
+
+    remove(imagePath.c_str());
+    removeBootData(data);
+}
+BENCHMARK(BM_Boot_FirstReading)->ArgName("cached")->Arg(0)->Arg(1)->UseManualTime()->Unit(benchmark::kMicrosecond);
+
+//---------- Publishing ----------//
+
+void BM_MqttPayload_Json(benchmark::State& state) {
+    auto reading = sampleReading();
+    std::string payload;
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        sensors::communication::PublishBus::encodeJson(reading, payload);
+        benchmark::DoNotOptimize(payload);
+    }
+    setAllocCounter(state, cycle.allocations());
+}
+BENCHMARK(BM_MqttPayload_Json);
+
+void BM_MqttTopic_Format(benchmark::State& state) {
+    auto ids = sensorIds();
+    size_t i = 0;
+    for (auto _ : state) {
+        char topic[128];
+        snprintf(topic, sizeof(topic), "sensors/%s/reading", ids[i++ % ids.size()].c_str());
+        std::string copy(topic);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_MqttTopic_Format);
+
+void BM_MqttTopic_Interned(benchmark::State& state) {
+    auto ids = sensorIds();
+    sensors::communication::TopicRegistry registry;
+    for (const auto& id : ids) {
+        registry.intern(id);
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        std::string copy(registry.topicsFor(ids[i++ % ids.size()]).reading);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_MqttTopic_Interned);
+
+void BM_PublishBus_FanOut(benchmark::State& state) {
+    sensors::communication::PublishBus bus;
+    sensors::communication::SubscriberOptions json;
+    sensors::communication::SubscriberOptions text;
+    text.format = sensors::communication::WireFormat::TEXT;
+
+    size_t delivered = 0;
+    auto sink = [&delivered](const sensors::SensorReading&, const sensors::communication::EncodedPayload& payload) {
+        delivered += payload->size();
+    };
+    bus.subscribe("mqtt", json, sink);
+    bus.subscribe("mirror", json, sink);
+    bus.subscribe("log", text, sink);
+
+    // Traced as onSensorReading does, with the trace resolved at registration;
+    // trace_every is the tracer's sample interval, 0 for no trace at all
+    uint32_t traceEvery = static_cast<uint32_t>(state.range(0));
+    sensors::LatencyTracer tracer(steadyMicros, traceEvery);
+    bool traced = traceEvery != 0;
+
+    auto reading = sampleReading();
+    reading.trace = traced ? tracer.sensor(reading.sensorId) : nullptr;
+    uint32_t now = 0;
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        sensors::TraceScope scope(reading.trace);
+        benchmark::DoNotOptimize(bus.publish(reading, now++));
+    }
+    setAllocCounter(state, cycle.allocations());
+    benchmark::DoNotOptimize(delivered);
+}
+BENCHMARK(BM_PublishBus_FanOut)->ArgName("trace_every")->Arg(0)->Arg(1)->Arg(4);
+
+//---------- BLE Live Data ----------//
+
+// Channel table and one reading cycle of the BLE sensor device sketch
+const LiveDataChannel LIVE_CHANNELS[] = {
+    {"bme280_temp",   LIVE_DATA_INT16,   -2},
+    {"bme280_humid",  LIVE_DATA_INT16,   -2},
+    {"bme280_press",  LIVE_DATA_INT16,   -1},
+    {"hdc1080_temp",  LIVE_DATA_INT16,   -2},
+    {"hdc1080_humid", LIVE_DATA_INT16,   -2},
+    {"ccs811_eco2",   LIVE_DATA_INT16,    0},
+    {"ccs811_tvoc",   LIVE_DATA_INT16,    0},
+    {"bh1750_light",  LIVE_DATA_FLOAT32,  0}
+};
+const size_t LIVE_CHANNEL_COUNT = sizeof(LIVE_CHANNELS) / sizeof(LIVE_CHANNELS[0]);
+const LiveDataSample LIVE_CYCLE[LIVE_CHANNEL_COUNT] = {
+    {0, 22.57f}, {1, 45.31f}, {2, 1013.2f}, {3, 22.41f},
+    {4, 44.87f}, {5, 412.0f}, {6, 12.0f}, {7, 54612.5f}
+};
+
+// Encode a full channel set into packets of the MTU's notification payload
+// and decode them again
+void BM_LiveData_Codec(benchmark::State& state) {
+    uint16_t mtu = static_cast<uint16_t>(state.range(0));
+    size_t payloadSize = liveDataPayloadSize(mtu);
+    std::vector<uint8_t> packet(payloadSize);
+    LiveDataSample decoded[LIVE_CHANNEL_COUNT];
+
+    size_t packets = 0;
+    size_t bytes = 0;
+    uint16_t sequence = 0;
+    for (auto _ : state) {
+        size_t sent = 0;
+        size_t received = 0;
+        while (sent < LIVE_CHANNEL_COUNT) {
+            size_t consumed;
+            size_t length = encodeLiveDataPacket(LIVE_CHANNELS, LIVE_CHANNEL_COUNT,
+                                                 LIVE_CYCLE + sent, LIVE_CHANNEL_COUNT - sent, &consumed,
+                                                 sequence++, 1000, packet.data(), packet.size());
+            uint16_t packetSequence;
+            uint32_t timestamp;
+            int count = decodeLiveDataPacket(packet.data(), length, LIVE_CHANNELS, LIVE_CHANNEL_COUNT,
+                                             &packetSequence, &timestamp,
+                                             decoded + received, LIVE_CHANNEL_COUNT - received);
+            if (length == 0 || count != static_cast<int>(consumed)) {
+                state.SkipWithError("Live data packet did not round-trip");
+                return;
+            }
+            sent += consumed;
+            received += consumed;
+            packets++;
+            bytes += length;
+        }
+        benchmark::DoNotOptimize(decoded);
+    }
+
+    // Per cycle: notifications, and payload bytes per sample including the packet headers
+    double cycles = static_cast<double>(state.iterations());
+    state.counters["packets"] = static_cast<double>(packets) / cycles;
+    state.counters["bytes_per_sample"] = static_cast<double>(bytes) / (cycles * LIVE_CHANNEL_COUNT);
+    state.SetItemsProcessed(state.iterations() * LIVE_CHANNEL_COUNT);
+}
+BENCHMARK(BM_LiveData_Codec)->ArgName("mtu")->Arg(ATT_DEFAULT_MTU)->Arg(185);
+
+//---------- Reading Cycle ----------//
+
+const char* const NODE_REPORT =
+    R"({"nodeId":"greenhouse_node_7","readings":[)"
+    R"({"id":"temperature","time":1700000000000,"value":21.4,"unit":"°C"},)"
+    R"({"id":"humidity","time":1700000000000,"value":55.2,"unit":"%RH"},)"
+    R"({"id":"soil_moisture","time":1700000000000,"value":31.0,"unit":"%"}]})";
+
+// ESP-NOW node report as onESPNowLegacyMessage handled it: message copied
+// into a string, a fresh reading per sample
+void BM_NodeReport_Heap(benchmark::State& state) {
+    const auto* data = reinterpret_cast<const uint8_t*>(NODE_REPORT);
+    size_t length = strlen(NODE_REPORT);
+    double total = 0;
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        std::string message(reinterpret_cast<const char*>(data), length);
+        auto report = sensors::json::parse(message);
+        std::string nodeId = report["nodeId"];
+        auto readings = report["readings"];
+        for (const auto& sample : readings) {
+            sensors::SensorReading reading;
+            reading.sensorId = nodeId + "_" + sample["id"].get<std::string>();
+            reading.value = sample["value"];
+            reading.unit = sample["unit"];
+            total += reading.value + reading.sensorId.size();
+        }
+    }
+    setAllocCounter(state, cycle.allocations());
+    benchmark::DoNotOptimize(total);
+}
+BENCHMARK(BM_NodeReport_Heap);
+
+// The same report parsed from the receive buffer into a pooled reading
+void BM_NodeReport_Pooled(benchmark::State& state) {
+    const auto* data = reinterpret_cast<const uint8_t*>(NODE_REPORT);
+    size_t length = strlen(NODE_REPORT);
+    sensors::ObjectPool<sensors::SensorReading, 4> pool;
+    double total = 0;
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        auto report = sensors::json::parse(data, data + length);
+        const std::string& nodeId = report["nodeId"].get_ref<const std::string&>();
+        auto reading = pool.acquire();
+        for (const auto& sample : report["readings"]) {
+            reading->sensorId.assign(nodeId).append("_").append(sample["id"].get_ref<const std::string&>());
+            reading->value = sample["value"];
+            reading->unit.assign(sample["unit"].get_ref<const std::string&>());
+            total += reading->value + reading->sensorId.size();
+        }
+    }
+    setAllocCounter(state, cycle.allocations());
+    benchmark::DoNotOptimize(total);
+}
+BENCHMARK(BM_NodeReport_Pooled);
+
+// One reading cycle's temporaries: the readings of every sensor collected
+// for the callback, in heap vectors or in the cycle arena
+void BM_ReadingCycle(benchmark::State& state) {
+    const size_t sensorCount = static_cast<size_t>(state.range(0));
+    const bool arenaBacked = state.range(1) != 0;
+    auto ids = sensorIds();
+    sensors::ObjectPool<sensors::SensorReading, 64> pool;
+    sensors::CycleArena arena(CYCLE_ARENA_SIZE);
+    double total = 0;
+
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        if (arenaBacked) {
+            using Handle = sensors::ObjectPool<sensors::SensorReading, 64>::Handle;
+            {
+                sensors::ArenaVector<Handle> readings{sensors::ArenaAllocator<Handle>(arena)};
+                for (size_t i = 0; i < sensorCount; i++) {
+                    readings.push_back(pool.acquire());
+                    readings.back()->sensorId.assign(ids[i % ids.size()]);
+                    readings.back()->value = static_cast<double>(i);
+                }
+                for (const auto& reading : readings) {
+                    total += reading->value;
+                }
+            }
+            arena.reset();
+        } else {
+            std::vector<sensors::SensorReading> readings;
+            for (size_t i = 0; i < sensorCount; i++) {
+                sensors::SensorReading reading;
+                reading.sensorId = ids[i % ids.size()];
+                reading.value = static_cast<double>(i);
+                readings.push_back(reading);
+            }
+            for (const auto& reading : readings) {
+                total += reading.value;
+            }
+        }
+    }
+    setAllocCounter(state, cycle.allocations());
+    state.counters["arenaOverflows"] = arena.overflows();
+    benchmark::DoNotOptimize(total);
+}
+BENCHMARK(BM_ReadingCycle)->ArgNames({"sensors", "arena"})->ArgsProduct({{4, 32}, {0, 1}});
+
+// A warmed-up reading cycle: pooled readings collected in a cycle arena,
+// stored in the latest-value cache, then traced and fanned out to the MQTT,
+// log and rate-limited relay sinks. Errors out if a cycle allocates, so a
+// regression shows up as a failed benchmark.
+void BM_ReadingCycle_NoAlloc(benchmark::State& state) {
+    using Handle = sensors::ObjectPool<sensors::SensorReading, 64>::Handle;
+    const size_t sensorCount = static_cast<size_t>(state.range(0));
+    auto ids = sensorIds();
+    sensors::ObjectPool<sensors::SensorReading, 64> pool;
+    sensors::CycleArena arena(CYCLE_ARENA_SIZE);
+    sensors::LatestValueCache cache(sensorCount);
+    sensors::LatencyTracer tracer(steadyMicros);
+
+    // Registration is the only place handles and traces are looked up
+    std::vector<int> handles;
+    std::vector<sensors::SensorTrace*> traces;
+    for (size_t i = 0; i < sensorCount; i++) {
+        handles.push_back(cache.registerSensor(ids[i]));
+        traces.push_back(tracer.sensor(ids[i]));
+    }
+
+    sensors::communication::PublishBus bus;
+    sensors::communication::SubscriberOptions json;
+    sensors::communication::SubscriberOptions text;
+    text.format = sensors::communication::WireFormat::TEXT;
+    sensors::communication::SubscriberOptions relay;
+    relay.minInterval = 10000;
+    size_t delivered = 0;
+    auto sink = [&delivered](const sensors::SensorReading&, const sensors::communication::EncodedPayload& payload) {
+        delivered += payload->size();
+    };
+    bus.subscribe("mqtt", json, sink);
+    bus.subscribe("log", text, sink);
+    bus.subscribe("relay", relay, sink);
+
+    auto runCycle = [&](uint32_t now) {
+        {
+            sensors::ArenaVector<Handle> readings{sensors::ArenaAllocator<Handle>(arena)};
+            for (size_t i = 0; i < sensorCount; i++) {
+                readings.push_back(pool.acquire());
+                sensors::SensorReading& reading = *readings.back();
+                reading.sensorId.assign(ids[i]);
+                reading.timestamp = now;
+                reading.value = 20.0 + (now / 1000 + i) % 100 * 0.1;
+                reading.rawValue = reading.value;
+                reading.unit.assign("°C");
+                reading.isValid = true;
+                reading.trace = traces[i];
+                cache.update(handles[i], reading, now);
+            }
+            for (const auto& reading : readings) {
+                sensors::TraceScope scope(reading->trace);
+                bus.publish(*reading, now);
+            }
+        }
+        arena.reset();
+    };
+
+    // The first cycles size the pooled strings and payloads and add the
+    // relay's per-sensor rate-limit entries
+    uint32_t now = 0;
+    for (int i = 0; i < 3; i++) {
+        runCycle(now += 5000);
+    }
+
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        sensors::AllocCycle cycle;
+        runCycle(now += 5000);
+        allocations += cycle.allocations();
+        if (allocations > 0) {
+            state.SkipWithError("Warmed-up reading cycle allocated");
+            break;
+        }
+    }
+    setAllocCounter(state, allocations);
+    benchmark::DoNotOptimize(delivered);
+}
+BENCHMARK(BM_ReadingCycle_NoAlloc)->ArgName("sensors")->Arg(4)->Arg(32);
+
+void BM_LatencyHistogram_Record(benchmark::State& state) {
+    sensors::LatencyHistogram histogram;
+    uint32_t sample = 1;
+    for (auto _ : state) {
+        histogram.record(sample);
+        sample = sample * 1103515245u + 12345u;
+        sample &= 0xFFFFF;
+    }
+    benchmark::DoNotOptimize(histogram.summarize());
+}
+BENCHMARK(BM_LatencyHistogram_Record);
+
+//---------- Calibration ----------//
+
+// Synthetic field log: a cubic sensor response with measurement noise
+struct ReferenceLog {
+    uint32_t state = 1;
+
+    void next(double& raw, double& reference) {
+        state = state * 1103515245u + 12345u;
+        raw = 200.0 + static_cast<double>(state >> 16 & 0x3FFF) * 0.01;
+        double noise = (static_cast<double>(state & 0xFF) - 127.5) * 0.0001;
+        reference = 0.5 + 1.02 * raw - 2e-4 * raw * raw + 1e-7 * raw * raw * raw + noise;
+    }
+};
+
+void BM_CalibrationFit_Stream(benchmark::State& state) {
+    const uint8_t degree = static_cast<uint8_t>(state.range(0));
+    const int64_t points = state.range(1);
+    sensors::CalibrationFit fit;
+    uint64_t allocations = 0;
+
+    for (auto _ : state) {
+        sensors::AllocCycle cycle;
+        sensors::StreamingFitter fitter(degree);
+        ReferenceLog log;
+        double raw, reference;
+        for (int64_t i = 0; i < points; i++) {
+            log.next(raw, reference);
+            fitter.add(raw, reference);
+        }
+        fitter.fit(degree, fit);
+        allocations += cycle.allocations();
+    }
+    state.SetItemsProcessed(state.iterations() * points);
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    state.counters["rmse"] = fit.rmse;
+    state.counters["bytes"] = sizeof(sensors::StreamingFitter);
+}
+BENCHMARK(BM_CalibrationFit_Stream)->ArgNames({"degree", "points"})->ArgsProduct({{1, 3}, {1 << 16, 1 << 22}})
+    ->Unit(benchmark::kMillisecond);
+
+// The same pairs collected as readings first
+void BM_CalibrationFit_Buffered(benchmark::State& state) {
+    const uint8_t degree = static_cast<uint8_t>(state.range(0));
+    const int64_t points = state.range(1);
+    sensors::CalibrationFit fit;
+    uint64_t allocations = 0;
+    size_t bytes = 0;
+
+    for (auto _ : state) {
+        sensors::AllocCycle cycle;
+        std::vector<sensors::SensorReading> readings;
+        ReferenceLog log;
+        for (int64_t i = 0; i < points; i++) {
+            sensors::SensorReading reading;
+            reading.sensorId = "temp_1";
+            log.next(reading.rawValue, reading.value);
+            readings.push_back(std::move(reading));
+        }
+
+        sensors::StreamingFitter fitter(degree);
+        for (const auto& reading : readings) {
+            fitter.add(reading.rawValue, reading.value);
+        }
+        fitter.fit(degree, fit);
+        bytes = readings.capacity() * sizeof(sensors::SensorReading);
+        allocations += cycle.allocations();
+    }
+    state.SetItemsProcessed(state.iterations() * points);
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    state.counters["rmse"] = fit.rmse;
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_CalibrationFit_Buffered)->ArgNames({"degree", "points"})->Args({3, 1 << 16})
+    ->Unit(benchmark::kMillisecond);
+
+// Gas sensor table: 32 raw points x 16 temperature points
+const int TABLE_RAW_POINTS = 32;
+const int TABLE_TEMPERATURE_POINTS = 16;
+
+double gasResponse(double raw, double temperature) {
+    return raw * (1.0 + 0.004 * (temperature - 25.0)) + 0.02 * temperature * temperature;
+}
+
+sensors::json gasTable() {
+    sensors::json rows = sensors::json::array();
+    for (int j = 0; j < TABLE_TEMPERATURE_POINTS; j++) {
+        sensors::json row = sensors::json::array();
+        for (int i = 0; i < TABLE_RAW_POINTS; i++) {
+            row.push_back(gasResponse(i * 2000.0 / (TABLE_RAW_POINTS - 1), -20.0 + j * 80.0 / (TABLE_TEMPERATURE_POINTS - 1)));
+        }
+        rows.push_back(row);
+    }
+    return {
+        {"method", "table2d"},
+        {"companion", "ambient_temp"},
+        {"raw", {{"min", 0}, {"max", 2000}, {"points", TABLE_RAW_POINTS}}},
+        {"temperature", {{"min", -20}, {"max", 60}, {"points", TABLE_TEMPERATURE_POINTS}}},
+        {"values", rows}
+    };
+}
+
+void BM_CompensationTable_Evaluate(benchmark::State& state) {
+    sensors::CompensationTable table;
+    std::string error;
+    if (!sensors::CompensationTable::fromJson(gasTable(), table, error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+
+    // Interpolation and quantization error across the grid
+    double maxError = 0.0;
+    for (float raw = 0.0f; raw <= 2000.0f; raw += 7.0f) {
+        for (float temperature = -20.0f; temperature <= 60.0f; temperature += 0.7f) {
+            maxError = std::max(maxError, std::fabs(table.evaluate(raw, temperature) - gasResponse(raw, temperature)));
+        }
+    }
+
+    uint32_t sample = 1;
+    for (auto _ : state) {
+        sample = sample * 1103515245u + 12345u;
+        float raw = static_cast<float>(sample >> 16 & 0x7FF);
+        float temperature = -20.0f + static_cast<float>(sample & 0x7F) * 0.6f;
+        float value = table.evaluate(raw, temperature);
+        benchmark::DoNotOptimize(value);
+    }
+    state.counters["bytes"] = table.getGridBytes();
+    state.counters["maxError"] = maxError;
+}
+BENCHMARK(BM_CompensationTable_Evaluate);
+
+// The same grid as nested double vectors with searched axes
+void BM_CompensationTable_Nested(benchmark::State& state) {
+    std::vector<double> rawAxis, temperatureAxis;
+    std::vector<std::vector<double>> values;
+    for (int i = 0; i < TABLE_RAW_POINTS; i++) rawAxis.push_back(i * 2000.0 / (TABLE_RAW_POINTS - 1));
+    for (int j = 0; j < TABLE_TEMPERATURE_POINTS; j++) {
+        temperatureAxis.push_back(-20.0 + j * 80.0 / (TABLE_TEMPERATURE_POINTS - 1));
+        std::vector<double> row;
+        for (double raw : rawAxis) row.push_back(gasResponse(raw, temperatureAxis.back()));
+        values.push_back(row);
+    }
+
+    auto cell = [](const std::vector<double>& axis, double x, double& fraction) {
+        size_t i = std::upper_bound(axis.begin(), axis.end(), x) - axis.begin();
+        i = std::min(std::max<size_t>(i, 1), axis.size() - 1) - 1;
+        fraction = std::min(std::max((x - axis[i]) / (axis[i + 1] - axis[i]), 0.0), 1.0);
+        return i;
+    };
+
+    uint32_t sample = 1;
+    for (auto _ : state) {
+        sample = sample * 1103515245u + 12345u;
+        double raw = static_cast<double>(sample >> 16 & 0x7FF);
+        double temperature = -20.0 + static_cast<double>(sample & 0x7F) * 0.6;
+        double fx, fy;
+        size_t i = cell(rawAxis, raw, fx);
+        size_t j = cell(temperatureAxis, temperature, fy);
+        double low = values[j][i] + fx * (values[j][i + 1] - values[j][i]);
+        double high = values[j + 1][i] + fx * (values[j + 1][i + 1] - values[j + 1][i]);
+        double value = low + fy * (high - low);
+        benchmark::DoNotOptimize(value);
+    }
+    state.counters["bytes"] = TABLE_RAW_POINTS * TABLE_TEMPERATURE_POINTS * sizeof(double);
+}
+BENCHMARK(BM_CompensationTable_Nested);
+
+//---------- Latest Values ----------//
+
+const int CACHED_SENSORS = 16;
+
+sensors::SensorReading cachedReading(int sensor, uint32_t cycle) {
+    sensors::SensorReading reading;
+    reading.sensorId = "sensor_" + std::to_string(sensor);
+    reading.timestamp = cycle;
+    reading.value = 20.0 + cycle % 100 * 0.1;
+    reading.rawValue = reading.value;
+    reading.unit = "°C";
+    reading.isValid = true;
+    return reading;
+}
+
+// Thread 0 is the acquisition loop, writing every sensor in turn; the
+// other threads read. Reads report the retries they needed as "retries".
+void BM_LatestValue_SeqLock(benchmark::State& state) {
+    static sensors::LatestValueCache* cache = nullptr;
+    static std::vector<int> handles;
+    if (state.thread_index() == 0) {
+        cache = new sensors::LatestValueCache(CACHED_SENSORS);
+        handles.clear();
+        for (int i = 0; i < CACHED_SENSORS; i++) {
+            handles.push_back(cache->registerSensor("sensor_" + std::to_string(i)));
+            cache->update(handles.back(), cachedReading(i, 0), 0);
+        }
+    }
+
+    std::vector<sensors::SensorReading> readings;
+    for (int i = 0; i < CACHED_SENSORS; i++) readings.push_back(cachedReading(i, 1));
+
+    uint32_t cycle = 0;
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        int sensor = cycle++ % CACHED_SENSORS;
+        sensors::AllocCycle allocs;
+        if (state.thread_index() == 0) {
+            cache->update(handles[sensor], readings[sensor], cycle);
+        } else {
+            sensors::CachedReading value;
+            cache->read(handles[sensor], value);
+            benchmark::DoNotOptimize(value);
+        }
+        allocations += allocs.allocations();
+    }
+
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    if (state.thread_index() == 0) {
+        state.counters["retries"] = cache->getReadRetries();
+        delete cache;
+        cache = nullptr;
+    }
+}
+BENCHMARK(BM_LatestValue_SeqLock)->ThreadRange(1, 4)->UseRealTime();
+
+// The same values in a map of readings behind a mutex
+void BM_LatestValue_Mutex(benchmark::State& state) {
+    static std::map<std::string, sensors::SensorReading>* cache = nullptr;
+    static std::mutex cacheMutex;
+    static std::vector<std::string> ids;
+    if (state.thread_index() == 0) {
+        cache = new std::map<std::string, sensors::SensorReading>();
+        ids.clear();
+        for (int i = 0; i < CACHED_SENSORS; i++) {
+            ids.push_back("sensor_" + std::to_string(i));
+            (*cache)[ids.back()] = cachedReading(i, 0);
+        }
+    }
+
+    std::vector<sensors::SensorReading> readings;
+    for (int i = 0; i < CACHED_SENSORS; i++) readings.push_back(cachedReading(i, 1));
+
+    uint32_t cycle = 0;
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        int sensor = cycle++ % CACHED_SENSORS;
+        sensors::AllocCycle allocs;
+        if (state.thread_index() == 0) {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            (*cache)[ids[sensor]] = readings[sensor];
+        } else {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            sensors::SensorReading value = cache->at(ids[sensor]);
+            benchmark::DoNotOptimize(value);
+        }
+        allocations += allocs.allocations();
+    }
+
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    if (state.thread_index() == 0) {
+        delete cache;
+        cache = nullptr;
+    }
+}
+BENCHMARK(BM_LatestValue_Mutex)->ThreadRange(1, 4)->UseRealTime();
+
+//---------- Inbound Messages ----------//
+
+void BM_MqttRoute_Registry(benchmark::State& state) {
+    auto ids = sensorIds();
+    sensors::communication::TopicRegistry registry;
+    std::vector<std::string> topics;
+    for (const auto& id : ids) {
+        registry.intern(id);
+        topics.push_back("sensors/gateway/command/" + id);
+    }
+
+    size_t i = 0;
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        sensors::communication::TopicRoute route;
+        benchmark::DoNotOptimize(registry.route(topics[i++ % topics.size()], route));
+    }
+    setAllocCounter(state, cycle.allocations());
+}
+BENCHMARK(BM_MqttRoute_Registry);
+
+// Topic dispatch as onMQTTMessage did it before the registry
+void BM_MqttRoute_Substring(benchmark::State& state) {
+    auto ids = sensorIds();
+    std::vector<std::string> topics;
+    for (const auto& id : ids) {
+        topics.push_back("sensors/gateway/command/" + id);
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        const std::string& topic = topics[i++ % topics.size()];
+        if (topic.find("/config/") != std::string::npos) {
+            std::string sensorId = topic.substr(topic.find("/config/") + 8);
+            benchmark::DoNotOptimize(sensorId);
+        }
+        if (topic.find("/command/") != std::string::npos) {
+            std::string sensorId = topic.substr(topic.find("/command/") + 9);
+            benchmark::DoNotOptimize(sensorId);
+        }
+    }
+}
+BENCHMARK(BM_MqttRoute_Substring);
+
+void BM_MqttCommand_Dom(benchmark::State& state) {
+    const std::string payload = R"({"action":"sleep"})";
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        auto command = sensors::json::parse(payload);
+        std::string action = command["action"];
+        benchmark::DoNotOptimize(action);
+    }
+    setAllocCounter(state, cycle.allocations());
+}
+BENCHMARK(BM_MqttCommand_Dom);
+
+void BM_MqttCommand_Parser(benchmark::State& state) {
+    const std::string payload = R"({"action":"sleep"})";
+    sensors::communication::SensorCommand command;
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sensors::communication::parseSensorCommand(payload, command));
+    }
+    setAllocCounter(state, cycle.allocations());
+}
+BENCHMARK(BM_MqttCommand_Parser);
+
+// sensorConfig update built from the sample instance configuration
+std::string configMessage() {
+    auto instance = sensors::json::parse(readFile(dataFile("configs/industrial_temp_sensor_instance.json")),
+                                         nullptr, false);
+    if (instance.is_discarded()) {
+        return std::string();
+    }
+    sensors::json message;
+    message["sensorConfig"] = instance["sensorConfig"]["sensorConfig"];
+    return message.dump();
+}
+
+void BM_MqttConfig_Dom(benchmark::State& state) {
+    const std::string payload = configMessage();
+    if (payload.empty()) {
+        state.SkipWithError("Data file not found");
+        return;
+    }
+
+    sensors::SensorConfig target;
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        auto message = sensors::json::parse(payload);
+        target.sensorConfig = message["sensorConfig"];
+        benchmark::DoNotOptimize(target);
+    }
+    setAllocCounter(state, cycle.allocations());
+}
+BENCHMARK(BM_MqttConfig_Dom);
+
+void BM_MqttConfig_Parser(benchmark::State& state) {
+    const std::string payload = configMessage();
+    if (payload.empty()) {
+        state.SkipWithError("Data file not found");
+        return;
+    }
+
+    sensors::communication::ConfigMessage message;
+    sensors::SensorConfig target;
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        sensors::communication::parseConfigMessage(payload, message);
+        benchmark::DoNotOptimize(sensors::communication::applyConfigMessage(message, target));
+    }
+    setAllocCounter(state, cycle.allocations());
+}
+BENCHMARK(BM_MqttConfig_Parser);
+
+//---------- Wireless Nodes ----------//
+
+// Node with a vendor-sequential MAC, as a batch of devices would have
+sensors::communication::NodeInfo nodeInfo(int i) {
+    char mac[18];
+    snprintf(mac, sizeof(mac), "24:6F:28:%02X:%02X:%02X", (i >> 16) & 0xFF, (i >> 8) & 0xFF, i & 0xFF);
+
+    sensors::communication::NodeInfo node;
+    node.nodeId = "node_" + std::to_string(i);
+    node.type = "environment";
+    node.protocol = "espnow";
+    node.macAddress = mac;
+    node.status = sensors::communication::NodeStatus::CONNECTED;
+    return node;
+}
+
+// Radio-path touch of a frame's sender, for registered nodes and for unknown MACs
+void BM_NodeTable_Lookup(benchmark::State& state) {
+    bool hit = state.range(0) != 0;
+    sensors::communication::NodeTable table;
+    std::vector<std::array<uint8_t, 6>> macs;
+    for (size_t i = 0; i < sensors::communication::NodeTable::MAX_NODES; i++) {
+        auto node = nodeInfo(static_cast<int>(i));
+        table.registerNode(node);
+        if (!hit) {
+            node = nodeInfo(static_cast<int>(i + 0x10000));
+        }
+        std::array<uint8_t, 6> mac;
+        sensors::communication::NodeTable::parseMac(node.macAddress, mac.data());
+        macs.push_back(mac);
+    }
+
+    size_t i = 0;
+    uint32_t now = 0;
+    for (auto _ : state) {
+        int handle = table.touch(macs[i++ % macs.size()].data(), sensors::communication::NodeProtocol::ESPNOW, now++);
+        benchmark::DoNotOptimize(handle);
+    }
+}
+BENCHMARK(BM_NodeTable_Lookup)->ArgName("hit")->Arg(0)->Arg(1);
+
+// A full table where one node leaves and a new one joins per iteration,
+// while lookups keep resolving the remaining nodes
+void BM_NodeTable_Churn(benchmark::State& state) {
+    const int nodes = static_cast<int>(sensors::communication::NodeTable::MAX_NODES);
+    sensors::communication::NodeTable table;
+    std::vector<std::array<uint8_t, 6>> macs(nodes);
+    for (int i = 0; i < nodes; i++) {
+        auto node = nodeInfo(i);
+        table.registerNode(node);
+        sensors::communication::NodeTable::parseMac(node.macAddress, macs[i].data());
+    }
+
+    int next = nodes;
+    uint32_t now = 0;
+    for (auto _ : state) {
+        int leaving = next - nodes;
+        table.unregisterNode("node_" + std::to_string(leaving));
+        auto node = nodeInfo(next++);
+        benchmark::DoNotOptimize(table.registerNode(node));
+        sensors::communication::NodeTable::parseMac(node.macAddress, macs[leaving % nodes].data());
+
+        for (int i = 0; i < nodes; i++) {
+            benchmark::DoNotOptimize(table.touch(macs[i].data(), sensors::communication::NodeProtocol::ESPNOW, now));
+        }
+        now++;
+    }
+    state.SetItemsProcessed(state.iterations() * nodes);
+}
+BENCHMARK(BM_NodeTable_Churn);
+
+// One node report of FRAME_CHANNELS channels with FRAME_ROUNDS samples each
+const int FRAME_CHANNELS = 3;
+const int FRAME_ROUNDS = 4;
+const char* const FRAME_CHANNEL_IDS[FRAME_CHANNELS] = {"temperature", "humidity", "soil_moisture"};
+const char* const FRAME_CHANNEL_UNITS[FRAME_CHANNELS] = {"°C", "%RH", "%"};
+
+sensors::communication::ReadingFrame frameReport() {
+    sensors::communication::ReadingFrame frame;
+    frame.nodeHandle = 7;
+    frame.sampleCount = FRAME_CHANNELS * FRAME_ROUNDS;
+    for (int i = 0; i < frame.sampleCount; i++) {
+        auto& sample = frame.samples[i];
+        sample.channel = static_cast<uint8_t>(i % FRAME_CHANNELS);
+        sample.timestamp = 1000000 + (i / FRAME_CHANNELS) * 5000;
+        sample.raw = 2140 + sample.channel * 1500 + i;
+    }
+    return frame;
+}
+
+// The same report as a legacy JSON message
+std::string jsonReport(const sensors::communication::ReadingFrame& frame) {
+    sensors::json report;
+    report["nodeId"] = "greenhouse_node_7";
+    report["readings"] = sensors::json::array();
+    for (int i = 0; i < frame.sampleCount; i++) {
+        const auto& sample = frame.samples[i];
+        report["readings"].push_back({
+            {"id", FRAME_CHANNEL_IDS[sample.channel]},
+            {"time", sample.timestamp},
+            {"value", frame.toValue(sample.raw)},
+            {"unit", FRAME_CHANNEL_UNITS[sample.channel]}
+        });
+    }
+    return report.dump();
+}
+
+// Receiver worker decode of one node report: a binary reading frame into the
+// channel's registered reading, as ESPNowFrameReceiver delivers it, or a JSON
+// message parsed into a pooled reading, as handleNodeReadings() does.
+// items_per_second is frames per second.
+void BM_EspNowFrame_Decode(benchmark::State& state, bool binary) {
+    auto report = frameReport();
+    std::vector<uint8_t> payload(sensors::communication::ESPNOW_MAX_FRAME_SIZE);
+    if (binary) {
+        payload.resize(sensors::communication::encodeReadingFrame(report, payload.data(), payload.size()));
+    } else {
+        std::string message = jsonReport(report);
+        payload.assign(message.begin(), message.end());
+    }
+
+    std::vector<sensors::SensorReading> channels(FRAME_CHANNELS);
+    for (int i = 0; i < FRAME_CHANNELS; i++) {
+        channels[i].sensorId = std::string("greenhouse_node_7_") + FRAME_CHANNEL_IDS[i];
+        channels[i].unit = FRAME_CHANNEL_UNITS[i];
+        channels[i].isValid = true;
+    }
+    sensors::communication::ReadingFrame frame;
+    sensors::ObjectPool<sensors::SensorReading, 4> pool;
+
+    double total = 0;
+    sensors::AllocCycle cycle;
+    for (auto _ : state) {
+        if (binary) {
+            if (!sensors::communication::decodeReadingFrame(payload.data(), payload.size(), frame)) {
+                state.SkipWithError("frame did not decode");
+                break;
+            }
+            for (int i = 0; i < frame.sampleCount; i++) {
+                const auto& sample = frame.samples[i];
+                sensors::SensorReading& reading = channels[sample.channel];
+                reading.timestamp = sample.timestamp;
+                reading.value = frame.toValue(sample.raw);
+                reading.rawValue = reading.value;
+                total += reading.value;
+            }
+        } else {
+            auto message = sensors::json::parse(payload.begin(), payload.end());
+            const std::string& nodeId = message["nodeId"].get_ref<const std::string&>();
+            auto reading = pool.acquire();
+            for (const auto& sample : message["readings"]) {
+                reading->sensorId.assign(nodeId).append("_").append(sample["id"].get_ref<const std::string&>());
+                reading->timestamp = sample["time"];
+                reading->value = sample["value"];
+                reading->rawValue = reading->value;
+                reading->unit.assign(sample["unit"].get_ref<const std::string&>());
+                total += reading->value;
+            }
+        }
+    }
+    setAllocCounter(state, cycle.allocations());
+    state.counters["bytes"] = static_cast<double>(payload.size());
+    state.SetItemsProcessed(state.iterations());
+    benchmark::DoNotOptimize(total);
+}
+BENCHMARK_CAPTURE(BM_EspNowFrame_Decode, json, false);
+BENCHMARK_CAPTURE(BM_EspNowFrame_Decode, binary, true);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,438 @@
+/**
+ * @file bench_sensors.cpp
+ * @brief Benchmarks of the sensor acquisition path on the simulated HAL
+ *
+ * Covers the single-wire decode, both compile-time specialized
+ * (SingleWireSensor<Protocol>, DHT11) and runtime configured (DigitalSensor),
+ * reading a whole fleet of sensors, applying calibration, and I2C register
+ * sensors running from protocol JSON. Besides CPU time, each read reports
+ * the virtual bus time it would occupy on the device as the "bus_us"
+ * counter, and the heap allocations it makes as "allocs"; I2C reads also
+ * report their bus transactions as "txns".
+ *
+ * The fleet benchmark runs with and without a trace scope around each read;
+ * the difference is the cost of the latency stage timers.
+ */
+
+#include "sim_hal.hpp"
+#include "core/utils/alloc_tracker.hpp"
+#include "core/utils/latency_trace.hpp"
+#include "sensors/digital/dht11.hpp"
+#include "sensors/digital/digital_sensor.hpp"
+#include "sensors/i2c/i2c_bus_scheduler.hpp"
+#include "sensors/i2c/i2c_register_sensor.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+const uint8_t DHT_PIN = 4;
+const uint32_t SAMPLING_PERIOD_MS = 2000;
+
+// Simulated HAL whose clock the latency tracer reads
+hal::SimHAL* g_traceHal = nullptr;
+
+uint32_t traceMicros() {
+    return g_traceHal->micros();
+}
+
+// Exposes the protected decode steps of DigitalSensor
+class BenchDigitalSensor : public sensors::DigitalSensor {
+public:
+    using DigitalSensor::readRaw;
+    using DigitalSensor::convertReading;
+};
+
+// Exposes the protected decode steps of SingleWireSensor
+template <typename Protocol>
+class BenchSingleWireSensor : public sensors::SingleWireSensor<Protocol> {
+public:
+    using sensors::SingleWireSensor<Protocol>::readRaw;
+};
+
+sensors::SensorConfig dhtConfig(const std::string& id, const std::string& protocol) {
+    sensors::SensorConfig config;
+    config.id = id;
+    config.name = protocol;
+    config.type = sensors::SensorType::TEMPERATURE;
+    config.bus = sensors::SensorBus::GPIO_DIGITAL;
+    config.busConfig = {{"pin", DHT_PIN}, {"protocol", protocol}};
+    return config;
+}
+
+void BM_DigitalSensor_ReadRaw(benchmark::State& state) {
+    hal::SimHAL sim;
+    sim.attachDHT(DHT_PIN, hal::SimHAL::dht11Frame(45, 23));
+
+    BenchDigitalSensor sensor;
+    sensor.configure(dhtConfig("dht_raw", "DHT11"));
+    sensor.begin(&sim);
+
+    uint64_t busTime = 0;
+    for (auto _ : state) {
+        uint64_t start = sim.now();
+        if (!sensor.readRaw()) {
+            state.SkipWithError(sensor.getLastError().c_str());
+            break;
+        }
+        busTime += sim.now() - start;
+    }
+    state.counters["bus_us"] = benchmark::Counter(static_cast<double>(busTime), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_DigitalSensor_ReadRaw);
+
+// Same frame as BM_DigitalSensor_ReadRaw, with the timings as constants
+void BM_SingleWire_ReadRaw(benchmark::State& state) {
+    hal::SimHAL sim;
+    sim.attachDHT(DHT_PIN, hal::SimHAL::dht11Frame(45, 23));
+
+    BenchSingleWireSensor<sensors::DHT11Protocol> sensor;
+    sensor.configure(dhtConfig("dht_raw", "DHT11"));
+    sensor.begin(&sim);
+
+    uint64_t busTime = 0;
+    for (auto _ : state) {
+        uint64_t start = sim.now();
+        if (!sensor.readRaw()) {
+            state.SkipWithError(sensor.getLastError().c_str());
+            break;
+        }
+        busTime += sim.now() - start;
+    }
+    state.counters["bus_us"] = benchmark::Counter(static_cast<double>(busTime), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SingleWire_ReadRaw);
+
+// Sensor is DHT11 (specialized) or DigitalSensor (protocol looked up at runtime)
+template <typename Sensor>
+void BM_DHT11_ReadAll(benchmark::State& state) {
+    hal::SimHAL sim;
+    sim.attachDHT(DHT_PIN, hal::SimHAL::dht11Frame(45, 23));
+
+    Sensor sensor;
+    sensor.configure(dhtConfig("dht11", "DHT11"));
+    sensor.begin(&sim);
+
+    uint64_t busTime = 0;
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        sim.advance(SAMPLING_PERIOD_MS * 1000);
+        uint64_t start = sim.now();
+        sensors::AllocCycle cycle;
+        auto readings = sensor.readAll();
+        if (readings.size() != 2) {
+            state.SkipWithError(sensor.getLastError().c_str());
+            break;
+        }
+        busTime += sim.now() - start;
+        benchmark::DoNotOptimize(readings);
+        allocations += cycle.allocations();
+    }
+    state.counters["bus_us"] = benchmark::Counter(static_cast<double>(busTime), benchmark::Counter::kAvgIterations);
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_TEMPLATE(BM_DHT11_ReadAll, sensors::DHT11);
+BENCHMARK_TEMPLATE(BM_DHT11_ReadAll, sensors::DigitalSensor);
+
+// Reads every sensor of a fleet the way SensorManager::readAll does
+void BM_SensorFleet_ReadAll(benchmark::State& state) {
+    hal::SimHAL sim;
+    sim.attachDHT(DHT_PIN, hal::SimHAL::dht11Frame(45, 23));
+    g_traceHal = &sim;
+    sensors::LatencyTracer tracer(traceMicros);
+    bool traced = state.range(1) != 0;
+
+    // Traces are resolved once per sensor, as SensorManager does when a sensor is added
+    std::vector<std::unique_ptr<sensors::ISensor>> fleet;
+    std::vector<sensors::SensorTrace*> traces;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        auto sensor = std::make_unique<sensors::DHT11>();
+        sensor->configure(dhtConfig("dht11_" + std::to_string(i), "DHT11"));
+        sensor->begin(&sim);
+        traces.push_back(traced ? tracer.sensor(sensor->getId()) : nullptr);
+        fleet.push_back(std::move(sensor));
+    }
+
+    std::vector<sensors::SensorReading> readings;
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        sim.advance(SAMPLING_PERIOD_MS * 1000);
+        sensors::AllocCycle cycle;
+        readings.clear();
+        for (size_t i = 0; i < fleet.size(); i++) {
+            sensors::TraceScope scope(traces[i]);
+            auto sensorReadings = fleet[i]->readAll();
+            readings.insert(readings.end(), sensorReadings.begin(), sensorReadings.end());
+        }
+        if (readings.size() != fleet.size() * 2) {
+            state.SkipWithError("Sensor read failed");
+            break;
+        }
+        benchmark::DoNotOptimize(readings);
+        allocations += cycle.allocations();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    g_traceHal = nullptr;
+}
+BENCHMARK(BM_SensorFleet_ReadAll)
+    ->ArgsProduct({{1, 10, 100, 1000}, {0, 1}})
+    ->ArgNames({"sensors", "traced"})
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_Calibration_Load(benchmark::State& state) {
+    sensors::DHT11 sensor;
+    sensors::json calibration = {
+        {"temperature", {{"offset", -0.5}, {"scale", 1.02}}},
+        {"humidity", {{"offset", 1.5}, {"scale", 0.98}}}
+    };
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sensor.calibrate(calibration));
+    }
+}
+BENCHMARK(BM_Calibration_Load);
+
+void BM_Calibration_Apply(benchmark::State& state) {
+    BenchDigitalSensor sensor;
+    sensor.configure(dhtConfig("dht22", "DHT22"));
+    sensor.calibrate({{"offset", -0.5}, {"scale", 1.02}});
+
+    uint8_t frame[5] = {0x02, 0x8C, 0x00, 0xE6, 0x74};
+    const std::string unit = "°C";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sensor.convertReading(frame, 0, unit));
+    }
+}
+BENCHMARK(BM_Calibration_Apply);
+
+// Channel decode through the DigitalProtocol pointer and inlined from the traits
+void BM_Decode_Runtime(benchmark::State& state) {
+    const sensors::DigitalProtocol& protocol = sensors::SENSOR_PROTOCOLS.at("DHT22");
+    uint8_t frame[5] = {0x02, 0x8C, 0x80, 0xE6, 0xF4};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(frame);
+        for (size_t i = 0; i < protocol.channelCount; i++) {
+            benchmark::DoNotOptimize(protocol.decode(frame, i));
+        }
+    }
+}
+BENCHMARK(BM_Decode_Runtime);
+
+void BM_Decode_Traits(benchmark::State& state) {
+    uint8_t frame[5] = {0x02, 0x8C, 0x80, 0xE6, 0xF4};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(frame);
+        for (size_t i = 0; i < sensors::DHT22Protocol::channelCount; i++) {
+            benchmark::DoNotOptimize(sensors::DHT22Protocol::decode(frame, i));
+        }
+    }
+}
+BENCHMARK(BM_Decode_Traits);
+
+//---------- I2C Register Sensors ----------//
+
+const uint8_t I2C_ADDRESS = 0x48;
+
+sensors::json industrialProtocol() {
+    std::ifstream file(std::string(SENSORHUB_DATA_DIR) + "/protocols/industrial_temp_sensor.json");
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return sensors::json::parse(contents.str(), nullptr, false);
+}
+
+// Auto-increment device with four fields: three close together, one apart
+sensors::json environmentalProtocol() {
+    return {{"protocol", {
+        {"name", "EnvSensor"},
+        {"communication", {{"i2c", {{"autoIncrement", true}, {"clockSpeed", 1000000}}}}},
+        {"capabilities", {{"sensorTypes", {"temperature"}}}},
+        {"dataFormat", {{"fields", {
+            {{"name", "temperature"}, {"register", "0x00"}, {"type", "int16"}, {"scaling", 0.01}, {"unit", "°C"}},
+            {{"name", "humidity"}, {"register", "0x02"}, {"type", "uint16"}, {"scaling", 0.01}, {"unit", "%"}},
+            {{"name", "pressure"}, {"register", "0x05"}, {"type", "uint24"}, {"scaling", 0.01}, {"unit", "hPa"}},
+            {{"name", "status"}, {"register", "0x10"}, {"type", "uint8"}, {"unit", "raw"}}
+        }}}}
+    }}};
+}
+
+void attachRegisterDevice(hal::SimHAL& sim, bool autoIncrement, uint8_t address = I2C_ADDRESS) {
+    sim.attachI2CDevice(address, autoIncrement);
+    sim.setI2CRegister(address, 0x00, {0x08, 0x3A});
+    sim.setI2CRegister(address, 0xFE, {0x55});
+    if (autoIncrement) {
+        sim.setI2CRegister(address, 0x02, {0x15, 0x7C, 0x00, 0x01, 0x8A, 0xC3});
+        sim.setI2CRegister(address, 0x10, {0x01});
+    }
+}
+
+// Readings through the compiled read plan
+void BM_I2CRegister_ReadAll(benchmark::State& state, sensors::json (*protocol)()) {
+    sensors::json document = protocol();
+    if (document.is_discarded()) {
+        state.SkipWithError("Data file not found");
+        return;
+    }
+
+    sensors::I2CRegisterSensor sensor(document);
+    bool autoIncrement = sensor.getName() != "IndustrialTempSensor";
+    hal::SimHAL sim;
+    attachRegisterDevice(sim, autoIncrement);
+
+    sensors::SensorConfig config;
+    config.id = "i2c_sensor";
+    config.busConfig = {{"address", "0x48"}, {"settings", {{"resolution", "14-bit"}}}};
+    if (!sensor.configure(config) || !sensor.begin(&sim)) {
+        state.SkipWithError(sensor.getLastError().c_str());
+        return;
+    }
+
+    const size_t fields = sensor.getReadPlan().fields.size();
+    uint64_t busTime = 0;
+    uint64_t allocations = 0;
+    uint32_t startTransactions = sim.i2cTransactions();
+    for (auto _ : state) {
+        uint64_t start = sim.now();
+        sensors::AllocCycle cycle;
+        auto readings = sensor.readAll();
+        if (readings.size() != fields) {
+            state.SkipWithError(sensor.getLastError().c_str());
+            break;
+        }
+        busTime += sim.now() - start;
+        benchmark::DoNotOptimize(readings);
+        allocations += cycle.allocations();
+    }
+    state.counters["bus_us"] = benchmark::Counter(static_cast<double>(busTime), benchmark::Counter::kAvgIterations);
+    state.counters["txns"] = benchmark::Counter(static_cast<double>(sim.i2cTransactions() - startTransactions),
+                                                benchmark::Counter::kAvgIterations);
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK_CAPTURE(BM_I2CRegister_ReadAll, industrial, industrialProtocol);
+BENCHMARK_CAPTURE(BM_I2CRegister_ReadAll, environmental, environmentalProtocol);
+
+// The environmental fields read one register access at a time, as a
+// hand-written driver without a read plan would
+void BM_I2CRegister_PerField(benchmark::State& state) {
+    hal::SimHAL sim;
+    attachRegisterDevice(sim, true);
+    const std::vector<std::pair<uint8_t, size_t>> fields = {{0x00, 2}, {0x02, 2}, {0x05, 3}, {0x10, 1}};
+
+    uint64_t busTime = 0;
+    uint32_t startTransactions = sim.i2cTransactions();
+    std::vector<uint8_t> data;
+    for (auto _ : state) {
+        uint64_t start = sim.now();
+        for (const auto& field : fields) {
+            sim.i2cWrite(I2C_ADDRESS, {field.first});
+            sim.i2cRead(I2C_ADDRESS, data, field.second);
+            benchmark::DoNotOptimize(data);
+        }
+        busTime += sim.now() - start;
+    }
+    state.counters["bus_us"] = benchmark::Counter(static_cast<double>(busTime), benchmark::Counter::kAvgIterations);
+    state.counters["txns"] = benchmark::Counter(static_cast<double>(sim.i2cTransactions() - startTransactions),
+                                                benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_I2CRegister_PerField);
+
+} // namespace
+
+//---------- Shared I2C Bus ----------//
+
+const uint8_t BUS_SDA = 21;
+const uint8_t BUS_SCL = 22;
+
+// Four devices on one bus: the pointer-addressed industrial sensor at
+// 100 kHz, two environmental sensors at 1 MHz and one limited to 400 kHz
+struct SharedBus {
+    hal::SimHAL sim;
+    std::vector<std::unique_ptr<sensors::I2CRegisterSensor>> sensors;
+
+    bool add(sensors::json protocol, uint8_t address, bool autoIncrement) {
+        attachRegisterDevice(sim, autoIncrement, address);
+        auto sensor = std::make_unique<sensors::I2CRegisterSensor>(protocol);
+        sensors::SensorConfig config;
+        config.id = "i2c_" + std::to_string(address);
+        config.busConfig = {{"address", address}};
+        if (!sensor->configure(config) || !sensor->begin(&sim)) return false;
+        sensors.push_back(std::move(sensor));
+        return true;
+    }
+
+    bool build() {
+        sensors::json industrial = industrialProtocol();
+        if (industrial.is_discarded()) return false;
+        sensors::json limited = environmentalProtocol();
+        limited["protocol"]["communication"]["i2c"]["clockSpeed"] = 400000;
+        sim.i2cInit(BUS_SDA, BUS_SCL);
+        return add(industrial, 0x48, false) &&
+               add(environmentalProtocol(), 0x76, true) &&
+               add(limited, 0x77, true) &&
+               add(environmentalProtocol(), 0x40, true);
+    }
+};
+
+// Each sensor takes the bus lock and reads on its own, at the shared clock
+void BM_I2CBus_Independent(benchmark::State& state) {
+    SharedBus bus;
+    if (!bus.build()) {
+        state.SkipWithError("Bus setup failed");
+        return;
+    }
+
+    std::mutex busMutex;
+    uint64_t busTime = 0;
+    for (auto _ : state) {
+        uint64_t start = bus.sim.now();
+        size_t count = 0;
+        for (auto& sensor : bus.sensors) {
+            std::lock_guard<std::mutex> lock(busMutex);
+            count += sensor->readAll().size();
+        }
+        busTime += bus.sim.now() - start;
+        benchmark::DoNotOptimize(count);
+    }
+    state.counters["bus_us"] = benchmark::Counter(static_cast<double>(busTime), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_I2CBus_Independent);
+
+// The same bus read in one scheduled window, each device at its own clock
+void BM_I2CBus_Scheduled(benchmark::State& state) {
+    SharedBus bus;
+    if (!bus.build()) {
+        state.SkipWithError("Bus setup failed");
+        return;
+    }
+
+    sensors::I2CBusScheduler scheduler(&bus.sim, BUS_SDA, BUS_SCL);
+    for (auto& sensor : bus.sensors) {
+        scheduler.addSensor(sensor.get());
+    }
+
+    uint64_t busTime = 0;
+    for (auto _ : state) {
+        uint64_t start = bus.sim.now();
+        auto readings = scheduler.readAll();
+        busTime += bus.sim.now() - start;
+        benchmark::DoNotOptimize(readings);
+    }
+
+    sensors::I2CBusReport report = scheduler.getReport();
+    uint32_t worstLatency = 0;
+    for (const auto& device : report.devices) {
+        worstLatency = std::max(worstLatency, device.maxLatencyUs);
+    }
+    state.counters["bus_us"] = benchmark::Counter(static_cast<double>(busTime), benchmark::Counter::kAvgIterations);
+    state.counters["clock_changes"] = benchmark::Counter(static_cast<double>(report.clockChanges),
+                                                         benchmark::Counter::kAvgIterations);
+    state.counters["max_latency_us"] = worstLatency;
+}
+BENCHMARK(BM_I2CBus_Scheduled);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,48 @@
+# Runs the host benchmarks and writes machine-readable reports.
+#
+#   cmake -DBENCHMARKS=<exe>,<exe> -DREPORT_DIR=<dir> -DSOURCE_DIR=<repo> -P run_benchmarks.cmake
+#
+# Each executable writes <REPORT_DIR>/<name>.json in Google Benchmark's JSON
+# format; the commit hash and dirty flag are added to the report context so
+# reports from different commits can be compared.
+
+execute_process(
+    COMMAND git rev-parse HEAD
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE GIT_COMMIT
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+)
+execute_process(
+    COMMAND git status --porcelain --untracked-files=no
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE GIT_STATUS
+    ERROR_QUIET
+)
+if(NOT GIT_COMMIT)
+    set(GIT_COMMIT unknown)
+endif()
+if(GIT_STATUS)
+    set(GIT_DIRTY true)
+else()
+    set(GIT_DIRTY false)
+endif()
+
+string(REPLACE "," ";" BENCHMARKS "${BENCHMARKS}")
+file(MAKE_DIRECTORY ${REPORT_DIR})
+foreach(BENCHMARK ${BENCHMARKS})
+    get_filename_component(NAME ${BENCHMARK} NAME_WE)
+    message(STATUS "Running ${NAME}")
+    execute_process(
+        COMMAND ${BENCHMARK}
+            --benchmark_out=${REPORT_DIR}/${NAME}.json
+            --benchmark_out_format=json
+            --benchmark_context=git_commit=${GIT_COMMIT}
+            --benchmark_context=git_dirty=${GIT_DIRTY}
+        RESULT_VARIABLE RESULT
+    )
+    if(NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "${NAME} failed (${RESULT})")
+    endif()
+endforeach()
+message(STATUS "Reports written to ${REPORT_DIR}")
@@ -0,0 +1,248 @@
+#include "sim_hal.hpp"
+#include <algorithm>
+
+namespace hal {
+
+namespace {
+
+// DHT timing after the host releases the line (us)
+const uint32_t DHT_RELEASE_HIGH = 30;
+const uint32_t DHT_RESPONSE_LOW = 80;
+const uint32_t DHT_RESPONSE_HIGH = 80;
+const uint32_t DHT_BIT_LOW = 50;
+const uint32_t DHT_ZERO_HIGH = 26;
+const uint32_t DHT_ONE_HIGH = 70;
+
+} // namespace
+
+void SimHAL::attachDHT(uint8_t pin, const std::array<uint8_t, 5>& frame) {
+    Pin& state = pins_[pin];
+    state.hasDHT = true;
+    state.edges.clear();
+
+    // Each entry ends a phase; phases alternate starting with high
+    uint32_t t = DHT_RELEASE_HIGH;
+    state.edges.push_back(t);
+    t += DHT_RESPONSE_LOW;
+    state.edges.push_back(t);
+    t += DHT_RESPONSE_HIGH;
+    state.edges.push_back(t);
+    for (uint8_t byte : frame) {
+        for (int bit = 7; bit >= 0; bit--) {
+            t += DHT_BIT_LOW;
+            state.edges.push_back(t);
+            t += (byte >> bit) & 1 ? DHT_ONE_HIGH : DHT_ZERO_HIGH;
+            state.edges.push_back(t);
+        }
+    }
+    t += DHT_BIT_LOW;
+    state.edges.push_back(t);  // Line stays high after the frame
+}
+
+std::array<uint8_t, 5> SimHAL::dht11Frame(uint8_t humidity, uint8_t temperature) {
+    return {humidity, 0, temperature, 0, static_cast<uint8_t>(humidity + temperature)};
+}
+
+void SimHAL::attachI2CDevice(uint8_t address, bool autoIncrement) {
+    I2CDevice& device = i2cDevices_[address];
+    device.autoIncrement = autoIncrement;
+}
+
+void SimHAL::setI2CRegister(uint8_t address, uint8_t reg, const std::vector<uint8_t>& bytes) {
+    I2CDevice& device = i2cDevices_[address];
+    if (device.autoIncrement) {
+        for (size_t i = 0; i < bytes.size(); i++) {
+            device.memory[(reg + i) & 0xFF] = bytes[i];
+        }
+    } else {
+        device.registers[reg] = bytes;
+    }
+}
+
+uint32_t SimHAL::i2cTransactions() const {
+    return i2cTransactions_;
+}
+
+void SimHAL::advance(uint64_t us) {
+    clock_ += us;
+}
+
+uint64_t SimHAL::now() const {
+    return clock_;
+}
+
+void SimHAL::pinMode(uint8_t pin, PinMode mode) {
+    Pin& state = pins_[pin];
+    bool wasOutput = state.mode == PinMode::OUTPUT;
+    state.mode = mode;
+
+    // Releasing the line after a start signal triggers the response
+    if (state.hasDHT && wasOutput && mode != PinMode::OUTPUT) {
+        state.releasedAt = clock_;
+        state.responding = true;
+    }
+}
+
+void SimHAL::digitalWrite(uint8_t pin, bool value) {
+    pins_[pin].output = value;
+}
+
+bool SimHAL::digitalRead(uint8_t pin) {
+    auto it = pins_.find(pin);
+    if (it == pins_.end()) {
+        return true;  // Pulled up
+    }
+
+    const Pin& state = it->second;
+    if (state.mode == PinMode::OUTPUT) {
+        return state.output;
+    }
+    if (!state.responding) {
+        return true;
+    }
+
+    // Every edge passed toggles the level, starting high
+    uint64_t elapsed = clock_ - state.releasedAt;
+    size_t passed = std::upper_bound(state.edges.begin(), state.edges.end(), elapsed) - state.edges.begin();
+    return passed % 2 == 0;
+}
+
+uint16_t SimHAL::analogRead(uint8_t) {
+    return 0;
+}
+
+void SimHAL::analogWrite(uint8_t, uint16_t) {
+}
+
+bool SimHAL::i2cInit(uint8_t, uint8_t, I2CSpeed speed) {
+    i2cFrequency_ = static_cast<uint32_t>(speed);
+    return true;
+}
+
+bool SimHAL::i2cWrite(uint8_t address, const std::vector<uint8_t>& data) {
+    i2cTransfer(data.size());
+    auto it = i2cDevices_.find(address);
+    if (it == i2cDevices_.end() || data.empty()) {
+        return false;  // Not acknowledged
+    }
+
+    I2CDevice& device = it->second;
+    device.pointer = data[0];
+    if (data.size() > 1) {
+        std::vector<uint8_t> value(data.begin() + 1, data.end());
+        setI2CRegister(address, device.pointer, value);
+    }
+    return true;
+}
+
+bool SimHAL::i2cRead(uint8_t address, std::vector<uint8_t>& data, size_t length) {
+    i2cTransfer(length);
+    auto it = i2cDevices_.find(address);
+    if (it == i2cDevices_.end()) {
+        return false;
+    }
+
+    I2CDevice& device = it->second;
+    data.resize(length);
+    if (device.autoIncrement) {
+        for (size_t i = 0; i < length; i++) {
+            data[i] = device.memory[device.pointer++];
+        }
+    } else {
+        const std::vector<uint8_t>& reg = device.registers[device.pointer];
+        for (size_t i = 0; i < length; i++) {
+            data[i] = i < reg.size() ? reg[i] : 0xFF;
+        }
+    }
+    return true;
+}
+
+std::vector<uint8_t> SimHAL::i2cScan() {
+    std::vector<uint8_t> addresses;
+    for (const auto& device : i2cDevices_) {
+        addresses.push_back(device.first);
+    }
+    return addresses;
+}
+
+bool SimHAL::spiInit(uint8_t, uint8_t, uint8_t, uint8_t, SPIMode) {
+    return true;
+}
+
+bool SimHAL::spiTransfer(const std::vector<uint8_t>& tx_data, std::vector<uint8_t>& rx_data) {
+    rx_data.assign(tx_data.size(), 0xFF);
+    return true;
+}
+
+void SimHAL::spiChipSelect(bool) {
+}
+
+uint32_t SimHAL::millis() {
+    return static_cast<uint32_t>(clock_ / 1000);
+}
+
+uint32_t SimHAL::micros() {
+    return static_cast<uint32_t>(clock_);
+}
+
+void SimHAL::delay(uint32_t ms) {
+    clock_ += static_cast<uint64_t>(ms) * 1000;
+}
+
+void SimHAL::delayMicroseconds(uint32_t us) {
+    clock_ += us;
+}
+
+void SimHAL::watchdogReset() {
+}
+
+void SimHAL::systemReset() {
+}
+
+float SimHAL::getCpuTemperature() {
+    return 40.0f;
+}
+
+float SimHAL::getVoltage() {
+    return 3.3f;
+}
+
+std::string SimHAL::getPlatformName() {
+    return "Simulated";
+}
+
+std::string SimHAL::getUniqueId() {
+    return "SIM000000000000";
+}
+
+bool SimHAL::nvStoreWrite(const std::string& key, const std::vector<uint8_t>& data) {
+    nvStore_[key] = data;
+    return true;
+}
+
+bool SimHAL::nvStoreRead(const std::string& key, std::vector<uint8_t>& data) {
+    auto it = nvStore_.find(key);
+    if (it == nvStore_.end()) {
+        return false;
+    }
+    data = it->second;
+    return true;
+}
+
+bool SimHAL::nvStoreDelete(const std::string& key) {
+    return nvStore_.erase(key) > 0;
+}
+
+void SimHAL::nvStoreClear() {
+    nvStore_.clear();
+}
+
+// Private methods
+void SimHAL::i2cTransfer(size_t bytes) {
+    // Start, address byte, data bytes (9 clocks each with the ACK), stop
+    uint64_t clocks = 1 + 9 * (bytes + 1) + 1;
+    clock_ += (clocks * 1000000 + i2cFrequency_ - 1) / i2cFrequency_;
+    i2cTransactions_++;
+}
+
+} // namespace hal
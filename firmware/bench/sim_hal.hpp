@@ -0,0 +1,163 @@
+/**
+ * @file sim_hal.hpp
+ * @brief Simulated HAL for host builds
+ *
+ * This file defines the SimHAL class, an implementation of the sensor HAL
+ * interface that runs on a virtual clock and replays the single-wire
+ * waveform of DHT-style sensors, so that sensor drivers can be exercised
+ * and measured without hardware. Register-mapped I2C devices can be
+ * attached as well.
+ */
+
+#pragma once
+
+#include "hal/interface/hal.hpp"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace hal {
+
+/**
+ * @brief Simulated hardware on a virtual clock
+ *
+ * delay() and delayMicroseconds() advance the virtual clock instead of
+ * sleeping, so a driver's blocking waits cost no wall time and the time the
+ * transfer would take on the wire can be read back from micros().
+ *
+ * A pin with an attached DHT frame answers every start signal: when the pin
+ * is switched back to input, the line follows the DHT response (80 us low,
+ * 80 us high) and then the 40 data bits (50 us low, then 26 us high for a 0
+ * or 70 us high for a 1), most significant bit first.
+ *
+ * An attached I2C device takes the first byte of a write as its register
+ * pointer and stores the rest. With auto-increment, registers are single
+ * bytes and reads continue through the following registers; without it,
+ * each pointer selects a whole register that a read returns. Every
+ * transaction advances the virtual clock by its time on the wire at the
+ * configured bus speed.
+ */
+class SimHAL : public IHAL {
+public:
+    SimHAL() = default;
+
+    //---------- Simulation Control ----------//
+
+    /**
+     * @brief Attach a simulated DHT sensor to a pin
+     * @param pin Pin number
+     * @param frame Five data bytes; the last is the checksum
+     */
+    void attachDHT(uint8_t pin, const std::array<uint8_t, 5>& frame);
+
+    /**
+     * @brief Build a DHT11 frame with a valid checksum
+     * @param humidity Integral humidity (%)
+     * @param temperature Integral temperature (°C)
+     * @return Frame bytes
+     */
+    static std::array<uint8_t, 5> dht11Frame(uint8_t humidity, uint8_t temperature);
+
+    /**
+     * @brief Attach a simulated register-mapped I2C device
+     * @param address 7-bit device address
+     * @param autoIncrement True if reads continue into the following registers
+     */
+    void attachI2CDevice(uint8_t address, bool autoIncrement);
+
+    /**
+     * @brief Set register contents of a simulated I2C device
+     * @param address Device address
+     * @param reg Register
+     * @param bytes Contents; with auto-increment they fill consecutive registers
+     */
+    void setI2CRegister(uint8_t address, uint8_t reg, const std::vector<uint8_t>& bytes);
+
+    /**
+     * @brief Get number of I2C transactions since construction
+     * @return Transactions, writes and reads
+     */
+    uint32_t i2cTransactions() const;
+
+    /**
+     * @brief Advance the virtual clock
+     * @param us Microseconds to advance
+     */
+    void advance(uint64_t us);
+
+    /**
+     * @brief Get the virtual clock
+     * @return Microseconds since construction
+     */
+    uint64_t now() const;
+
+    //---------- IHAL ----------//
+
+    void pinMode(uint8_t pin, PinMode mode) override;
+    void digitalWrite(uint8_t pin, bool value) override;
+    bool digitalRead(uint8_t pin) override;
+    uint16_t analogRead(uint8_t pin) override;
+    void analogWrite(uint8_t pin, uint16_t value) override;
+
+    bool i2cInit(uint8_t sda, uint8_t scl, I2CSpeed speed = I2CSpeed::STANDARD_MODE) override;
+    bool i2cWrite(uint8_t address, const std::vector<uint8_t>& data) override;
+    bool i2cRead(uint8_t address, std::vector<uint8_t>& data, size_t length) override;
+    std::vector<uint8_t> i2cScan() override;
+
+    bool spiInit(uint8_t sck, uint8_t miso, uint8_t mosi, uint8_t cs, SPIMode mode = SPIMode::MODE0) override;
+    bool spiTransfer(const std::vector<uint8_t>& tx_data, std::vector<uint8_t>& rx_data) override;
+    void spiChipSelect(bool select) override;
+
+    uint32_t millis() override;
+    uint32_t micros() override;
+    void delay(uint32_t ms) override;
+    void delayMicroseconds(uint32_t us) override;
+
+    void watchdogReset() override;
+    void systemReset() override;
+    float getCpuTemperature() override;
+    float getVoltage() override;
+    std::string getPlatformName() override;
+    std::string getUniqueId() override;
+
+    bool nvStoreWrite(const std::string& key, const std::vector<uint8_t>& data) override;
+    bool nvStoreRead(const std::string& key, std::vector<uint8_t>& data) override;
+    bool nvStoreDelete(const std::string& key) override;
+    void nvStoreClear() override;
+
+private:
+    /**
+     * @brief Simulated pin state
+     */
+    struct Pin {
+        PinMode mode{PinMode::INPUT};       ///< Current mode
+        bool output{true};                  ///< Level driven while an output
+        bool hasDHT{false};                 ///< A DHT sensor is attached
+        uint64_t releasedAt{0};             ///< Time the host released the line (us)
+        bool responding{false};             ///< The DHT is sending a frame
+        std::vector<uint32_t> edges;        ///< Level changes after release (us), high before the first
+    };
+
+    /**
+     * @brief Simulated I2C device
+     */
+    struct I2CDevice {
+        bool autoIncrement{true};                           ///< Reads advance the pointer
+        uint8_t pointer{0};                                 ///< Register pointer
+        std::array<uint8_t, 256> memory{};                  ///< Byte registers, with auto-increment
+        std::map<uint8_t, std::vector<uint8_t>> registers;  ///< Whole registers, without it
+    };
+
+    void i2cTransfer(size_t bytes);
+
+    uint64_t clock_{0};                                     ///< Virtual time (us)
+    std::map<uint8_t, Pin> pins_;                           ///< Pin state by number
+    std::map<uint8_t, I2CDevice> i2cDevices_;               ///< I2C devices by address
+    uint32_t i2cFrequency_{100000};                         ///< I2C clock (Hz)
+    uint32_t i2cTransactions_{0};                           ///< I2C transactions
+    std::map<std::string, std::vector<uint8_t>> nvStore_;   ///< Non-volatile storage
+};
+
+} // namespace hal
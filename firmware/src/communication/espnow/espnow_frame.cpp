@@ -0,0 +1,171 @@
+#include "espnow_frame.hpp"
+#include <cmath>
+#include <limits>
+
+namespace sensors {
+namespace communication {
+
+namespace {
+
+const size_t CRC_SIZE = 2;
+
+bool putVarint(uint8_t*& pos, const uint8_t* end, uint64_t value) {
+    do {
+        if (pos >= end) return false;
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        *pos++ = byte | (value ? 0x80 : 0);
+    } while (value);
+    return true;
+}
+
+bool getVarint(const uint8_t*& pos, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= end) return false;
+        uint8_t byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace
+
+double ReadingFrame::toValue(int32_t raw) const {
+    return raw * std::pow(10.0, scale);
+}
+
+int32_t ReadingFrame::toRaw(double value) const {
+    double raw = std::round(value * std::pow(10.0, -scale));
+    if (raw >= std::numeric_limits<int32_t>::max()) return std::numeric_limits<int32_t>::max();
+    if (raw <= std::numeric_limits<int32_t>::min()) return std::numeric_limits<int32_t>::min();
+    return static_cast<int32_t>(raw);
+}
+
+bool isReadingFrame(const uint8_t* data, size_t length) {
+    return length >= ESPNOW_FRAME_HEADER_SIZE + CRC_SIZE &&
+           data[0] == ESPNOW_FRAME_MAGIC &&
+           data[1] == ESPNOW_FRAME_VERSION;
+}
+
+size_t encodeReadingFrame(const ReadingFrame& frame, uint8_t* buffer, size_t size) {
+    if (size > ESPNOW_MAX_FRAME_SIZE) {
+        size = ESPNOW_MAX_FRAME_SIZE;
+    }
+    if (size < ESPNOW_FRAME_HEADER_SIZE + CRC_SIZE || frame.sampleCount > ESPNOW_FRAME_MAX_SAMPLES) {
+        return 0;
+    }
+
+    uint32_t baseTimestamp = frame.sampleCount > 0 ? frame.samples[0].timestamp : 0;
+
+    uint8_t* pos = buffer;
+    *pos++ = ESPNOW_FRAME_MAGIC;
+    *pos++ = ESPNOW_FRAME_VERSION;
+    *pos++ = frame.nodeHandle & 0xFF;
+    *pos++ = frame.nodeHandle >> 8;
+    *pos++ = frame.sequence;
+    *pos++ = static_cast<uint8_t>(frame.scale);
+    for (int i = 0; i < 4; i++) {
+        *pos++ = static_cast<uint8_t>(baseTimestamp >> (8 * i));
+    }
+    *pos++ = frame.sampleCount;
+
+    const uint8_t* end = buffer + size - CRC_SIZE;
+    std::array<int32_t, ESPNOW_FRAME_MAX_CHANNELS> previous{};
+    uint32_t lastTimestamp = baseTimestamp;
+
+    for (size_t i = 0; i < frame.sampleCount; i++) {
+        const ReadingFrameSample& sample = frame.samples[i];
+        if (sample.channel >= ESPNOW_FRAME_MAX_CHANNELS || sample.timestamp < lastTimestamp) {
+            return 0;
+        }
+        if (pos >= end) {
+            return 0;
+        }
+
+        *pos++ = sample.channel;
+        if (!putVarint(pos, end, sample.timestamp - lastTimestamp) ||
+            !putVarint(pos, end, zigzag(static_cast<int64_t>(sample.raw) - previous[sample.channel]))) {
+            return 0;
+        }
+
+        lastTimestamp = sample.timestamp;
+        previous[sample.channel] = sample.raw;
+    }
+
+    uint16_t crc = frameCrc16(buffer, pos - buffer);
+    *pos++ = crc & 0xFF;
+    *pos++ = crc >> 8;
+    return pos - buffer;
+}
+
+bool decodeReadingFrame(const uint8_t* data, size_t length, ReadingFrame& frame) {
+    if (!isReadingFrame(data, length) || length > ESPNOW_MAX_FRAME_SIZE) {
+        return false;
+    }
+
+    uint16_t crc = data[length - 2] | (data[length - 1] << 8);
+    if (frameCrc16(data, length - CRC_SIZE) != crc) {
+        return false;
+    }
+
+    frame.nodeHandle = data[2] | (data[3] << 8);
+    frame.sequence = data[4];
+    frame.scale = static_cast<int8_t>(data[5]);
+    uint32_t timestamp = data[6] | (data[7] << 8) | (data[8] << 16) | (static_cast<uint32_t>(data[9]) << 24);
+    frame.sampleCount = data[10];
+    if (frame.sampleCount > ESPNOW_FRAME_MAX_SAMPLES) {
+        return false;
+    }
+
+    const uint8_t* pos = data + ESPNOW_FRAME_HEADER_SIZE;
+    const uint8_t* end = data + length - CRC_SIZE;
+    std::array<int32_t, ESPNOW_FRAME_MAX_CHANNELS> previous{};
+
+    for (size_t i = 0; i < frame.sampleCount; i++) {
+        if (pos >= end) {
+            return false;
+        }
+        ReadingFrameSample& sample = frame.samples[i];
+        sample.channel = *pos++;
+        if (sample.channel >= ESPNOW_FRAME_MAX_CHANNELS) {
+            return false;
+        }
+
+        uint64_t timeDelta;
+        uint64_t valueDelta;
+        if (!getVarint(pos, end, timeDelta) || !getVarint(pos, end, valueDelta)) {
+            return false;
+        }
+
+        timestamp += static_cast<uint32_t>(timeDelta);
+        sample.timestamp = timestamp;
+        sample.raw = static_cast<int32_t>(previous[sample.channel] + unzigzag(valueDelta));
+        previous[sample.channel] = sample.raw;
+    }
+
+    return pos == end;
+}
+
+uint16_t frameCrc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+} // namespace communication
+} // namespace sensors
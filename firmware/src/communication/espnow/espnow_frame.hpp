@@ -0,0 +1,113 @@
+/**
+ * @file espnow_frame.hpp
+ * @brief Binary reading frame format for ESP-NOW nodes
+ *
+ * This file defines the compact, versioned binary frame that wireless nodes
+ * use to send sensor readings over ESP-NOW, together with its encoder and
+ * decoder. Both are allocation-free and build for the host as well.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace sensors {
+namespace communication {
+
+/**
+ * Frame layout (little endian):
+ *
+ *   magic u8 | version u8 | nodeHandle u16 | sequence u8 | scale i8 |
+ *   baseTimestamp u32 | sampleCount u8 | samples... | crc16 u16
+ *
+ * Each sample is: channel u8 | timeDelta uvarint | valueDelta svarint
+ *
+ * timeDelta is the offset in ms from the previous sample (the first sample
+ * from baseTimestamp). valueDelta is the zigzag-coded difference to the
+ * previous raw value of the same channel in the frame (the first from 0).
+ * The physical value is raw * 10^scale. The CRC is CRC-16/CCITT-FALSE over
+ * everything before it.
+ */
+const uint8_t ESPNOW_FRAME_MAGIC = 0xB5;            ///< First byte of a reading frame
+const uint8_t ESPNOW_FRAME_VERSION = 1;             ///< Current frame version
+const size_t ESPNOW_MAX_FRAME_SIZE = 250;           ///< ESP-NOW payload limit
+const size_t ESPNOW_FRAME_HEADER_SIZE = 11;         ///< Header bytes before the samples
+const size_t ESPNOW_FRAME_MAX_SAMPLES = 79;         ///< Samples that fit at 3 bytes each
+const size_t ESPNOW_FRAME_MAX_CHANNELS = 32;         ///< Channels per node
+
+/**
+ * @brief Sample of a reading frame
+ */
+struct ReadingFrameSample {
+    uint8_t channel{0};         ///< Channel index in the node's channel table
+    uint32_t timestamp{0};      ///< Sender timestamp (ms), only meaningful relative to the frame's other samples
+    int32_t raw{0};             ///< Raw value, physical value is raw * 10^scale
+};
+
+/**
+ * @brief Decoded reading frame
+ */
+struct ReadingFrame {
+    uint16_t nodeHandle{0};                                         ///< Handle assigned to the node
+    uint8_t sequence{0};                                            ///< Frame sequence number
+    int8_t scale{-2};                                               ///< Decimal exponent of raw values
+    uint8_t sampleCount{0};                                         ///< Number of valid samples
+    std::array<ReadingFrameSample, ESPNOW_FRAME_MAX_SAMPLES> samples;   ///< Samples in time order
+
+    /**
+     * @brief Convert raw value to physical value
+     * @param raw Raw value
+     * @return Physical value
+     */
+    double toValue(int32_t raw) const;
+
+    /**
+     * @brief Convert physical value to raw value
+     * @param value Physical value
+     * @return Raw value, saturated to the int32 range
+     */
+    int32_t toRaw(double value) const;
+};
+
+/**
+ * @brief Check if payload looks like a reading frame
+ * @param data Payload
+ * @param length Payload length
+ * @return True if magic and version match, false otherwise
+ */
+bool isReadingFrame(const uint8_t* data, size_t length);
+
+/**
+ * @brief Encode reading frame
+ *
+ * Samples must be in non-decreasing time order, starting at or after the
+ * first sample's timestamp, which becomes the base timestamp.
+ *
+ * @param frame Frame to encode
+ * @param buffer Output buffer
+ * @param size Output buffer size
+ * @return Encoded length, or 0 if the frame does not fit
+ */
+size_t encodeReadingFrame(const ReadingFrame& frame, uint8_t* buffer, size_t size);
+
+/**
+ * @brief Decode reading frame
+ * @param data Payload
+ * @param length Payload length
+ * @param frame Decoded frame
+ * @return True if the frame is valid and its CRC matches, false otherwise
+ */
+bool decodeReadingFrame(const uint8_t* data, size_t length, ReadingFrame& frame);
+
+/**
+ * @brief Compute CRC-16/CCITT-FALSE
+ * @param data Data
+ * @param length Data length
+ * @return CRC value
+ */
+uint16_t frameCrc16(const uint8_t* data, size_t length);
+
+} // namespace communication
+} // namespace sensors
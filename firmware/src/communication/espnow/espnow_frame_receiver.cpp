@@ -0,0 +1,216 @@
+#include "espnow_frame_receiver.hpp"
+#include <chrono>
+#include <cstring>
+
+namespace sensors {
+namespace communication {
+
+ESPNowFrameReceiver::ESPNowFrameReceiver() {
+}
+
+ESPNowFrameReceiver::~ESPNowFrameReceiver() {
+    stop();
+}
+
+bool ESPNowFrameReceiver::registerNode(uint16_t handle, const std::string& nodeId, const std::vector<FrameChannel>& channels) {
+    if (channels.size() > ESPNOW_FRAME_MAX_CHANNELS) {
+        return false;
+    }
+
+    auto node = std::make_shared<Node>();
+    node->nodeId = nodeId;
+    node->readings.resize(channels.size());
+    for (size_t i = 0; i < channels.size(); i++) {
+        SensorReading& reading = node->readings[i];
+        reading.sensorId = channels[i].sensorId;
+        reading.unit = channels[i].unit;
+        reading.isValid = true;
+        reading.trace = channels[i].trace;
+    }
+
+    std::lock_guard<std::mutex> lock(nodesMutex_);
+    nodes_[handle] = std::move(node);
+    return true;
+}
+
+void ESPNowFrameReceiver::unregisterNode(uint16_t handle) {
+    std::lock_guard<std::mutex> lock(nodesMutex_);
+    nodes_.erase(handle);
+}
+
+bool ESPNowFrameReceiver::findHandle(const std::string& nodeId, uint16_t& handle) const {
+    std::lock_guard<std::mutex> lock(nodesMutex_);
+    for (const auto& pair : nodes_) {
+        if (pair.second->nodeId == nodeId) {
+            handle = pair.first;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ESPNowFrameReceiver::start(FrameReadingCallback readingCallback, RawMessageCallback rawCallback) {
+    if (running_) {
+        return false;
+    }
+
+    readingCallback_ = readingCallback;
+    rawCallback_ = rawCallback;
+    running_ = true;
+    workerThread_ = std::make_unique<std::thread>(&ESPNowFrameReceiver::workerThread, this);
+    return true;
+}
+
+void ESPNowFrameReceiver::stop() {
+    running_ = false;
+    notifyWorker();
+    if (workerThread_ && workerThread_->joinable()) {
+        workerThread_->join();
+    }
+    workerThread_.reset();
+}
+
+bool ESPNowFrameReceiver::push(const uint8_t* mac, const uint8_t* data, size_t length) {
+    if (length > ESPNOW_MAX_FRAME_SIZE) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Single producer: the radio task is the only caller
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    if (head - tail >= QUEUE_SLOTS) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Slot& slot = slots_[head % QUEUE_SLOTS];
+    memcpy(slot.mac, mac, sizeof(slot.mac));
+    memcpy(slot.data, data, length);
+    slot.length = static_cast<uint8_t>(length);
+
+    head_.store(head + 1, std::memory_order_release);
+    received_.fetch_add(1, std::memory_order_relaxed);
+
+    // Every payload notifies: the worker may have seen the ring empty just
+    // before this slot was published
+    notifyWorker();
+    return true;
+}
+
+FrameReceiverStats ESPNowFrameReceiver::getStats() const {
+    FrameReceiverStats stats;
+    stats.received = received_;
+    stats.dropped = dropped_;
+    stats.decoded = decoded_;
+    stats.samples = samples_;
+    stats.invalid = invalid_;
+    stats.unknownNode = unknownNode_;
+    stats.raw = raw_;
+    return stats;
+}
+
+// Private methods
+void ESPNowFrameReceiver::workerThread() {
+#ifdef ESP_PLATFORM
+    workerTask_.store(xTaskGetCurrentTaskHandle());
+#endif
+
+    while (running_) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            waitForWork();
+            continue;
+        }
+
+        process(slots_[tail % QUEUE_SLOTS]);
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+#ifdef ESP_PLATFORM
+    workerTask_.store(nullptr);
+#endif
+}
+
+void ESPNowFrameReceiver::notifyWorker() {
+#ifdef ESP_PLATFORM
+    TaskHandle_t task = workerTask_.load();
+    if (task) {
+        xTaskNotifyGive(task);
+    }
+#else
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakePending_ = true;
+    }
+    wake_.notify_one();
+#endif
+}
+
+void ESPNowFrameReceiver::waitForWork() {
+#ifdef ESP_PLATFORM
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#else
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    wake_.wait(lock, [this]() { return wakePending_; });
+    wakePending_ = false;
+#endif
+}
+
+void ESPNowFrameReceiver::process(const Slot& slot) {
+    if (!isReadingFrame(slot.data, slot.length)) {
+        raw_++;
+        if (rawCallback_) {
+            rawCallback_(slot.mac, slot.data, slot.length);
+        }
+        return;
+    }
+
+    if (!decodeReadingFrame(slot.data, slot.length, frame_)) {
+        invalid_++;
+        return;
+    }
+
+    std::shared_ptr<Node> node;
+    {
+        std::lock_guard<std::mutex> lock(nodesMutex_);
+        auto it = nodes_.find(frame_.nodeHandle);
+        if (it == nodes_.end()) {
+            unknownNode_++;
+            return;
+        }
+        node = it->second;
+    }
+
+    // Frame times are in the sender's clock, modulo 2^32. The last sample is
+    // taken as received now and the others keep their offsets to it.
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+    uint32_t newest = frame_.sampleCount > 0 ? frame_.samples[frame_.sampleCount - 1].timestamp : 0;
+
+    // The node's readings are only written here, so each sample reuses the
+    // reading of its channel instead of copying ID and unit into a new one
+    uint32_t delivered = 0;
+    for (size_t i = 0; i < frame_.sampleCount; i++) {
+        const ReadingFrameSample& sample = frame_.samples[i];
+        if (sample.channel >= node->readings.size()) {
+            continue;
+        }
+
+        SensorReading& reading = node->readings[sample.channel];
+        reading.timestamp = now - static_cast<int64_t>(newest - sample.timestamp);
+        reading.value = frame_.toValue(sample.raw);
+        reading.rawValue = reading.value;
+        delivered++;
+        if (readingCallback_) {
+            readingCallback_(reading);
+        }
+    }
+
+    decoded_++;
+    samples_ += delivered;
+}
+
+} // namespace communication
+} // namespace sensors
@@ -0,0 +1,225 @@
+/**
+ * @file espnow_frame_receiver.hpp
+ * @brief Decoupled ESP-NOW receive path
+ *
+ * This file defines the ESPNowFrameReceiver class, which takes ESP-NOW
+ * payloads out of the radio receive callback through a lock-free queue and
+ * decodes them into sensor readings on a worker thread.
+ */
+
+#pragma once
+
+#include "espnow_frame.hpp"
+#include "../../core/sensor_types.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+namespace sensors {
+namespace communication {
+
+/**
+ * @brief Type definition for decoded reading callback
+ */
+using FrameReadingCallback = std::function<void(const SensorReading&)>;
+
+/**
+ * @brief Type definition for callback of payloads that are not reading frames
+ */
+using RawMessageCallback = std::function<void(const uint8_t*, const uint8_t*, size_t)>;
+
+/**
+ * @brief Channel of a node's channel table
+ */
+struct FrameChannel {
+    std::string sensorId;       ///< Sensor ID readings are reported under
+    std::string unit;           ///< Unit of measurement
+    SensorTrace* trace{nullptr};    ///< Latency trace handed on with each reading
+};
+
+/**
+ * @brief Receive path statistics
+ */
+struct FrameReceiverStats {
+    uint32_t received{0};       ///< Payloads queued by the receive callback
+    uint32_t dropped{0};        ///< Payloads dropped because the queue was full
+    uint32_t decoded{0};        ///< Reading frames decoded
+    uint32_t samples{0};        ///< Readings delivered
+    uint32_t invalid{0};        ///< Reading frames with bad CRC or layout
+    uint32_t unknownNode{0};    ///< Reading frames from unregistered handles
+    uint32_t raw{0};            ///< Payloads passed to the raw message callback
+};
+
+/**
+ * @brief ESP-NOW receive queue and frame decoder
+ *
+ * push() is the only method meant for the radio receive callback: it copies
+ * the payload into a preallocated slot of a single-producer/single-consumer
+ * ring and returns, never allocating or locking. On the device the worker
+ * sleeps on a FreeRTOS task notification, which push() gives for every
+ * payload; a notification given before the worker waits is kept, so the
+ * worker needs no polling. Host builds use a condition variable instead,
+ * which takes a mutex in push(). The worker drains the
+ * ring, decodes reading frames against the channel table registered for the
+ * node handle, and hands other payloads (e.g. legacy JSON messages) to the
+ * raw message callback. Sample times are rebased from the sender's clock
+ * onto this device's wall clock, taking each frame's last sample as just
+ * received, so decoded readings carry epoch ms like local ones. A reading passed to the reading callback belongs to
+ * its channel and is rewritten for the channel's next sample, so it is only
+ * valid during the call.
+ */
+class ESPNowFrameReceiver {
+public:
+    static const size_t QUEUE_SLOTS = 16;       ///< Ring capacity, power of two
+
+    /**
+     * @brief Default constructor
+     */
+    ESPNowFrameReceiver();
+
+    /**
+     * @brief Destructor, stops the worker
+     */
+    ~ESPNowFrameReceiver();
+
+    //---------- Node Directory ----------//
+
+    /**
+     * @brief Register channel table of a node
+     * @param handle Node handle used in its frames
+     * @param nodeId Node ID
+     * @param channels Channel table, indexed by the channel field of samples
+     * @return True if successful, false if the table is too large
+     */
+    bool registerNode(uint16_t handle, const std::string& nodeId, const std::vector<FrameChannel>& channels);
+
+    /**
+     * @brief Remove node from the directory
+     * @param handle Node handle
+     */
+    void unregisterNode(uint16_t handle);
+
+    /**
+     * @brief Find handle of a registered node
+     * @param nodeId Node ID
+     * @param handle Node handle, set if found
+     * @return True if the node is registered, false otherwise
+     */
+    bool findHandle(const std::string& nodeId, uint16_t& handle) const;
+
+    //---------- Receive Path ----------//
+
+    /**
+     * @brief Start the decoder worker
+     * @param readingCallback Callback for decoded readings
+     * @param rawCallback Callback for payloads that are not reading frames
+     * @return True if started, false if already running
+     */
+    bool start(FrameReadingCallback readingCallback, RawMessageCallback rawCallback);
+
+    /**
+     * @brief Stop the decoder worker
+     */
+    void stop();
+
+    /**
+     * @brief Queue payload from the radio receive callback
+     * @param mac Sender MAC address (6 bytes)
+     * @param data Payload
+     * @param length Payload length
+     * @return True if queued, false if the queue is full or the payload too large
+     */
+    bool push(const uint8_t* mac, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Get receive path statistics
+     * @return Statistics
+     */
+    FrameReceiverStats getStats() const;
+
+private:
+    /**
+     * @brief Queue slot holding one payload
+     */
+    struct Slot {
+        uint8_t mac[6];                             ///< Sender MAC address
+        uint8_t length;                             ///< Payload length
+        uint8_t data[ESPNOW_MAX_FRAME_SIZE];        ///< Payload
+    };
+
+    /**
+     * @brief Registered node
+     *
+     * Never changed once registered: registerNode() replaces the whole node,
+     * so the worker can keep using one it took out of the directory.
+     */
+    struct Node {
+        std::string nodeId;                         ///< Node ID
+        std::vector<SensorReading> readings;        ///< Reading per channel, ID and unit filled in at registration
+    };
+
+    /**
+     * @brief Worker thread function
+     */
+    void workerThread();
+
+    /**
+     * @brief Decode one payload and deliver its readings
+     * @param slot Queue slot
+     */
+    void process(const Slot& slot);
+
+    /**
+     * @brief Wake the worker
+     */
+    void notifyWorker();
+
+    /**
+     * @brief Block the worker until notified
+     */
+    void waitForWork();
+
+private:
+    std::array<Slot, QUEUE_SLOTS> slots_;           ///< Preallocated ring slots
+    std::atomic<uint32_t> head_{0};                 ///< Next slot to write (producer)
+    std::atomic<uint32_t> tail_{0};                 ///< Next slot to read (consumer)
+
+    std::map<uint16_t, std::shared_ptr<Node>> nodes_;   ///< Map of node handle to channel table
+    mutable std::mutex nodesMutex_;                 ///< Mutex for the node directory
+
+    FrameReadingCallback readingCallback_;          ///< Decoded reading callback
+    RawMessageCallback rawCallback_;                ///< Raw message callback
+    ReadingFrame frame_;                            ///< Decode buffer (worker only)
+    std::atomic<bool> running_{false};              ///< Worker state flag
+    std::unique_ptr<std::thread> workerThread_;     ///< Decoder worker
+#ifdef ESP_PLATFORM
+    std::atomic<TaskHandle_t> workerTask_{nullptr}; ///< Task notified by push()
+#else
+    std::mutex wakeMutex_;                          ///< Mutex for the worker wait
+    std::condition_variable wake_;                  ///< Signalled by push()
+    bool wakePending_{false};                       ///< Notification not yet taken
+#endif
+
+    std::atomic<uint32_t> received_{0};             ///< Payloads queued
+    std::atomic<uint32_t> dropped_{0};              ///< Payloads dropped
+    std::atomic<uint32_t> decoded_{0};              ///< Frames decoded
+    std::atomic<uint32_t> samples_{0};              ///< Readings delivered
+    std::atomic<uint32_t> invalid_{0};              ///< Invalid frames
+    std::atomic<uint32_t> unknownNode_{0};          ///< Frames from unknown handles
+    std::atomic<uint32_t> raw_{0};                  ///< Raw payloads
+};
+
+} // namespace communication
+} // namespace sensors
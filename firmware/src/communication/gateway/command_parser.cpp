@@ -0,0 +1,383 @@
+#include "command_parser.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace sensors {
+namespace communication {
+
+namespace {
+
+const int MAX_NESTING = 16;             // Deepest nested value accepted
+const size_t MAX_NUMBER_LENGTH = 32;    // Longest number literal accepted
+
+// Single-pass reader over a JSON payload; never allocates
+class Scanner {
+public:
+    explicit Scanner(std::string_view input) : input_(input) {}
+
+    // Consume c after optional whitespace
+    bool consume(char c) {
+        skipSpace();
+        if (pos_ < input_.size() && input_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    // True if only whitespace is left
+    bool atEnd() {
+        skipSpace();
+        return pos_ == input_.size();
+    }
+
+    // Read a string token; out holds the characters between the quotes
+    bool readString(std::string_view& out, bool& escaped) {
+        if (!consume('"')) return false;
+
+        size_t start = pos_;
+        escaped = false;
+        while (pos_ < input_.size()) {
+            char c = input_[pos_];
+            if (c == '"') {
+                out = input_.substr(start, pos_ - start);
+                pos_++;
+                return true;
+            }
+            if (c == '\\') {
+                escaped = true;
+                if (!readEscape()) return false;
+                continue;
+            }
+            if (static_cast<uint8_t>(c) < 0x20) {
+                return false;
+            }
+            pos_++;
+        }
+        return false;
+    }
+
+    // Decode a value into a config field; objects and arrays keep their raw text
+    bool readField(ConfigField& field) {
+        skipSpace();
+        if (pos_ >= input_.size()) return false;
+
+        char c = input_[pos_];
+        if (c == '"') {
+            field.type = ConfigValueType::STRING;
+            return readString(field.text, field.escaped);
+        }
+        if (c == '{' || c == '[') {
+            field.type = ConfigValueType::NESTED;
+            return skipValue(field.text);
+        }
+        if (readLiteral("true")) {
+            field.type = ConfigValueType::BOOLEAN;
+            field.boolean = true;
+            return true;
+        }
+        if (readLiteral("false")) {
+            field.type = ConfigValueType::BOOLEAN;
+            field.boolean = false;
+            return true;
+        }
+        if (readLiteral("null")) {
+            field.type = ConfigValueType::NUL;
+            return true;
+        }
+        return readNumber(field);
+    }
+
+    // Skip any value; raw holds its JSON text
+    bool skipValue(std::string_view& raw, int depth = 0) {
+        skipSpace();
+        if (pos_ >= input_.size() || depth > MAX_NESTING) return false;
+
+        size_t start = pos_;
+        bool ok;
+        char c = input_[pos_];
+        if (c == '{') {
+            pos_++;
+            ok = forEachMember([this, depth](std::string_view, bool) {
+                std::string_view ignored;
+                return skipValue(ignored, depth + 1);
+            }, true);
+        } else if (c == '[') {
+            pos_++;
+            ok = skipElements(depth);
+        } else if (c == '"') {
+            std::string_view ignored;
+            bool escaped;
+            ok = readString(ignored, escaped);
+        } else {
+            ConfigField ignored;
+            ok = readField(ignored);
+        }
+
+        if (ok) {
+            raw = input_.substr(start, pos_ - start);
+        }
+        return ok;
+    }
+
+    // Visit the members of an object; the visitor must consume each value
+    template <typename Visitor>
+    bool forEachMember(Visitor visit, bool opened = false) {
+        if (!opened && !consume('{')) return false;
+        if (consume('}')) return true;
+
+        do {
+            std::string_view key;
+            bool escaped;
+            if (!readString(key, escaped) || !consume(':') || !visit(key, escaped)) {
+                return false;
+            }
+        } while (consume(','));
+
+        return consume('}');
+    }
+
+private:
+    void skipSpace() {
+        while (pos_ < input_.size() &&
+               (input_[pos_] == ' ' || input_[pos_] == '\t' || input_[pos_] == '\n' || input_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool readLiteral(const char* literal) {
+        size_t length = strlen(literal);
+        if (input_.compare(pos_, length, literal) != 0) return false;
+        pos_ += length;
+        return true;
+    }
+
+    // Escape sequence at pos_ (the backslash); leaves pos_ after it
+    bool readEscape() {
+        if (++pos_ >= input_.size()) return false;
+
+        char c = input_[pos_++];
+        if (c != 'u') {
+            return c != '\0' && strchr("\"\\/bfnrt", c) != nullptr;
+        }
+        for (int i = 0; i < 4; i++, pos_++) {
+            if (pos_ >= input_.size() || !isxdigit(static_cast<unsigned char>(input_[pos_]))) return false;
+        }
+        return true;
+    }
+
+    bool isDigit(size_t at) const {
+        return at < input_.size() && input_[at] >= '0' && input_[at] <= '9';
+    }
+
+    void skipDigits() {
+        while (isDigit(pos_)) pos_++;
+    }
+
+    // Number per the JSON grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool readNumber(ConfigField& field) {
+        size_t start = pos_;
+        bool integer = true;
+
+        if (pos_ < input_.size() && input_[pos_] == '-') pos_++;
+        if (!isDigit(pos_)) return false;
+        if (input_[pos_] == '0') {
+            pos_++;
+        } else {
+            skipDigits();
+        }
+        if (pos_ < input_.size() && input_[pos_] == '.') {
+            integer = false;
+            if (!isDigit(++pos_)) return false;
+            skipDigits();
+        }
+        if (pos_ < input_.size() && (input_[pos_] == 'e' || input_[pos_] == 'E')) {
+            integer = false;
+            pos_++;
+            if (pos_ < input_.size() && (input_[pos_] == '+' || input_[pos_] == '-')) pos_++;
+            if (!isDigit(pos_)) return false;
+            skipDigits();
+        }
+
+        size_t length = pos_ - start;
+        if (length == 0 || length >= MAX_NUMBER_LENGTH) return false;
+
+        // strtod/strtoll need a terminated string
+        char number[MAX_NUMBER_LENGTH];
+        memcpy(number, input_.data() + start, length);
+        number[length] = '\0';
+
+        char* end = nullptr;
+        if (integer) {
+            field.type = ConfigValueType::INTEGER;
+            field.integer = strtoll(number, &end, 10);
+        } else {
+            field.type = ConfigValueType::REAL;
+            field.real = strtod(number, &end);
+        }
+        return end == number + length;
+    }
+
+    bool skipElements(int depth) {
+        if (consume(']')) return true;
+
+        do {
+            std::string_view ignored;
+            if (!skipValue(ignored, depth + 1)) return false;
+        } while (consume(','));
+
+        return consume(']');
+    }
+
+private:
+    std::string_view input_;
+    size_t pos_{0};
+};
+
+CommandAction actionFromString(std::string_view action) {
+    if (action == "calibrate") return CommandAction::CALIBRATE;
+    if (action == "sleep") return CommandAction::SLEEP;
+    if (action == "wake") return CommandAction::WAKE;
+    if (action == "reset") return CommandAction::RESET;
+    if (action == "discover") return CommandAction::DISCOVER;
+    return CommandAction::UNKNOWN;
+}
+
+// Unescape a raw JSON string by letting the JSON parser read it
+bool unescape(std::string_view raw, std::string& out) {
+    std::string quoted;
+    quoted.reserve(raw.size() + 2);
+    quoted += '"';
+    quoted.append(raw.data(), raw.size());
+    quoted += '"';
+
+    json value = json::parse(quoted, nullptr, false);
+    if (!value.is_string()) {
+        return false;
+    }
+    out = value.get<std::string>();
+    return true;
+}
+
+} // namespace
+
+bool parseSensorCommand(std::string_view payload, SensorCommand& command) {
+    command = SensorCommand();
+    Scanner scanner(payload);
+
+    bool ok = scanner.forEachMember([&](std::string_view key, bool) {
+        if (key == "action") {
+            std::string_view action;
+            bool escaped;
+            if (!scanner.readString(action, escaped)) return false;
+            command.action = actionFromString(action);
+            return true;
+        }
+        if (key == "calibrationData") {
+            return scanner.skipValue(command.calibrationData);
+        }
+        std::string_view ignored;
+        return scanner.skipValue(ignored);
+    });
+
+    return ok && scanner.atEnd();
+}
+
+bool parseConfigMessage(std::string_view payload, ConfigMessage& message) {
+    message.hasSensorConfig = false;
+    message.fieldCount = 0;
+    message.calibrationConfig = std::string_view();
+    Scanner scanner(payload);
+
+    bool ok = scanner.forEachMember([&](std::string_view key, bool) {
+        if (key == "sensorConfig") {
+            message.hasSensorConfig = true;
+            message.fieldCount = 0;
+            return scanner.forEachMember([&](std::string_view fieldKey, bool keyEscaped) {
+                if (message.fieldCount >= CONFIG_MESSAGE_MAX_FIELDS) return false;
+
+                ConfigField& field = message.fields[message.fieldCount];
+                field = ConfigField();
+                field.key = fieldKey;
+                field.keyEscaped = keyEscaped;
+                if (!scanner.readField(field)) return false;
+
+                message.fieldCount++;
+                return true;
+            });
+        }
+        if (key == "calibrationConfig") {
+            return scanner.skipValue(message.calibrationConfig);
+        }
+        std::string_view ignored;
+        return scanner.skipValue(ignored);
+    });
+
+    return ok && scanner.atEnd();
+}
+
+bool applyConfigMessage(const ConfigMessage& message, SensorConfig& config) {
+    if (!message.calibrationConfig.empty()) {
+        json calibrationConfig = json::parse(message.calibrationConfig.begin(), message.calibrationConfig.end(),
+                                             nullptr, false);
+        if (calibrationConfig.is_discarded()) {
+            return false;
+        }
+        config.calibrationConfig = std::move(calibrationConfig);
+    }
+
+    if (!message.hasSensorConfig) {
+        return true;
+    }
+
+    json sensorConfig = json::object();
+    for (size_t i = 0; i < message.fieldCount; i++) {
+        const ConfigField& field = message.fields[i];
+        std::string key;
+        if (!field.keyEscaped) {
+            key.assign(field.key.data(), field.key.size());
+        } else if (!unescape(field.key, key)) {
+            return false;
+        }
+
+        switch (field.type) {
+            case ConfigValueType::NUL:
+                sensorConfig[key] = nullptr;
+                break;
+            case ConfigValueType::BOOLEAN:
+                sensorConfig[key] = field.boolean;
+                break;
+            case ConfigValueType::INTEGER:
+                sensorConfig[key] = field.integer;
+                break;
+            case ConfigValueType::REAL:
+                sensorConfig[key] = field.real;
+                break;
+            case ConfigValueType::STRING: {
+                std::string text;
+                if (!field.escaped) {
+                    text.assign(field.text.data(), field.text.size());
+                } else if (!unescape(field.text, text)) {
+                    return false;
+                }
+                sensorConfig[key] = std::move(text);
+                break;
+            }
+            case ConfigValueType::NESTED: {
+                json nested = json::parse(field.text.begin(), field.text.end(), nullptr, false);
+                if (nested.is_discarded()) {
+                    return false;
+                }
+                sensorConfig[key] = std::move(nested);
+                break;
+            }
+        }
+    }
+
+    config.sensorConfig = std::move(sensorConfig);
+    return true;
+}
+
+} // namespace communication
+} // namespace sensors
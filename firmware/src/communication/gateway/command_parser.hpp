@@ -0,0 +1,124 @@
+/**
+ * @file command_parser.hpp
+ * @brief Allocation-free decoding of inbound command and config messages
+ *
+ * This file defines typed forms of the small set of JSON messages the
+ * gateway accepts over MQTT (sensor commands and sensorConfig updates) and
+ * schema-driven parsers that decode them in one pass over the payload,
+ * without building a JSON document. They build for the host as well.
+ */
+
+#pragma once
+
+#include "../../core/sensor_types.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace sensors {
+namespace communication {
+
+/**
+ * @brief Sensor command action enumeration
+ */
+enum class CommandAction : uint8_t {
+    NONE = 0,       ///< No "action" member
+    CALIBRATE = 1,  ///< Store calibration data and recalibrate
+    SLEEP = 2,      ///< Put sensor to sleep
+    WAKE = 3,       ///< Wake sensor
+    RESET = 4,      ///< Restart sensor
+    DISCOVER = 5,   ///< Run a wireless discovery round
+    UNKNOWN = 6     ///< Action not recognized
+};
+
+/**
+ * @brief Decoded sensor command
+ *
+ * String views point into the parsed payload.
+ */
+struct SensorCommand {
+    CommandAction action{CommandAction::NONE};  ///< Requested action
+    std::string_view calibrationData;           ///< Raw JSON of "calibrationData", empty if absent
+};
+
+/**
+ * @brief Config field value type enumeration
+ */
+enum class ConfigValueType : uint8_t {
+    NUL = 0,        ///< null
+    BOOLEAN = 1,    ///< true or false
+    INTEGER = 2,    ///< Number without fraction or exponent
+    REAL = 3,       ///< Any other number
+    STRING = 4,     ///< String, text holds the raw (still escaped) characters
+    NESTED = 5      ///< Object or array, text holds its raw JSON
+};
+
+/**
+ * @brief One member of a sensorConfig object
+ */
+struct ConfigField {
+    std::string_view key;                       ///< Member name (raw characters)
+    ConfigValueType type{ConfigValueType::NUL}; ///< Value type
+    bool keyEscaped{false};                     ///< Key contains escapes
+    bool escaped{false};                        ///< String value contains escapes
+    bool boolean{false};                        ///< Value if BOOLEAN
+    int64_t integer{0};                         ///< Value if INTEGER
+    double real{0.0};                           ///< Value if REAL
+    std::string_view text;                      ///< Value if STRING or NESTED
+};
+
+const size_t CONFIG_MESSAGE_MAX_FIELDS = 24;    ///< sensorConfig members per message
+
+/**
+ * @brief Decoded config message
+ *
+ * String views point into the parsed payload.
+ */
+struct ConfigMessage {
+    bool hasSensorConfig{false};                                        ///< "sensorConfig" present
+    uint8_t fieldCount{0};                                              ///< Number of valid fields
+    std::array<ConfigField, CONFIG_MESSAGE_MAX_FIELDS> fields;          ///< sensorConfig members in order
+    std::string_view calibrationConfig;                                 ///< Raw JSON of "calibrationConfig", empty if absent
+};
+
+/**
+ * @brief Parse sensor command message
+ *
+ * Accepts {"action": "...", "calibrationData": {...}}; other members are
+ * skipped.
+ *
+ * @param payload Message payload
+ * @param command Output command
+ * @return True if successful, false if the payload is not a valid JSON object
+ */
+bool parseSensorCommand(std::string_view payload, SensorCommand& command);
+
+/**
+ * @brief Parse config message
+ *
+ * Accepts {"sensorConfig": {...}, "calibrationConfig": {...}}; other
+ * members are skipped. Scalar sensorConfig members are decoded into typed
+ * fields; nested members keep their raw JSON.
+ *
+ * @param payload Message payload
+ * @param message Output message
+ * @return True if successful, false if the payload is invalid or has too many sensorConfig members
+ */
+bool parseConfigMessage(std::string_view payload, ConfigMessage& message);
+
+/**
+ * @brief Apply config message to a sensor configuration
+ *
+ * A present sensorConfig replaces the sensor's sensorConfig, and a present
+ * calibrationConfig replaces its calibrationConfig. Only nested members,
+ * escaped strings and calibrationConfig are run through the JSON parser.
+ *
+ * @param message Decoded message
+ * @param config Configuration to update
+ * @return True if successful, false if a nested value or escape sequence is invalid
+ */
+bool applyConfigMessage(const ConfigMessage& message, SensorConfig& config);
+
+} // namespace communication
+} // namespace sensors
@@ -0,0 +1,179 @@
+#include "publish_bus.hpp"
+#include "../../core/utils/cycle_arena.hpp"
+#include "../../core/utils/latency_trace.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace sensors {
+namespace communication {
+
+namespace {
+
+const size_t TARGET_ARENA_SIZE = 512;   // Room for 16 targets before the heap is used
+
+} // namespace
+
+PublishBus::PublishBus() {
+    encoders_[static_cast<size_t>(WireFormat::JSON)] = encodeJson;
+    encoders_[static_cast<size_t>(WireFormat::TEXT)] = encodeText;
+}
+
+void PublishBus::setEncoder(WireFormat format, ReadingEncoder encoder) {
+    std::lock_guard<std::mutex> lock(busMutex_);
+    encoders_[static_cast<size_t>(format)] = encoder;
+}
+
+int PublishBus::subscribe(const std::string& name, const SubscriberOptions& options, ReadingSink sink) {
+    std::lock_guard<std::mutex> lock(busMutex_);
+
+    Subscriber subscriber;
+    subscriber.id = nextId_++;
+    subscriber.options = options;
+    subscriber.sink = std::make_shared<const ReadingSink>(std::move(sink));
+    subscriber.stats.name = name;
+    subscribers_.push_back(std::move(subscriber));
+    return subscribers_.back().id;
+}
+
+bool PublishBus::unsubscribe(int id) {
+    std::lock_guard<std::mutex> lock(busMutex_);
+
+    for (auto it = subscribers_.begin(); it != subscribers_.end(); ++it) {
+        if (it->id == id) {
+            subscribers_.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t PublishBus::publish(const SensorReading& reading, uint32_t now) {
+    struct Target {
+        int id;
+        std::shared_ptr<const ReadingSink> sink;
+        WireFormat format;
+    };
+    alignas(std::max_align_t) uint8_t scratch[TARGET_ARENA_SIZE];
+    CycleArena arena(scratch, sizeof(scratch));
+    ArenaVector<Target> targets{ArenaAllocator<Target>(arena)};
+    std::array<ReadingEncoder, WIRE_FORMAT_COUNT> encoders;
+    std::array<bool, WIRE_FORMAT_COUNT> needed{};
+    SENSORHUB_TRACE_SPLITS(stages);
+
+    {
+        std::lock_guard<std::mutex> lock(busMutex_);
+        stats_.published++;
+        targets.reserve(subscribers_.size());
+
+        for (auto& subscriber : subscribers_) {
+            const auto& options = subscriber.options;
+            if (options.filter && !options.filter(reading)) {
+                subscriber.stats.filtered++;
+                continue;
+            }
+
+            if (options.minInterval > 0) {
+                auto last = subscriber.lastSent.find(reading.sensorId);
+                if (last != subscriber.lastSent.end() && now - last->second < options.minInterval) {
+                    subscriber.stats.rateLimited++;
+                    continue;
+                }
+                subscriber.lastSent[reading.sensorId] = now;
+            }
+
+            targets.push_back({subscriber.id, subscriber.sink, options.format});
+            needed[static_cast<size_t>(options.format)] = true;
+        }
+
+        encoders = encoders_;
+    }
+    SENSORHUB_TRACE_SPLIT(stages, FILTER);
+
+    // Encode each wanted format once, outside the lock
+    std::array<EncodedPayload, WIRE_FORMAT_COUNT> payloads;
+    std::array<bool, WIRE_FORMAT_COUNT> failed{};
+    for (size_t format = 0; format < WIRE_FORMAT_COUNT; format++) {
+        if (!needed[format]) continue;
+
+        auto payload = payloadPools_[format].acquire();
+        if (encoders[format] && encoders[format](reading, *payload)) {
+            payloads[format] = payload;
+        } else {
+            failed[format] = true;
+        }
+    }
+    SENSORHUB_TRACE_SPLIT(stages, ENCODE);
+
+    {
+        std::lock_guard<std::mutex> lock(busMutex_);
+        for (size_t format = 0; format < WIRE_FORMAT_COUNT; format++) {
+            if (payloads[format]) stats_.encodes[format]++;
+            if (failed[format]) stats_.encodeFailures++;
+        }
+        for (auto& subscriber : subscribers_) {
+            for (const auto& target : targets) {
+                if (target.id == subscriber.id && payloads[static_cast<size_t>(target.format)]) {
+                    subscriber.stats.delivered++;
+                }
+            }
+        }
+    }
+
+    size_t delivered = 0;
+    for (const auto& target : targets) {
+        const EncodedPayload& payload = payloads[static_cast<size_t>(target.format)];
+        if (payload) {
+            (*target.sink)(reading, payload);
+            delivered++;
+        }
+    }
+    SENSORHUB_TRACE_SPLIT(stages, PUBLISH);
+    return delivered;
+}
+
+PublishBusStats PublishBus::getStats() const {
+    std::lock_guard<std::mutex> lock(busMutex_);
+
+    PublishBusStats stats = stats_;
+    for (const auto& pool : payloadPools_) {
+        stats.poolMisses += pool.misses();
+    }
+    for (const auto& subscriber : subscribers_) {
+        stats.subscribers.push_back(subscriber.stats);
+    }
+    return stats;
+}
+
+bool PublishBus::encodeJson(const SensorReading& reading, std::string& out) {
+    char payload[256];
+    int length = snprintf(payload, sizeof(payload),
+                          "{\"value\":%.2f,\"unit\":\"%s\",\"timestamp\":%lld,\"raw\":%.2f}",
+                          reading.value,
+                          reading.unit.c_str(),
+                          static_cast<long long>(reading.timestamp),
+                          reading.rawValue);
+    if (length < 0 || length >= static_cast<int>(sizeof(payload))) {
+        return false;
+    }
+
+    out.assign(payload, length);
+    return true;
+}
+
+bool PublishBus::encodeText(const SensorReading& reading, std::string& out) {
+    char line[192];
+    int length = snprintf(line, sizeof(line), "Sensor %s reading: %.2f %s (time: %lld)",
+                          reading.sensorId.c_str(),
+                          reading.value,
+                          reading.unit.c_str(),
+                          static_cast<long long>(reading.timestamp));
+    if (length < 0) {
+        return false;
+    }
+
+    out.assign(line, std::min<size_t>(length, sizeof(line) - 1));
+    return true;
+}
+
+} // namespace communication
+} // namespace sensors
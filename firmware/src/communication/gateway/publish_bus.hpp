@@ -0,0 +1,204 @@
+/**
+ * @file publish_bus.hpp
+ * @brief Fan-out of sensor readings to multiple transports
+ *
+ * This file defines the PublishBus class, which encodes each reading once
+ * per wire format and hands the shared encoded buffer to every subscribed
+ * sink (MQTT, ESP-NOW relay, BLE, log) subject to its filter and rate.
+ */
+
+#pragma once
+
+#include "../../core/sensor_types.hpp"
+#include "../../core/utils/object_pool.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sensors {
+namespace communication {
+
+/**
+ * @brief Wire format enumeration
+ */
+enum class WireFormat : uint8_t {
+    JSON = 0,       ///< JSON object, as published over MQTT
+    BINARY = 1,     ///< Compact binary frame for radio links
+    TEXT = 2        ///< Human-readable line for logs
+};
+
+const size_t WIRE_FORMAT_COUNT = 3;     ///< Number of wire formats
+const size_t PAYLOAD_POOL_SIZE = 8;     ///< Pooled payload buffers per format
+
+/**
+ * @brief Encoded reading shared by all sinks of one format
+ */
+using EncodedPayload = std::shared_ptr<const std::string>;
+
+/**
+ * @brief Type definition for reading encoder
+ *
+ * Writes the encoded reading to the output string. Returns false if the
+ * reading cannot be represented in the format.
+ */
+using ReadingEncoder = std::function<bool(const SensorReading&, std::string&)>;
+
+/**
+ * @brief Type definition for subscriber filter
+ *
+ * Returns true if the subscriber wants the reading.
+ */
+using ReadingFilter = std::function<bool(const SensorReading&)>;
+
+/**
+ * @brief Type definition for subscriber sink
+ */
+using ReadingSink = std::function<void(const SensorReading&, const EncodedPayload&)>;
+
+/**
+ * @brief Subscriber options
+ */
+struct SubscriberOptions {
+    WireFormat format{WireFormat::JSON};    ///< Format the sink consumes
+    ReadingFilter filter;                   ///< Filter, empty to accept every reading
+    uint32_t minInterval{0};                ///< Minimum time between readings of one sensor (ms)
+};
+
+/**
+ * @brief Subscriber statistics
+ */
+struct SubscriberStats {
+    std::string name;                       ///< Subscriber name
+    uint32_t delivered{0};                  ///< Readings delivered
+    uint32_t filtered{0};                   ///< Readings rejected by the filter
+    uint32_t rateLimited{0};                ///< Readings dropped by the rate limit
+};
+
+/**
+ * @brief Publish bus statistics
+ */
+struct PublishBusStats {
+    uint32_t published{0};                                  ///< Readings published
+    std::array<uint32_t, WIRE_FORMAT_COUNT> encodes{};      ///< Encodings per format
+    uint32_t encodeFailures{0};                             ///< Encodings that failed
+    uint32_t poolMisses{0};                                 ///< Payloads allocated outside the pool
+    std::vector<SubscriberStats> subscribers;               ///< Per-subscriber statistics
+};
+
+/**
+ * @brief Reading fan-out bus
+ *
+ * publish() selects the subscribers that accept a reading, encodes it once
+ * for each format those subscribers use, and passes the same reference-
+ * counted buffer to all of them. Formats nobody wants for a reading are not
+ * encoded, so an extra sink on an existing format costs no serialization.
+ *
+ * publish() may be called from any thread. Filters run under the bus lock
+ * and must not publish. Sinks run on the publishing thread without the lock
+ * held and must be thread-safe; a sink that keeps the payload only needs to
+ * keep the shared pointer.
+ *
+ * Inside a TraceScope, subscriber selection, encoding (all formats) and the
+ * sink calls (with delivery bookkeeping) are timed as the FILTER, ENCODE and
+ * PUBLISH stages, one clock read per stage boundary.
+ *
+ * Payload buffers come from a pool per format and are reused, with their
+ * capacity, once every sink has dropped them; the per-publish target list
+ * lives in a stack arena. A steady stream of readings therefore publishes
+ * without heap allocations, unless sinks hold on to more than
+ * PAYLOAD_POOL_SIZE payloads of one format (counted as pool misses).
+ */
+class PublishBus {
+public:
+    /**
+     * @brief Constructor, installs the JSON and text encoders
+     */
+    PublishBus();
+
+    /**
+     * @brief Set encoder for a wire format
+     * @param format Wire format
+     * @param encoder Encoder
+     */
+    void setEncoder(WireFormat format, ReadingEncoder encoder);
+
+    //---------- Subscribers ----------//
+
+    /**
+     * @brief Add subscriber
+     * @param name Subscriber name, used in statistics
+     * @param options Format, filter and rate
+     * @param sink Sink receiving the encoded readings
+     * @return Subscriber ID
+     */
+    int subscribe(const std::string& name, const SubscriberOptions& options, ReadingSink sink);
+
+    /**
+     * @brief Remove subscriber
+     * @param id Subscriber ID
+     * @return True if successful, false if not found
+     */
+    bool unsubscribe(int id);
+
+    //---------- Publishing ----------//
+
+    /**
+     * @brief Publish reading to all matching subscribers
+     * @param reading Sensor reading
+     * @param now Current time (ms), used for rate limits
+     * @return Number of sinks the reading was delivered to
+     */
+    size_t publish(const SensorReading& reading, uint32_t now);
+
+    /**
+     * @brief Get bus statistics
+     * @return Statistics
+     */
+    PublishBusStats getStats() const;
+
+    //---------- Default Encoders ----------//
+
+    /**
+     * @brief Encode reading as the MQTT JSON payload
+     * @param reading Sensor reading
+     * @param out Output payload
+     * @return True if successful, false otherwise
+     */
+    static bool encodeJson(const SensorReading& reading, std::string& out);
+
+    /**
+     * @brief Encode reading as a log line
+     * @param reading Sensor reading
+     * @param out Output line
+     * @return True if successful, false otherwise
+     */
+    static bool encodeText(const SensorReading& reading, std::string& out);
+
+private:
+    /**
+     * @brief Subscriber state
+     */
+    struct Subscriber {
+        int id;                                         ///< Subscriber ID
+        SubscriberOptions options;                      ///< Options
+        std::shared_ptr<const ReadingSink> sink;        ///< Sink, shared with in-flight publishes
+        std::map<std::string, uint32_t> lastSent;       ///< Last delivery per sensor (ms)
+        SubscriberStats stats;                          ///< Statistics
+    };
+
+private:
+    std::array<ReadingEncoder, WIRE_FORMAT_COUNT> encoders_;    ///< Encoder per format
+    std::array<SharedPool<std::string, PAYLOAD_POOL_SIZE>, WIRE_FORMAT_COUNT> payloadPools_;   ///< Payload buffers per format
+    std::vector<Subscriber> subscribers_;                       ///< Subscribers
+    int nextId_{1};                                             ///< Next subscriber ID
+    PublishBusStats stats_;                                     ///< Bus statistics
+    mutable std::mutex busMutex_;                               ///< Mutex for thread safety
+};
+
+} // namespace communication
+} // namespace sensors
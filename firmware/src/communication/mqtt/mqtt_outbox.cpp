@@ -0,0 +1,503 @@
+#include "mqtt_outbox.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+
+namespace sensors {
+namespace communication {
+
+namespace {
+
+// Spool layout: ackedOffset u32 | records...
+// Record: topicLength u16 | payloadLength u16 | qos u8 | topic | payload
+const uint32_t SPOOL_HEADER_SIZE = 4;
+const uint32_t RECORD_HEADER_SIZE = 5;
+
+// Acknowledged spool progress is written to the header after this many
+// spooled messages or this long, whichever comes first. A reboot in
+// between resends the messages acknowledged since the last write.
+const uint32_t PROGRESS_MESSAGES = 32;
+const uint32_t PROGRESS_INTERVAL = 10000;   // ms
+
+// Push buffered writes through to flash
+bool syncFile(FILE* file) {
+    return fflush(file) == 0 && fsync(fileno(file)) == 0;
+}
+
+void putLE(uint8_t* out, uint32_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint32_t getLE(const uint8_t* data, size_t bytes) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= static_cast<uint32_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+bool writeReadOffset(FILE* file, uint32_t offset) {
+    uint8_t header[SPOOL_HEADER_SIZE];
+    putLE(header, offset, SPOOL_HEADER_SIZE);
+    return fseek(file, 0, SEEK_SET) == 0 &&
+           fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+// Read one record at the current position
+bool readRecord(FILE* file, OutboxMessage& message, uint32_t& length) {
+    uint8_t header[RECORD_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)) {
+        return false;
+    }
+
+    uint16_t topicLength = static_cast<uint16_t>(getLE(header, 2));
+    uint16_t payloadLength = static_cast<uint16_t>(getLE(header + 2, 2));
+    message.qos = header[4];
+    message.topic.resize(topicLength);
+    message.payload.resize(payloadLength);
+
+    if (fread(&message.topic[0], 1, topicLength, file) != topicLength ||
+        fread(&message.payload[0], 1, payloadLength, file) != payloadLength) {
+        return false;
+    }
+
+    length = RECORD_HEADER_SIZE + topicLength + payloadLength;
+    return true;
+}
+
+} // namespace
+
+MQTTOutbox::MQTTOutbox(const std::string& spoolPath,
+                       size_t ramCapacity,
+                       size_t spoolCapacity,
+                       size_t window,
+                       uint32_t replayRate,
+                       uint32_t ackTimeout) :
+    spoolPath_(spoolPath),
+    ramCapacity_(std::max<size_t>(ramCapacity, 1)),
+    spoolCapacity_(spoolCapacity),
+    window_(std::max<size_t>(window, 1)),
+    replayRate_(std::max<uint32_t>(replayRate, 1)),
+    ackTimeout_(ackTimeout) {
+}
+
+bool MQTTOutbox::init() {
+    std::lock_guard<std::mutex> lock(outboxMutex_);
+
+    spoolAckedOffset_ = 0;
+    spoolPersistedOffset_ = 0;
+    spoolReadOffset_ = 0;
+    spoolSize_ = 0;
+    spoolCount_ = 0;
+
+    FILE* file = fopen(spoolPath_.c_str(), "rb");
+    if (!file) {
+        return true;  // Nothing spooled
+    }
+
+    uint8_t header[SPOOL_HEADER_SIZE];
+    bool valid = fread(header, 1, sizeof(header), file) == sizeof(header);
+    uint32_t offset = valid ? getLE(header, SPOOL_HEADER_SIZE) : 0;
+    valid = valid && offset >= SPOOL_HEADER_SIZE && fseek(file, offset, SEEK_SET) == 0;
+
+    // Count complete records; a torn last record from a power cut is ignored
+    uint32_t end = offset;
+    OutboxMessage message;
+    uint32_t length;
+    while (valid && readRecord(file, message, length)) {
+        end += length;
+        spoolCount_++;
+    }
+    fclose(file);
+
+    if (!valid || spoolCount_ == 0) {
+        spoolCount_ = 0;
+        std::remove(spoolPath_.c_str());
+        return valid;
+    }
+
+    spoolAckedOffset_ = offset;
+    spoolPersistedOffset_ = offset;
+    spoolReadOffset_ = offset;
+    spoolSize_ = end;
+    return true;
+}
+
+void MQTTOutbox::setPublishFunction(OutboxPublishFunction publish, bool ackOnSend) {
+    std::lock_guard<std::mutex> lock(outboxMutex_);
+    publish_ = publish;
+    ackOnSend_ = ackOnSend;
+}
+
+bool MQTTOutbox::enqueue(const std::string& topic, const std::string& payload, uint8_t qos) {
+    std::lock_guard<std::mutex> lock(outboxMutex_);
+
+    OutboxMessage message{topic, payload, static_cast<uint8_t>(qos > 0 ? 1 : 0)};
+
+    // Once anything is spooled, newer messages must follow it to keep order
+    if (spoolCount_ > 0 || queue_.size() >= ramCapacity_) {
+        if (!spool(message)) {
+            stats_.dropped++;
+            return false;
+        }
+    } else {
+        Entry entry;
+        entry.message = std::move(message);
+        queue_.push_back(std::move(entry));
+    }
+
+    stats_.queued++;
+    return true;
+}
+
+void MQTTOutbox::acknowledge(uint16_t packetId) {
+    std::lock_guard<std::mutex> lock(outboxMutex_);
+
+    for (auto& entry : queue_) {
+        if (entry.sent && !entry.acked && entry.packetId == packetId) {
+            entry.acked = true;
+            stats_.acknowledged++;
+            break;
+        }
+    }
+
+    popCompleted();
+}
+
+size_t MQTTOutbox::service(uint32_t now, bool connected) {
+    std::vector<Entry*> batch;
+    OutboxPublishFunction publish;
+
+    {
+        std::lock_guard<std::mutex> lock(outboxMutex_);
+
+        if (!connected) {
+            // Whatever was in flight is resent after the reconnect
+            if (connected_) {
+                for (auto& entry : queue_) {
+                    if (entry.sent && !entry.acked) {
+                        entry.sent = false;
+                    }
+                }
+            }
+            connected_ = false;
+            return 0;
+        }
+
+        if (!connected_) {
+            // Everything that waited for the connection is replayed at replayRate
+            connected_ = true;
+            lastRefill_ = now;
+            backlog_ = spoolCount_;
+            for (const auto& entry : queue_) {
+                if (!entry.acked) {
+                    backlog_++;
+                }
+            }
+        }
+
+        tokens_ = std::min<double>(window_, tokens_ + (now - lastRefill_) * replayRate_ / 1000.0);
+        lastRefill_ = now;
+
+        refill();
+
+        size_t inFlight = 0;
+        for (const auto& entry : queue_) {
+            if (entry.sent && !entry.acked && entry.message.qos > 0) {
+                inFlight++;
+            }
+        }
+
+        // Walk in order; a message is never sent ahead of an older unsent one.
+        // Only the backlog is paced; after it, the window is the only limit.
+        size_t backlog = backlog_;
+        for (auto& entry : queue_) {
+            if (entry.acked) continue;
+            bool paced = backlog > 0;
+            if (paced && tokens_ < 1) break;
+
+            if (entry.sent) {
+                if (now - entry.sentAt >= ackTimeout_) {
+                    batch.push_back(&entry);
+                    if (paced) tokens_ -= 1;
+                }
+                continue;
+            }
+
+            if (entry.message.qos > 0) {
+                if (inFlight >= window_) break;
+                if (entry.packetId == 0) {
+                    entry.packetId = nextPacketId();
+                }
+                inFlight++;
+            }
+            batch.push_back(&entry);
+            if (paced) {
+                tokens_ -= 1;
+                backlog--;
+            }
+        }
+
+        publish = publish_;
+    }
+
+    if (!publish) {
+        return 0;
+    }
+
+    // Entries are only removed by this thread, so the pointers stay valid
+    size_t sent = 0;
+    for (Entry* entry : batch) {
+        bool success = publish(entry->message, entry->packetId, entry->duplicate);
+
+        std::lock_guard<std::mutex> lock(outboxMutex_);
+        if (!success) {
+            break;
+        }
+
+        if (entry->duplicate) {
+            stats_.retransmitted++;
+        } else {
+            stats_.published++;
+        }
+        if (!entry->sent && backlog_ > 0) {
+            backlog_--;
+        }
+        entry->sent = true;
+        entry->duplicate = true;
+        entry->sentAt = now;
+        if (entry->message.qos == 0 || ackOnSend_) {
+            entry->acked = true;
+            stats_.acknowledged++;
+        }
+        sent++;
+    }
+
+    std::lock_guard<std::mutex> lock(outboxMutex_);
+    popCompleted();
+    persistSpoolProgress(now);
+    return sent;
+}
+
+size_t MQTTOutbox::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(outboxMutex_);
+    return queue_.size() + spoolCount_;
+}
+
+OutboxStats MQTTOutbox::getStats() const {
+    std::lock_guard<std::mutex> lock(outboxMutex_);
+
+    OutboxStats stats = stats_;
+    stats.ramDepth = queue_.size();
+    stats.spoolBytes = spoolSize_ - spoolReadOffset_;
+    stats.inFlight = 0;
+    for (const auto& entry : queue_) {
+        if (entry.sent && !entry.acked) {
+            stats.inFlight++;
+        }
+    }
+    return stats;
+}
+
+// Private methods
+bool MQTTOutbox::spool(const OutboxMessage& message) {
+    if (message.topic.size() > 0xFFFF || message.payload.size() > 0xFFFF) {
+        return false;
+    }
+
+    // Records read into RAM stay in the file until they are acknowledged
+    uint32_t length = RECORD_HEADER_SIZE + message.topic.size() + message.payload.size();
+    uint32_t retained = spoolSize_ > 0 ? spoolSize_ - spoolAckedOffset_ : 0;
+    if (retained + length > spoolCapacity_) {
+        return false;
+    }
+
+    bool created = spoolSize_ == 0;
+    FILE* file = fopen(spoolPath_.c_str(), created ? "wb" : "r+b");
+    if (!file) {
+        return false;
+    }
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    putLE(header, message.topic.size(), 2);
+    putLE(header + 2, message.payload.size(), 2);
+    header[4] = message.qos;
+
+    // Append after the last complete record, over a torn tail if there is one
+    bool success = created ? writeReadOffset(file, SPOOL_HEADER_SIZE) : fseek(file, spoolSize_, SEEK_SET) == 0;
+    success = success && fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    success = success && fwrite(message.topic.data(), 1, message.topic.size(), file) == message.topic.size();
+    success = success && fwrite(message.payload.data(), 1, message.payload.size(), file) == message.payload.size();
+    success = success && syncFile(file);
+    fclose(file);
+
+    if (!success) {
+        if (created) {
+            std::remove(spoolPath_.c_str());
+        }
+        return false;
+    }
+
+    if (created) {
+        spoolAckedOffset_ = SPOOL_HEADER_SIZE;
+        spoolPersistedOffset_ = SPOOL_HEADER_SIZE;
+        spoolReadOffset_ = SPOOL_HEADER_SIZE;
+        spoolSize_ = SPOOL_HEADER_SIZE;
+    }
+    spoolSize_ += length;
+    spoolCount_++;
+    stats_.spooled++;
+    return true;
+}
+
+void MQTTOutbox::refill() {
+    if (spoolCount_ == 0 || queue_.size() >= ramCapacity_) {
+        return;
+    }
+
+    FILE* file = fopen(spoolPath_.c_str(), "rb");
+    if (!file) {
+        spoolCount_ = 0;
+        spoolSize_ = spoolReadOffset_;
+        return;
+    }
+
+    // The header is left alone: until acknowledged, these records are
+    // replayed from the file after a reboot
+    fseek(file, spoolReadOffset_, SEEK_SET);
+    while (spoolCount_ > 0 && queue_.size() < ramCapacity_) {
+        Entry entry;
+        uint32_t length;
+        if (!readRecord(file, entry.message, length)) {
+            spoolCount_ = 0;  // Unreadable tail, give it up
+            spoolSize_ = spoolReadOffset_;
+            break;
+        }
+        spoolReadOffset_ += length;
+        entry.spoolEnd = spoolReadOffset_;
+        queue_.push_back(std::move(entry));
+        spoolCount_--;
+    }
+    fclose(file);
+}
+
+void MQTTOutbox::popCompleted() {
+    while (!queue_.empty() && queue_.front().acked) {
+        if (queue_.front().spoolEnd != 0) {
+            spoolAckedOffset_ = queue_.front().spoolEnd;
+            unpersistedAcks_++;
+        }
+        queue_.pop_front();
+    }
+}
+
+void MQTTOutbox::persistSpoolProgress(uint32_t now) {
+    if (spoolSize_ == 0 || spoolAckedOffset_ == spoolPersistedOffset_) {
+        lastPersist_ = now;
+        return;
+    }
+
+    // Every spooled message acknowledged
+    if (spoolCount_ == 0 && spoolAckedOffset_ >= spoolSize_) {
+        std::remove(spoolPath_.c_str());
+        spoolAckedOffset_ = 0;
+        spoolPersistedOffset_ = 0;
+        spoolReadOffset_ = 0;
+        spoolSize_ = 0;
+        unpersistedAcks_ = 0;
+        lastPersist_ = now;
+        return;
+    }
+
+    // Batch header writes to spare the flash
+    if (unpersistedAcks_ < PROGRESS_MESSAGES && now - lastPersist_ < PROGRESS_INTERVAL) {
+        return;
+    }
+    unpersistedAcks_ = 0;
+    lastPersist_ = now;
+
+    if (spoolAckedOffset_ - SPOOL_HEADER_SIZE > spoolCapacity_ / 2) {
+        compactSpool();
+        return;
+    }
+
+    FILE* file = fopen(spoolPath_.c_str(), "r+b");
+    if (file) {
+        if (writeReadOffset(file, spoolAckedOffset_) && syncFile(file)) {
+            spoolPersistedOffset_ = spoolAckedOffset_;
+        }
+        fclose(file);
+    }
+}
+
+void MQTTOutbox::compactSpool() {
+    std::string tempPath = spoolPath_ + ".tmp";
+    FILE* source = fopen(spoolPath_.c_str(), "rb");
+    FILE* target = fopen(tempPath.c_str(), "wb");
+
+    bool success = source && target && writeReadOffset(target, SPOOL_HEADER_SIZE) &&
+                   fseek(source, spoolAckedOffset_, SEEK_SET) == 0;
+
+    uint8_t buffer[256];
+    size_t count;
+    while (success && (count = fread(buffer, 1, sizeof(buffer), source)) > 0) {
+        success = fwrite(buffer, 1, count, target) == count;
+    }
+    success = success && syncFile(target);
+
+    if (source) fclose(source);
+    if (target) fclose(target);
+
+    if (!success) {
+        std::remove(tempPath.c_str());
+        return;
+    }
+
+    std::remove(spoolPath_.c_str());
+    if (std::rename(tempPath.c_str(), spoolPath_.c_str()) != 0) {
+        spoolCount_ = 0;
+        spoolAckedOffset_ = 0;
+        spoolPersistedOffset_ = 0;
+        spoolReadOffset_ = 0;
+        spoolSize_ = 0;
+        for (auto& entry : queue_) {
+            entry.spoolEnd = 0;
+        }
+        return;
+    }
+
+    // Shift offsets of the records still in RAM along with the file
+    uint32_t removed = spoolAckedOffset_ - SPOOL_HEADER_SIZE;
+    for (auto& entry : queue_) {
+        if (entry.spoolEnd != 0) {
+            entry.spoolEnd -= removed;
+        }
+    }
+    spoolSize_ -= removed;
+    spoolReadOffset_ -= removed;
+    spoolAckedOffset_ = SPOOL_HEADER_SIZE;
+    spoolPersistedOffset_ = SPOOL_HEADER_SIZE;
+}
+
+uint16_t MQTTOutbox::nextPacketId() {
+    while (true) {
+        lastPacketId_++;
+        if (lastPacketId_ == 0) {
+            continue;
+        }
+
+        bool inUse = false;
+        for (const auto& entry : queue_) {
+            inUse = inUse || (entry.packetId == lastPacketId_ && !entry.acked);
+        }
+        if (!inUse) {
+            return lastPacketId_;
+        }
+    }
+}
+
+} // namespace communication
+} // namespace sensors
@@ -0,0 +1,226 @@
+/**
+ * @file mqtt_outbox.hpp
+ * @brief Store-and-forward outbox for MQTT publishes
+ *
+ * This file defines the MQTTOutbox class, which queues outgoing MQTT
+ * messages in RAM, spills them to flash when the RAM queue is full, and
+ * forwards them with QoS 1 in-flight tracking once the broker is reachable.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace sensors {
+namespace communication {
+
+/**
+ * @brief Message waiting in the outbox
+ */
+struct OutboxMessage {
+    std::string topic;          ///< Topic
+    std::string payload;        ///< Payload
+    uint8_t qos{1};             ///< Quality of service (0 or 1)
+};
+
+/**
+ * @brief Outbox statistics
+ */
+struct OutboxStats {
+    uint32_t queued{0};         ///< Messages accepted
+    uint32_t spooled{0};        ///< Messages written to flash
+    uint32_t published{0};      ///< First transmissions
+    uint32_t retransmitted{0};  ///< Retransmissions with the DUP flag
+    uint32_t acknowledged{0};   ///< Messages completed
+    uint32_t dropped{0};        ///< Messages rejected because the spool was full
+    size_t ramDepth{0};         ///< Messages in the RAM queue
+    size_t spoolBytes{0};       ///< Unread bytes in the spool file
+    size_t inFlight{0};         ///< Messages sent but not acknowledged
+};
+
+/**
+ * @brief Type definition for the publish function
+ *
+ * Called with the message, its packet ID and whether it is a retransmission.
+ * Returns true if the message was handed to the network.
+ */
+using OutboxPublishFunction = std::function<bool(const OutboxMessage&, uint16_t, bool)>;
+
+/**
+ * @brief Bounded, flash-backed MQTT outbox
+ *
+ * Messages are kept in order. The RAM queue holds the oldest messages; once
+ * it is full, newer messages are appended to a spool file and read back as
+ * the queue drains, so ordering is preserved across the spill. A message
+ * counts as spooled once its record is synced to flash. The spool survives
+ * a reboot: its header records the oldest spooled message not yet
+ * acknowledged, so messages read back into RAM but lost with it are sent
+ * again. The header is rewritten every few dozen acknowledgements or
+ * seconds rather than after every batch, so a reboot may also resend some
+ * messages that were already acknowledged.
+ *
+ * While connected, service() keeps up to `window` QoS 1 messages in flight
+ * and sends more as PUBACKs arrive, instead of waiting for each one.
+ * Unacknowledged messages are retransmitted with the DUP flag after the ack
+ * timeout or after a reconnect. The messages that were waiting when the
+ * connection came up are the backlog; they are paced by a token bucket of
+ * `replayRate` messages per second, so a backlog replays in order without
+ * flooding the link. Once it is sent, messages go out as fast as the
+ * window allows.
+ *
+ * enqueue() may be called from any thread. service() and acknowledge() must
+ * be called from the thread that drives the MQTT client.
+ */
+class MQTTOutbox {
+public:
+    /**
+     * @brief Constructor
+     * @param spoolPath Filesystem path of the spool file
+     * @param ramCapacity Maximum messages held in RAM
+     * @param spoolCapacity Maximum unread bytes in the spool file
+     * @param window Maximum unacknowledged QoS 1 messages
+     * @param replayRate Maximum messages sent per second while replaying a backlog
+     * @param ackTimeout Time before an unacknowledged message is resent (ms)
+     */
+    explicit MQTTOutbox(const std::string& spoolPath = "/spiffs/mqtt_outbox.bin",
+                        size_t ramCapacity = 64,
+                        size_t spoolCapacity = 64 * 1024,
+                        size_t window = 8,
+                        uint32_t replayRate = 20,
+                        uint32_t ackTimeout = 5000);
+
+    /**
+     * @brief Resume messages spooled by a previous run
+     * @return True if successful, false otherwise
+     */
+    bool init();
+
+    /**
+     * @brief Set publish function
+     * @param publish Function handing a message to the MQTT client
+     * @param ackOnSend True if the client cannot report PUBACKs, so a
+     *                  successful send completes the message
+     */
+    void setPublishFunction(OutboxPublishFunction publish, bool ackOnSend = false);
+
+    //---------- Queueing ----------//
+
+    /**
+     * @brief Queue message for publishing
+     * @param topic Topic
+     * @param payload Payload
+     * @param qos Quality of service (0 or 1)
+     * @return True if queued, false if the outbox is full
+     */
+    bool enqueue(const std::string& topic, const std::string& payload, uint8_t qos = 1);
+
+    /**
+     * @brief Complete message acknowledged by the broker
+     * @param packetId Packet ID of the PUBACK
+     */
+    void acknowledge(uint16_t packetId);
+
+    /**
+     * @brief Send queued messages and retransmit timed-out ones
+     * @param now Current time (ms)
+     * @param connected True if the MQTT client is connected
+     * @return Number of messages handed to the network
+     */
+    size_t service(uint32_t now, bool connected);
+
+    //---------- Status ----------//
+
+    /**
+     * @brief Get number of messages not yet completed
+     * @return Messages in RAM and in the spool
+     */
+    size_t getPendingCount() const;
+
+    /**
+     * @brief Get outbox statistics
+     * @return Statistics
+     */
+    OutboxStats getStats() const;
+
+private:
+    /**
+     * @brief Queued message with delivery state
+     */
+    struct Entry {
+        OutboxMessage message;      ///< Message
+        uint16_t packetId{0};       ///< Packet ID, assigned on first send
+        bool sent{false};           ///< Handed to the network and awaiting ack
+        bool duplicate{false};      ///< Sent at least once before
+        bool acked{false};          ///< Completed
+        uint32_t sentAt{0};         ///< Time of the last send (ms)
+        uint32_t spoolEnd{0};       ///< Spool offset after this record, 0 if never spooled
+    };
+
+    /**
+     * @brief Append message to the spool file (caller holds outboxMutex_)
+     * @param message Message
+     * @return True if successful, false if the spool is full or unwritable
+     */
+    bool spool(const OutboxMessage& message);
+
+    /**
+     * @brief Move spooled messages into free RAM slots (caller holds outboxMutex_)
+     */
+    void refill();
+
+    /**
+     * @brief Remove completed messages from the front (caller holds outboxMutex_)
+     */
+    void popCompleted();
+
+    /**
+     * @brief Record acknowledged spool progress in the spool file when due (caller holds outboxMutex_)
+     * @param now Current time (ms)
+     */
+    void persistSpoolProgress(uint32_t now);
+
+    /**
+     * @brief Rewrite the spool without its acknowledged prefix (caller holds outboxMutex_)
+     */
+    void compactSpool();
+
+    /**
+     * @brief Allocate next packet ID (caller holds outboxMutex_)
+     * @return Packet ID, never 0 and not in flight
+     */
+    uint16_t nextPacketId();
+
+private:
+    std::string spoolPath_;                     ///< Spool file path
+    size_t ramCapacity_;                        ///< Maximum messages in RAM
+    size_t spoolCapacity_;                      ///< Maximum unread spool bytes
+    size_t window_;                             ///< Maximum in-flight messages
+    uint32_t replayRate_;                       ///< Maximum messages per second
+    uint32_t ackTimeout_;                       ///< Retransmission timeout (ms)
+
+    OutboxPublishFunction publish_;             ///< Publish function
+    bool ackOnSend_{false};                     ///< Send completes the message
+
+    std::deque<Entry> queue_;                   ///< RAM queue, oldest first
+    uint32_t spoolAckedOffset_{0};              ///< Offset of the oldest unacknowledged record
+    uint32_t spoolPersistedOffset_{0};          ///< Acknowledged offset in the spool header
+    uint32_t unpersistedAcks_{0};               ///< Spooled messages acknowledged since the header write
+    uint32_t lastPersist_{0};                   ///< Time of the last header write (ms)
+    uint32_t spoolReadOffset_{0};               ///< Offset of the next unread record
+    uint32_t spoolSize_{0};                     ///< Spool file size
+    uint32_t spoolCount_{0};                    ///< Unread records in the spool
+    uint16_t lastPacketId_{0};                  ///< Last packet ID assigned
+    bool connected_{false};                     ///< Connection state at the last service()
+    size_t backlog_{0};                         ///< Messages of the reconnect backlog not yet sent
+    double tokens_{0};                          ///< Send tokens available
+    uint32_t lastRefill_{0};                    ///< Time of the last token refill (ms)
+    OutboxStats stats_;                         ///< Statistics
+    mutable std::mutex outboxMutex_;            ///< Mutex for thread safety
+};
+
+} // namespace communication
+} // namespace sensors
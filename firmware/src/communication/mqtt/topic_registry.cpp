@@ -0,0 +1,111 @@
+#include "topic_registry.hpp"
+
+namespace sensors {
+namespace communication {
+
+namespace {
+
+// FNV-1a, usable at compile time for the action keywords
+constexpr uint32_t hashSegment(std::string_view segment) {
+    uint32_t hash = 2166136261u;
+    for (char c : segment) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+constexpr uint32_t CONFIG_HASH = hashSegment("config");
+constexpr uint32_t COMMAND_HASH = hashSegment("command");
+
+// Split off the segment before the next '/', advancing rest past it
+std::string_view nextSegment(std::string_view& rest) {
+    size_t slash = rest.find('/');
+    std::string_view segment = rest.substr(0, slash);
+    rest = slash == std::string_view::npos ? std::string_view() : rest.substr(slash + 1);
+    return segment;
+}
+
+} // namespace
+
+TopicRegistry::TopicRegistry(const std::string& root) :
+    root_(root) {
+}
+
+int TopicRegistry::intern(const std::string& sensorId) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+
+    auto it = handles_.find(sensorId);
+    if (it != handles_.end()) {
+        return it->second;
+    }
+
+    SensorTopics topics;
+    topics.sensorId = sensorId;
+    topics.reading = root_ + "/" + sensorId + "/reading";
+    topics.error = root_ + "/" + sensorId + "/error";
+    topics_.push_back(std::move(topics));
+
+    int handle = static_cast<int>(topics_.size() - 1);
+    handles_[topics_.back().sensorId] = handle;
+    return handle;
+}
+
+int TopicRegistry::find(std::string_view sensorId) const {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+
+    auto it = handles_.find(sensorId);
+    return it != handles_.end() ? it->second : INVALID_HANDLE;
+}
+
+const SensorTopics* TopicRegistry::getTopics(int handle) const {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+
+    if (handle < 0 || handle >= static_cast<int>(topics_.size())) {
+        return nullptr;
+    }
+    return &topics_[handle];
+}
+
+const SensorTopics& TopicRegistry::topicsFor(const std::string& sensorId) {
+    int handle = intern(sensorId);
+
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    return topics_[handle];
+}
+
+bool TopicRegistry::route(std::string_view topic, TopicRoute& route) const {
+    route = TopicRoute();
+
+    std::string_view rest = topic;
+    if (nextSegment(rest) != root_) {
+        return false;
+    }
+    nextSegment(rest);  // Device segment, matched by the '+' subscription
+
+    std::string_view action = nextSegment(rest);
+    switch (hashSegment(action)) {
+        case CONFIG_HASH:
+            if (action != "config") return false;
+            route.action = TopicAction::CONFIG;
+            break;
+        case COMMAND_HASH:
+            if (action != "command") return false;
+            route.action = TopicAction::COMMAND;
+            break;
+        default:
+            return false;
+    }
+
+    // The sensor ID is the rest of the topic
+    route.sensorId = rest;
+    route.handle = find(rest);
+    return true;
+}
+
+size_t TopicRegistry::size() const {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    return topics_.size();
+}
+
+} // namespace communication
+} // namespace sensors
@@ -0,0 +1,123 @@
+/**
+ * @file topic_registry.hpp
+ * @brief Precomputed MQTT topics and inbound topic routing
+ *
+ * This file defines the TopicRegistry class, which builds the MQTT topics of
+ * each sensor once and routes inbound topics to a sensor handle and action
+ * without substring searches or allocation.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace sensors {
+namespace communication {
+
+/**
+ * @brief Inbound topic action enumeration
+ */
+enum class TopicAction : uint8_t {
+    NONE = 0,       ///< Topic not handled
+    CONFIG = 1,     ///< sensors/<device>/config/<sensorId>
+    COMMAND = 2     ///< sensors/<device>/command/<sensorId>
+};
+
+/**
+ * @brief Topics of one sensor, built at registration
+ */
+struct SensorTopics {
+    std::string sensorId;       ///< Sensor ID
+    std::string reading;        ///< sensors/<sensorId>/reading
+    std::string error;          ///< sensors/<sensorId>/error
+};
+
+/**
+ * @brief Result of routing an inbound topic
+ */
+struct TopicRoute {
+    TopicAction action{TopicAction::NONE};  ///< Action selected by the topic
+    int handle{-1};                         ///< Sensor handle, or INVALID_HANDLE if not registered
+    std::string_view sensorId;              ///< Sensor ID segment, a view into the routed topic
+};
+
+/**
+ * @brief Registry of per-sensor MQTT topics
+ *
+ * intern() assigns a sensor a stable handle and builds its outbound topics
+ * once; publishers reuse the stored strings instead of formatting a topic
+ * per message. Entries are never removed, so SensorTopics references stay
+ * valid for the lifetime of the registry.
+ *
+ * route() splits an inbound topic into segments in place, selects the
+ * action by a hash of the action segment and resolves the sensor segment to
+ * its handle with one hash lookup.
+ *
+ * All methods may be called from any thread.
+ */
+class TopicRegistry {
+public:
+    static const int INVALID_HANDLE = -1;   ///< Handle of an unregistered sensor
+
+    /**
+     * @brief Constructor
+     * @param root First topic segment
+     */
+    explicit TopicRegistry(const std::string& root = "sensors");
+
+    /**
+     * @brief Register sensor, or find it if already registered
+     * @param sensorId Sensor ID
+     * @return Sensor handle
+     */
+    int intern(const std::string& sensorId);
+
+    /**
+     * @brief Find sensor handle
+     * @param sensorId Sensor ID
+     * @return Sensor handle, or INVALID_HANDLE if not registered
+     */
+    int find(std::string_view sensorId) const;
+
+    /**
+     * @brief Get topics of a sensor
+     * @param handle Sensor handle
+     * @return Topics, or nullptr if the handle is invalid
+     */
+    const SensorTopics* getTopics(int handle) const;
+
+    /**
+     * @brief Get topics of a sensor, registering it if needed
+     * @param sensorId Sensor ID
+     * @return Topics
+     */
+    const SensorTopics& topicsFor(const std::string& sensorId);
+
+    /**
+     * @brief Route inbound topic
+     * @param topic Topic
+     * @param route Output route; sensorId points into topic
+     * @return True if the topic names a known action, false otherwise
+     */
+    bool route(std::string_view topic, TopicRoute& route) const;
+
+    /**
+     * @brief Get number of registered sensors
+     * @return Number of sensors
+     */
+    size_t size() const;
+
+private:
+    std::string root_;                                          ///< First topic segment
+    std::deque<SensorTopics> topics_;                           ///< Topics by handle, stable addresses
+    std::unordered_map<std::string_view, int> handles_;         ///< Handle by sensor ID (views into topics_)
+    mutable std::mutex registryMutex_;                          ///< Mutex for thread safety
+};
+
+} // namespace communication
+} // namespace sensors
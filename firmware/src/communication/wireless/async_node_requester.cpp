@@ -0,0 +1,235 @@
+#include "async_node_requester.hpp"
+#include <utility>
+
+namespace sensors {
+namespace communication {
+
+AsyncNodeRequester::AsyncNodeRequester(RequestSendFunction send,
+                                       RequestTimeSource timeSource,
+                                       uint32_t defaultTimeout,
+                                       size_t defaultWindow) :
+    send_(send),
+    timeSource_(timeSource),
+    defaultTimeout_(defaultTimeout),
+    defaultWindow_(defaultWindow > 0 ? defaultWindow : 1) {
+}
+
+void AsyncNodeRequester::registerNode(const std::string& nodeId, const std::string& protocol, uint32_t timeout) {
+    std::lock_guard<std::mutex> lock(requestMutex_);
+    nodes_[nodeId] = {protocol, timeout > 0 ? timeout : defaultTimeout_};
+}
+
+void AsyncNodeRequester::unregisterNode(const std::string& nodeId) {
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex_);
+        nodes_.erase(nodeId);
+
+        for (auto& request : table_) {
+            if (request.cid != 0 && request.nodeId == nodeId) {
+                completions.push_back({std::move(request.callback), RequestStatus::CANCELLED});
+                release(request);
+            }
+        }
+
+        for (auto it = queue_.begin(); it != queue_.end();) {
+            if (it->nodeId == nodeId) {
+                completions.push_back({std::move(it->callback), RequestStatus::CANCELLED});
+                it = queue_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (auto& completion : completions) {
+        if (completion.callback) completion.callback(completion.status, json());
+    }
+}
+
+void AsyncNodeRequester::setProtocolWindow(const std::string& protocol, size_t window) {
+    std::lock_guard<std::mutex> lock(requestMutex_);
+    windows_[protocol] = window > 0 ? window : 1;
+}
+
+bool AsyncNodeRequester::requestData(const std::string& nodeId, const json& request, RequestCallback callback) {
+    return submit(nodeId, request, callback);
+}
+
+bool AsyncNodeRequester::sendCommand(const std::string& nodeId, const json& command, RequestCallback callback) {
+    return submit(nodeId, command, callback);
+}
+
+bool AsyncNodeRequester::handleResponse(const std::string& nodeId, const json& data) {
+    if (!data.is_object() || !data.contains("cid") || !data["cid"].is_number_unsigned()) {
+        return false;
+    }
+
+    uint32_t cid = data["cid"].get<uint32_t>();
+    RequestCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex_);
+
+        Request& request = table_[cid % MAX_OUTSTANDING];
+        if (cid == 0 || request.cid != cid || request.nodeId != nodeId) {
+            stats_.unmatched++;
+            return true;  // Late reply to a request that already timed out
+        }
+
+        callback = std::move(request.callback);
+        release(request);
+        stats_.completed++;
+    }
+
+    if (callback) callback(RequestStatus::COMPLETED, data);
+    return true;
+}
+
+void AsyncNodeRequester::update() {
+    std::vector<Completion> completions;
+    std::vector<Request> toSend;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex_);
+        uint32_t now = timeSource_();
+
+        for (auto& request : table_) {
+            if (request.cid != 0 && now - request.sentAt >= request.timeout) {
+                completions.push_back({std::move(request.callback), RequestStatus::TIMEOUT});
+                release(request);
+                stats_.timedOut++;
+            }
+        }
+
+        dispatch(toSend);
+    }
+
+    for (auto& completion : completions) {
+        if (completion.callback) completion.callback(completion.status, json());
+    }
+    sendAll(toSend);
+}
+
+RequestStats AsyncNodeRequester::getStats() const {
+    std::lock_guard<std::mutex> lock(requestMutex_);
+
+    RequestStats stats = stats_;
+    stats.outstanding = 0;
+    for (const auto& request : table_) {
+        if (request.cid != 0) stats.outstanding++;
+    }
+    stats.queued = queue_.size();
+    return stats;
+}
+
+// Private methods
+bool AsyncNodeRequester::submit(const std::string& nodeId, const json& payload, RequestCallback callback) {
+    std::vector<Request> toSend;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex_);
+
+        if (queue_.size() >= MAX_QUEUED) {
+            stats_.rejected++;
+            return false;
+        }
+
+        Request request;
+        request.nodeId = nodeId;
+        request.payload = payload;
+        request.callback = callback;
+
+        auto node = nodes_.find(nodeId);
+        if (node != nodes_.end()) {
+            request.protocol = node->second.protocol;
+            request.timeout = node->second.timeout;
+        } else {
+            request.timeout = defaultTimeout_;
+        }
+
+        queue_.push_back(std::move(request));
+        stats_.submitted++;
+        dispatch(toSend);
+    }
+
+    sendAll(toSend);
+    return true;
+}
+
+void AsyncNodeRequester::dispatch(std::vector<Request>& toSend) {
+    uint32_t now = timeSource_();
+
+    for (auto it = queue_.begin(); it != queue_.end();) {
+        auto window = windows_.find(it->protocol);
+        size_t limit = window != windows_.end() ? window->second : defaultWindow_;
+        if (inFlight_[it->protocol] >= limit) {
+            ++it;  // Later requests for other protocols may still go
+            continue;
+        }
+
+        uint16_t cid = allocateCid();
+        if (cid == 0) {
+            break;  // Table full
+        }
+
+        Request& slot = table_[cid % MAX_OUTSTANDING];
+        slot = std::move(*it);
+        slot.cid = cid;
+        slot.sentAt = now;
+        inFlight_[slot.protocol]++;
+
+        // The copy carries what the sender needs; the callback stays in the table
+        Request outgoing;
+        outgoing.cid = cid;
+        outgoing.nodeId = slot.nodeId;
+        outgoing.payload = slot.payload;
+        outgoing.payload["cid"] = cid;
+        toSend.push_back(std::move(outgoing));
+
+        it = queue_.erase(it);
+    }
+}
+
+void AsyncNodeRequester::sendAll(std::vector<Request>& toSend) {
+    for (auto& outgoing : toSend) {
+        if (send_ && send_(outgoing.nodeId, outgoing.payload)) {
+            continue;
+        }
+
+        RequestCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(requestMutex_);
+            Request& request = table_[outgoing.cid % MAX_OUTSTANDING];
+            if (request.cid != outgoing.cid) {
+                continue;  // Already answered or cancelled
+            }
+            callback = std::move(request.callback);
+            release(request);
+            stats_.failed++;
+        }
+
+        if (callback) callback(RequestStatus::SEND_FAILED, json());
+    }
+}
+
+void AsyncNodeRequester::release(Request& request) {
+    auto inFlight = inFlight_.find(request.protocol);
+    if (inFlight != inFlight_.end() && inFlight->second > 0) {
+        inFlight->second--;
+    }
+    request = Request();
+}
+
+uint16_t AsyncNodeRequester::allocateCid() {
+    for (size_t i = 0; i < MAX_OUTSTANDING; i++) {
+        lastCid_++;
+        if (lastCid_ == 0) {
+            lastCid_++;
+        }
+        if (table_[lastCid_ % MAX_OUTSTANDING].cid == 0) {
+            return lastCid_;
+        }
+    }
+    return 0;
+}
+
+} // namespace communication
+} // namespace sensors
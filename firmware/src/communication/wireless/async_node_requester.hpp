@@ -0,0 +1,248 @@
+/**
+ * @file async_node_requester.hpp
+ * @brief Pipelined asynchronous requests to wireless nodes
+ *
+ * This file defines the AsyncNodeRequester class, which sends requests and
+ * commands to wireless nodes without waiting for each response, matches the
+ * responses back by correlation ID and reports completion through callbacks.
+ */
+
+#pragma once
+
+#include "../../core/sensor_types.hpp"
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sensors {
+namespace communication {
+
+/**
+ * @brief Request completion status
+ */
+enum class RequestStatus {
+    COMPLETED,      ///< Response received
+    TIMEOUT,        ///< No response within the node timeout
+    SEND_FAILED,    ///< Request could not be sent
+    CANCELLED       ///< Node was unregistered
+};
+
+/**
+ * @brief Type definition for request completion callback
+ *
+ * Called with the status and, if completed, the node's response.
+ */
+using RequestCallback = std::function<void(RequestStatus, const json&)>;
+
+/**
+ * @brief Type definition for the send function
+ *
+ * Called with the node ID and the request including its "cid" field.
+ * Returns true if the request was handed to the radio.
+ */
+using RequestSendFunction = std::function<bool(const std::string&, const json&)>;
+
+/**
+ * @brief Type definition for the time source (ms)
+ */
+using RequestTimeSource = std::function<uint32_t()>;
+
+/**
+ * @brief Request statistics
+ */
+struct RequestStats {
+    uint32_t submitted{0};      ///< Requests accepted
+    uint32_t rejected{0};       ///< Requests refused because the queue was full
+    uint32_t completed{0};      ///< Requests answered
+    uint32_t timedOut{0};       ///< Requests that timed out
+    uint32_t failed{0};         ///< Requests that could not be sent
+    uint32_t unmatched{0};      ///< Responses with an unknown or stale cid
+    size_t outstanding{0};      ///< Requests sent and awaiting a response
+    size_t queued{0};           ///< Requests waiting for a free window slot
+};
+
+/**
+ * @brief Pipelined request dispatcher for wireless nodes
+ *
+ * Each request gets a correlation ID ("cid") that the node echoes in its
+ * response. Up to `window` requests per protocol are outstanding at once,
+ * so polling a fleet takes about one round trip instead of one per node.
+ * Requests beyond the window wait in FIFO order; a saturated protocol does
+ * not hold back requests for another one.
+ *
+ * Outstanding requests live in a direct-mapped table indexed by
+ * `cid % MAX_OUTSTANDING`. IDs are allocated so that no two outstanding
+ * requests share a slot, which makes response matching a single lookup.
+ *
+ * Requests may be submitted and responses handled from any thread. A request
+ * is sent by the submitting thread if a slot is free; otherwise update(),
+ * called from loop(), sends it once a response or timeout frees one.
+ * Callbacks run without the internal lock held.
+ */
+class AsyncNodeRequester {
+public:
+    static const size_t MAX_OUTSTANDING = 32;   ///< Outstanding requests across all protocols
+    static const size_t MAX_QUEUED = 64;        ///< Requests waiting for a window slot
+
+    /**
+     * @brief Constructor
+     * @param send Function sending a request to a node
+     * @param timeSource Time source (ms)
+     * @param defaultTimeout Response timeout for nodes without their own (ms)
+     * @param defaultWindow Outstanding requests per protocol
+     */
+    AsyncNodeRequester(RequestSendFunction send,
+                       RequestTimeSource timeSource,
+                       uint32_t defaultTimeout = 2000,
+                       size_t defaultWindow = 8);
+
+    //---------- Node Management ----------//
+
+    /**
+     * @brief Register node
+     * @param nodeId Node ID
+     * @param protocol Communication protocol
+     * @param timeout Response timeout (ms), 0 for the default
+     */
+    void registerNode(const std::string& nodeId, const std::string& protocol, uint32_t timeout = 0);
+
+    /**
+     * @brief Unregister node and cancel its requests
+     * @param nodeId Node ID
+     */
+    void unregisterNode(const std::string& nodeId);
+
+    /**
+     * @brief Set number of outstanding requests for a protocol
+     * @param protocol Protocol name
+     * @param window Outstanding requests
+     */
+    void setProtocolWindow(const std::string& protocol, size_t window);
+
+    //---------- Requests ----------//
+
+    /**
+     * @brief Request data from node
+     * @param nodeId Node ID
+     * @param request Request data
+     * @param callback Completion callback
+     * @return True if accepted, false if the queue is full
+     */
+    bool requestData(const std::string& nodeId, const json& request, RequestCallback callback);
+
+    /**
+     * @brief Send command to node and wait for its acknowledgement
+     * @param nodeId Node ID
+     * @param command Command data
+     * @param callback Completion callback
+     * @return True if accepted, false if the queue is full
+     */
+    bool sendCommand(const std::string& nodeId, const json& command, RequestCallback callback);
+
+    /**
+     * @brief Match node data against outstanding requests
+     * @param nodeId Node ID the data came from
+     * @param data Data received
+     * @return True if the data was a response (carried a cid), false otherwise
+     */
+    bool handleResponse(const std::string& nodeId, const json& data);
+
+    /**
+     * @brief Expire timed-out requests and send queued ones
+     */
+    void update();
+
+    //---------- Status ----------//
+
+    /**
+     * @brief Get request statistics
+     * @return Statistics
+     */
+    RequestStats getStats() const;
+
+private:
+    /**
+     * @brief Request and its delivery state
+     */
+    struct Request {
+        uint16_t cid{0};                ///< Correlation ID, 0 while queued
+        std::string nodeId;             ///< Node ID
+        std::string protocol;           ///< Protocol the node uses
+        json payload;                   ///< Request data
+        RequestCallback callback;       ///< Completion callback
+        uint32_t timeout{0};            ///< Response timeout (ms)
+        uint32_t sentAt{0};             ///< Send time (ms)
+    };
+
+    /**
+     * @brief Completed request waiting for its callback
+     */
+    struct Completion {
+        RequestCallback callback;       ///< Completion callback
+        RequestStatus status;           ///< Status
+    };
+
+    /**
+     * @brief Queue request and send it if a window slot is free
+     * @param nodeId Node ID
+     * @param payload Request data
+     * @param callback Completion callback
+     * @return True if accepted, false if the queue is full
+     */
+    bool submit(const std::string& nodeId, const json& payload, RequestCallback callback);
+
+    /**
+     * @brief Move queued requests into free window slots (caller holds requestMutex_)
+     * @param toSend Requests to send once the lock is released
+     */
+    void dispatch(std::vector<Request>& toSend);
+
+    /**
+     * @brief Send requests and complete the ones that fail
+     * @param toSend Requests to send
+     */
+    void sendAll(std::vector<Request>& toSend);
+
+    /**
+     * @brief Free table slot (caller holds requestMutex_)
+     * @param request Outstanding request
+     */
+    void release(Request& request);
+
+    /**
+     * @brief Allocate correlation ID with a free slot (caller holds requestMutex_)
+     * @return Correlation ID, or 0 if the table is full
+     */
+    uint16_t allocateCid();
+
+private:
+    /**
+     * @brief Per-node parameters
+     */
+    struct NodeEntry {
+        std::string protocol;           ///< Communication protocol
+        uint32_t timeout;               ///< Response timeout (ms)
+    };
+
+    RequestSendFunction send_;                          ///< Send function
+    RequestTimeSource timeSource_;                      ///< Time source
+    uint32_t defaultTimeout_;                           ///< Default response timeout (ms)
+    size_t defaultWindow_;                              ///< Default window per protocol
+
+    std::array<Request, MAX_OUTSTANDING> table_;        ///< Outstanding requests by cid % MAX_OUTSTANDING
+    std::deque<Request> queue_;                         ///< Requests waiting for a window slot
+    std::map<std::string, NodeEntry> nodes_;            ///< Registered nodes
+    std::map<std::string, size_t> windows_;             ///< Window per protocol
+    std::map<std::string, size_t> inFlight_;            ///< Outstanding requests per protocol
+    uint16_t lastCid_{0};                               ///< Last correlation ID allocated
+    RequestStats stats_;                                ///< Statistics
+    mutable std::mutex requestMutex_;                   ///< Mutex for thread safety
+};
+
+} // namespace communication
+} // namespace sensors
@@ -0,0 +1,162 @@
+#include "discovery_scheduler.hpp"
+#include <algorithm>
+
+namespace sensors {
+namespace communication {
+
+namespace {
+
+// ESP-NOW at the default 1 Mbps rate: long preamble plus 802.11 action frame overhead
+const uint32_t ESPNOW_PREAMBLE_US = 192;
+const uint32_t ESPNOW_OVERHEAD_BYTES = 43;
+const uint32_t ESPNOW_US_PER_BYTE = 8;
+
+// BLE 1M PHY: link layer, L2CAP and ATT headers, plus the empty reply and two IFS
+const uint32_t BLE_OVERHEAD_BYTES = 17;
+const uint32_t BLE_US_PER_BYTE = 8;
+const uint32_t BLE_EXCHANGE_US = 380;
+
+// True if time a is after time b, tolerating millis() wrap-around
+bool isAfter(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+} // namespace
+
+DiscoveryScheduler::DiscoveryScheduler(const DiscoverySchedule& schedule) :
+    schedule_(schedule),
+    interval_(schedule.minInterval) {
+    stats_.currentInterval = interval_;
+}
+
+bool DiscoveryScheduler::update(uint32_t now, bool discoveryRunning, uint32_t& window) {
+    foldDataAirtime();
+
+    if (!started_) {
+        started_ = true;
+        nextRoundAt_ = now;  // Nothing is known at boot
+    }
+
+    if (triggered_.exchange(false)) {
+        interval_ = schedule_.minInterval;
+        if (!inRound_) {
+            nextRoundAt_ = now;
+        }
+    }
+
+    if (windowOpen_) {
+        if (discoveryRunning) {
+            return false;
+        }
+        windowOpen_ = false;
+        stats_.discoveryAirtime += now - windowStartedAt_;
+        nextWindowAt_ = now + schedule_.windowGap;
+        if (windowsLeft_ == 0) {
+            finishRound(now);
+        }
+    }
+
+    if (discoveryRunning) {
+        return false;  // Someone else is scanning
+    }
+
+    if (!inRound_) {
+        // Churn between rounds brings the next round forward
+        if (churn_.load() && interval_ > schedule_.minInterval) {
+            interval_ = schedule_.minInterval;
+            stats_.currentInterval = interval_;
+            if (isAfter(nextRoundAt_, now + interval_)) {
+                nextRoundAt_ = now + interval_;
+            }
+        }
+        if (isAfter(nextRoundAt_, now)) {
+            return false;
+        }
+
+        inRound_ = true;
+        churn_ = false;
+        windowsLeft_ = schedule_.windowsPerRound;
+        nextWindowAt_ = now;
+        stats_.rounds++;
+    }
+
+    if (isAfter(nextWindowAt_, now)) {
+        return false;
+    }
+
+    // Let a burst of data traffic finish first, but never starve discovery
+    bool dataActive = now - lastDataAt_.load() < schedule_.quietTime;
+    if (dataActive && now - nextWindowAt_ < schedule_.maxDeferral) {
+        if (!deferring_) {
+            deferring_ = true;
+            stats_.deferred++;
+        }
+        return false;
+    }
+
+    deferring_ = false;
+    windowOpen_ = true;
+    windowStartedAt_ = now;
+    windowsLeft_--;
+    stats_.windows++;
+    window = schedule_.windowLength;
+    return true;
+}
+
+void DiscoveryScheduler::notifyChurn() {
+    churn_ = true;
+}
+
+void DiscoveryScheduler::trigger() {
+    triggered_ = true;
+}
+
+void DiscoveryScheduler::recordDataFrame(NodeProtocol protocol, size_t length, uint32_t now) {
+    uint32_t airtime;
+    switch (protocol) {
+        case NodeProtocol::ESPNOW:
+            airtime = ESPNOW_PREAMBLE_US + (length + ESPNOW_OVERHEAD_BYTES) * ESPNOW_US_PER_BYTE;
+            break;
+        case NodeProtocol::BLE:
+            airtime = BLE_EXCHANGE_US + (length + BLE_OVERHEAD_BYTES) * BLE_US_PER_BYTE;
+            break;
+        default:
+            return;  // WiFi traffic is not counted
+    }
+
+    dataAirtimeUs_ += airtime;
+    dataFrames_++;
+    lastDataAt_ = now;
+}
+
+DiscoveryStats DiscoveryScheduler::getStats() const {
+    DiscoveryStats stats = stats_;
+    uint32_t unfolded = dataAirtimeUs_.load() - dataAirtimeFoldedUs_;
+    stats.dataAirtime = (dataAirtimeTotalUs_ + unfolded) / 1000;
+    stats.dataFrames = dataFrames_.load();
+    return stats;
+}
+
+// Private methods
+void DiscoveryScheduler::foldDataAirtime() {
+    // Unsigned difference, correct across one wrap of the counter
+    uint32_t counted = dataAirtimeUs_.load();
+    dataAirtimeTotalUs_ += counted - dataAirtimeFoldedUs_;
+    dataAirtimeFoldedUs_ = counted;
+}
+
+void DiscoveryScheduler::finishRound(uint32_t now) {
+    inRound_ = false;
+
+    // A quiet round doubles the interval; churn during the round resets it
+    if (churn_.exchange(false)) {
+        interval_ = schedule_.minInterval;
+    } else {
+        interval_ = std::min(interval_ * 2, schedule_.maxInterval);
+    }
+    nextRoundAt_ = now + interval_;
+    stats_.currentInterval = interval_;
+}
+
+} // namespace communication
+} // namespace sensors
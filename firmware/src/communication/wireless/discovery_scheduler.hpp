@@ -0,0 +1,137 @@
+/**
+ * @file discovery_scheduler.hpp
+ * @brief Adaptive, duty-cycled scheduling of wireless node discovery
+ *
+ * This file defines the DiscoveryScheduler class, which decides when to run
+ * short discovery scan windows so that discovery backs off while the node
+ * set is stable and leaves the radio to data traffic.
+ */
+
+#pragma once
+
+#include "node_table.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace sensors {
+namespace communication {
+
+/**
+ * @brief Discovery scheduling parameters
+ */
+struct DiscoverySchedule {
+    uint32_t minInterval{30000};        ///< Round interval after churn (ms)
+    uint32_t maxInterval{600000};       ///< Round interval once the node set is stable (ms)
+    uint32_t windowLength{1000};        ///< Length of one scan window (ms)
+    uint8_t windowsPerRound{3};         ///< Scan windows per discovery round
+    uint32_t windowGap{2000};           ///< Radio time left to data between windows (ms)
+    uint32_t quietTime{200};            ///< Data silence wanted before a window starts (ms)
+    uint32_t maxDeferral{5000};         ///< Longest a window waits for data to go quiet (ms)
+};
+
+/**
+ * @brief Discovery and data airtime report
+ */
+struct DiscoveryStats {
+    uint32_t rounds{0};                 ///< Discovery rounds run
+    uint32_t windows{0};                ///< Scan windows run
+    uint32_t deferred{0};               ///< Windows postponed for data traffic
+    uint32_t currentInterval{0};        ///< Current round interval (ms)
+    uint64_t discoveryAirtime{0};       ///< Time spent scanning (ms)
+    uint64_t dataAirtime{0};            ///< Estimated time spent on data frames (ms)
+    uint32_t dataFrames{0};             ///< Data frames counted
+};
+
+/**
+ * @brief Adaptive discovery scheduler
+ *
+ * Discovery runs in rounds of a few short scan windows separated by gaps in
+ * which data traffic has the radio. A window waits for a short lull in data
+ * frames, up to a maximum deferral. After a round without churn the round
+ * interval doubles up to the maximum; churn or an explicit trigger resets
+ * it to the minimum.
+ *
+ * update() and getStats() must be called from one thread (loop()).
+ * recordDataFrame(), notifyChurn() and trigger() may be called from any
+ * thread, including radio callbacks. They only touch 32-bit atomics, which
+ * are lock-free on the ESP32; update() folds the wrapping data airtime
+ * counter into a 64-bit total, so it must run at least once per 71 min of
+ * counted airtime.
+ */
+class DiscoveryScheduler {
+public:
+    /**
+     * @brief Constructor
+     * @param schedule Scheduling parameters
+     */
+    explicit DiscoveryScheduler(const DiscoverySchedule& schedule = DiscoverySchedule());
+
+    /**
+     * @brief Decide whether to start a scan window
+     * @param now Current time (ms)
+     * @param discoveryRunning True if a scan window is still running
+     * @param window Output scan window length (ms)
+     * @return True if a scan window should be started now
+     */
+    bool update(uint32_t now, bool discoveryRunning, uint32_t& window);
+
+    /**
+     * @brief Report a change in the node set
+     */
+    void notifyChurn();
+
+    /**
+     * @brief Request a discovery round as soon as possible
+     */
+    void trigger();
+
+    /**
+     * @brief Count a data frame towards airtime
+     * @param protocol Protocol the frame was sent or received on
+     * @param length Payload length (bytes)
+     * @param now Current time (ms)
+     */
+    void recordDataFrame(NodeProtocol protocol, size_t length, uint32_t now);
+
+    /**
+     * @brief Get discovery and airtime statistics
+     * @return Statistics
+     */
+    DiscoveryStats getStats() const;
+
+private:
+    /**
+     * @brief Finish the current round and schedule the next
+     * @param now Current time (ms)
+     */
+    void finishRound(uint32_t now);
+
+    /**
+     * @brief Add data airtime counted since the last call to the 64-bit total
+     */
+    void foldDataAirtime();
+
+private:
+    DiscoverySchedule schedule_;                ///< Scheduling parameters
+    uint32_t interval_;                         ///< Current round interval (ms)
+    bool started_{false};                       ///< update() has run
+    bool inRound_{false};                       ///< A round is in progress
+    bool windowOpen_{false};                    ///< A scan window is running
+    bool deferring_{false};                     ///< The next window is waiting for data to go quiet
+    uint8_t windowsLeft_{0};                    ///< Scan windows left in the round
+    uint32_t nextRoundAt_{0};                   ///< Start of the next round (ms)
+    uint32_t nextWindowAt_{0};                  ///< Earliest start of the next window (ms)
+    uint32_t windowStartedAt_{0};               ///< Start of the running window (ms)
+
+    std::atomic<bool> churn_{false};            ///< Node set changed since the last round
+    std::atomic<bool> triggered_{false};        ///< Round requested
+    std::atomic<uint32_t> lastDataAt_{0};       ///< Time of the last data frame (ms)
+    std::atomic<uint32_t> dataAirtimeUs_{0};    ///< Estimated data airtime (us), wraps after 71 min
+    uint32_t dataAirtimeFoldedUs_{0};           ///< dataAirtimeUs_ when last folded into the total
+    uint64_t dataAirtimeTotalUs_{0};            ///< Data airtime folded in by update() (us)
+    std::atomic<uint32_t> dataFrames_{0};       ///< Data frames counted
+    DiscoveryStats stats_;                      ///< Discovery statistics
+};
+
+} // namespace communication
+} // namespace sensors
@@ -0,0 +1,46 @@
+/**
+ * @file node_info.hpp
+ * @brief Wireless node description and status
+ *
+ * This file defines the NodeInfo structure and NodeStatus enumeration shared
+ * by the wireless node manager and the node table.
+ */
+
+#pragma once
+
+#include "../../core/sensor_types.hpp"
+#include <cstdint>
+#include <string>
+
+namespace sensors {
+namespace communication {
+
+/**
+ * @brief Node status enumeration
+ */
+enum class NodeStatus {
+    UNKNOWN,        ///< Unknown status
+    CONNECTING,     ///< Node is connecting
+    CONNECTED,      ///< Node is connected
+    DISCONNECTED,   ///< Node is disconnected
+    ERROR           ///< Node is in error state
+};
+
+/**
+ * @brief Wireless node information
+ */
+struct NodeInfo {
+    std::string nodeId;                        ///< Node ID
+    std::string name;                          ///< Node name
+    std::string type;                          ///< Node type
+    std::string protocol;                      ///< Communication protocol
+    std::string macAddress;                    ///< MAC address
+    NodeStatus status{NodeStatus::UNKNOWN};    ///< Node status
+    json capabilities;                         ///< Node capabilities
+    json configuration;                        ///< Node configuration
+    int64_t lastSeen{0};                       ///< Last seen timestamp
+    int rssi{0};                               ///< Signal strength
+};
+
+} // namespace communication
+} // namespace sensors
@@ -0,0 +1,217 @@
+#include "node_liveness.hpp"
+
+namespace sensors {
+namespace communication {
+
+namespace {
+
+// True if time a is after time b, tolerating millis() wrap-around
+bool isAfter(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+} // namespace
+
+NodeLivenessTracker::NodeLivenessTracker(std::shared_ptr<NodeTable> nodeTable,
+                                         uint32_t tickInterval,
+                                         uint32_t defaultInterval,
+                                         uint8_t missedHeartbeats) :
+    nodeTable_(nodeTable),
+    tickInterval_(tickInterval > 0 ? tickInterval : 1),
+    defaultInterval_(defaultInterval),
+    missedHeartbeats_(missedHeartbeats > 0 ? missedHeartbeats : 1) {
+    heads_.fill(-1);
+    occupancy_.fill(0);
+}
+
+void NodeLivenessTracker::setHeartbeatInterval(const std::string& type, uint32_t interval) {
+    std::lock_guard<std::mutex> lock(wheelMutex_);
+    intervals_[type] = interval;
+}
+
+void NodeLivenessTracker::setCallback(LivenessCallback callback) {
+    std::lock_guard<std::mutex> lock(wheelMutex_);
+    callback_ = callback;
+}
+
+bool NodeLivenessTracker::track(int handle, const std::string& type, uint32_t now) {
+    if (!nodeTable_->touch(handle, now)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(wheelMutex_);
+
+    // A record reused by another node takes over its timer
+    auto interval = intervals_.find(type);
+    size_t index = NodeTable::indexOf(handle);
+    Timer& timer = timers_[index];
+    timer.handle = handle;
+    timer.timeout = (interval != intervals_.end() ? interval->second : defaultInterval_) * missedHeartbeats_;
+    timer.expired = false;
+    arm(index, now + timer.timeout);
+    return true;
+}
+
+void NodeLivenessTracker::untrack(int handle) {
+    if (handle < 0 || NodeTable::indexOf(handle) >= NodeTable::MAX_NODES) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(wheelMutex_);
+    size_t index = NodeTable::indexOf(handle);
+    if (timers_[index].handle == handle) {
+        disarm(index);
+    }
+}
+
+void NodeLivenessTracker::advance(uint32_t now) {
+    std::vector<int> expired;
+    std::vector<int> revived;
+    LivenessCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(wheelMutex_);
+
+        uint32_t targetTick = now / tickInterval_;
+        if (!started_) {
+            started_ = true;
+            currentTick_ = targetTick;
+        }
+
+        // After a long stall every slot is visited once; timers check their own due time
+        size_t ticks = 0;
+        while (!isAfter(currentTick_, targetTick) && ticks < SLOT_COUNT) {
+            processSlot(currentTick_ % SLOT_COUNT, now, expired, revived);
+            currentTick_++;
+            ticks++;
+        }
+        if (isAfter(targetTick, currentTick_ - 1)) {
+            currentTick_ = targetTick + 1;
+        }
+
+        callback = callback_;
+    }
+
+    if (callback && !expired.empty()) callback(expired, NodeStatus::DISCONNECTED);
+    if (callback && !revived.empty()) callback(revived, NodeStatus::CONNECTED);
+}
+
+LivenessStats NodeLivenessTracker::getStats() const {
+    std::lock_guard<std::mutex> lock(wheelMutex_);
+
+    LivenessStats stats = stats_;
+    stats.tracked = 0;
+    stats.maxSlotOccupancy = 0;
+    stats.usedSlots = 0;
+    for (size_t i = 0; i < SLOT_COUNT; i++) {
+        stats.tracked += occupancy_[i];
+        if (occupancy_[i] > stats.maxSlotOccupancy) stats.maxSlotOccupancy = occupancy_[i];
+        if (occupancy_[i] > 0) stats.usedSlots++;
+    }
+    if (stats.expired > 0) {
+        stats.averageJitter = static_cast<uint32_t>(jitterSum_ / stats.expired);
+    }
+    return stats;
+}
+
+// Private methods
+void NodeLivenessTracker::arm(size_t index, uint32_t due) {
+    disarm(index);
+
+    Timer& timer = timers_[index];
+    timer.due = due;
+    // Round up so a timer is never checked before it is due
+    timer.slot = static_cast<uint8_t>(((due + tickInterval_ - 1) / tickInterval_) % SLOT_COUNT);
+    timer.prev = -1;
+    timer.next = heads_[timer.slot];
+    if (timer.next >= 0) {
+        timers_[timer.next].prev = static_cast<int16_t>(index);
+    }
+    heads_[timer.slot] = static_cast<int16_t>(index);
+    occupancy_[timer.slot]++;
+    timer.armed = true;
+}
+
+void NodeLivenessTracker::disarm(size_t index) {
+    Timer& timer = timers_[index];
+    if (!timer.armed) {
+        return;
+    }
+
+    if (timer.prev >= 0) {
+        timers_[timer.prev].next = timer.next;
+    } else {
+        heads_[timer.slot] = timer.next;
+    }
+    if (timer.next >= 0) {
+        timers_[timer.next].prev = timer.prev;
+    }
+    occupancy_[timer.slot]--;
+    timer.armed = false;
+    timer.next = -1;
+    timer.prev = -1;
+}
+
+void NodeLivenessTracker::processSlot(size_t slot, uint32_t now,
+                                      std::vector<int>& expired,
+                                      std::vector<int>& revived) {
+    // Detach the chain first; timers re-armed into this slot wait for its next turn
+    int16_t index = heads_[slot];
+    heads_[slot] = -1;
+    occupancy_[slot] = 0;
+
+    while (index >= 0) {
+        Timer& timer = timers_[index];
+        int16_t next = timer.next;
+        timer.armed = false;
+        timer.next = -1;
+        timer.prev = -1;
+
+        int handle = timer.handle;
+        NodeHotInfo node;
+        if (!nodeTable_->getHotInfo(handle, node)) {
+            index = next;  // Node was removed; drop its timer
+            continue;
+        }
+
+        // Not due yet: the due time lies a full wheel rotation or more ahead
+        if (isAfter(timer.due, now)) {
+            arm(index, timer.due);
+            index = next;
+            continue;
+        }
+
+        uint32_t silentUntil = node.lastSeen + timer.timeout;
+        if (timer.expired) {
+            if (isAfter(node.lastSeen, timer.expiredAt)) {
+                timer.expired = false;
+                nodeTable_->setStatus(handle, NodeStatus::CONNECTED);
+                revived.push_back(handle);
+                stats_.revived++;
+                arm(index, silentUntil);
+            } else {
+                arm(index, now + timer.timeout / missedHeartbeats_);
+            }
+        } else if (isAfter(silentUntil, now)) {
+            // Seen since the timer was armed; move it instead of expiring
+            stats_.rearmed++;
+            arm(index, silentUntil);
+        } else {
+            uint32_t jitter = now - silentUntil;
+            jitterSum_ += jitter;
+            if (jitter > stats_.maxJitter) stats_.maxJitter = jitter;
+
+            timer.expired = true;
+            timer.expiredAt = now;
+            nodeTable_->setStatus(handle, NodeStatus::DISCONNECTED);
+            expired.push_back(handle);
+            stats_.expired++;
+            // Look for the node again after one heartbeat interval
+            arm(index, now + timer.timeout / missedHeartbeats_);
+        }
+
+        index = next;
+    }
+}
+
+} // namespace communication
+} // namespace sensors
@@ -0,0 +1,179 @@
+/**
+ * @file node_liveness.hpp
+ * @brief Timer-wheel liveness tracking for wireless nodes
+ *
+ * This file defines the NodeLivenessTracker class, which marks wireless
+ * nodes disconnected when their heartbeats stop and connected again when
+ * they resume, without scanning every node periodically.
+ */
+
+#pragma once
+
+#include "node_table.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sensors {
+namespace communication {
+
+/**
+ * @brief Type definition for liveness callback
+ *
+ * Called once per batch with the handles of the nodes whose status changed
+ * and the new status (DISCONNECTED or CONNECTED).
+ */
+using LivenessCallback = std::function<void(const std::vector<int>&, NodeStatus)>;
+
+/**
+ * @brief Liveness statistics
+ */
+struct LivenessStats {
+    size_t tracked{0};              ///< Nodes in the wheel
+    uint32_t expired{0};            ///< Nodes marked disconnected
+    uint32_t revived{0};            ///< Disconnected nodes heard from again
+    uint32_t rearmed{0};            ///< Timers moved because the node was seen
+    uint32_t maxJitter{0};          ///< Largest delay between due time and expiry (ms)
+    uint32_t averageJitter{0};      ///< Mean delay between due time and expiry (ms)
+    size_t maxSlotOccupancy{0};     ///< Largest number of timers in one slot
+    size_t usedSlots{0};            ///< Slots holding at least one timer
+};
+
+/**
+ * @brief Hashed timer wheel for node liveness
+ *
+ * Every tracked node has one timer in a wheel of SLOT_COUNT slots of
+ * `tickInterval` ms each. Inbound frames do not touch the wheel: they only
+ * update the node's lastSeen in the NodeTable. When a slot comes due, each
+ * timer in it checks lastSeen and either moves to the slot of its new due
+ * time or expires. Work per tick is proportional to the timers in that
+ * slot, not to the number of nodes.
+ *
+ * A node expires after `missedHeartbeats` heartbeat intervals of silence;
+ * the interval is configured per node type. Expired nodes keep a timer that
+ * fires once per heartbeat interval and report the node connected again
+ * once a frame has arrived.
+ */
+class NodeLivenessTracker {
+public:
+    static const size_t SLOT_COUNT = 64;        ///< Wheel slots
+
+    /**
+     * @brief Constructor
+     * @param nodeTable Node table holding lastSeen and status
+     * @param tickInterval Wheel resolution (ms)
+     * @param defaultInterval Heartbeat interval for types without their own (ms)
+     * @param missedHeartbeats Heartbeats missed before a node expires
+     */
+    NodeLivenessTracker(std::shared_ptr<NodeTable> nodeTable,
+                        uint32_t tickInterval = 250,
+                        uint32_t defaultInterval = 15000,
+                        uint8_t missedHeartbeats = 3);
+
+    /**
+     * @brief Set heartbeat interval for a node type
+     * @param type Node type
+     * @param interval Heartbeat interval (ms)
+     */
+    void setHeartbeatInterval(const std::string& type, uint32_t interval);
+
+    /**
+     * @brief Set liveness callback
+     * @param callback Callback function
+     */
+    void setCallback(LivenessCallback callback);
+
+    //---------- Tracking ----------//
+
+    /**
+     * @brief Start tracking node
+     * @param handle Node handle
+     * @param type Node type
+     * @param now Current time (ms)
+     * @return True if successful, false if the handle is invalid
+     */
+    bool track(int handle, const std::string& type, uint32_t now);
+
+    /**
+     * @brief Stop tracking node
+     * @param handle Node handle
+     */
+    void untrack(int handle);
+
+    /**
+     * @brief Process due slots and report status changes
+     * @param now Current time (ms)
+     */
+    void advance(uint32_t now);
+
+    //---------- Status ----------//
+
+    /**
+     * @brief Get liveness statistics
+     * @return Statistics
+     */
+    LivenessStats getStats() const;
+
+private:
+    /**
+     * @brief Timer of one node, linked into its slot
+     */
+    struct Timer {
+        int handle{-1};             ///< Handle of the tracked node
+        uint32_t due{0};            ///< Time the timer is checked (ms)
+        uint32_t timeout{0};        ///< Silence before expiry (ms)
+        uint32_t expiredAt{0};      ///< Time of expiry (ms), if expired
+        int16_t next{-1};           ///< Record index of the next timer in slot
+        int16_t prev{-1};           ///< Record index of the previous timer in slot
+        uint8_t slot{0};            ///< Slot index
+        bool armed{false};          ///< Linked into the wheel
+        bool expired{false};        ///< Node is reported disconnected
+    };
+
+    /**
+     * @brief Link timer into the slot for its due time (caller holds wheelMutex_)
+     * @param index Record index of the node
+     * @param due Due time (ms)
+     */
+    void arm(size_t index, uint32_t due);
+
+    /**
+     * @brief Unlink timer from its slot (caller holds wheelMutex_)
+     * @param index Record index of the node
+     */
+    void disarm(size_t index);
+
+    /**
+     * @brief Check timers in a slot (caller holds wheelMutex_)
+     * @param slot Slot index
+     * @param now Current time (ms)
+     * @param expired Output handles that expired
+     * @param revived Output handles that came back
+     */
+    void processSlot(size_t slot, uint32_t now, std::vector<int>& expired, std::vector<int>& revived);
+
+private:
+    std::shared_ptr<NodeTable> nodeTable_;                      ///< Node table
+    uint32_t tickInterval_;                                     ///< Wheel resolution (ms)
+    uint32_t defaultInterval_;                                  ///< Default heartbeat interval (ms)
+    uint8_t missedHeartbeats_;                                  ///< Heartbeats missed before expiry
+    std::map<std::string, uint32_t> intervals_;                 ///< Heartbeat interval per node type
+    LivenessCallback callback_;                                 ///< Liveness callback
+
+    std::array<Timer, NodeTable::MAX_NODES> timers_;            ///< Timers by record index
+    std::array<int16_t, SLOT_COUNT> heads_;                     ///< First timer per slot
+    std::array<uint16_t, SLOT_COUNT> occupancy_;                ///< Timers per slot
+    uint32_t currentTick_{0};                                   ///< Next tick to process
+    bool started_{false};                                       ///< advance() has run
+    uint64_t jitterSum_{0};                                     ///< Sum of expiry delays (ms)
+    LivenessStats stats_;                                       ///< Statistics
+    mutable std::mutex wheelMutex_;                             ///< Mutex for thread safety
+};
+
+} // namespace communication
+} // namespace sensors
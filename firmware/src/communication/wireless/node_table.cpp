@@ -0,0 +1,384 @@
+#include "node_table.hpp"
+#include <cstdio>
+
+namespace sensors {
+namespace communication {
+
+namespace {
+
+// 64-bit finalizer (splitmix64), spreads sequential vendor MACs over the index
+uint64_t mixKey(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 27;
+    key *= 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    return key;
+}
+
+// Probe passes before a lookup racing removals gives up and reports a miss
+const int LOOKUP_ATTEMPTS = 4;
+
+} // namespace
+
+NodeTable::NodeTable() {
+    for (auto& slot : index_) {
+        slot.store(INDEX_EMPTY, std::memory_order_relaxed);
+    }
+}
+
+int NodeTable::registerNode(const NodeInfo& nodeInfo) {
+    uint8_t mac[6];
+    NodeProtocol protocol = protocolFromString(nodeInfo.protocol);
+    if (!parseMac(nodeInfo.macAddress, mac) || protocol == NodeProtocol::UNKNOWN) {
+        return INVALID_HANDLE;
+    }
+    uint64_t key = makeKey(mac, protocol);
+
+    std::lock_guard<std::mutex> lock(tableMutex_);
+
+    // A node that moved to another MAC or protocol gets a fresh record
+    auto existing = handlesById_.find(nodeInfo.nodeId);
+    if (existing != handlesById_.end() && recordKey(indexOf(existing->second)) != key) {
+        removeRecord(existing->second);
+    }
+
+    int handle = lookup(key);
+    if (handle == INVALID_HANDLE) {
+        size_t index = MAX_NODES;
+        for (size_t i = 0; i < MAX_NODES; i++) {
+            if (records_[i].keyHigh.load(std::memory_order_relaxed) == 0) {
+                index = i;
+                break;
+            }
+        }
+        if (index == MAX_NODES) {
+            return INVALID_HANDLE;
+        }
+
+        // Fill the record before publishing its key, then make it reachable
+        NodeRecord& record = records_[index];
+        record.status.store(static_cast<uint8_t>(nodeInfo.status), std::memory_order_relaxed);
+        record.rssi.store(static_cast<int8_t>(nodeInfo.rssi), std::memory_order_relaxed);
+        record.lastSeen.store(static_cast<uint32_t>(nodeInfo.lastSeen), std::memory_order_relaxed);
+        record.keyLow.store(static_cast<uint32_t>(key), std::memory_order_relaxed);
+        record.keyHigh.store(static_cast<uint32_t>(key >> 32), std::memory_order_release);
+
+        if (!insertIndex(key, static_cast<uint8_t>(index))) {
+            record.keyHigh.store(0, std::memory_order_relaxed);
+            record.keyLow.store(0, std::memory_order_relaxed);
+            return INVALID_HANDLE;
+        }
+        handle = static_cast<int>((record.generation.load(std::memory_order_relaxed) << HANDLE_INDEX_BITS) | index);
+    } else {
+        // Same MAC re-registered, possibly under a new node ID
+        const std::string& previousId = cold_[indexOf(handle)].nodeId;
+        if (previousId != nodeInfo.nodeId) {
+            handlesById_.erase(previousId);
+        }
+        records_[indexOf(handle)].status.store(static_cast<uint8_t>(nodeInfo.status), std::memory_order_relaxed);
+    }
+
+    NodeColdData& cold = cold_[indexOf(handle)];
+    cold.nodeId = nodeInfo.nodeId;
+    cold.name = nodeInfo.name;
+    cold.type = nodeInfo.type;
+    cold.macAddress = nodeInfo.macAddress;
+    cold.protocol = nodeInfo.protocol;
+    cold.capabilities = nodeInfo.capabilities;
+    cold.configuration = nodeInfo.configuration;
+    handlesById_[nodeInfo.nodeId] = handle;
+
+    return handle;
+}
+
+bool NodeTable::unregisterNode(const std::string& nodeId) {
+    std::lock_guard<std::mutex> lock(tableMutex_);
+
+    auto it = handlesById_.find(nodeId);
+    if (it == handlesById_.end()) {
+        return false;
+    }
+
+    removeRecord(it->second);
+    return true;
+}
+
+int NodeTable::findByMac(const uint8_t* mac, NodeProtocol protocol) const {
+    return lookup(makeKey(mac, protocol));
+}
+
+int NodeTable::touch(const uint8_t* mac, NodeProtocol protocol, uint32_t now, int rssi) {
+    int handle = lookup(makeKey(mac, protocol));
+    if (handle == INVALID_HANDLE) {
+        return INVALID_HANDLE;
+    }
+
+    NodeRecord& record = records_[indexOf(handle)];
+    record.lastSeen.store(now, std::memory_order_relaxed);
+    if (rssi != 0) {
+        record.rssi.store(static_cast<int8_t>(rssi), std::memory_order_relaxed);
+    }
+    return handle;
+}
+
+// A write racing the removal of the node itself may still land in the
+// record; once removal has returned, the old handle no longer matches
+bool NodeTable::touch(int handle, uint32_t now) {
+    if (!isCurrent(handle)) {
+        return false;
+    }
+
+    records_[indexOf(handle)].lastSeen.store(now, std::memory_order_relaxed);
+    return true;
+}
+
+bool NodeTable::setStatus(int handle, NodeStatus status) {
+    if (!isCurrent(handle)) {
+        return false;
+    }
+
+    records_[indexOf(handle)].status.store(static_cast<uint8_t>(status), std::memory_order_relaxed);
+    return true;
+}
+
+bool NodeTable::getHotInfo(int handle, NodeHotInfo& info) const {
+    if (handle < 0) {
+        return false;
+    }
+    size_t index = indexOf(handle);
+    return index < MAX_NODES && readRecord(index, info) && info.handle == handle;
+}
+
+int NodeTable::findByNodeId(const std::string& nodeId) const {
+    std::lock_guard<std::mutex> lock(tableMutex_);
+
+    auto it = handlesById_.find(nodeId);
+    return it != handlesById_.end() ? it->second : INVALID_HANDLE;
+}
+
+std::string NodeTable::getNodeId(int handle) const {
+    std::lock_guard<std::mutex> lock(tableMutex_);
+
+    if (!isCurrent(handle)) {
+        return "";
+    }
+    return cold_[indexOf(handle)].nodeId;
+}
+
+NodeInfo NodeTable::getNodeInfo(int handle) const {
+    NodeInfo nodeInfo;
+    NodeHotInfo hot;
+
+    std::lock_guard<std::mutex> lock(tableMutex_);
+    if (!getHotInfo(handle, hot)) {
+        return nodeInfo;
+    }
+
+    const NodeColdData& cold = cold_[indexOf(handle)];
+    nodeInfo.nodeId = cold.nodeId;
+    nodeInfo.name = cold.name;
+    nodeInfo.type = cold.type;
+    nodeInfo.protocol = cold.protocol;
+    nodeInfo.macAddress = cold.macAddress;
+    nodeInfo.status = hot.status;
+    nodeInfo.capabilities = cold.capabilities;
+    nodeInfo.configuration = cold.configuration;
+    nodeInfo.lastSeen = hot.lastSeen;
+    nodeInfo.rssi = hot.rssi;
+    return nodeInfo;
+}
+
+bool NodeTable::setConfiguration(int handle, const json& configuration) {
+    std::lock_guard<std::mutex> lock(tableMutex_);
+
+    if (!isCurrent(handle)) {
+        return false;
+    }
+    cold_[indexOf(handle)].configuration = configuration;
+    return true;
+}
+
+size_t NodeTable::size() const {
+    std::lock_guard<std::mutex> lock(tableMutex_);
+    return handlesById_.size();
+}
+
+bool NodeTable::parseMac(const std::string& text, uint8_t* mac) {
+    unsigned int bytes[6];
+    char trailing;
+    if (sscanf(text.c_str(), "%2x:%2x:%2x:%2x:%2x:%2x%c",
+               &bytes[0], &bytes[1], &bytes[2], &bytes[3], &bytes[4], &bytes[5], &trailing) != 6) {
+        return false;
+    }
+
+    for (int i = 0; i < 6; i++) {
+        mac[i] = static_cast<uint8_t>(bytes[i]);
+    }
+    return true;
+}
+
+NodeProtocol NodeTable::protocolFromString(const std::string& protocol) {
+    if (protocol == "ble") return NodeProtocol::BLE;
+    if (protocol == "espnow") return NodeProtocol::ESPNOW;
+    if (protocol == "wifi") return NodeProtocol::WIFI;
+    return NodeProtocol::UNKNOWN;
+}
+
+// Private methods
+uint64_t NodeTable::makeKey(const uint8_t* mac, NodeProtocol protocol) {
+    uint64_t key = static_cast<uint64_t>(protocol) << 48;
+    for (int i = 0; i < 6; i++) {
+        key |= static_cast<uint64_t>(mac[i]) << (8 * (5 - i));
+    }
+    return key;
+}
+
+int NodeTable::lookup(uint64_t key) const {
+    for (int attempt = 0; attempt < LOOKUP_ATTEMPTS; attempt++) {
+        uint32_t version = indexVersion_.load(std::memory_order_acquire);
+        size_t slot = mixKey(key) & (INDEX_SIZE - 1);
+
+        for (size_t probe = 0; probe < INDEX_SIZE; probe++) {
+            uint8_t record = index_[slot].load(std::memory_order_acquire);
+            if (record == INDEX_EMPTY) {
+                break;
+            }
+            int handle = matchRecord(record, key);
+            if (handle != INVALID_HANDLE) {
+                return handle;
+            }
+            slot = (slot + 1) & (INDEX_SIZE - 1);
+        }
+
+        // A hit is checked against the record key; a miss only counts if no
+        // removal moved entries while we probed
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((version & 1) == 0 && indexVersion_.load(std::memory_order_relaxed) == version) {
+            return INVALID_HANDLE;
+        }
+    }
+    return INVALID_HANDLE;
+}
+
+int NodeTable::matchRecord(size_t index, uint64_t key) const {
+    // Generation, key words, generation again: a record freed or reused
+    // between the reads changes the generation
+    const NodeRecord& record = records_[index];
+    uint16_t generation = record.generation.load(std::memory_order_acquire);
+    uint32_t high = record.keyHigh.load(std::memory_order_acquire);
+    uint32_t low = record.keyLow.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (high != static_cast<uint32_t>(key >> 32) || low != static_cast<uint32_t>(key) ||
+        record.generation.load(std::memory_order_relaxed) != generation) {
+        return INVALID_HANDLE;
+    }
+    return static_cast<int>((static_cast<size_t>(generation) << HANDLE_INDEX_BITS) | index);
+}
+
+uint64_t NodeTable::recordKey(size_t index) const {
+    const NodeRecord& record = records_[index];
+    return (static_cast<uint64_t>(record.keyHigh.load(std::memory_order_relaxed)) << 32) |
+           record.keyLow.load(std::memory_order_relaxed);
+}
+
+bool NodeTable::isCurrent(int handle) const {
+    if (handle < 0 || indexOf(handle) >= MAX_NODES) {
+        return false;
+    }
+
+    const NodeRecord& record = records_[indexOf(handle)];
+    return record.keyHigh.load(std::memory_order_acquire) != 0 &&
+           record.generation.load(std::memory_order_relaxed) == (static_cast<size_t>(handle) >> HANDLE_INDEX_BITS);
+}
+
+bool NodeTable::readRecord(size_t index, NodeHotInfo& info) const {
+    const NodeRecord& record = records_[index];
+    uint16_t generation = record.generation.load(std::memory_order_acquire);
+    uint32_t high = record.keyHigh.load(std::memory_order_acquire);
+    if (high == 0) {
+        return false;
+    }
+    uint64_t key = (static_cast<uint64_t>(high) << 32) | record.keyLow.load(std::memory_order_relaxed);
+    info.status = static_cast<NodeStatus>(record.status.load(std::memory_order_relaxed));
+    info.rssi = record.rssi.load(std::memory_order_relaxed);
+    info.lastSeen = record.lastSeen.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (record.generation.load(std::memory_order_relaxed) != generation) {
+        return false;
+    }
+
+    for (int i = 0; i < 6; i++) {
+        info.mac[i] = static_cast<uint8_t>(key >> (8 * (5 - i)));
+    }
+    info.protocol = static_cast<NodeProtocol>(key >> 48);
+    info.handle = static_cast<int>((static_cast<size_t>(generation) << HANDLE_INDEX_BITS) | index);
+    return true;
+}
+
+bool NodeTable::insertIndex(uint64_t key, uint8_t record) {
+    size_t slot = mixKey(key) & (INDEX_SIZE - 1);
+
+    for (size_t probe = 0; probe < INDEX_SIZE; probe++) {
+        if (index_[slot].load(std::memory_order_relaxed) == INDEX_EMPTY) {
+            index_[slot].store(record, std::memory_order_release);
+            return true;
+        }
+        slot = (slot + 1) & (INDEX_SIZE - 1);
+    }
+    return false;
+}
+
+void NodeTable::eraseIndex(uint64_t key) {
+    int handle = lookup(key);
+    if (handle == INVALID_HANDLE) {
+        return;
+    }
+    uint8_t record = static_cast<uint8_t>(indexOf(handle));
+    size_t hole = mixKey(key) & (INDEX_SIZE - 1);
+    while (index_[hole].load(std::memory_order_relaxed) != record) {
+        hole = (hole + 1) & (INDEX_SIZE - 1);
+    }
+
+    indexVersion_.store(indexVersion_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole so no tombstone is left behind
+    size_t slot = (hole + 1) & (INDEX_SIZE - 1);
+    while (slot != hole) {
+        uint8_t current = index_[slot].load(std::memory_order_relaxed);
+        if (current == INDEX_EMPTY) {
+            break;
+        }
+        size_t home = mixKey(recordKey(current)) & (INDEX_SIZE - 1);
+        if (((slot - home) & (INDEX_SIZE - 1)) >= ((slot - hole) & (INDEX_SIZE - 1))) {
+            index_[hole].store(current, std::memory_order_release);
+            hole = slot;
+        }
+        slot = (slot + 1) & (INDEX_SIZE - 1);
+    }
+    index_[hole].store(INDEX_EMPTY, std::memory_order_release);
+
+    indexVersion_.store(indexVersion_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void NodeTable::removeRecord(int handle) {
+    size_t index = indexOf(handle);
+    NodeRecord& record = records_[index];
+    eraseIndex(recordKey(index));
+
+    // New generation first, so readers that see the cleared key also see it
+    uint16_t generation = record.generation.load(std::memory_order_relaxed);
+    record.generation.store((generation + 1) & GENERATION_MASK, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.keyHigh.store(0, std::memory_order_relaxed);
+    record.keyLow.store(0, std::memory_order_relaxed);
+
+    handlesById_.erase(cold_[index].nodeId);
+    cold_[index] = NodeColdData();
+}
+
+} // namespace communication
+} // namespace sensors
@@ -0,0 +1,319 @@
+/**
+ * @file node_table.hpp
+ * @brief Compact wireless node table indexed by MAC address
+ *
+ * This file defines the NodeTable class, which keeps the per-frame fields of
+ * wireless nodes in a flat array behind an open-addressing MAC index, with
+ * the JSON capabilities and configuration stored out of line.
+ */
+
+#pragma once
+
+#include "node_info.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace sensors {
+namespace communication {
+
+/**
+ * @brief Node protocol enumeration
+ */
+enum class NodeProtocol : uint8_t {
+    UNKNOWN = 0,    ///< Unknown protocol
+    BLE = 1,        ///< Bluetooth Low Energy
+    ESPNOW = 2,     ///< ESP-NOW
+    WIFI = 3        ///< WiFi
+};
+
+/**
+ * @brief Copy of the hot fields of a node
+ */
+struct NodeHotInfo {
+    uint8_t mac[6]{0};                          ///< MAC address
+    NodeProtocol protocol{NodeProtocol::UNKNOWN}; ///< Protocol
+    NodeStatus status{NodeStatus::UNKNOWN};     ///< Status
+    int8_t rssi{0};                             ///< Last signal strength
+    uint32_t lastSeen{0};                       ///< Time of the last frame (ms)
+    int handle{-1};                             ///< Node handle
+};
+
+/**
+ * @brief Node table for wireless nodes
+ *
+ * Each node occupies one fixed-size record in a flat array. A handle is the
+ * record index plus the record's generation, which is bumped whenever the
+ * record is freed, so a handle kept past its node's removal is rejected
+ * instead of reaching the node that reuses the record. An open-addressing
+ * index maps (MAC, protocol) to the record, so radio callbacks resolve and
+ * update a node without locking or allocating. Node ID, name and JSON data
+ * are only needed off the radio path and are kept separately under a mutex.
+ *
+ * Registration and removal are serialized by the mutex; they publish records
+ * with release stores so lock-free readers never see a half-written node.
+ * Record fields are at most 32 bits wide, since the ESP32 has no lock-free
+ * 64-bit atomics; the key is split into two words that readers check
+ * against the generation, as in a sequence lock. Removal shifts later index
+ * entries back instead of leaving tombstones, so probes for unknown MACs
+ * stay short after churn; a lookup that misses while a removal is shifting
+ * entries probes again (a bounded number of times).
+ */
+class NodeTable {
+public:
+    static const size_t MAX_NODES = 64;             ///< Maximum registered nodes
+    static const int INVALID_HANDLE = -1;           ///< Handle returned when a node is unknown
+
+    /**
+     * @brief Default constructor
+     */
+    NodeTable();
+
+    //---------- Registration ----------//
+
+    /**
+     * @brief Register node or update its registration
+     * @param nodeInfo Node information; macAddress as "AA:BB:CC:DD:EE:FF"
+     * @return Node handle, or INVALID_HANDLE if the MAC is invalid or the table is full
+     */
+    int registerNode(const NodeInfo& nodeInfo);
+
+    /**
+     * @brief Unregister node
+     * @param nodeId Node ID
+     * @return True if successful, false if not registered
+     */
+    bool unregisterNode(const std::string& nodeId);
+
+    //---------- Radio Path (lock-free) ----------//
+
+    /**
+     * @brief Find node by MAC address
+     * @param mac MAC address (6 bytes)
+     * @param protocol Protocol the frame arrived on
+     * @return Node handle, or INVALID_HANDLE if unknown
+     */
+    int findByMac(const uint8_t* mac, NodeProtocol protocol) const;
+
+    /**
+     * @brief Record a frame from a node
+     * @param mac MAC address (6 bytes)
+     * @param protocol Protocol the frame arrived on
+     * @param now Current time (ms)
+     * @param rssi Signal strength, 0 if not available
+     * @return Node handle, or INVALID_HANDLE if unknown
+     */
+    int touch(const uint8_t* mac, NodeProtocol protocol, uint32_t now, int rssi = 0);
+
+    /**
+     * @brief Record a frame from a node resolved by handle
+     * @param handle Node handle
+     * @param now Current time (ms)
+     * @return True if successful, false if the handle is invalid
+     */
+    bool touch(int handle, uint32_t now);
+
+    /**
+     * @brief Update node status
+     * @param handle Node handle
+     * @param status Node status
+     * @return True if successful, false if the handle is invalid
+     */
+    bool setStatus(int handle, NodeStatus status);
+
+    /**
+     * @brief Get hot fields of node
+     * @param handle Node handle
+     * @param info Output hot fields
+     * @return True if successful, false if the handle is invalid
+     */
+    bool getHotInfo(int handle, NodeHotInfo& info) const;
+
+    /**
+     * @brief Visit the hot fields of every registered node without copying the table
+     * @param visitor Function called for each node
+     */
+    template<typename Visitor>
+    void forEachNode(Visitor visitor) const {
+        NodeHotInfo info;
+        for (size_t i = 0; i < MAX_NODES; i++) {
+            if (readRecord(i, info)) {
+                visitor(info);
+            }
+        }
+    }
+
+    /**
+     * @brief Get record index of a handle
+     * @param handle Node handle
+     * @return Record index, below MAX_NODES for any valid handle
+     */
+    static size_t indexOf(int handle) {
+        return static_cast<size_t>(handle) & HANDLE_INDEX_MASK;
+    }
+
+    //---------- Cold Data ----------//
+
+    /**
+     * @brief Find node by ID
+     * @param nodeId Node ID
+     * @return Node handle, or INVALID_HANDLE if unknown
+     */
+    int findByNodeId(const std::string& nodeId) const;
+
+    /**
+     * @brief Get node ID
+     * @param handle Node handle
+     * @return Node ID, or empty if the handle is invalid
+     */
+    std::string getNodeId(int handle) const;
+
+    /**
+     * @brief Get full node information
+     * @param handle Node handle
+     * @return Node information, or empty if the handle is invalid
+     */
+    NodeInfo getNodeInfo(int handle) const;
+
+    /**
+     * @brief Replace node configuration
+     * @param handle Node handle
+     * @param configuration Configuration data
+     * @return True if successful, false if the handle is invalid
+     */
+    bool setConfiguration(int handle, const json& configuration);
+
+    /**
+     * @brief Get number of registered nodes
+     * @return Node count
+     */
+    size_t size() const;
+
+    //---------- Utilities ----------//
+
+    /**
+     * @brief Parse MAC address string
+     * @param text MAC address as "AA:BB:CC:DD:EE:FF"
+     * @param mac Output MAC address (6 bytes)
+     * @return True if successful, false otherwise
+     */
+    static bool parseMac(const std::string& text, uint8_t* mac);
+
+    /**
+     * @brief Convert protocol name to protocol
+     * @param protocol Protocol name ("ble", "espnow", "wifi")
+     * @return Protocol
+     */
+    static NodeProtocol protocolFromString(const std::string& protocol);
+
+private:
+    /**
+     * @brief Hot fields, one cache-friendly record per node
+     */
+    struct NodeRecord {
+        std::atomic<uint32_t> keyHigh{0};       ///< Protocol and first two MAC bytes, 0 if free
+        std::atomic<uint32_t> keyLow{0};        ///< Last four MAC bytes
+        std::atomic<uint16_t> generation{0};    ///< Bumped when the record is freed
+        std::atomic<uint8_t> status{0};         ///< NodeStatus
+        std::atomic<int8_t> rssi{0};            ///< Last signal strength
+        std::atomic<uint32_t> lastSeen{0};      ///< Time of the last frame (ms)
+    };
+
+    /**
+     * @brief Cold fields, only touched off the radio path
+     */
+    struct NodeColdData {
+        std::string nodeId;                     ///< Node ID
+        std::string name;                       ///< Node name
+        std::string type;                       ///< Node type
+        std::string macAddress;                 ///< MAC address string
+        std::string protocol;                   ///< Protocol name
+        json capabilities;                      ///< Node capabilities
+        json configuration;                     ///< Node configuration
+    };
+
+    /**
+     * @brief Pack MAC and protocol into an index key
+     * @param mac MAC address (6 bytes)
+     * @param protocol Protocol
+     * @return Key, never 0 for a known protocol
+     */
+    static uint64_t makeKey(const uint8_t* mac, NodeProtocol protocol);
+
+    /**
+     * @brief Find node for key
+     * @param key Index key
+     * @return Node handle, or INVALID_HANDLE if absent
+     */
+    int lookup(uint64_t key) const;
+
+    /**
+     * @brief Get handle of record if it holds key
+     * @param index Record index
+     * @param key Index key
+     * @return Node handle, or INVALID_HANDLE if the record holds another key
+     */
+    int matchRecord(size_t index, uint64_t key) const;
+
+    /**
+     * @brief Get key of record (caller holds tableMutex_)
+     * @param index Record index
+     * @return Index key, 0 if the record is free
+     */
+    uint64_t recordKey(size_t index) const;
+
+    /**
+     * @brief Check that handle refers to a registered node
+     * @param handle Node handle
+     * @return True if the handle's record is in use and of the same generation
+     */
+    bool isCurrent(int handle) const;
+
+    /**
+     * @brief Read hot fields of record
+     * @param index Record index
+     * @param info Output hot fields, with the current handle of the record
+     * @return True if the record is in use and was read consistently
+     */
+    bool readRecord(size_t index, NodeHotInfo& info) const;
+
+    /**
+     * @brief Insert record into the index (caller holds tableMutex_)
+     * @param key Index key
+     * @param record Record index
+     * @return True if successful, false if the index is full
+     */
+    bool insertIndex(uint64_t key, uint8_t record);
+
+    /**
+     * @brief Remove record from the index by backward shift (caller holds tableMutex_)
+     * @param key Index key
+     */
+    void eraseIndex(uint64_t key);
+
+    /**
+     * @brief Remove node (caller holds tableMutex_)
+     * @param handle Node handle
+     */
+    void removeRecord(int handle);
+
+private:
+    static const size_t INDEX_SIZE = 128;       ///< Index slots, power of two and twice MAX_NODES
+    static const uint8_t INDEX_EMPTY = 0xFF;    ///< Free index slot
+    static const int HANDLE_INDEX_BITS = 8;     ///< Handle bits holding the record index
+    static const size_t HANDLE_INDEX_MASK = (1u << HANDLE_INDEX_BITS) - 1;  ///< Record index of a handle
+    static const uint16_t GENERATION_MASK = 0x7FFF;  ///< Generation bits, keeping handles positive
+
+    std::array<NodeRecord, MAX_NODES> records_;             ///< Hot records by handle
+    std::array<std::atomic<uint8_t>, INDEX_SIZE> index_;    ///< Open-addressing MAC index
+    std::atomic<uint32_t> indexVersion_{0};                 ///< Odd while a removal shifts index entries
+    std::array<NodeColdData, MAX_NODES> cold_;              ///< Cold data by handle
+    std::map<std::string, int> handlesById_;                ///< Node ID to handle
+    mutable std::mutex tableMutex_;                         ///< Mutex for writers and cold data
+};
+
+} // namespace communication
+} // namespace sensors
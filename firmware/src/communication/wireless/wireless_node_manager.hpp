@@ -10,6 +10,7 @@
 #pragma once
 
 #include "../../core/sensor_types.hpp"
+#include "node_info.hpp"
 #include "wireless_sensor.hpp"
 #include <memory>
 #include <map>
@@ -21,33 +22,6 @@
 namespace sensors {
 namespace communication {
 
-/**
- * @brief Node status enumeration
- */
-enum class NodeStatus {
-    UNKNOWN,        ///< Unknown status
-    CONNECTING,     ///< Node is connecting
-    CONNECTED,      ///< Node is connected
-    DISCONNECTED,   ///< Node is disconnected
-    ERROR           ///< Node is in error state
-};
-
-/**
- * @brief Wireless node information
- */
-struct NodeInfo {
-    std::string nodeId;                        ///< Node ID
-    std::string name;                          ///< Node name
-    std::string type;                          ///< Node type
-    std::string protocol;                      ///< Communication protocol
-    std::string macAddress;                    ///< MAC address
-    NodeStatus status{NodeStatus::UNKNOWN};    ///< Node status
-    json capabilities;                         ///< Node capabilities
-    json configuration;                        ///< Node configuration
-    int64_t lastSeen{0};                       ///< Last seen timestamp
-    int rssi{0};                               ///< Signal strength
-};
-
 /**
  * @brief Type definition for node status callback
  */
@@ -0,0 +1,270 @@
+#include "boot_sequencer.hpp"
+
+#ifdef ESP_PLATFORM
+#include <esp_pthread.h>
+#endif
+
+namespace sensors {
+
+BootSequencer::BootSequencer(BootTimeSource timeSource, size_t workerCount, size_t stackSize) :
+    timeSource_(std::move(timeSource)),
+    workerCount_(workerCount > 0 ? workerCount : 1),
+    stackSize_(stackSize) {
+}
+
+BootSequencer::~BootSequencer() {
+    join();
+}
+
+bool BootSequencer::addStage(const std::string& name, const std::vector<std::string>& dependencies, BootStageFunction function) {
+    std::lock_guard<std::mutex> lock(bootMutex_);
+
+    if (started_ || !function || findStage(name) != stages_.size()) {
+        return false;
+    }
+
+    Stage stage;
+    stage.info.name = name;
+    stage.info.dependencies = dependencies;
+    stage.function = std::move(function);
+    stages_.push_back(std::move(stage));
+    return true;
+}
+
+void BootSequencer::setStageCallback(BootStageCallback callback) {
+    std::lock_guard<std::mutex> lock(bootMutex_);
+    stageCallback_ = std::move(callback);
+}
+
+bool BootSequencer::start() {
+    std::lock_guard<std::mutex> lock(bootMutex_);
+
+    if (started_) {
+        return false;
+    }
+
+    // Resolve dependency names
+    for (auto& stage : stages_) {
+        stage.dependencies.clear();
+        for (const auto& dependency : stage.info.dependencies) {
+            size_t index = findStage(dependency);
+            if (index == stages_.size()) {
+                return false;
+            }
+            stage.dependencies.push_back(index);
+        }
+    }
+
+    // Reject cycles (Kahn's algorithm)
+    std::vector<size_t> unresolved(stages_.size());
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < stages_.size(); i++) {
+        unresolved[i] = stages_[i].dependencies.size();
+        if (unresolved[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+    size_t ordered = 0;
+    while (!ready.empty()) {
+        size_t current = ready.back();
+        ready.pop_back();
+        ordered++;
+        for (size_t i = 0; i < stages_.size(); i++) {
+            for (size_t dependency : stages_[i].dependencies) {
+                if (dependency == current && --unresolved[i] == 0) {
+                    ready.push_back(i);
+                }
+            }
+        }
+    }
+    if (ordered != stages_.size()) {
+        return false;
+    }
+
+    started_ = true;
+    remaining_ = stages_.size();
+    bootStart_ = timeSource_();
+
+#ifdef ESP_PLATFORM
+    // std::thread takes its stack size from the creating task's pthread config
+    esp_pthread_cfg_t previous = esp_pthread_get_default_config();
+    bool restore = esp_pthread_get_cfg(&previous) == ESP_OK;
+    esp_pthread_cfg_t config = esp_pthread_get_default_config();
+    config.stack_size = stackSize_;
+    config.thread_name = "boot";
+    esp_pthread_set_cfg(&config);
+#endif
+
+    for (size_t i = 0; i < workerCount_; i++) {
+        workers_.push_back(std::make_unique<std::thread>(&BootSequencer::workerThread, this));
+    }
+
+#ifdef ESP_PLATFORM
+    if (!restore) {
+        previous = esp_pthread_get_default_config();
+    }
+    esp_pthread_set_cfg(&previous);
+#endif
+    return true;
+}
+
+bool BootSequencer::waitFor(const std::string& name) {
+    std::unique_lock<std::mutex> lock(bootMutex_);
+
+    size_t index = findStage(name);
+    if (!started_ || index == stages_.size()) {
+        return false;
+    }
+
+    stageChanged_.wait(lock, [this, index]() {
+        return isFinal(stages_[index].info.state);
+    });
+    return stages_[index].info.state == BootStageState::DONE;
+}
+
+bool BootSequencer::isDone(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(bootMutex_);
+
+    size_t index = findStage(name);
+    return index != stages_.size() && stages_[index].info.state == BootStageState::DONE;
+}
+
+bool BootSequencer::isFinished() const {
+    std::lock_guard<std::mutex> lock(bootMutex_);
+    return started_ && remaining_ == 0;
+}
+
+void BootSequencer::join() {
+    for (auto& worker : workers_) {
+        if (worker && worker->joinable()) {
+            worker->join();
+        }
+    }
+    workers_.clear();
+}
+
+std::vector<BootStageInfo> BootSequencer::getStages() const {
+    std::lock_guard<std::mutex> lock(bootMutex_);
+
+    std::vector<BootStageInfo> stages;
+    for (const auto& stage : stages_) {
+        stages.push_back(stage.info);
+    }
+    return stages;
+}
+
+// Private methods
+void BootSequencer::workerThread() {
+    std::unique_lock<std::mutex> lock(bootMutex_);
+
+    std::vector<BootStageInfo> skipped;
+
+    while (remaining_ > 0) {
+        skipped.clear();
+        size_t index = findRunnableStage(skipped);
+
+        // Report skipped stages first; the graph may change while unlocked
+        if (!skipped.empty()) {
+            BootStageCallback callback = stageCallback_;
+            if (callback) {
+                lock.unlock();
+                for (const auto& info : skipped) {
+                    callback(info);
+                }
+                lock.lock();
+                continue;
+            }
+        }
+
+        if (index == stages_.size()) {
+            // Nothing runnable: either all remaining stages wait on running ones
+            // or skipping just finished the graph
+            if (remaining_ == 0) break;
+            stageChanged_.wait(lock);
+            continue;
+        }
+
+        Stage& stage = stages_[index];
+        stage.info.state = BootStageState::RUNNING;
+        uint32_t start = timeSource_();
+        stage.info.startTime = start - bootStart_;
+
+        lock.unlock();
+        bool success = stage.function();
+        uint32_t end = timeSource_();
+        lock.lock();
+
+        stage.info.duration = end - start;
+        stage.info.state = success ? BootStageState::DONE : BootStageState::FAILED;
+        remaining_--;
+
+        BootStageInfo info = stage.info;
+        BootStageCallback callback = stageCallback_;
+        stageChanged_.notify_all();
+
+        if (callback) {
+            lock.unlock();
+            callback(info);
+            lock.lock();
+        }
+    }
+
+    stageChanged_.notify_all();
+}
+
+size_t BootSequencer::findRunnableStage(std::vector<BootStageInfo>& skipped) {
+    bool changed = true;
+
+    // Skipping a stage can make its dependents skippable, so repeat until stable
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < stages_.size(); i++) {
+            Stage& stage = stages_[i];
+            if (stage.info.state != BootStageState::PENDING) {
+                continue;
+            }
+
+            bool ready = true;
+            bool blocked = false;
+            for (size_t dependency : stage.dependencies) {
+                BootStageState state = stages_[dependency].info.state;
+                if (state == BootStageState::FAILED || state == BootStageState::SKIPPED) {
+                    blocked = true;
+                } else if (state != BootStageState::DONE) {
+                    ready = false;
+                }
+            }
+
+            if (blocked) {
+                stage.info.state = BootStageState::SKIPPED;
+                stage.info.startTime = timeSource_() - bootStart_;
+                stage.info.duration = 0;
+                skipped.push_back(stage.info);
+                remaining_--;
+                changed = true;
+                stageChanged_.notify_all();
+            } else if (ready) {
+                return i;
+            }
+        }
+    }
+
+    return stages_.size();
+}
+
+size_t BootSequencer::findStage(const std::string& name) const {
+    for (size_t i = 0; i < stages_.size(); i++) {
+        if (stages_[i].info.name == name) {
+            return i;
+        }
+    }
+    return stages_.size();
+}
+
+bool BootSequencer::isFinal(BootStageState state) {
+    return state == BootStageState::DONE ||
+           state == BootStageState::FAILED ||
+           state == BootStageState::SKIPPED;
+}
+
+} // namespace sensors
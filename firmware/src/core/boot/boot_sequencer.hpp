@@ -0,0 +1,196 @@
+/**
+ * @file boot_sequencer.hpp
+ * @brief Dependency-driven, concurrent boot stage runner
+ *
+ * This file defines the BootSequencer class, which runs the system
+ * initialization stages as a dependency graph, executing independent
+ * stages concurrently and recording per-stage timing.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sensors {
+
+/**
+ * @brief Boot stage state enumeration
+ */
+enum class BootStageState {
+    PENDING,    ///< Waiting for dependencies
+    RUNNING,    ///< Currently executing
+    DONE,       ///< Completed successfully
+    FAILED,     ///< Stage function returned false
+    SKIPPED     ///< Not run because a dependency did not complete
+};
+
+/**
+ * @brief Boot stage information and timing
+ */
+struct BootStageInfo {
+    std::string name;                               ///< Stage name
+    std::vector<std::string> dependencies;          ///< Stages that must complete first
+    BootStageState state{BootStageState::PENDING};  ///< Current state
+    uint32_t startTime{0};                          ///< Start time relative to boot start (ms)
+    uint32_t duration{0};                           ///< Execution time (ms)
+};
+
+/**
+ * @brief Type definition for boot stage function
+ */
+using BootStageFunction = std::function<bool()>;
+
+/**
+ * @brief Type definition for boot stage completion callback
+ */
+using BootStageCallback = std::function<void(const BootStageInfo&)>;
+
+/**
+ * @brief Type definition for millisecond time source
+ */
+using BootTimeSource = std::function<uint32_t()>;
+
+/**
+ * @brief Runs boot stages as a dependency graph
+ *
+ * Stages are registered with the names of the stages they depend on.
+ * After start(), a small pool of worker threads executes every stage whose
+ * dependencies have completed, so independent stages (e.g. WiFi join and
+ * configuration loading) overlap. A stage whose dependency failed or was
+ * skipped is itself skipped. Callers block on the stages they need with
+ * waitFor() and poll the rest with isDone().
+ *
+ * Stages parse JSON and bring up the radios, which overflows the pthread
+ * default stack (about 3 KB on ESP-IDF), so on the device start() creates
+ * the workers with the stack size given to the constructor.
+ */
+class BootSequencer {
+public:
+    /**
+     * @brief Constructor
+     * @param timeSource Millisecond time source
+     * @param workerCount Number of worker threads
+     * @param stackSize Worker stack size in bytes (ESP-IDF only)
+     */
+    explicit BootSequencer(BootTimeSource timeSource, size_t workerCount = 2, size_t stackSize = 8192);
+
+    /**
+     * @brief Destructor, waits for running stages
+     */
+    ~BootSequencer();
+
+    //---------- Stage Registration ----------//
+
+    /**
+     * @brief Register boot stage
+     * @param name Stage name
+     * @param dependencies Names of stages that must complete first
+     * @param function Stage function, returns true on success
+     * @return True if successful, false if name is taken or already started
+     */
+    bool addStage(const std::string& name, const std::vector<std::string>& dependencies, BootStageFunction function);
+
+    /**
+     * @brief Set stage completion callback
+     * @param callback Callback invoked from a worker after each stage finishes
+     *                 or is skipped
+     */
+    void setStageCallback(BootStageCallback callback);
+
+    //---------- Execution ----------//
+
+    /**
+     * @brief Validate the stage graph and start the workers
+     * @return True if started, false on unknown dependency or cycle
+     */
+    bool start();
+
+    /**
+     * @brief Block until stage has finished
+     * @param name Stage name
+     * @return True if the stage completed successfully, false otherwise
+     */
+    bool waitFor(const std::string& name);
+
+    /**
+     * @brief Check if stage completed successfully
+     * @param name Stage name
+     * @return True if the stage is done, false otherwise
+     */
+    bool isDone(const std::string& name) const;
+
+    /**
+     * @brief Check if every stage has finished
+     * @return True if no stage is pending or running, false otherwise
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Wait for all stages and stop the workers
+     */
+    void join();
+
+    /**
+     * @brief Get stage information and timing
+     * @return Vector of stage information in registration order
+     */
+    std::vector<BootStageInfo> getStages() const;
+
+private:
+    /**
+     * @brief Registered stage
+     */
+    struct Stage {
+        BootStageInfo info;                 ///< Stage information
+        BootStageFunction function;         ///< Stage function
+        std::vector<size_t> dependencies;   ///< Indices of dependencies
+    };
+
+    /**
+     * @brief Worker thread function
+     */
+    void workerThread();
+
+    /**
+     * @brief Find next runnable stage (caller holds bootMutex_)
+     * @param skipped Stages skipped on the way, appended
+     * @return Stage index or stages_.size() if none
+     */
+    size_t findRunnableStage(std::vector<BootStageInfo>& skipped);
+
+    /**
+     * @brief Find stage index by name (caller holds bootMutex_)
+     * @param name Stage name
+     * @return Stage index or stages_.size() if not found
+     */
+    size_t findStage(const std::string& name) const;
+
+    /**
+     * @brief Check if stage has reached a final state
+     * @param state Stage state
+     * @return True if final, false otherwise
+     */
+    static bool isFinal(BootStageState state);
+
+private:
+    BootTimeSource timeSource_;                             ///< Millisecond time source
+    size_t workerCount_;                                    ///< Number of worker threads
+    size_t stackSize_;                                      ///< Worker stack size in bytes
+    uint32_t bootStart_{0};                                 ///< Time when start() was called
+    std::vector<Stage> stages_;                             ///< Registered stages
+    BootStageCallback stageCallback_;                       ///< Stage completion callback
+    size_t remaining_{0};                                   ///< Stages not yet final
+    bool started_{false};                                   ///< Start state flag
+    std::vector<std::unique_ptr<std::thread>> workers_;     ///< Worker threads
+    mutable std::mutex bootMutex_;                          ///< Mutex for thread safety
+    std::condition_variable stageChanged_;                  ///< Signalled when a stage changes state
+};
+
+} // namespace sensors
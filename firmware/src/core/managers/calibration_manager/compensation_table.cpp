@@ -0,0 +1,208 @@
+#include "compensation_table.hpp"
+#include <cmath>
+#include <limits>
+
+namespace sensors {
+
+namespace {
+
+const char* TABLE_METHOD = "table2d";
+
+// Evenly spaced axis: min, max and number of points
+bool parseAxis(const json& data, const char* name, float& min, float& max, uint16_t& points, std::string& error) {
+    if (!data.contains(name) || !data[name].is_object()) {
+        error = std::string("Missing ") + name + " axis";
+        return false;
+    }
+
+    const json& axis = data[name];
+    if (!axis.contains("min") || !axis["min"].is_number() ||
+        !axis.contains("max") || !axis["max"].is_number() ||
+        !axis.contains("points") || !axis["points"].is_number_integer()) {
+        error = std::string("Invalid ") + name + " axis";
+        return false;
+    }
+
+    min = axis["min"].get<float>();
+    max = axis["max"].get<float>();
+    int64_t count = axis["points"].get<int64_t>();
+    if (!(max > min) || count < 2 || count > static_cast<int64_t>(CompensationTable::MAX_AXIS_POINTS)) {
+        error = std::string("Invalid ") + name + " axis range or point count";
+        return false;
+    }
+
+    points = static_cast<uint16_t>(count);
+    return true;
+}
+
+} // namespace
+
+bool CompensationTable::fromJson(const json& data, CompensationTable& table, std::string& error) {
+    if (!TemperatureCompensator::isTableData(data)) {
+        error = "Not a table2d calibration";
+        return false;
+    }
+
+    CompensationTable result;
+    if (!data.contains("companion") || !data["companion"].is_string()) {
+        error = "Missing companion sensor";
+        return false;
+    }
+    result.companion_ = data["companion"].get<std::string>();
+
+    if (!parseAxis(data, "raw", result.rawMin_, result.rawMax_, result.rawPoints_, error) ||
+        !parseAxis(data, "temperature", result.temperatureMin_, result.temperatureMax_,
+                   result.temperaturePoints_, error)) {
+        return false;
+    }
+    result.rawScale_ = static_cast<float>(result.rawPoints_ - 1) / (result.rawMax_ - result.rawMin_);
+    result.temperatureScale_ = static_cast<float>(result.temperaturePoints_ - 1) /
+                               (result.temperatureMax_ - result.temperatureMin_);
+
+    // Values in units, checked against the axes
+    const json& rows = data.contains("values") ? data["values"] : json();
+    if (!rows.is_array() || rows.size() != result.temperaturePoints_) {
+        error = "Table needs one row of values per temperature point";
+        return false;
+    }
+
+    std::vector<double> values;
+    values.reserve(static_cast<size_t>(result.rawPoints_) * result.temperaturePoints_);
+    for (const auto& row : rows) {
+        if (!row.is_array() || row.size() != result.rawPoints_) {
+            error = "Table rows need one value per raw point";
+            return false;
+        }
+        for (const auto& value : row) {
+            if (!value.is_number()) {
+                error = "Table values must be numbers";
+                return false;
+            }
+            values.push_back(value.get<double>());
+        }
+    }
+
+    // Fixed point around the middle of the value range
+    auto range = std::minmax_element(values.begin(), values.end());
+    double low = *range.first;
+    double high = *range.second;
+    double offset = (low + high) / 2.0;
+    double resolution = (high - low) / (2.0 * std::numeric_limits<int16_t>::max());
+    if (data.contains("resolution")) {
+        if (!data["resolution"].is_number() || !(data["resolution"].get<double>() > 0.0)) {
+            error = "Invalid resolution";
+            return false;
+        }
+        resolution = data["resolution"].get<double>();
+    } else if (resolution == 0.0) {
+        resolution = 1.0;
+    }
+
+    result.grid_.reserve(values.size());
+    for (double value : values) {
+        double step = std::round((value - offset) / resolution);
+        if (step < std::numeric_limits<int16_t>::min() || step > std::numeric_limits<int16_t>::max()) {
+            error = "Table values exceed the int16 range at this resolution";
+            return false;
+        }
+        result.grid_.push_back(static_cast<int16_t>(step));
+    }
+    result.offset_ = static_cast<float>(offset);
+    result.resolution_ = static_cast<float>(resolution);
+
+    table = std::move(result);
+    return true;
+}
+
+json CompensationTable::toJson() const {
+    json data;
+    data["method"] = TABLE_METHOD;
+    data["companion"] = companion_;
+    data["raw"] = {{"min", rawMin_}, {"max", rawMax_}, {"points", rawPoints_}};
+    data["temperature"] = {{"min", temperatureMin_}, {"max", temperatureMax_}, {"points", temperaturePoints_}};
+    data["resolution"] = resolution_;
+
+    json rows = json::array();
+    for (size_t j = 0; j < temperaturePoints_; j++) {
+        json row = json::array();
+        for (size_t i = 0; i < rawPoints_; i++) {
+            row.push_back(offset_ + resolution_ * grid_[j * rawPoints_ + i]);
+        }
+        rows.push_back(std::move(row));
+    }
+    data["values"] = std::move(rows);
+    return data;
+}
+
+const std::string& CompensationTable::getCompanion() const {
+    return companion_;
+}
+
+size_t CompensationTable::getGridBytes() const {
+    return grid_.size() * sizeof(int16_t);
+}
+
+void TemperatureCompensator::setCompanionSource(CompanionSource source) {
+    std::lock_guard<std::mutex> lock(compensatorMutex_);
+    companionSource_ = std::move(source);
+}
+
+bool TemperatureCompensator::setTable(const std::string& sensorId, const json& calibrationData) {
+    CompensationTable table;
+    std::string error;
+    bool valid = CompensationTable::fromJson(calibrationData, table, error);
+
+    std::lock_guard<std::mutex> lock(compensatorMutex_);
+    if (!valid) {
+        lastError_ = sensorId + ": " + error;
+        return false;
+    }
+    if (table.getCompanion() == sensorId) {
+        lastError_ = sensorId + ": sensor cannot be its own companion";
+        return false;
+    }
+
+    tables_[sensorId] = std::make_shared<const CompensationTable>(std::move(table));
+    return true;
+}
+
+bool TemperatureCompensator::removeTable(const std::string& sensorId) {
+    std::lock_guard<std::mutex> lock(compensatorMutex_);
+    return tables_.erase(sensorId) > 0;
+}
+
+bool TemperatureCompensator::hasTable(const std::string& sensorId) const {
+    std::lock_guard<std::mutex> lock(compensatorMutex_);
+    return tables_.count(sensorId) > 0;
+}
+
+bool TemperatureCompensator::isTableData(const json& calibrationData) {
+    return calibrationData.is_object() && calibrationData.contains("method") &&
+           calibrationData["method"] == TABLE_METHOD;
+}
+
+bool TemperatureCompensator::apply(SensorReading& reading) const {
+    std::shared_ptr<const CompensationTable> table;
+    CompanionSource companionSource;
+    {
+        std::lock_guard<std::mutex> lock(compensatorMutex_);
+        auto it = tables_.find(reading.sensorId);
+        if (it == tables_.end() || !companionSource_) return false;
+        table = it->second;
+        companionSource = companionSource_;
+    }
+
+    // The companion may be read from hardware; the lock is not held for it
+    double temperature;
+    if (!companionSource(table->getCompanion(), temperature)) return false;
+
+    reading.value = table->evaluate(static_cast<float>(reading.rawValue), static_cast<float>(temperature));
+    return true;
+}
+
+std::string TemperatureCompensator::getLastError() const {
+    std::lock_guard<std::mutex> lock(compensatorMutex_);
+    return lastError_;
+}
+
+} // namespace sensors
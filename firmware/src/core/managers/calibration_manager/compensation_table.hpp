@@ -0,0 +1,188 @@
+/**
+ * @file compensation_table.hpp
+ * @brief Temperature-compensated calibration tables
+ *
+ * This file defines the CompensationTable class, a two-dimensional
+ * calibration grid over raw value and temperature, and the
+ * TemperatureCompensator, which applies the tables to readings using the
+ * temperature measured by a companion sensor. Gas and humidity sensors
+ * whose response drifts with temperature are calibrated this way instead
+ * of by compensation code written for one sensor.
+ */
+
+#pragma once
+
+#include "../../sensor_types.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sensors {
+
+/**
+ * @brief Calibration grid over raw value and temperature
+ *
+ * Both axes are evenly spaced, so a lookup finds its cell with one
+ * multiply per axis and interpolates bilinearly between four int16
+ * fixed-point entries: a few dozen instructions and no search. Inputs
+ * outside the grid are clamped to its edges.
+ *
+ * Calibration data (method "table2d"):
+ * @code
+ * {
+ *   "method": "table2d",
+ *   "companion": "ambient_temp",                   // Sensor measuring the temperature
+ *   "raw": {"min": 0, "max": 1000, "points": 11},
+ *   "temperature": {"min": -10, "max": 50, "points": 7},
+ *   "values": [[...], ...],                        // One row of raw points per temperature point
+ *   "resolution": 0.01                             // Optional fixed-point step
+ * }
+ * @endcode
+ */
+class CompensationTable {
+public:
+    static constexpr size_t MAX_AXIS_POINTS = 64;   ///< Largest grid side
+
+    /**
+     * @brief Calibrated value
+     * @param raw Raw sensor value
+     * @param temperature Companion temperature
+     * @return Interpolated value
+     */
+    float evaluate(float raw, float temperature) const {
+        float x = std::min(std::max((raw - rawMin_) * rawScale_, 0.0f), static_cast<float>(rawPoints_ - 1));
+        float y = std::min(std::max((temperature - temperatureMin_) * temperatureScale_, 0.0f),
+                           static_cast<float>(temperaturePoints_ - 1));
+        size_t i = std::min(static_cast<size_t>(x), static_cast<size_t>(rawPoints_ - 2));
+        size_t j = std::min(static_cast<size_t>(y), static_cast<size_t>(temperaturePoints_ - 2));
+        float fx = x - static_cast<float>(i);
+        float fy = y - static_cast<float>(j);
+
+        const int16_t* cell = &grid_[j * rawPoints_ + i];
+        float low = cell[0] + fx * static_cast<float>(cell[1] - cell[0]);
+        float high = cell[rawPoints_] + fx * static_cast<float>(cell[rawPoints_ + 1] - cell[rawPoints_]);
+        return offset_ + resolution_ * (low + fy * (high - low));
+    }
+
+    /**
+     * @brief Load table from calibration data
+     * @param data Calibration data in the "table2d" format
+     * @param table Table to fill
+     * @param error Reason on failure
+     * @return True if the data holds a valid table, false otherwise
+     */
+    static bool fromJson(const json& data, CompensationTable& table, std::string& error);
+
+    /**
+     * @brief Convert to calibration data
+     * @return Calibration data in the "table2d" format, values after quantization
+     */
+    json toJson() const;
+
+    /**
+     * @brief Get companion sensor ID
+     * @return Sensor measuring the temperature
+     */
+    const std::string& getCompanion() const;
+
+    /**
+     * @brief Get grid memory
+     * @return Bytes of fixed-point entries
+     */
+    size_t getGridBytes() const;
+
+private:
+    std::string companion_;                 ///< Sensor measuring the temperature
+    std::vector<int16_t> grid_;             ///< Entries, one row of raw points per temperature point
+    uint16_t rawPoints_{0};                 ///< Raw axis points
+    uint16_t temperaturePoints_{0};         ///< Temperature axis points
+    float rawMin_{0.0f};                    ///< First raw point
+    float rawScale_{0.0f};                  ///< Raw axis points per unit
+    float temperatureMin_{0.0f};            ///< First temperature point
+    float temperatureScale_{0.0f};          ///< Temperature axis points per degree
+    float rawMax_{0.0f};                    ///< Last raw point
+    float temperatureMax_{0.0f};            ///< Last temperature point
+    float offset_{0.0f};                    ///< Value of a zero entry
+    float resolution_{1.0f};                ///< Value of one entry step
+};
+
+/**
+ * @brief Function returning the current value of a sensor
+ *
+ * Returns false if the sensor has no usable value.
+ */
+using CompanionSource = std::function<bool(const std::string& sensorId, double& value)>;
+
+/**
+ * @brief Applies compensation tables to readings
+ *
+ * Holds one table per compensated sensor. A reading of such a sensor is
+ * recalibrated from its raw value and the companion sensor's temperature,
+ * which is taken from the companion source. Tables are immutable once set
+ * and shared, so apply() only holds the lock to pick the table up and calls
+ * the companion source, which may read hardware, without it.
+ */
+class TemperatureCompensator {
+public:
+    /**
+     * @brief Set where companion temperatures come from
+     * @param source Companion source
+     */
+    void setCompanionSource(CompanionSource source);
+
+    /**
+     * @brief Set table of a sensor
+     * @param sensorId Compensated sensor ID
+     * @param calibrationData Calibration data in the "table2d" format
+     * @return True if the table is valid, false otherwise
+     */
+    bool setTable(const std::string& sensorId, const json& calibrationData);
+
+    /**
+     * @brief Remove table of a sensor
+     * @param sensorId Compensated sensor ID
+     * @return True if a table was removed, false otherwise
+     */
+    bool removeTable(const std::string& sensorId);
+
+    /**
+     * @brief Check if sensor has a table
+     * @param sensorId Sensor ID
+     * @return True if compensated, false otherwise
+     */
+    bool hasTable(const std::string& sensorId) const;
+
+    /**
+     * @brief Check if calibration data is a compensation table
+     * @param calibrationData Calibration data
+     * @return True if its method is "table2d", false otherwise
+     */
+    static bool isTableData(const json& calibrationData);
+
+    /**
+     * @brief Recalibrate a reading
+     * @param reading Reading of a compensated sensor, value replaced
+     * @return True if compensated, false if the sensor has no table or
+     *         its companion has no value (the reading is left unchanged)
+     */
+    bool apply(SensorReading& reading) const;
+
+    /**
+     * @brief Get last error message
+     * @return Error message
+     */
+    std::string getLastError() const;
+
+private:
+    std::map<std::string, std::shared_ptr<const CompensationTable>> tables_;   ///< Map of sensor ID to table
+    CompanionSource companionSource_;                                           ///< Companion temperatures
+    std::string lastError_;                                                     ///< Last error message
+    mutable std::mutex compensatorMutex_;                                       ///< Mutex for thread safety
+};
+
+} // namespace sensors
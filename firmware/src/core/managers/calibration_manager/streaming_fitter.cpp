@@ -0,0 +1,236 @@
+#include "streaming_fitter.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sensors {
+
+namespace {
+
+// Diagonal entries this small relative to the largest are treated as zero
+const double RANK_TOLERANCE = 1e-12;
+
+const json& protocolRoot(const json& protocol) {
+    return protocol.is_object() && protocol.contains("protocol") ? protocol["protocol"] : protocol;
+}
+
+} // namespace
+
+json CalibrationPolynomial::toJson() const {
+    json data;
+    data["method"] = degree == 1 ? "linear" : "polynomial";
+    data["degree"] = degree;
+    data["origin"] = origin;
+    data["coefficients"] = json::array();
+    for (size_t i = 0; i <= degree; i++) {
+        data["coefficients"].push_back(coefficients[i]);
+    }
+
+    if (degree == 1) {
+        data["scale"] = coefficients[1];
+        data["offset"] = coefficients[0] - coefficients[1] * origin;
+    }
+    return data;
+}
+
+bool CalibrationPolynomial::fromJson(const json& data, CalibrationPolynomial& polynomial) {
+    if (!data.is_object() || !data.contains("coefficients")) return false;
+
+    const json& coefficients = data["coefficients"];
+    if (!coefficients.is_array() || coefficients.empty() || coefficients.size() > MAX_DEGREE + 1u) {
+        return false;
+    }
+
+    CalibrationPolynomial result;
+    result.degree = static_cast<uint8_t>(coefficients.size() - 1);
+    for (size_t i = 0; i < coefficients.size(); i++) {
+        if (!coefficients[i].is_number()) return false;
+        result.coefficients[i] = coefficients[i].get<double>();
+    }
+
+    if (data.contains("origin")) {
+        if (!data["origin"].is_number()) return false;
+        result.origin = data["origin"].get<double>();
+    }
+
+    polynomial = result;
+    return true;
+}
+
+json CalibrationFit::toJson() const {
+    json data = polynomial.toJson();
+    data["fit"] = {
+        {"count", count},
+        {"residualSumSquares", residualSumSquares},
+        {"rmse", rmse},
+        {"standardError", standardError},
+        {"rSquared", rSquared}
+    };
+    return data;
+}
+
+StreamingFitter::StreamingFitter(uint8_t maxDegree)
+    : terms_(static_cast<uint8_t>(std::min<uint8_t>(maxDegree, CalibrationPolynomial::MAX_DEGREE) + 1)) {
+}
+
+uint8_t StreamingFitter::maxDegreeFor(const json& protocol) {
+    const json& root = protocolRoot(protocol);
+    if (!root.is_object() || !root.contains("calibration")) return 1;
+
+    const json& calibration = root["calibration"];
+    if (!calibration.is_object() || !calibration.contains("polynomialParams")) return 1;
+
+    const json& params = calibration["polynomialParams"];
+    if (!params.is_object() || !params.contains("maxDegree") || !params["maxDegree"].is_number_unsigned()) {
+        return 1;
+    }
+    return static_cast<uint8_t>(std::min<unsigned>(params["maxDegree"].get<unsigned>(),
+                                                   CalibrationPolynomial::MAX_DEGREE));
+}
+
+void StreamingFitter::add(double raw, double reference) {
+    if (count_ == 0) {
+        origin_ = raw;
+    }
+
+    std::array<double, MAX_TERMS> row;
+    double t = raw - origin_;
+    double power = 1.0;
+    for (size_t i = 0; i < terms_; i++) {
+        row[i] = power;
+        power *= t;
+    }
+
+    double residual = rotateIn(row, reference);
+    residual_ += residual * residual;
+
+    // Welford update of the reference variance, for R^2
+    count_++;
+    double delta = reference - referenceMean_;
+    referenceMean_ += delta / static_cast<double>(count_);
+    referenceM2_ += delta * (reference - referenceMean_);
+}
+
+bool StreamingFitter::merge(const StreamingFitter& other) {
+    if (other.terms_ != terms_) return false;
+    if (other.count_ == 0) return true;
+    if (count_ == 0) {
+        *this = other;
+        return true;
+    }
+
+    // Rows of the other factor are in powers of u = raw - other.origin_;
+    // rewrite them in powers of t = raw - origin_ with the binomial
+    // expansion of t^j = (u - d)^j, d = origin_ - other.origin_
+    double d = origin_ - other.origin_;
+    std::array<std::array<double, MAX_TERMS>, MAX_TERMS> binomial{};
+    for (size_t k = 0; k < terms_; k++) {
+        binomial[k][0] = 1.0;
+        for (size_t j = 1; j <= k; j++) {
+            binomial[k][j] = binomial[k - 1][j - 1] + (j < k ? binomial[k - 1][j] : 0.0);
+        }
+    }
+
+    for (size_t i = 0; i < terms_; i++) {
+        std::array<double, MAX_TERMS> row{};
+        for (size_t j = i; j < terms_; j++) {
+            double power = 1.0;
+            for (size_t k = j + 1; k-- > i;) {
+                row[j] += binomial[j][k] * power * other.r_[i * MAX_TERMS + k];
+                power *= -d;
+            }
+        }
+
+        double residual = rotateIn(row, other.qty_[i]);
+        residual_ += residual * residual;
+    }
+    residual_ += other.residual_;
+
+    // Combine the reference variances (Chan et al.)
+    double total = static_cast<double>(count_ + other.count_);
+    double delta = other.referenceMean_ - referenceMean_;
+    referenceM2_ += other.referenceM2_ + delta * delta * static_cast<double>(count_) *
+                    static_cast<double>(other.count_) / total;
+    referenceMean_ += delta * static_cast<double>(other.count_) / total;
+    count_ += other.count_;
+    return true;
+}
+
+void StreamingFitter::reset() {
+    *this = StreamingFitter(static_cast<uint8_t>(terms_ - 1));
+}
+
+bool StreamingFitter::fit(uint8_t degree, CalibrationFit& fit) const {
+    size_t terms = static_cast<size_t>(degree) + 1;
+    if (terms > terms_ || count_ < terms) return false;
+
+    double largest = 0.0;
+    for (size_t i = 0; i < terms; i++) {
+        largest = std::max(largest, std::fabs(r_[i * MAX_TERMS + i]));
+    }
+
+    // Back substitution on the leading block of the factor
+    CalibrationFit result;
+    result.polynomial.degree = degree;
+    result.polynomial.origin = origin_;
+    for (size_t i = terms; i-- > 0;) {
+        double diagonal = r_[i * MAX_TERMS + i];
+        if (std::fabs(diagonal) <= largest * RANK_TOLERANCE || diagonal == 0.0) return false;
+
+        double sum = qty_[i];
+        for (size_t j = i + 1; j < terms; j++) {
+            sum -= r_[i * MAX_TERMS + j] * result.polynomial.coefficients[j];
+        }
+        result.polynomial.coefficients[i] = sum / diagonal;
+    }
+
+    // Terms above this degree only add to the residual
+    double residual = residual_;
+    for (size_t i = terms; i < terms_; i++) {
+        residual += qty_[i] * qty_[i];
+    }
+
+    result.count = count_;
+    result.residualSumSquares = residual;
+    result.rmse = std::sqrt(residual / static_cast<double>(count_));
+    result.standardError = count_ > terms ? std::sqrt(residual / static_cast<double>(count_ - terms)) : 0.0;
+    result.rSquared = referenceM2_ > 0.0 ? 1.0 - residual / referenceM2_ : 1.0;
+
+    fit = result;
+    return true;
+}
+
+uint64_t StreamingFitter::getCount() const {
+    return count_;
+}
+
+uint8_t StreamingFitter::getMaxDegree() const {
+    return static_cast<uint8_t>(terms_ - 1);
+}
+
+// Private methods
+double StreamingFitter::rotateIn(std::array<double, MAX_TERMS>& row, double target) {
+    for (size_t k = 0; k < terms_; k++) {
+        double value = row[k];
+        if (value == 0.0) continue;
+
+        double& diagonal = r_[k * MAX_TERMS + k];
+        double radius = std::sqrt(diagonal * diagonal + value * value);
+        double c = diagonal / radius;
+        double s = value / radius;
+        diagonal = radius;
+
+        for (size_t j = k + 1; j < terms_; j++) {
+            double& factor = r_[k * MAX_TERMS + j];
+            double rotated = c * factor + s * row[j];
+            row[j] = c * row[j] - s * factor;
+            factor = rotated;
+        }
+
+        double rotated = c * qty_[k] + s * target;
+        target = c * target - s * qty_[k];
+        qty_[k] = rotated;
+    }
+    return target;
+}
+
+} // namespace sensors
@@ -0,0 +1,181 @@
+/**
+ * @file streaming_fitter.hpp
+ * @brief Streaming least-squares fitting of calibration polynomials
+ *
+ * This file defines the StreamingFitter class, which fits linear and
+ * polynomial calibrations to (raw, reference) pairs one pair at a time in
+ * constant memory, and the CalibrationPolynomial it produces. Hours of
+ * field reference data can be fitted on the device as they arrive, and
+ * multi-million-point logs on the host, without holding the readings.
+ */
+
+#pragma once
+
+#include "../../sensor_types.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace sensors {
+
+/**
+ * @brief Compiled polynomial calibration
+ *
+ * value = c0 + c1*t + c2*t^2 + ..., with t = raw - origin. Keeping the
+ * origin instead of expanding the coefficients around zero preserves the
+ * precision of the fit when the raw values sit far from zero.
+ */
+struct CalibrationPolynomial {
+    static constexpr uint8_t MAX_DEGREE = 5;                    ///< Highest supported degree
+
+    uint8_t degree{0};                                          ///< Polynomial degree
+    double origin{0.0};                                         ///< Raw value the polynomial is centred on
+    std::array<double, MAX_DEGREE + 1> coefficients{};          ///< c0..c[degree]
+
+    /**
+     * @brief Apply the calibration
+     * @param raw Raw value
+     * @return Calibrated value
+     */
+    double evaluate(double raw) const {
+        double t = raw - origin;
+        double value = coefficients[degree];
+        for (int i = degree - 1; i >= 0; i--) {
+            value = value * t + coefficients[i];
+        }
+        return value;
+    }
+
+    /**
+     * @brief Convert to calibration data
+     *
+     * Linear fits also carry "offset" and "scale" (value = raw * scale +
+     * offset), the form the sensors' calibrate() accepts.
+     *
+     * @return Calibration data with "method", "degree", "origin" and "coefficients"
+     */
+    json toJson() const;
+
+    /**
+     * @brief Load from calibration data written by toJson()
+     * @param data Calibration data
+     * @param polynomial Polynomial to fill
+     * @return True if the data holds a valid polynomial, false otherwise
+     */
+    static bool fromJson(const json& data, CalibrationPolynomial& polynomial);
+};
+
+/**
+ * @brief Result of a fit
+ */
+struct CalibrationFit {
+    CalibrationPolynomial polynomial;   ///< Fitted calibration
+    uint64_t count{0};                  ///< Pairs fitted
+    double residualSumSquares{0.0};     ///< Sum of squared residuals
+    double rmse{0.0};                   ///< Root mean squared residual
+    double standardError{0.0};          ///< Residual standard error, with degree + 1 fitted parameters
+    double rSquared{0.0};               ///< Share of the reference variance explained
+
+    /**
+     * @brief Convert to calibration data, with the residual statistics under "fit"
+     * @return Calibration data
+     */
+    json toJson() const;
+};
+
+/**
+ * @brief Constant-memory least-squares fitter
+ *
+ * Every pair is folded into an upper-triangular QR factor of the
+ * Vandermonde matrix with Givens rotations, O(degree^2) work and memory
+ * and no heap. The factor of a lower degree is the leading block of the
+ * factor of a higher one, so a fitter set up for maxDegree fits every
+ * degree up to it from the same pass, each with its own residuals. Unlike
+ * the normal equations, the QR factor does not square the condition number
+ * of the problem, and the raw values are centred on the first one seen.
+ *
+ * Fitters that saw disjoint parts of a dataset can be merged, so a host
+ * can split a large log between threads. A fitter is not thread-safe.
+ */
+class StreamingFitter {
+public:
+    /**
+     * @brief Constructor
+     * @param maxDegree Highest degree to fit, at most CalibrationPolynomial::MAX_DEGREE
+     */
+    explicit StreamingFitter(uint8_t maxDegree = 1);
+
+    /**
+     * @brief Get fit degree limit of a protocol
+     * @param protocol Protocol definition, with or without its top-level "protocol" key
+     * @return calibration.polynomialParams.maxDegree, or 1 if not given
+     */
+    static uint8_t maxDegreeFor(const json& protocol);
+
+    //---------- Accumulation ----------//
+
+    /**
+     * @brief Add a pair
+     * @param raw Raw sensor value
+     * @param reference Reference value for the same instant
+     */
+    void add(double raw, double reference);
+
+    /**
+     * @brief Add the pairs another fitter saw
+     * @param other Fitter with the same maximum degree
+     * @return True if merged, false if the degrees differ
+     */
+    bool merge(const StreamingFitter& other);
+
+    /**
+     * @brief Discard every pair
+     */
+    void reset();
+
+    //---------- Results ----------//
+
+    /**
+     * @brief Fit a polynomial
+     * @param degree Degree, at most the fitter's maximum
+     * @param fit Result to fill
+     * @return True if fitted, false if the degree is too high or the raw
+     *         values do not determine it (fewer distinct values than coefficients)
+     */
+    bool fit(uint8_t degree, CalibrationFit& fit) const;
+
+    /**
+     * @brief Get number of pairs added
+     * @return Pair count
+     */
+    uint64_t getCount() const;
+
+    /**
+     * @brief Get highest degree the fitter can fit
+     * @return Maximum degree
+     */
+    uint8_t getMaxDegree() const;
+
+private:
+    static constexpr size_t MAX_TERMS = CalibrationPolynomial::MAX_DEGREE + 1;
+
+    /**
+     * @brief Rotate one row into the factor
+     * @param row Vandermonde row, overwritten
+     * @param target Right-hand side of the row
+     * @return Part of the row the factor cannot represent, a residual
+     */
+    double rotateIn(std::array<double, MAX_TERMS>& row, double target);
+
+private:
+    uint8_t terms_;                                     ///< maxDegree + 1
+    std::array<double, MAX_TERMS * MAX_TERMS> r_{};     ///< Upper-triangular factor, row-major
+    std::array<double, MAX_TERMS> qty_{};               ///< Rotated reference values
+    double residual_{0.0};                              ///< Residual sum of squares of the full-degree fit
+    double origin_{0.0};                                ///< First raw value
+    uint64_t count_{0};                                 ///< Pairs added
+    double referenceMean_{0.0};                         ///< Running mean of the reference values
+    double referenceM2_{0.0};                           ///< Running sum of squared deviations from the mean
+};
+
+} // namespace sensors
@@ -0,0 +1,331 @@
+#include "config_store.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <dirent.h>
+#include <unistd.h>
+
+namespace sensors {
+
+namespace {
+
+const char* RECORD_SUFFIX = ".json";
+const char* TEMP_SUFFIX = ".json.tmp";
+
+bool endsWith(const std::string& str, const char* suffix) {
+    size_t len = strlen(suffix);
+    return str.size() >= len && str.compare(str.size() - len, len, suffix) == 0;
+}
+
+bool readFile(const std::string& path, std::string& data) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    data.clear();
+    char buffer[256];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, count);
+    }
+    fclose(file);
+    return true;
+}
+
+bool isCompleteRecord(const std::string& path) {
+    std::string data;
+    return readFile(path, data) && json::accept(data);
+}
+
+json readRecord(const std::string& path) {
+    std::string data;
+    if (!readFile(path, data)) {
+        return json();
+    }
+    json record = json::parse(data, nullptr, false);
+    return record.is_discarded() ? json() : record;
+}
+
+} // namespace
+
+ConfigStore::ConfigStore(const std::string& storagePath, uint32_t debounceMs, uint32_t maxDelayMs) :
+    storagePath_(storagePath),
+    debounceMs_(debounceMs),
+    maxDelayMs_(maxDelayMs) {
+}
+
+bool ConfigStore::init() {
+    DIR* dir = opendir(storagePath_.c_str());
+    if (!dir) {
+        return false;
+    }
+
+    std::vector<std::string> tempFiles;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        if (endsWith(name, TEMP_SUFFIX)) {
+            tempFiles.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    // A temporary record only survives an interrupted write. If the record
+    // it replaces is still present, the old record wins; otherwise the
+    // temporary one is promoted when it holds a complete document.
+    for (const auto& name : tempFiles) {
+        std::string tempPath = storagePath_ + "/" + name;
+        std::string path = tempPath.substr(0, tempPath.size() - strlen(TEMP_SUFFIX)) + RECORD_SUFFIX;
+
+        FILE* existing = fopen(path.c_str(), "rb");
+        if (existing) {
+            fclose(existing);
+            std::remove(tempPath.c_str());
+            continue;
+        }
+
+        if (isCompleteRecord(tempPath)) {
+            std::rename(tempPath.c_str(), path.c_str());
+        } else {
+            std::remove(tempPath.c_str());
+        }
+    }
+
+    return true;
+}
+
+void ConfigStore::markDirty(const SensorConfig& config, uint32_t nowMs) {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+
+    if (pending_.empty()) {
+        firstDirtyMs_ = nowMs;
+    }
+    lastDirtyMs_ = nowMs;
+
+    PendingRecord& pending = pending_[config.id];
+    pending.config = config;
+    pending.removed = false;
+}
+
+void ConfigStore::markRemoved(const std::string& sensorId, uint32_t nowMs) {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+
+    if (pending_.empty()) {
+        firstDirtyMs_ = nowMs;
+    }
+    lastDirtyMs_ = nowMs;
+
+    PendingRecord& pending = pending_[sensorId];
+    pending.config = SensorConfig();
+    pending.removed = true;
+}
+
+bool ConfigStore::hasPending() const {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    return !pending_.empty();
+}
+
+size_t ConfigStore::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    return pending_.size();
+}
+
+bool ConfigStore::flush(uint32_t nowMs) {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+
+    if (pending_.empty()) {
+        return true;
+    }
+
+    // Wait for the burst to settle, but never hold a change indefinitely
+    bool quiet = (nowMs - lastDirtyMs_) >= debounceMs_;
+    bool overdue = (nowMs - firstDirtyMs_) >= maxDelayMs_;
+    if (!quiet && !overdue) {
+        return true;
+    }
+
+    bool success = writePending();
+    firstDirtyMs_ = nowMs;
+    lastDirtyMs_ = nowMs;
+    return success;
+}
+
+bool ConfigStore::flushAll() {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    return writePending();
+}
+
+json ConfigStore::toRecord(const SensorConfig& config, const json& source) {
+    // Start from the stored object so fields SensorConfig does not model survive
+    json sensorConfig = json::object();
+    if (source.is_object() && source.contains("sensorConfig") && source["sensorConfig"].is_object()) {
+        sensorConfig = source["sensorConfig"];
+    }
+
+    sensorConfig["id"] = config.id;
+    sensorConfig["name"] = config.name;
+    sensorConfig["type"] = sensorTypeToString(config.type);
+    sensorConfig["bus"] = sensorBusToString(config.bus);
+    sensorConfig["enabled"] = config.enabled;
+    sensorConfig["busConfig"] = config.busConfig;
+    sensorConfig["sensorConfig"] = config.sensorConfig;
+    sensorConfig["calibrationConfig"] = config.calibrationConfig;
+
+    if (config.wireless.isWireless) {
+        sensorConfig["wireless"]["nodeId"] = config.wireless.nodeId;
+        sensorConfig["wireless"]["communicationType"] = config.wireless.communicationType;
+        sensorConfig["wireless"]["communicationConfig"] = config.wireless.communicationConfig;
+    } else {
+        sensorConfig.erase("wireless");
+    }
+
+    json record;
+    record["sensorConfig"] = sensorConfig;
+    return record;
+}
+
+std::string ConfigStore::getRecordPath(const std::string& sensorId) const {
+    // Sensor IDs are used as file names, keep them inside the directory
+    std::string fileName = sensorId;
+    for (auto& c : fileName) {
+        if (c == '/' || c == '\\') {
+            c = '_';
+        }
+    }
+    return storagePath_ + "/" + fileName + RECORD_SUFFIX;
+}
+
+// Private methods
+void ConfigStore::scanSources() {
+    sourceFiles_.clear();
+    sourcesScanned_ = true;
+
+    DIR* dir = opendir(storagePath_.c_str());
+    if (!dir) {
+        return;
+    }
+
+    std::vector<std::string> names;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        if (endsWith(name, RECORD_SUFFIX)) {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for (const auto& name : names) {
+        std::string path = storagePath_ + "/" + name;
+        json record = readRecord(path);
+        if (!record.is_object() || !record.contains("sensorConfig") || !record["sensorConfig"].is_object()) {
+            continue;
+        }
+        const json& sensorConfig = record["sensorConfig"];
+        if (!sensorConfig.contains("id") || !sensorConfig["id"].is_string()) {
+            continue;
+        }
+
+        // An instance file is preferred over a record named after the
+        // sensor, which only exists for sensors created at runtime
+        std::string sensorId = sensorConfig["id"].get<std::string>();
+        auto& files = sourceFiles_[sensorId];
+        if (path == getRecordPath(sensorId)) {
+            files.push_back(path);
+        } else {
+            files.insert(files.begin(), path);
+        }
+    }
+}
+
+bool ConfigStore::writePending() {
+    bool success = true;
+
+    // Resolved on the first write rather than in init(), which runs on the
+    // boot path where the instance files are otherwise not parsed
+    if (!sourcesScanned_) {
+        scanSources();
+    }
+
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        bool written = it->second.removed ?
+            removeRecord(it->first) :
+            writeRecord(it->second.config);
+
+        if (written) {
+            it = pending_.erase(it);
+        } else {
+            // Keep the change pending so the next flush retries it
+            success = false;
+            ++it;
+        }
+    }
+
+    return success;
+}
+
+bool ConfigStore::writeRecord(const SensorConfig& config) {
+    auto& files = sourceFiles_[config.id];
+    std::string path = files.empty() ? getRecordPath(config.id) : files.front();
+    std::string tempPath = path.substr(0, path.size() - strlen(RECORD_SUFFIX)) + TEMP_SUFFIX;
+    std::string data = toRecord(config, readRecord(path)).dump();
+
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool success = fwrite(data.data(), 1, data.size(), file) == data.size();
+    success = success && fflush(file) == 0;
+    success = success && fsync(fileno(file)) == 0;
+    fclose(file);
+
+    if (!success) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    // SPIFFS rename does not replace an existing file, so the old record is
+    // removed first; a power loss in between leaves the synced temporary
+    // record as the only copy, which init() promotes on the next boot
+    std::remove(path.c_str());
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        return false;
+    }
+
+    // Drop other files carrying the same ID so the next load is unambiguous
+    for (size_t i = 1; i < files.size(); i++) {
+        std::remove(files[i].c_str());
+    }
+    files.assign(1, path);
+    return true;
+}
+
+bool ConfigStore::removeRecord(const std::string& sensorId) {
+    std::vector<std::string> paths = sourceFiles_[sensorId];
+    paths.push_back(getRecordPath(sensorId));
+
+    bool success = true;
+    for (const auto& path : paths) {
+        if (std::remove(path.c_str()) == 0) {
+            continue;
+        }
+
+        // Nothing to delete is not an error
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file) {
+            fclose(file);
+            success = false;
+        }
+    }
+
+    if (success) {
+        sourceFiles_.erase(sensorId);
+    }
+    return success;
+}
+
+} // namespace sensors
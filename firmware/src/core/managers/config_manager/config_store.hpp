@@ -0,0 +1,158 @@
+/**
+ * @file config_store.hpp
+ * @brief Incremental, debounced persistence of sensor configurations
+ *
+ * This file defines the ConfigStore class, which tracks configurations
+ * that changed since the last write and persists only those, one record
+ * file per sensor, after a debounce window has elapsed.
+ */
+
+#pragma once
+
+#include "../../sensor_types.hpp"
+#include <map>
+#include <string>
+#include <mutex>
+#include <vector>
+
+namespace sensors {
+
+/**
+ * @brief Dirty-tracking store for sensor configuration records
+ *
+ * Each sensor is persisted as its own record file using the same layout
+ * as the configuration instance files ({"sensorConfig": {...}}), so the
+ * ConfigManager loads them unchanged. A sensor loaded from an instance
+ * file is written back to that file, keeping the fields SensorConfig does
+ * not carry (protocol, description, tags, ...), so the directory never
+ * holds two files with the same sensor ID. Changes are coalesced: a record is
+ * written once the configuration has been quiet for the debounce window,
+ * or when the oldest pending change reaches the maximum delay.
+ *
+ * Records are written to a temporary file, synced, and then renamed over
+ * the previous record. A power loss therefore leaves either the old or
+ * the new record intact; init() resolves leftover temporary files.
+ */
+class ConfigStore {
+public:
+    /**
+     * @brief Constructor
+     * @param storagePath Filesystem path of the record directory
+     * @param debounceMs Quiet time required before pending records are written
+     * @param maxDelayMs Maximum time a change may stay pending
+     */
+    explicit ConfigStore(const std::string& storagePath = "/spiffs/config",
+                         uint32_t debounceMs = 2000,
+                         uint32_t maxDelayMs = 10000);
+
+    /**
+     * @brief Initialize the store and recover interrupted record writes
+     * @return True if initialization successful, false otherwise
+     */
+    bool init();
+
+    //---------- Change Tracking ----------//
+
+    /**
+     * @brief Mark configuration as changed
+     * @param config Sensor configuration
+     * @param nowMs Current time in milliseconds
+     */
+    void markDirty(const SensorConfig& config, uint32_t nowMs);
+
+    /**
+     * @brief Mark configuration as removed
+     * @param sensorId Sensor ID
+     * @param nowMs Current time in milliseconds
+     */
+    void markRemoved(const std::string& sensorId, uint32_t nowMs);
+
+    /**
+     * @brief Check if any change is waiting to be written
+     * @return True if changes are pending, false otherwise
+     */
+    bool hasPending() const;
+
+    /**
+     * @brief Get number of pending records
+     * @return Number of sensors with unwritten changes
+     */
+    size_t getPendingCount() const;
+
+    //---------- Persistence ----------//
+
+    /**
+     * @brief Write pending records if the debounce window has elapsed
+     * @param nowMs Current time in milliseconds
+     * @return True if nothing failed, false if any record could not be written
+     */
+    bool flush(uint32_t nowMs);
+
+    /**
+     * @brief Write all pending records immediately
+     * @return True if nothing failed, false if any record could not be written
+     */
+    bool flushAll();
+
+    /**
+     * @brief Convert configuration to its persisted record
+     * @param config Sensor configuration
+     * @param source Record previously stored for the sensor, whose other fields are kept
+     * @return Record JSON
+     */
+    static json toRecord(const SensorConfig& config, const json& source = json());
+
+    /**
+     * @brief Get record file path for a sensor without an instance file
+     * @param sensorId Sensor ID
+     * @return Path of the record file
+     */
+    std::string getRecordPath(const std::string& sensorId) const;
+
+private:
+    /**
+     * @brief Pending change for one sensor
+     */
+    struct PendingRecord {
+        SensorConfig config;    ///< Configuration to write
+        bool removed{false};    ///< Whether the record should be deleted
+    };
+
+    /**
+     * @brief Map sensor IDs to the files that hold them (caller holds storeMutex_)
+     */
+    void scanSources();
+
+    /**
+     * @brief Write pending records (caller holds storeMutex_)
+     * @return True if nothing failed, false otherwise
+     */
+    bool writePending();
+
+    /**
+     * @brief Atomically replace the file holding the sensor's record
+     * @param config Sensor configuration
+     * @return True if successful, false otherwise
+     */
+    bool writeRecord(const SensorConfig& config);
+
+    /**
+     * @brief Delete every file holding the sensor's record
+     * @param sensorId Sensor ID
+     * @return True if successful, false otherwise
+     */
+    bool removeRecord(const std::string& sensorId);
+
+private:
+    std::string storagePath_;                                      ///< Record directory
+    uint32_t debounceMs_;                                          ///< Quiet time before writing
+    uint32_t maxDelayMs_;                                          ///< Upper bound on write delay
+    std::map<std::string, PendingRecord> pending_;                 ///< Map of sensor ID to pending change
+    std::map<std::string, std::vector<std::string>> sourceFiles_;  ///< Map of sensor ID to files holding it
+    bool sourcesScanned_{false};                                   ///< Whether sourceFiles_ is populated
+    uint32_t firstDirtyMs_{0};                                     ///< Time of oldest pending change
+    uint32_t lastDirtyMs_{0};                                      ///< Time of newest pending change
+    mutable std::mutex storeMutex_;                                ///< Mutex for thread safety
+};
+
+} // namespace sensors
@@ -0,0 +1,214 @@
+#include "i2c_rediscovery.hpp"
+#include <algorithm>
+
+namespace sensors {
+
+namespace {
+
+const uint8_t FIRST_ADDRESS = 0x08;     // 0x00-0x07 and 0x78-0x7F are reserved
+const uint8_t LAST_ADDRESS = 0x77;
+const int64_t MAX_CREDIT = 5000;        // us, bounds the burst after an idle period
+
+} // namespace
+
+I2CRediscovery::I2CRediscovery(std::shared_ptr<hal::IHAL> hal,
+                               std::shared_ptr<I2CTopologyScanner> scanner,
+                               const std::vector<uint8_t>& buses,
+                               uint8_t budgetPercent,
+                               uint32_t passInterval) :
+    hal_(hal),
+    scanner_(scanner),
+    budgetPercent_(1),
+    passInterval_(passInterval) {
+    for (uint8_t busNum : buses) {
+        buses_[busNum] = BusState();
+    }
+    setBudgetPercent(budgetPercent);
+    lastPassEnd_ = hal_->millis();
+}
+
+void I2CRediscovery::setBudgetPercent(uint8_t budgetPercent) {
+    budgetPercent_ = std::min<uint8_t>(std::max<uint8_t>(budgetPercent, 1), 100);
+}
+
+uint8_t I2CRediscovery::getBudgetPercent() const {
+    return budgetPercent_;
+}
+
+void I2CRediscovery::setKnownDevices(const std::vector<I2CDeviceInfo>& devices) {
+    knownDevices_.clear();
+    for (const auto& device : devices) {
+        if (!device.protocolName.empty()) {
+            knownDevices_.push_back(device);
+        }
+    }
+}
+
+const std::vector<I2CDeviceInfo>& I2CRediscovery::getKnownDevices() const {
+    return knownDevices_;
+}
+
+void I2CRediscovery::setOccupiedAddresses(const std::set<std::pair<uint8_t, uint8_t>>& occupied) {
+    occupied_ = occupied;
+}
+
+void I2CRediscovery::markSuspect(uint8_t busNum, uint8_t address) {
+    if (findKnown(busNum, address) != knownDevices_.size()) {
+        suspects_.insert({busNum, address});
+    }
+}
+
+bool I2CRediscovery::step() {
+    uint32_t now = hal_->micros();
+
+    if (!passRunning_) {
+        if (hal_->millis() - lastPassEnd_ < passInterval_) {
+            return false;
+        }
+        startPass();
+        lastStep_ = now;
+        return false;
+    }
+
+    // Every bus earns its share of the elapsed time as probe credit
+    int64_t earned = static_cast<int64_t>(now - lastStep_) * budgetPercent_ / 100;
+    lastStep_ = now;
+
+    bool remaining = false;
+    for (auto& pair : buses_) {
+        BusState& bus = pair.second;
+        bus.credit = std::min(bus.credit + earned, MAX_CREDIT);
+
+        // A probe may overdraw the credit; the debt is repaid before the next one
+        while (!bus.queue.empty() && bus.credit > 0) {
+            Probe probe = bus.queue.front();
+            bus.queue.pop_front();
+
+            uint32_t start = hal_->micros();
+            runProbe(pair.first, probe);
+            uint32_t duration = hal_->micros() - start;
+
+            bus.credit -= duration;
+            busTimeUsed_ += duration;
+        }
+
+        remaining = remaining || !bus.queue.empty();
+    }
+
+    if (remaining) {
+        return false;
+    }
+
+    passRunning_ = false;
+    passCount_++;
+    lastPassEnd_ = hal_->millis();
+    return true;
+}
+
+I2CTopologyDiff I2CRediscovery::takeDiff() {
+    I2CTopologyDiff diff;
+    std::swap(diff, diff_);
+
+    for (const auto& device : diff.removed) {
+        size_t index = findKnown(device.busNum, device.address);
+        if (index != knownDevices_.size()) {
+            knownDevices_.erase(knownDevices_.begin() + index);
+        }
+    }
+    for (const auto& change : diff.changed) {
+        size_t index = findKnown(change.second.busNum, change.second.address);
+        if (index != knownDevices_.size()) {
+            knownDevices_[index] = change.second;
+        }
+    }
+    knownDevices_.insert(knownDevices_.end(), diff.added.begin(), diff.added.end());
+
+    return diff;
+}
+
+bool I2CRediscovery::isPassRunning() const {
+    return passRunning_;
+}
+
+uint32_t I2CRediscovery::getPassCount() const {
+    return passCount_;
+}
+
+uint64_t I2CRediscovery::getBusTimeUsed() const {
+    return busTimeUsed_;
+}
+
+// Private methods
+void I2CRediscovery::startPass() {
+    diff_ = I2CTopologyDiff();
+
+    for (auto& pair : buses_) {
+        uint8_t busNum = pair.first;
+        BusState& bus = pair.second;
+        bus.queue.clear();
+        bus.credit = 0;
+
+        // Free addresses where some protocol could appear
+        for (uint8_t address = FIRST_ADDRESS; address <= LAST_ADDRESS; address++) {
+            if (!scanner_->isCandidateAddress(address) ||
+                occupied_.count({busNum, address}) ||
+                findKnown(busNum, address) != knownDevices_.size()) {
+                continue;
+            }
+            bus.queue.push_back({address, false});
+        }
+
+        // Known devices whose sensors are failing
+        for (const auto& suspect : suspects_) {
+            if (suspect.first == busNum) {
+                bus.queue.push_back({suspect.second, true});
+            }
+        }
+    }
+
+    suspects_.clear();
+    passRunning_ = true;
+}
+
+void I2CRediscovery::runProbe(uint8_t busNum, const Probe& probe) {
+    I2CDeviceInfo device;
+
+    if (probe.recheck) {
+        size_t index = findKnown(busNum, probe.address);
+        if (index == knownDevices_.size()) {
+            return;
+        }
+        const I2CDeviceInfo& known = knownDevices_[index];
+
+        int value = hal_->i2cReadRegister(known.address, known.idRegister, busNum);
+        if (value == known.idValue) {
+            return;
+        }
+        if (value < 0 || !scanner_->identify(busNum, probe.address, device)) {
+            diff_.removed.push_back(known);
+        } else if (device.protocolName != known.protocolName) {
+            diff_.changed.push_back({known, device});
+        }
+        return;
+    }
+
+    // A one-byte read is the cheapest presence check; absent devices NACK the address
+    uint8_t data;
+    if (hal_->i2cRead(probe.address, &data, 1, busNum) != 1) {
+        return;
+    }
+    if (scanner_->identify(busNum, probe.address, device)) {
+        diff_.added.push_back(device);
+    }
+}
+
+size_t I2CRediscovery::findKnown(uint8_t busNum, uint8_t address) const {
+    for (size_t i = 0; i < knownDevices_.size(); i++) {
+        if (knownDevices_[i].busNum == busNum && knownDevices_[i].address == address) {
+            return i;
+        }
+    }
+    return knownDevices_.size();
+}
+
+} // namespace sensors
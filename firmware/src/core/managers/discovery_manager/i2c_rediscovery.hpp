@@ -0,0 +1,195 @@
+/**
+ * @file i2c_rediscovery.hpp
+ * @brief Incremental background I2C rediscovery
+ *
+ * This file defines the I2CRediscovery class, which periodically probes the
+ * unused I2C addresses for hot-plugged sensors and re-checks failing ones,
+ * spending at most a configured share of bus time.
+ */
+
+#pragma once
+
+#include "i2c_topology_scanner.hpp"
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace sensors {
+
+/**
+ * @brief Difference between two I2C topologies
+ */
+struct I2CTopologyDiff {
+    std::vector<I2CDeviceInfo> added;       ///< Devices that appeared
+    std::vector<I2CDeviceInfo> removed;     ///< Devices that no longer answer
+    std::vector<std::pair<I2CDeviceInfo, I2CDeviceInfo>> changed;  ///< (previous, current) of devices now identified as another protocol
+
+    /**
+     * @brief Check if topology is unchanged
+     * @return True if there are no differences, false otherwise
+     */
+    bool empty() const {
+        return added.empty() && removed.empty() && changed.empty();
+    }
+};
+
+/**
+ * @brief Low-priority, budgeted rediscovery of I2C devices
+ *
+ * A pass visits every candidate address of the probe plan that is not owned
+ * by a configured sensor, plus the known devices whose sensors reported
+ * errors. Addresses owned by healthy sensors are never touched. Probing is
+ * paced by a per-bus token bucket: each bus earns budgetPercent of elapsed
+ * time as probe credit and every probe is charged its measured duration, so
+ * a pass is spread over many step() calls and acquisition is never paused.
+ */
+class I2CRediscovery {
+public:
+    /**
+     * @brief Constructor
+     * @param hal Pointer to HAL interface
+     * @param scanner Scanner holding the probe plan
+     * @param buses I2C bus numbers to watch
+     * @param budgetPercent Maximum share of bus time used for probing
+     * @param passInterval Minimum time between passes (ms)
+     */
+    I2CRediscovery(std::shared_ptr<hal::IHAL> hal,
+                   std::shared_ptr<I2CTopologyScanner> scanner,
+                   const std::vector<uint8_t>& buses,
+                   uint8_t budgetPercent = 2,
+                   uint32_t passInterval = 30000);
+
+    //---------- Configuration ----------//
+
+    /**
+     * @brief Set bus time budget
+     * @param budgetPercent Maximum share of bus time used for probing (1-100)
+     */
+    void setBudgetPercent(uint8_t budgetPercent);
+
+    /**
+     * @brief Get bus time budget
+     * @return Maximum share of bus time used for probing
+     */
+    uint8_t getBudgetPercent() const;
+
+    //---------- Registry ----------//
+
+    /**
+     * @brief Set devices currently registered from discovery
+     * @param devices Identified devices
+     */
+    void setKnownDevices(const std::vector<I2CDeviceInfo>& devices);
+
+    /**
+     * @brief Get devices currently registered from discovery
+     * @return Identified devices
+     */
+    const std::vector<I2CDeviceInfo>& getKnownDevices() const;
+
+    /**
+     * @brief Set addresses owned by configured sensors
+     * @param occupied Set of (bus, address) pairs that must not be probed
+     */
+    void setOccupiedAddresses(const std::set<std::pair<uint8_t, uint8_t>>& occupied);
+
+    /**
+     * @brief Request a re-check of a known device on the next pass
+     * @param busNum I2C bus number
+     * @param address Device address
+     */
+    void markSuspect(uint8_t busNum, uint8_t address);
+
+    //---------- Execution ----------//
+
+    /**
+     * @brief Spend available bus time on the current pass
+     * @return True if a pass completed during this call, false otherwise
+     */
+    bool step();
+
+    /**
+     * @brief Take the diff of the last completed pass
+     *
+     * The known devices are updated as if the diff had been applied.
+     *
+     * @return Topology diff, empty if nothing changed
+     */
+    I2CTopologyDiff takeDiff();
+
+    /**
+     * @brief Check if a pass is in progress
+     * @return True if running, false otherwise
+     */
+    bool isPassRunning() const;
+
+    /**
+     * @brief Get number of completed passes
+     * @return Completed passes
+     */
+    uint32_t getPassCount() const;
+
+    /**
+     * @brief Get total bus time spent probing
+     * @return Bus time (us)
+     */
+    uint64_t getBusTimeUsed() const;
+
+private:
+    /**
+     * @brief Work item of a pass
+     */
+    struct Probe {
+        uint8_t address;        ///< Device address
+        bool recheck;           ///< Known device to re-check rather than a free address
+    };
+
+    /**
+     * @brief Per-bus pass state
+     */
+    struct BusState {
+        std::deque<Probe> queue;        ///< Remaining probes of the pass
+        int64_t credit{0};              ///< Available bus time (us)
+    };
+
+    /**
+     * @brief Build work queues of a new pass
+     */
+    void startPass();
+
+    /**
+     * @brief Execute one probe
+     * @param busNum I2C bus number
+     * @param probe Probe to execute
+     */
+    void runProbe(uint8_t busNum, const Probe& probe);
+
+    /**
+     * @brief Find known device
+     * @param busNum I2C bus number
+     * @param address Device address
+     * @return Index into knownDevices_ or knownDevices_.size() if not found
+     */
+    size_t findKnown(uint8_t busNum, uint8_t address) const;
+
+private:
+    std::shared_ptr<hal::IHAL> hal_;                        ///< HAL interface
+    std::shared_ptr<I2CTopologyScanner> scanner_;           ///< Scanner holding the probe plan
+    uint8_t budgetPercent_;                                 ///< Share of bus time for probing
+    uint32_t passInterval_;                                 ///< Minimum time between passes (ms)
+    std::map<uint8_t, BusState> buses_;                     ///< Map of bus number to pass state
+    std::vector<I2CDeviceInfo> knownDevices_;               ///< Devices registered from discovery
+    std::set<std::pair<uint8_t, uint8_t>> occupied_;        ///< Addresses owned by configured sensors
+    std::set<std::pair<uint8_t, uint8_t>> suspects_;        ///< Known devices to re-check
+    I2CTopologyDiff diff_;                                  ///< Diff of the current pass
+    bool passRunning_{false};                               ///< Pass state flag
+    uint32_t lastPassEnd_{0};                               ///< End of the last pass (ms)
+    uint32_t lastStep_{0};                                  ///< Time of the last step (us)
+    uint32_t passCount_{0};                                 ///< Completed passes
+    uint64_t busTimeUsed_{0};                               ///< Total bus time spent probing (us)
+};
+
+} // namespace sensors
@@ -0,0 +1,349 @@
+#include "i2c_topology_scanner.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+namespace sensors {
+
+namespace {
+
+const int TOPOLOGY_VERSION = 1;
+
+// Parse "0x48" style values used throughout the protocol definitions
+int parseNumber(const json& value) {
+    if (value.is_number_integer()) {
+        return value.get<int>();
+    }
+    if (value.is_string()) {
+        try {
+            return std::stoi(value.get<std::string>(), nullptr, 0);
+        } catch (const std::exception&) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+std::string I2CDeviceInfo::getUniqueId() const {
+    char id[8];
+    snprintf(id, sizeof(id), "%u_%02x", busNum, address);
+    return id;
+}
+
+json I2CDeviceInfo::getBusParams() const {
+    char addressStr[8];
+    snprintf(addressStr, sizeof(addressStr), "0x%02X", address);
+
+    json params;
+    params["address"] = addressStr;
+    params["bus"] = busNum;
+    return params;
+}
+
+I2CTopologyScanner::I2CTopologyScanner(std::shared_ptr<hal::IHAL> hal) :
+    hal_(hal) {
+}
+
+size_t I2CTopologyScanner::loadProtocols(const json& protocols) {
+    return loadRules(compileProtocols(protocols));
+}
+
+size_t I2CTopologyScanner::loadRules(const std::vector<I2CDetectionRule>& rules) {
+    std::lock_guard<std::mutex> lock(scanMutex_);
+    plan_.clear();
+    size_t count = 0;
+
+    for (const auto& rule : rules) {
+        Candidate candidate;
+        candidate.protocolName = rule.protocolName;
+        candidate.type = rule.type;
+        for (size_t i = 0; i < rule.registers.size() && i < rule.values.size(); i++) {
+            candidate.checks.push_back({rule.registers[i], rule.values[i]});
+        }
+        if (candidate.protocolName.empty() || candidate.checks.empty()) {
+            continue;
+        }
+
+        bool added = false;
+        for (uint8_t address : rule.addresses) {
+            if (address > 0x7F) {
+                continue;
+            }
+            AddressPlan& plan = plan_[address];
+            plan.candidates.push_back(candidate);
+            for (const auto& check : candidate.checks) {
+                if (std::find(plan.registers.begin(), plan.registers.end(), check.reg) == plan.registers.end()) {
+                    plan.registers.push_back(check.reg);
+                }
+            }
+            added = true;
+        }
+
+        if (added) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+std::vector<I2CDetectionRule> I2CTopologyScanner::compileProtocols(const json& protocols) {
+    std::vector<I2CDetectionRule> rules;
+
+    for (const auto& document : protocols) {
+        const json& protocol = document.contains("protocol") ? document["protocol"] : document;
+        if (!protocol.is_object() || !protocol.contains("discovery")) {
+            continue;
+        }
+
+        const json& discovery = protocol["discovery"];
+        if (!discovery.value("supportsAutoDetection", false) ||
+            discovery.value("detectionMethod", "") != "i2c") {
+            continue;
+        }
+
+        I2CDetectionRule rule;
+        rule.protocolName = protocol.value("name", "");
+        if (protocol.contains("capabilities") && protocol["capabilities"].contains("sensorTypes") &&
+            !protocol["capabilities"]["sensorTypes"].empty()) {
+            rule.type = stringToSensorType(protocol["capabilities"]["sensorTypes"][0].get<std::string>());
+        }
+
+        // Identifier registers and read steps of the detection sequence
+        std::vector<json> checks;
+        for (const auto& id : discovery.value("uniqueIdentifiers", json::array())) {
+            checks.push_back({{"register", id.value("register", json())}, {"value", id.value("value", json())}});
+        }
+        for (const auto& step : discovery.value("detectionSequence", json::array())) {
+            if (step.value("type", "") == "read") {
+                checks.push_back({{"register", step.value("register", json())}, {"value", step.value("expectedValue", json())}});
+            }
+        }
+
+        for (const auto& check : checks) {
+            int reg = parseNumber(check["register"]);
+            int value = parseNumber(check["value"]);
+            if (reg < 0 || reg > 0xFF || value < 0 || value > 0xFF) {
+                continue;
+            }
+            bool duplicate = false;
+            for (size_t i = 0; i < rule.registers.size(); i++) {
+                duplicate = duplicate || (rule.registers[i] == reg && rule.values[i] == value);
+            }
+            if (!duplicate) {
+                rule.registers.push_back(static_cast<uint8_t>(reg));
+                rule.values.push_back(static_cast<uint8_t>(value));
+            }
+        }
+
+        // Candidate addresses
+        const json& i2c = protocol.value("communication", json::object()).value("i2c", json::object());
+        std::vector<int> addresses{parseNumber(i2c.value("defaultAddress", json()))};
+        for (const auto& address : i2c.value("alternativeAddresses", json::array())) {
+            addresses.push_back(parseNumber(address));
+        }
+        for (int address : addresses) {
+            if (address >= 0 && address <= 0x7F) {
+                rule.addresses.push_back(static_cast<uint8_t>(address));
+            }
+        }
+
+        if (!rule.protocolName.empty() && !rule.registers.empty() && !rule.addresses.empty()) {
+            rules.push_back(std::move(rule));
+        }
+    }
+
+    return rules;
+}
+
+bool I2CTopologyScanner::hasProbePlan() const {
+    std::lock_guard<std::mutex> lock(scanMutex_);
+    return !plan_.empty();
+}
+
+std::vector<I2CDeviceInfo> I2CTopologyScanner::scan(const std::vector<uint8_t>& buses) {
+    std::vector<I2CDeviceInfo> devices;
+    std::mutex devicesMutex;
+    std::vector<std::thread> threads;
+
+    // Buses are independent peripherals, scan them concurrently
+    for (uint8_t busNum : buses) {
+        threads.emplace_back([this, busNum, &devices, &devicesMutex]() {
+            auto found = scanBus(busNum);
+            std::lock_guard<std::mutex> lock(devicesMutex);
+            devices.insert(devices.end(), found.begin(), found.end());
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::sort(devices.begin(), devices.end(), [](const I2CDeviceInfo& a, const I2CDeviceInfo& b) {
+        return a.busNum != b.busNum ? a.busNum < b.busNum : a.address < b.address;
+    });
+    return devices;
+}
+
+bool I2CTopologyScanner::identify(uint8_t busNum, uint8_t address, I2CDeviceInfo& device) {
+    device = I2CDeviceInfo();
+    device.busNum = busNum;
+    device.address = address;
+
+    auto planIt = plan_.find(address);
+    if (planIt == plan_.end()) {
+        return false;
+    }
+    const AddressPlan& plan = planIt->second;
+
+    // Read each distinct register once, then match every candidate
+    std::map<uint8_t, int> values;
+    for (uint8_t reg : plan.registers) {
+        values[reg] = hal_->i2cReadRegister(address, reg, busNum);
+        probeCount_++;
+    }
+
+    for (const auto& candidate : plan.candidates) {
+        bool match = true;
+        for (const auto& check : candidate.checks) {
+            match = match && values[check.reg] == check.expected;
+        }
+        if (match) {
+            device.protocolName = candidate.protocolName;
+            device.type = candidate.type;
+            device.idRegister = candidate.checks.front().reg;
+            device.idValue = candidate.checks.front().expected;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool I2CTopologyScanner::verify(const std::vector<I2CDeviceInfo>& devices) {
+    for (const auto& device : devices) {
+        if (device.protocolName.empty()) {
+            continue;
+        }
+        probeCount_++;
+        if (hal_->i2cReadRegister(device.address, device.idRegister, device.busNum) != device.idValue) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool I2CTopologyScanner::isCandidateAddress(uint8_t address) const {
+    return plan_.find(address) != plan_.end();
+}
+
+uint32_t I2CTopologyScanner::getProbeCount() const {
+    return probeCount_;
+}
+
+bool I2CTopologyScanner::saveTopology(const std::string& path, const std::vector<I2CDeviceInfo>& devices) {
+    json topology;
+    topology["version"] = TOPOLOGY_VERSION;
+    topology["fingerprint"] = fingerprint(devices);
+    topology["devices"] = json::array();
+    for (const auto& device : devices) {
+        topology["devices"].push_back({
+            {"bus", device.busNum},
+            {"address", device.address},
+            {"protocol", device.protocolName},
+            {"type", sensorTypeToString(device.type)},
+            {"idRegister", device.idRegister},
+            {"idValue", device.idValue}
+        });
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::string data = topology.dump();
+    bool success = fwrite(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    return success;
+}
+
+bool I2CTopologyScanner::loadTopology(const std::string& path, std::vector<I2CDeviceInfo>& devices) {
+    devices.clear();
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::string data;
+    char buffer[256];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, count);
+    }
+    fclose(file);
+
+    json topology = json::parse(data, nullptr, false);
+    if (topology.is_discarded() || topology.value("version", 0) != TOPOLOGY_VERSION) {
+        return false;
+    }
+
+    try {
+        for (const auto& entry : topology.at("devices")) {
+            I2CDeviceInfo device;
+            device.busNum = entry.at("bus").get<uint8_t>();
+            device.address = entry.at("address").get<uint8_t>();
+            device.protocolName = entry.at("protocol").get<std::string>();
+            device.type = stringToSensorType(entry.at("type").get<std::string>());
+            device.idRegister = entry.at("idRegister").get<uint8_t>();
+            device.idValue = entry.at("idValue").get<uint8_t>();
+            devices.push_back(device);
+        }
+    } catch (const std::exception&) {
+        devices.clear();
+        return false;
+    }
+
+    if (topology.value("fingerprint", 0u) != fingerprint(devices)) {
+        devices.clear();
+        return false;
+    }
+    return true;
+}
+
+// Private methods
+std::vector<I2CDeviceInfo> I2CTopologyScanner::scanBus(uint8_t busNum) {
+    std::vector<I2CDeviceInfo> devices;
+
+    probeCount_++;
+    for (uint8_t address : hal_->i2cScan(busNum)) {
+        I2CDeviceInfo device;
+        identify(busNum, address, device);
+        devices.push_back(device);
+    }
+
+    return devices;
+}
+
+uint32_t I2CTopologyScanner::fingerprint(const std::vector<I2CDeviceInfo>& devices) {
+    // FNV-1a over the identifying fields
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](uint8_t byte) {
+        hash ^= byte;
+        hash *= 16777619u;
+    };
+
+    for (const auto& device : devices) {
+        mix(device.busNum);
+        mix(device.address);
+        mix(device.idRegister);
+        mix(device.idValue);
+        for (char c : device.protocolName) {
+            mix(static_cast<uint8_t>(c));
+        }
+    }
+    return hash;
+}
+
+} // namespace sensors
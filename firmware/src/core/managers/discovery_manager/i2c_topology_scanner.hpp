@@ -0,0 +1,206 @@
+/**
+ * @file i2c_topology_scanner.hpp
+ * @brief Concurrent I2C discovery with cached bus topology
+ *
+ * This file defines the I2CTopologyScanner class, which identifies I2C
+ * sensors on all buses in parallel using the identifier registers declared
+ * in the protocol definitions, and persists the resulting bus topology so
+ * later boots can verify it with a few probes instead of a full scan.
+ */
+
+#pragma once
+
+#include "../../sensor_types.hpp"
+#include "../../../hal/ihal.hpp"
+#include <memory>
+#include <map>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+namespace sensors {
+
+/**
+ * @brief Device found on an I2C bus
+ */
+struct I2CDeviceInfo {
+    uint8_t busNum{0};                        ///< I2C bus number
+    uint8_t address{0};                       ///< 7-bit device address
+    std::string protocolName;                 ///< Matched protocol, empty if unidentified
+    SensorType type{SensorType::UNKNOWN};     ///< Primary sensor type of the protocol
+    uint8_t idRegister{0};                    ///< Register used to identify the device
+    uint8_t idValue{0};                       ///< Value read from the identifier register
+
+    /**
+     * @brief Get unique ID of the device position
+     * @return Unique ID ("<bus>_<address>")
+     */
+    std::string getUniqueId() const;
+
+    /**
+     * @brief Get bus parameters for configuration generation
+     * @return Bus parameters JSON
+     */
+    json getBusParams() const;
+};
+
+/**
+ * @brief I2C detection rule of one protocol, compiled from its definition
+ */
+struct I2CDetectionRule {
+    std::string protocolName;                 ///< Protocol name
+    SensorType type{SensorType::UNKNOWN};     ///< Primary sensor type
+    std::vector<uint8_t> addresses;           ///< Candidate 7-bit addresses
+    std::vector<uint8_t> registers;           ///< Identifier registers, all must match
+    std::vector<uint8_t> values;              ///< Expected value of each register
+};
+
+/**
+ * @brief I2C discovery with per-address identifier probing
+ *
+ * Protocol definitions are compiled into a probe plan: for every candidate
+ * address, the distinct identifier registers of all protocols that may live
+ * there. Each responding address is probed once per distinct register, and
+ * every candidate protocol is matched against the values read, instead of
+ * re-probing the address for each protocol. Buses are scanned concurrently.
+ */
+class I2CTopologyScanner {
+public:
+    /**
+     * @brief Constructor
+     * @param hal Pointer to HAL interface
+     */
+    explicit I2CTopologyScanner(std::shared_ptr<hal::IHAL> hal);
+
+    /**
+     * @brief Compile probe plan from protocol definitions
+     * @param protocols Array of protocol documents ({"protocol": {...}})
+     * @return Number of protocols that can be auto-detected over I2C
+     */
+    size_t loadProtocols(const json& protocols);
+
+    /**
+     * @brief Compile probe plan from detection rules
+     * @param rules Detection rules, as returned by compileProtocols()
+     * @return Number of protocols that can be auto-detected over I2C
+     */
+    size_t loadRules(const std::vector<I2CDetectionRule>& rules);
+
+    /**
+     * @brief Extract I2C detection rules from protocol definitions
+     * @param protocols Array of protocol documents ({"protocol": {...}})
+     * @return Rules of the protocols that support I2C auto-detection
+     */
+    static std::vector<I2CDetectionRule> compileProtocols(const json& protocols);
+
+    /**
+     * @brief Check if any protocol can be detected
+     * @return True if the probe plan is not empty, false otherwise
+     */
+    bool hasProbePlan() const;
+
+    //---------- Discovery ----------//
+
+    /**
+     * @brief Scan buses concurrently and identify devices
+     * @param buses I2C bus numbers to scan
+     * @return Responding devices, identified where a protocol matched
+     */
+    std::vector<I2CDeviceInfo> scan(const std::vector<uint8_t>& buses);
+
+    /**
+     * @brief Identify device at a known address
+     * @param busNum I2C bus number
+     * @param address Device address
+     * @param device Device information, protocol fields set on match
+     * @return True if a protocol matched, false otherwise
+     */
+    bool identify(uint8_t busNum, uint8_t address, I2CDeviceInfo& device);
+
+    /**
+     * @brief Verify cached topology with one probe per identified device
+     * @param devices Cached devices
+     * @return True if every identified device still answers as expected
+     */
+    bool verify(const std::vector<I2CDeviceInfo>& devices);
+
+    /**
+     * @brief Check if address is a candidate of any protocol
+     * @param address Device address
+     * @return True if some protocol may be found at this address
+     */
+    bool isCandidateAddress(uint8_t address) const;
+
+    /**
+     * @brief Get number of probes issued since construction
+     * @return Register reads and bus scans performed
+     */
+    uint32_t getProbeCount() const;
+
+    //---------- Topology Persistence ----------//
+
+    /**
+     * @brief Save topology fingerprint
+     * @param path Filesystem path of the topology file
+     * @param devices Devices to save
+     * @return True if successful, false otherwise
+     */
+    static bool saveTopology(const std::string& path, const std::vector<I2CDeviceInfo>& devices);
+
+    /**
+     * @brief Load topology fingerprint
+     * @param path Filesystem path of the topology file
+     * @param devices Devices loaded
+     * @return True if a valid fingerprint was loaded, false otherwise
+     */
+    static bool loadTopology(const std::string& path, std::vector<I2CDeviceInfo>& devices);
+
+private:
+    /**
+     * @brief Identifier check of one protocol
+     */
+    struct IdentifierCheck {
+        uint8_t reg;                ///< Register to read
+        uint8_t expected;           ///< Expected value
+    };
+
+    /**
+     * @brief Protocol that may be found at an address
+     */
+    struct Candidate {
+        std::string protocolName;               ///< Protocol name
+        SensorType type;                        ///< Primary sensor type
+        std::vector<IdentifierCheck> checks;    ///< All checks must pass
+    };
+
+    /**
+     * @brief Probe plan of one address
+     */
+    struct AddressPlan {
+        std::vector<uint8_t> registers;         ///< Distinct registers to read
+        std::vector<Candidate> candidates;      ///< Protocols to match
+    };
+
+    /**
+     * @brief Scan a single bus
+     * @param busNum I2C bus number
+     * @return Responding devices on the bus
+     */
+    std::vector<I2CDeviceInfo> scanBus(uint8_t busNum);
+
+    /**
+     * @brief Compute fingerprint hash of a topology
+     * @param devices Devices
+     * @return Fingerprint hash
+     */
+    static uint32_t fingerprint(const std::vector<I2CDeviceInfo>& devices);
+
+private:
+    std::shared_ptr<hal::IHAL> hal_;                ///< HAL interface
+    std::map<uint8_t, AddressPlan> plan_;           ///< Map of address to probe plan
+    std::atomic<uint32_t> probeCount_{0};           ///< Probes issued
+    mutable std::mutex scanMutex_;                  ///< Mutex for thread safety
+};
+
+} // namespace sensors
@@ -12,6 +12,8 @@
 
 #include "../../isensor.hpp"
 #include "../../../hal/ihal.hpp"
+#include "../../utils/latency_trace.hpp"
+#include "../../utils/latest_value_cache.hpp"
 #include <memory>
 #include <map>
 #include <vector>
@@ -20,6 +22,8 @@
 
 namespace sensors {
 
+const size_t LATEST_VALUE_CAPACITY = 64;        ///< Sensors with a latest-value cache slot
+
 /**
  * @brief Type definition for sensor map
  */
@@ -132,6 +136,37 @@ public:
      */
     SensorReading read(const std::string& sensorId);
     
+    /**
+     * @brief Get handle of a sensor's latest-value cache slot
+     *
+     * Every added sensor gets a slot; handles stay valid when sensors are
+     * removed and added again under the same ID.
+     *
+     * @param sensorId Sensor ID
+     * @return Sensor handle, or LatestValueCache::INVALID_HANDLE if unknown
+     */
+    int getHandle(const std::string& sensorId) const;
+    
+    /**
+     * @brief Read a sensor's most recent value
+     *
+     * Returns the value last stored by the background reading loop, or by
+     * read(), without locking or bus traffic. Only when it is older than
+     * maxAge, or there is none yet, is the sensor read from hardware; that
+     * reading refreshes the cache.
+     *
+     * @param handle Sensor handle from getHandle()
+     * @param maxAge Oldest acceptable value in milliseconds
+     * @return Snapshot, isValid false if no valid value could be had
+     */
+    CachedReading readCached(int handle, uint32_t maxAge);
+    
+    /**
+     * @brief Get latest-value cache
+     * @return Cache of every sensor's most recent value
+     */
+    const LatestValueCache& getLatestValues() const;
+    
     /**
      * @brief Read from sensors by type
      * @param type Sensor type
@@ -141,6 +176,15 @@ public:
     
     /**
      * @brief Start continuous reading in background
+     *
+     * With a latency tracer set, each sensor is read inside a TraceScope
+     * for its trace, so the driver's stage timers and those of the callback
+     * are recorded against that sensor. Traces are resolved when a sensor
+     * is added or the tracer is set, and handed on in SensorReading::trace.
+     *
+     * Every reading is also stored in the latest-value cache before the
+     * callback runs.
+     *
      * @param interval Reading interval in milliseconds
      * @param callback Callback function to call with sensor readings
      * @return True if successful, false otherwise
@@ -151,6 +195,12 @@ public:
      * @brief Stop continuous reading
      */
     void stopReading();
+    
+    /**
+     * @brief Set latency tracer for background reads
+     * @param tracer Latency tracer, nullptr to stop tracing
+     */
+    void setLatencyTracer(std::shared_ptr<LatencyTracer> tracer);
 
     //---------- Calibration Methods ----------//
     
@@ -255,6 +305,9 @@ private:
     SensorMap sensors_;                               ///< Map of sensors
     SensorErrorCallback errorCallback_;               ///< Error callback
     SensorReadingCallback readingCallback_;           ///< Reading callback
+    std::shared_ptr<LatencyTracer> latencyTracer_;    ///< Latency tracer, may be null
+    std::map<std::string, SensorTrace*> traces_;      ///< Trace per sensor, empty without a tracer
+    LatestValueCache latestValues_{LATEST_VALUE_CAPACITY};      ///< Most recent value of every sensor
     
     volatile bool isReading_;                         ///< Reading state flag
     uint32_t readingInterval_;                        ///< Reading interval
@@ -19,6 +19,8 @@ namespace sensors {
 
 using json = nlohmann::json;
 
+struct SensorTrace;
+
 /**
  * @brief Enumeration of supported sensor types
  */
@@ -68,6 +70,7 @@ struct SensorReading {
     std::string unit;          ///< Unit of measurement
     bool isValid{false};       ///< Validity flag
     json metadata;             ///< Additional metadata
+    SensorTrace* trace{nullptr};    ///< Latency trace of the sensor, resolved once at registration
 };
 
 /**
@@ -0,0 +1,250 @@
+#include "alloc_tracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace sensors {
+
+thread_local AllocSubsystem AllocScope::current_ = AllocSubsystem::OTHER;
+
+namespace {
+
+const char* const SUBSYSTEM_NAMES[ALLOC_SUBSYSTEM_COUNT] = {
+    "other", "sensor_manager", "config", "calibration", "wireless", "mqtt"
+};
+
+// Counters are constant-initialized, so allocations made during static
+// initialization are already accounted
+struct SubsystemCounters {
+    std::atomic<uint32_t> allocations{0};
+    std::atomic<uint32_t> frees{0};
+    std::atomic<size_t> liveBytes{0};
+    std::atomic<size_t> peakBytes{0};
+};
+
+SubsystemCounters g_counters[ALLOC_SUBSYSTEM_COUNT];
+std::atomic<size_t> g_liveBytes{0};
+std::atomic<size_t> g_peakBytes{0};
+
+// Per-thread totals behind AllocCycle
+thread_local uint32_t t_allocations[ALLOC_SUBSYSTEM_COUNT] = {};
+thread_local size_t t_bytes = 0;
+
+void raisePeak(std::atomic<size_t>& peak, size_t value) {
+    size_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void append(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+void append(std::string& out, const char* format, ...) {
+    char buffer[160];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length > 0) {
+        out.append(buffer, std::min<size_t>(length, sizeof(buffer) - 1));
+    }
+}
+
+} // namespace
+
+const char* allocSubsystemName(AllocSubsystem subsystem) {
+    size_t index = static_cast<size_t>(subsystem);
+    return index < ALLOC_SUBSYSTEM_COUNT ? SUBSYSTEM_NAMES[index] : "unknown";
+}
+
+//---------- AllocTracker ----------//
+
+AllocSubsystem AllocTracker::recordAlloc(size_t bytes) {
+    AllocSubsystem subsystem = AllocScope::current();
+    size_t index = static_cast<size_t>(subsystem);
+
+    SubsystemCounters& counters = g_counters[index];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    raisePeak(counters.peakBytes, counters.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    raisePeak(g_peakBytes, g_liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+
+    t_allocations[index]++;
+    t_bytes += bytes;
+    return subsystem;
+}
+
+void AllocTracker::recordFree(size_t bytes, AllocSubsystem subsystem) {
+    SubsystemCounters& counters = g_counters[static_cast<size_t>(subsystem)];
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+    counters.liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    g_liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+AllocStats AllocTracker::snapshot(size_t freeHeap, size_t largestFreeBlock) {
+    AllocStats stats;
+    for (size_t i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+        stats.subsystems[i].allocations = g_counters[i].allocations.load(std::memory_order_relaxed);
+        stats.subsystems[i].frees = g_counters[i].frees.load(std::memory_order_relaxed);
+        stats.subsystems[i].liveBytes = g_counters[i].liveBytes.load(std::memory_order_relaxed);
+        stats.subsystems[i].peakBytes = g_counters[i].peakBytes.load(std::memory_order_relaxed);
+    }
+    stats.liveBytes = g_liveBytes.load(std::memory_order_relaxed);
+    stats.peakBytes = g_peakBytes.load(std::memory_order_relaxed);
+    stats.freeHeap = freeHeap;
+    stats.largestFreeBlock = largestFreeBlock;
+    return stats;
+}
+
+void AllocTracker::resetPeaks() {
+    for (auto& counters : g_counters) {
+        counters.peakBytes.store(counters.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    g_peakBytes.store(g_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void AllocTracker::formatJson(const AllocStats& stats, std::string& out) {
+    out.clear();
+    append(out, "{\"freeHeap\":%u,\"largestFreeBlock\":%u,\"liveBytes\":%u,\"peakBytes\":%u,"
+           "\"cycleAllocs\":%.1f,\"subsystems\":{",
+           static_cast<unsigned>(stats.freeHeap), static_cast<unsigned>(stats.largestFreeBlock),
+           static_cast<unsigned>(stats.liveBytes), static_cast<unsigned>(stats.peakBytes),
+           stats.cycleAllocations);
+    for (size_t i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+        const AllocCounters& counters = stats.subsystems[i];
+        append(out, "%s\"%s\":{\"allocs\":%u,\"frees\":%u,\"live\":%u,\"peak\":%u}",
+               i == 0 ? "" : ",", SUBSYSTEM_NAMES[i],
+               static_cast<unsigned>(counters.allocations), static_cast<unsigned>(counters.frees),
+               static_cast<unsigned>(counters.liveBytes), static_cast<unsigned>(counters.peakBytes));
+    }
+    out += "}}";
+}
+
+void AllocTracker::formatText(const AllocStats& stats, std::string& out) {
+    out.clear();
+    append(out, "%-16s %10s %10s %10s %10s\n", "subsystem", "allocs", "frees", "live", "peak");
+    for (size_t i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+        const AllocCounters& counters = stats.subsystems[i];
+        append(out, "%-16s %10u %10u %10u %10u\n", SUBSYSTEM_NAMES[i],
+               static_cast<unsigned>(counters.allocations), static_cast<unsigned>(counters.frees),
+               static_cast<unsigned>(counters.liveBytes), static_cast<unsigned>(counters.peakBytes));
+    }
+    append(out, "%-16s %10s %10s %10u %10u\n", "total", "", "",
+           static_cast<unsigned>(stats.liveBytes), static_cast<unsigned>(stats.peakBytes));
+    append(out, "Free heap %u bytes, largest free block %u bytes, %.1f allocations per reading\n",
+           static_cast<unsigned>(stats.freeHeap), static_cast<unsigned>(stats.largestFreeBlock),
+           stats.cycleAllocations);
+}
+
+//---------- AllocCycle ----------//
+
+AllocCycle::AllocCycle() {
+    restart();
+}
+
+void AllocCycle::restart() {
+    std::copy(std::begin(t_allocations), std::end(t_allocations), startAllocations_.begin());
+    startBytes_ = t_bytes;
+}
+
+uint32_t AllocCycle::allocations() const {
+    uint32_t total = 0;
+    for (size_t i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+        total += t_allocations[i] - startAllocations_[i];
+    }
+    return total;
+}
+
+uint32_t AllocCycle::allocations(AllocSubsystem subsystem) const {
+    size_t index = static_cast<size_t>(subsystem);
+    return t_allocations[index] - startAllocations_[index];
+}
+
+size_t AllocCycle::bytes() const {
+    return t_bytes - startBytes_;
+}
+
+} // namespace sensors
+
+#if SENSORHUB_ALLOC_TRACKING
+
+namespace {
+
+// Prepended to every block; padded so the returned pointer keeps malloc's alignment
+struct BlockHeader {
+    size_t size;
+    sensors::AllocSubsystem subsystem;
+};
+
+const size_t HEADER_SIZE = alignof(std::max_align_t) >= sizeof(BlockHeader)
+    ? alignof(std::max_align_t)
+    : (sizeof(BlockHeader) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+void* trackedAlloc(size_t size) {
+    if (size == 0) size = 1;
+
+    void* block = std::malloc(size + HEADER_SIZE);
+    if (!block) return nullptr;
+
+    BlockHeader* header = static_cast<BlockHeader*>(block);
+    header->size = size;
+    header->subsystem = sensors::AllocTracker::recordAlloc(size);
+    return static_cast<char*>(block) + HEADER_SIZE;
+}
+
+void trackedFree(void* ptr) {
+    if (!ptr) return;
+
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - HEADER_SIZE);
+    sensors::AllocTracker::recordFree(header->size, header->subsystem);
+    std::free(header);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    void* ptr = trackedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = trackedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    trackedFree(ptr);
+}
+
+#endif
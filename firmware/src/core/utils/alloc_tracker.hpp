@@ -0,0 +1,211 @@
+/**
+ * @file alloc_tracker.hpp
+ * @brief Heap allocation accounting per subsystem
+ *
+ * This file defines the AllocTracker, AllocScope and AllocCycle classes,
+ * which attribute every operator new/delete to the subsystem that made it
+ * (sensor manager, config, calibration, wireless, MQTT) and count the
+ * allocations of one reading cycle. Building with
+ * SENSORHUB_ALLOC_TRACKING=0 restores the default operator new.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef SENSORHUB_ALLOC_TRACKING
+#define SENSORHUB_ALLOC_TRACKING 1      ///< Set to 0 to stop replacing operator new/delete
+#endif
+
+namespace sensors {
+
+/**
+ * @brief Subsystem an allocation is charged to
+ */
+enum class AllocSubsystem : uint8_t {
+    OTHER = 0,              ///< Outside any scope (framework, libraries)
+    SENSOR_MANAGER = 1,     ///< Sensor reads and the reading callback
+    CONFIG = 2,             ///< Configuration loading and persistence
+    CALIBRATION = 3,        ///< Calibration data
+    WIRELESS = 4,           ///< ESP-NOW and wireless node handling
+    MQTT = 5                ///< MQTT messages and outbox
+};
+
+const size_t ALLOC_SUBSYSTEM_COUNT = 6;     ///< Number of subsystems
+
+/**
+ * @brief Get short subsystem name, as used in reports
+ * @param subsystem Subsystem
+ * @return Subsystem name
+ */
+const char* allocSubsystemName(AllocSubsystem subsystem);
+
+/**
+ * @brief Allocation counters of one subsystem
+ */
+struct AllocCounters {
+    uint32_t allocations{0};    ///< Allocations since boot
+    uint32_t frees{0};          ///< Frees since boot
+    size_t liveBytes{0};        ///< Bytes currently allocated
+    size_t peakBytes{0};        ///< Highest liveBytes since the last peak reset
+};
+
+/**
+ * @brief Heap state snapshot
+ */
+struct AllocStats {
+    std::array<AllocCounters, ALLOC_SUBSYSTEM_COUNT> subsystems;   ///< Counters per subsystem
+    size_t liveBytes{0};            ///< Bytes currently allocated, all subsystems
+    size_t peakBytes{0};            ///< Highest liveBytes since the last peak reset
+    size_t freeHeap{0};             ///< Free heap reported by the HAL
+    size_t largestFreeBlock{0};     ///< Largest allocatable block reported by the HAL
+    double cycleAllocations{0};     ///< Mean allocations per reading cycle, set by the caller
+};
+
+/**
+ * @brief Process-wide allocation accounting
+ *
+ * The replacement operator new/delete in alloc_tracker.cpp call
+ * recordAlloc() and recordFree(). Each block carries a small header with
+ * its size and subsystem, so a free is credited to the subsystem that
+ * allocated the block even if another one releases it. malloc() calls made
+ * by C code are not seen; the HAL heap figures still include them.
+ */
+class AllocTracker {
+public:
+    /**
+     * @brief Account an allocation to the current subsystem
+     * @param bytes Requested size
+     * @return Subsystem charged
+     */
+    static AllocSubsystem recordAlloc(size_t bytes);
+
+    /**
+     * @brief Account a free
+     * @param bytes Size of the block
+     * @param subsystem Subsystem the block was charged to
+     */
+    static void recordFree(size_t bytes, AllocSubsystem subsystem);
+
+    /**
+     * @brief Get counters of all subsystems
+     * @param freeHeap Free heap, from IHAL::getFreeHeap()
+     * @param largestFreeBlock Largest free block, from IHAL::getLargestFreeBlock()
+     * @return Snapshot
+     */
+    static AllocStats snapshot(size_t freeHeap = 0, size_t largestFreeBlock = 0);
+
+    /**
+     * @brief Restart peak tracking from the current live bytes
+     */
+    static void resetPeaks();
+
+    /**
+     * @brief Format a snapshot as the MQTT diagnostics payload
+     * @param stats Snapshot
+     * @param out Output payload
+     */
+    static void formatJson(const AllocStats& stats, std::string& out);
+
+    /**
+     * @brief Format a snapshot as a table for the serial console
+     * @param stats Snapshot
+     * @param out Output text, one line per subsystem
+     */
+    static void formatText(const AllocStats& stats, std::string& out);
+};
+
+/**
+ * @brief Charges the calling thread's allocations to a subsystem
+ *
+ * Scopes nest and restore the previous subsystem when they end.
+ */
+class AllocScope {
+public:
+    /**
+     * @brief Constructor, makes the subsystem current
+     * @param subsystem Subsystem
+     */
+    explicit AllocScope(AllocSubsystem subsystem) : previous_(current_) {
+        current_ = subsystem;
+    }
+
+    ~AllocScope() {
+        current_ = previous_;
+    }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+    /**
+     * @brief Get current subsystem of the calling thread
+     * @return Subsystem, OTHER outside any scope
+     */
+    static AllocSubsystem current() {
+        return current_;
+    }
+
+private:
+    AllocSubsystem previous_;                       ///< Subsystem current before this scope
+    static thread_local AllocSubsystem current_;    ///< Current subsystem of this thread
+};
+
+/**
+ * @brief Counts the allocations the calling thread makes during a cycle
+ *
+ * Only the constructing thread's allocations are counted, so work running
+ * concurrently on other tasks does not show up in the cycle. A steady-state
+ * cycle that allocates nothing reads allocations() == 0. With
+ * SENSORHUB_ALLOC_TRACKING=0 nothing is counted.
+ */
+class AllocCycle {
+public:
+    /**
+     * @brief Constructor, starts the cycle
+     */
+    AllocCycle();
+
+    /**
+     * @brief Start a new cycle
+     */
+    void restart();
+
+    /**
+     * @brief Get allocations since the cycle started
+     * @return Allocation count, all subsystems
+     */
+    uint32_t allocations() const;
+
+    /**
+     * @brief Get allocations of one subsystem since the cycle started
+     * @param subsystem Subsystem
+     * @return Allocation count
+     */
+    uint32_t allocations(AllocSubsystem subsystem) const;
+
+    /**
+     * @brief Get bytes allocated since the cycle started
+     * @return Bytes requested, all subsystems
+     */
+    size_t bytes() const;
+
+private:
+    std::array<uint32_t, ALLOC_SUBSYSTEM_COUNT> startAllocations_;     ///< Thread counts at start
+    size_t startBytes_;                                                ///< Thread bytes at start
+};
+
+} // namespace sensors
+
+#if SENSORHUB_ALLOC_TRACKING
+#define SENSORHUB_ALLOC_CONCAT_(a, b) a##b
+#define SENSORHUB_ALLOC_NAME_(line) SENSORHUB_ALLOC_CONCAT_(sensorhubAlloc_, line)
+
+/// Charge allocations in the rest of the enclosing block to an AllocSubsystem
+#define SENSORHUB_ALLOC_SCOPE(subsystem) \
+    ::sensors::AllocScope SENSORHUB_ALLOC_NAME_(__LINE__)(::sensors::AllocSubsystem::subsystem)
+#else
+#define SENSORHUB_ALLOC_SCOPE(subsystem) ((void)0)
+#endif
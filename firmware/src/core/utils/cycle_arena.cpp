@@ -0,0 +1,88 @@
+#include "cycle_arena.hpp"
+#include <algorithm>
+#include <new>
+
+namespace sensors {
+
+CycleArena::CycleArena(void* buffer, size_t size)
+    : buffer_(static_cast<uint8_t*>(buffer)), capacity_(size), ownsBuffer_(false) {
+}
+
+CycleArena::CycleArena(size_t capacity)
+    : buffer_(static_cast<uint8_t*>(::operator new(capacity))), capacity_(capacity), ownsBuffer_(true) {
+}
+
+CycleArena::~CycleArena() {
+    if (ownsBuffer_) {
+        ::operator delete(buffer_);
+    }
+}
+
+void* CycleArena::allocate(size_t bytes, size_t alignment) {
+    if (bytes == 0) bytes = 1;  // Keep every pointer inside the buffer
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(buffer_);
+    uintptr_t start = (base + offset_ + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    size_t end = (start - base) + bytes;
+
+    if (end > capacity_) {
+        overflows_++;
+        return ::operator new(bytes);
+    }
+
+    offset_ = end;
+    highWater_ = std::max(highWater_, offset_);
+    return reinterpret_cast<void*>(start);
+}
+
+void CycleArena::deallocate(void* ptr, size_t bytes) {
+    if (bytes == 0) bytes = 1;
+    if (!owns(ptr)) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    // Only the top allocation can be given back
+    uint8_t* bytePtr = static_cast<uint8_t*>(ptr);
+    if (bytePtr + bytes == buffer_ + offset_) {
+        offset_ = bytePtr - buffer_;
+    }
+}
+
+void CycleArena::reset() {
+    offset_ = 0;
+}
+
+size_t CycleArena::mark() const {
+    return offset_;
+}
+
+void CycleArena::rewind(size_t mark) {
+    if (mark < offset_) {
+        offset_ = mark;
+    }
+}
+
+size_t CycleArena::used() const {
+    return offset_;
+}
+
+size_t CycleArena::capacity() const {
+    return capacity_;
+}
+
+size_t CycleArena::highWater() const {
+    return highWater_;
+}
+
+uint32_t CycleArena::overflows() const {
+    return overflows_;
+}
+
+// Private methods
+bool CycleArena::owns(const void* ptr) const {
+    const uint8_t* bytePtr = static_cast<const uint8_t*>(ptr);
+    return bytePtr >= buffer_ && bytePtr < buffer_ + capacity_;
+}
+
+} // namespace sensors
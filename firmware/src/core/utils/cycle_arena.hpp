@@ -0,0 +1,184 @@
+/**
+ * @file cycle_arena.hpp
+ * @brief Monotonic arena for per-cycle temporaries
+ *
+ * This file defines the CycleArena class and the ArenaAllocator adaptor,
+ * which let the short-lived containers of one reading or publish cycle
+ * take their memory from a single buffer that is released with one reset
+ * instead of going through the heap one object at a time.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sensors {
+
+/**
+ * @brief Monotonic bump allocator
+ *
+ * Allocations are carved from one buffer, either supplied by the caller
+ * (for example a stack array) or allocated once by the arena. Freeing the
+ * most recent allocation gives its space back, which covers the usual
+ * vector growth pattern; everything else is only reclaimed by reset() or
+ * rewind(). When the buffer is full, allocations fall back to the heap and
+ * are counted as overflows, so an undersized arena costs performance but
+ * never fails.
+ *
+ * An arena is not thread-safe; use one per cycle and thread. Containers
+ * using the arena must be destroyed before reset() or rewind() past them.
+ */
+class CycleArena {
+public:
+    /**
+     * @brief Constructor, uses a caller-owned buffer
+     * @param buffer Buffer, aligned to alignof(std::max_align_t)
+     * @param size Buffer size in bytes
+     */
+    CycleArena(void* buffer, size_t size);
+
+    /**
+     * @brief Constructor, allocates the buffer once
+     * @param capacity Buffer size in bytes
+     */
+    explicit CycleArena(size_t capacity);
+
+    ~CycleArena();
+
+    CycleArena(const CycleArena&) = delete;
+    CycleArena& operator=(const CycleArena&) = delete;
+
+    //---------- Allocation ----------//
+
+    /**
+     * @brief Allocate memory
+     * @param bytes Size in bytes
+     * @param alignment Required alignment, a power of two
+     * @return Memory, from the heap if the buffer is full
+     */
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Free memory
+     *
+     * Heap fallbacks are freed; arena memory is reclaimed only if it was
+     * the most recent allocation.
+     *
+     * @param ptr Memory from allocate()
+     * @param bytes Size passed to allocate()
+     */
+    void deallocate(void* ptr, size_t bytes);
+
+    /**
+     * @brief Release every arena allocation at once
+     */
+    void reset();
+
+    /**
+     * @brief Get current position, for a later rewind()
+     * @return Bytes in use
+     */
+    size_t mark() const;
+
+    /**
+     * @brief Release the allocations made since a mark
+     * @param mark Value returned by mark()
+     */
+    void rewind(size_t mark);
+
+    //---------- Statistics ----------//
+
+    /**
+     * @brief Get bytes in use
+     * @return Bytes in use, including alignment padding
+     */
+    size_t used() const;
+
+    /**
+     * @brief Get buffer size
+     * @return Capacity in bytes
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Get highest use since construction
+     * @return Bytes
+     */
+    size_t highWater() const;
+
+    /**
+     * @brief Get allocations that did not fit and went to the heap
+     * @return Overflow count
+     */
+    uint32_t overflows() const;
+
+private:
+    bool owns(const void* ptr) const;
+
+private:
+    uint8_t* buffer_;           ///< Arena memory
+    size_t capacity_;           ///< Buffer size
+    size_t offset_{0};          ///< First free byte
+    size_t highWater_{0};       ///< Highest offset seen
+    uint32_t overflows_{0};     ///< Heap fallbacks
+    bool ownsBuffer_;           ///< Buffer was allocated by the arena
+};
+
+/**
+ * @brief Standard allocator drawing from a CycleArena
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    /**
+     * @brief Constructor
+     * @param arena Arena to allocate from
+     */
+    explicit ArenaAllocator(CycleArena& arena) noexcept : arena_(&arena) {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {
+    }
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept {
+        arena_->deallocate(ptr, count * sizeof(T));
+    }
+
+    /**
+     * @brief Get arena
+     * @return Arena this allocator draws from
+     */
+    CycleArena* arena() const noexcept {
+        return arena_;
+    }
+
+private:
+    CycleArena* arena_;     ///< Arena
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+    return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+    return a.arena() != b.arena();
+}
+
+/**
+ * @brief Vector whose storage comes from a CycleArena
+ */
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace sensors
@@ -0,0 +1,193 @@
+#include "latency_trace.hpp"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+namespace sensors {
+
+thread_local SensorTrace* TraceScope::current_ = nullptr;
+thread_local SensorTrace* TraceScope::scoped_ = nullptr;
+
+namespace {
+
+const char* const STAGE_NAMES[TRACE_STAGE_COUNT] = {
+    "bus", "decode", "calibrate", "filter", "encode", "publish"
+};
+
+// Smallest value with at least the given share of samples at or below it
+uint32_t percentile(const std::array<uint32_t, LatencyHistogram::BUCKET_COUNT>& counts,
+                    uint32_t total, uint32_t permille) {
+    uint64_t rank = (static_cast<uint64_t>(total) * permille + 999) / 1000;
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return LatencyHistogram::bucketUpperBound(i);
+        }
+    }
+    return LatencyHistogram::bucketUpperBound(counts.size() - 1);
+}
+
+void append(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+void append(std::string& out, const char* format, ...) {
+    char buffer[128];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length > 0) {
+        out.append(buffer, std::min<size_t>(length, sizeof(buffer) - 1));
+    }
+}
+
+} // namespace
+
+const char* traceStageName(TraceStage stage) {
+    size_t index = static_cast<size_t>(stage);
+    return index < TRACE_STAGE_COUNT ? STAGE_NAMES[index] : "unknown";
+}
+
+//---------- LatencyHistogram ----------//
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+LatencySummary LatencyHistogram::summarize() const {
+    LatencySummary summary;
+
+    // Totals come from the copied buckets so percentiles stay consistent
+    std::array<uint32_t, BUCKET_COUNT> counts;
+    uint32_t total = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] = counts_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return summary;
+    }
+
+    summary.count = total;
+    summary.min = min_.load(std::memory_order_relaxed);
+    summary.max = max_.load(std::memory_order_relaxed);
+    summary.p50 = std::min(percentile(counts, total, 500), summary.max);
+    summary.p90 = std::min(percentile(counts, total, 900), summary.max);
+    summary.p99 = std::min(percentile(counts, total, 990), summary.max);
+    return summary;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& count : counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    min_.store(UINT32_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < LINEAR_LIMIT) {
+        return static_cast<uint32_t>(index);
+    }
+    if (index >= BUCKET_COUNT - 1) {
+        return UINT32_MAX;
+    }
+
+    size_t offset = index - LINEAR_LIMIT;
+    uint32_t shift = static_cast<uint32_t>(offset / SUB_BUCKETS) + 1;
+    uint32_t lower = (SUB_BUCKETS + static_cast<uint32_t>(offset % SUB_BUCKETS)) << shift;
+    return lower + (1u << shift) - 1;
+}
+
+//---------- LatencyTracer ----------//
+
+LatencyTracer::LatencyTracer(TraceClock clock, uint32_t sampleInterval)
+    : clock_(clock), sampleInterval_(sampleInterval > 0 ? sampleInterval : 1) {
+}
+
+SensorTrace* LatencyTracer::sensor(const std::string& sensorId) {
+    std::lock_guard<std::mutex> lock(tracerMutex_);
+
+    auto it = index_.find(sensorId);
+    if (it != index_.end()) {
+        return it->second;
+    }
+
+    traces_.emplace_back();
+    SensorTrace* trace = &traces_.back();
+    trace->sensorId = sensorId;
+    trace->clock = clock_;
+    trace->sampleInterval = sampleInterval_;
+    index_.emplace(sensorId, trace);
+    return trace;
+}
+
+size_t LatencyTracer::size() const {
+    std::lock_guard<std::mutex> lock(tracerMutex_);
+    return traces_.size();
+}
+
+std::vector<SensorLatencySnapshot> LatencyTracer::snapshot(bool reset) {
+    std::lock_guard<std::mutex> lock(tracerMutex_);
+
+    std::vector<SensorLatencySnapshot> snapshots;
+    snapshots.reserve(traces_.size());
+    for (auto& trace : traces_) {
+        SensorLatencySnapshot snapshot;
+        snapshot.sensorId = trace.sensorId;
+        for (size_t stage = 0; stage < TRACE_STAGE_COUNT; stage++) {
+            snapshot.stages[stage] = trace.stages[stage].summarize();
+            if (reset) {
+                trace.stages[stage].reset();
+            }
+        }
+        snapshots.push_back(std::move(snapshot));
+    }
+    return snapshots;
+}
+
+void LatencyTracer::formatJson(const std::vector<SensorLatencySnapshot>& snapshots, std::string& out) {
+    out = "{";
+    bool firstSensor = true;
+    for (const auto& snapshot : snapshots) {
+        append(out, "%s\"%s\":{", firstSensor ? "" : ",", snapshot.sensorId.c_str());
+        firstSensor = false;
+
+        bool firstStage = true;
+        for (size_t stage = 0; stage < TRACE_STAGE_COUNT; stage++) {
+            const LatencySummary& summary = snapshot.stages[stage];
+            if (summary.count == 0) continue;
+
+            append(out, "%s\"%s\":{\"n\":%u,\"min\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}",
+                   firstStage ? "" : ",", STAGE_NAMES[stage],
+                   static_cast<unsigned>(summary.count), static_cast<unsigned>(summary.min),
+                   static_cast<unsigned>(summary.p50), static_cast<unsigned>(summary.p90),
+                   static_cast<unsigned>(summary.p99), static_cast<unsigned>(summary.max));
+            firstStage = false;
+        }
+        out += "}";
+    }
+    out += "}";
+}
+
+void LatencyTracer::formatText(const std::vector<SensorLatencySnapshot>& snapshots, std::string& out) {
+    out.clear();
+    append(out, "%-24s %-10s %8s %8s %8s %8s %8s %8s\n",
+           "sensor", "stage", "n", "min", "p50", "p90", "p99", "max");
+    for (const auto& snapshot : snapshots) {
+        for (size_t stage = 0; stage < TRACE_STAGE_COUNT; stage++) {
+            const LatencySummary& summary = snapshot.stages[stage];
+            if (summary.count == 0) continue;
+
+            append(out, "%-24.24s %-10s %8u %8u %8u %8u %8u %8u\n",
+                   snapshot.sensorId.c_str(), STAGE_NAMES[stage],
+                   static_cast<unsigned>(summary.count), static_cast<unsigned>(summary.min),
+                   static_cast<unsigned>(summary.p50), static_cast<unsigned>(summary.p90),
+                   static_cast<unsigned>(summary.p99), static_cast<unsigned>(summary.max));
+        }
+    }
+}
+
+} // namespace sensors
@@ -0,0 +1,380 @@
+/**
+ * @file latency_trace.hpp
+ * @brief Per-stage latency histograms for the reading path
+ *
+ * This file defines the LatencyHistogram and LatencyTracer classes and the
+ * SENSORHUB_TRACE_* macros, which time each stage a reading passes through
+ * (bus transfer, decode, calibrate, filter, encode, publish) per sensor.
+ * Building with SENSORHUB_TRACING=0 removes every timer from the code.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef SENSORHUB_TRACING
+#define SENSORHUB_TRACING 1     ///< Set to 0 to compile the stage timers out
+#endif
+
+namespace sensors {
+
+/**
+ * @brief Reading path stage
+ */
+enum class TraceStage : uint8_t {
+    BUS_TRANSFER = 0,   ///< Talking to the sensor on its bus
+    DECODE = 1,         ///< Checking and unpacking the raw frame
+    CALIBRATE = 2,      ///< Raw to calibrated value
+    FILTER = 3,         ///< Selecting the sinks that want the reading
+    ENCODE = 4,         ///< Encoding the reading for the wire
+    PUBLISH = 5         ///< Handing the payload to the sinks
+};
+
+const size_t TRACE_STAGE_COUNT = 6;     ///< Number of trace stages
+
+/**
+ * @brief Get short stage name, as used in reports
+ * @param stage Trace stage
+ * @return Stage name
+ */
+const char* traceStageName(TraceStage stage);
+
+/**
+ * @brief Type definition for the trace clock
+ *
+ * Returns a free-running microsecond counter, normally IHAL::micros().
+ */
+using TraceClock = uint32_t (*)();
+
+/**
+ * @brief Histogram summary
+ */
+struct LatencySummary {
+    uint32_t count{0};      ///< Samples recorded
+    uint32_t min{0};        ///< Smallest sample (us)
+    uint32_t p50{0};        ///< Median (us)
+    uint32_t p90{0};        ///< 90th percentile (us)
+    uint32_t p99{0};        ///< 99th percentile (us)
+    uint32_t max{0};        ///< Largest sample (us)
+};
+
+/**
+ * @brief Log-bucketed latency histogram
+ *
+ * Values below 16 us get a bucket each; above that every power of two is
+ * split into eight buckets, so a percentile is reported as the upper bound
+ * of its bucket, at most 12.5% above the true value. Values from 2^24 us
+ * (about 16 s) share the last bucket; min and max are exact. Bucket counts
+ * are 16 bits and stop at 65535, so long-running histograms should be
+ * reset periodically (see LatencyTracer::snapshot()).
+ *
+ * One thread records into a histogram at a time. summarize() may run on
+ * another thread and then sees a sample that is mid-update as missing.
+ */
+class LatencyHistogram {
+public:
+    static const uint32_t SUB_BUCKET_BITS = 3;                          ///< log2 of buckets per power of two
+    static const uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;          ///< Buckets per power of two
+    static const uint32_t LINEAR_LIMIT = 2 * SUB_BUCKETS;               ///< Values below this are exact
+    static const uint32_t MAX_EXPONENT = 24;                            ///< Values from 2^MAX_EXPONENT are clamped
+    static const size_t BUCKET_COUNT =
+        LINEAR_LIMIT + (MAX_EXPONENT - SUB_BUCKET_BITS - 1) * SUB_BUCKETS;  ///< Number of buckets
+
+    LatencyHistogram();
+
+    /**
+     * @brief Record a sample
+     * @param us Latency (us)
+     */
+    void record(uint32_t us) {
+        auto& bucket = counts_[bucketIndex(us)];
+        uint16_t count = bucket.load(std::memory_order_relaxed);
+        if (count != UINT16_MAX) bucket.store(count + 1, std::memory_order_relaxed);
+        if (us < min_.load(std::memory_order_relaxed)) min_.store(us, std::memory_order_relaxed);
+        if (us > max_.load(std::memory_order_relaxed)) max_.store(us, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Summarize the recorded samples
+     * @return Count, percentiles and extremes; all zero if empty
+     */
+    LatencySummary summarize() const;
+
+    /**
+     * @brief Discard all samples
+     */
+    void reset();
+
+    /**
+     * @brief Get bucket of a value
+     * @param us Value (us)
+     * @return Bucket index
+     */
+    static size_t bucketIndex(uint32_t us) {
+        if (us < LINEAR_LIMIT) return us;
+
+        uint32_t exponent = 31 - __builtin_clz(us);
+        if (exponent >= MAX_EXPONENT) return BUCKET_COUNT - 1;
+
+        uint32_t shift = exponent - SUB_BUCKET_BITS;
+        return LINEAR_LIMIT + (exponent - SUB_BUCKET_BITS - 1) * SUB_BUCKETS +
+               ((us >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    /**
+     * @brief Get largest value that falls into a bucket
+     * @param index Bucket index
+     * @return Upper bound (us)
+     */
+    static uint32_t bucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint16_t>, BUCKET_COUNT> counts_;   ///< Samples per bucket
+    std::atomic<uint32_t> min_{UINT32_MAX};                    ///< Smallest sample (us)
+    std::atomic<uint32_t> max_{0};                             ///< Largest sample (us)
+};
+
+/**
+ * @brief Stage histograms of one sensor
+ */
+struct SensorTrace {
+    std::string sensorId;                                       ///< Sensor ID
+    TraceClock clock{nullptr};                                  ///< Clock used by the stage timers
+    uint32_t sampleInterval{1};                                 ///< Readings per traced reading
+    std::atomic<uint32_t> untilSample{0};                       ///< Readings left before the next traced one
+    std::array<LatencyHistogram, TRACE_STAGE_COUNT> stages;     ///< Histogram per stage
+
+    /**
+     * @brief Decide whether the next reading is traced
+     * @return True for one reading in sampleInterval
+     */
+    bool sample() {
+        uint32_t left = untilSample.load(std::memory_order_relaxed);
+        if (left > 0) {
+            untilSample.store(left - 1, std::memory_order_relaxed);
+            return false;
+        }
+        untilSample.store(sampleInterval - 1, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+/**
+ * @brief Stage summaries of one sensor
+ */
+struct SensorLatencySnapshot {
+    std::string sensorId;                                       ///< Sensor ID
+    std::array<LatencySummary, TRACE_STAGE_COUNT> stages;       ///< Summary per stage
+};
+
+/**
+ * @brief Per-sensor latency histograms
+ *
+ * Holds a SensorTrace for every sensor that has been traced. Trace objects
+ * are never freed, so pointers returned by sensor() stay valid for the
+ * lifetime of the tracer. sensor() locks and looks the ID up, so callers
+ * resolve a sensor's trace once when it is registered and carry the
+ * pointer (see SensorReading::trace) instead of calling it per reading.
+ */
+class LatencyTracer {
+public:
+    /**
+     * @brief Constructor
+     *
+     * Each stage boundary costs a clock read. On a fast path such as
+     * PublishBus::publish() that is a noticeable share of the work, so the
+     * tracer can trace only one reading in sampleInterval per sensor.
+     *
+     * @param clock Microsecond clock for the stage timers
+     * @param sampleInterval Readings per traced reading, 1 to trace every reading
+     */
+    explicit LatencyTracer(TraceClock clock, uint32_t sampleInterval = 1);
+
+    /**
+     * @brief Get trace of a sensor, adding it on first use
+     * @param sensorId Sensor ID
+     * @return Sensor trace
+     */
+    SensorTrace* sensor(const std::string& sensorId);
+
+    /**
+     * @brief Get number of traced sensors
+     * @return Sensor count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Summarize every sensor's histograms
+     * @param reset Discard the samples after summarizing them
+     * @return Snapshot per sensor, in the order sensors were first traced
+     */
+    std::vector<SensorLatencySnapshot> snapshot(bool reset = false);
+
+    //---------- Reporting ----------//
+
+    /**
+     * @brief Format snapshots as the MQTT diagnostics payload
+     *
+     * {"sensor_id":{"bus":{"n":12,"min":..,"p50":..,"p90":..,"p99":..,"max":..},..},..}
+     * Stages without samples are left out.
+     *
+     * @param snapshots Sensor snapshots
+     * @param out Output payload
+     */
+    static void formatJson(const std::vector<SensorLatencySnapshot>& snapshots, std::string& out);
+
+    /**
+     * @brief Format snapshots as a table for the serial console
+     * @param snapshots Sensor snapshots
+     * @param out Output text, one line per sensor and stage
+     */
+    static void formatText(const std::vector<SensorLatencySnapshot>& snapshots, std::string& out);
+
+private:
+    TraceClock clock_;                                          ///< Clock handed to new traces
+    uint32_t sampleInterval_;                                   ///< Sample interval handed to new traces
+    std::deque<SensorTrace> traces_;                            ///< Traces, address-stable
+    std::unordered_map<std::string, SensorTrace*> index_;       ///< Trace by sensor ID
+    mutable std::mutex tracerMutex_;                            ///< Mutex for thread safety
+};
+
+/**
+ * @brief Makes a sensor's trace current for the calling thread
+ *
+ * Stage timers record into the current trace; outside any scope they do
+ * nothing. Opening a scope counts a reading of the sensor, and readings the
+ * trace does not sample run without a current trace. Scopes nest and
+ * restore the previous trace when they end; a scope nested in one for the
+ * same sensor belongs to the same reading and keeps its sampling decision.
+ */
+class TraceScope {
+public:
+    /**
+     * @brief Constructor, makes the trace current if it samples this reading
+     * @param trace Sensor trace, nullptr to suspend tracing
+     */
+    explicit TraceScope(SensorTrace* trace) : previous_(current_), previousScoped_(scoped_) {
+        if (trace != scoped_) {
+            current_ = trace && trace->sample() ? trace : nullptr;
+            scoped_ = trace;
+        }
+    }
+
+    ~TraceScope() {
+        current_ = previous_;
+        scoped_ = previousScoped_;
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    /**
+     * @brief Get current trace of the calling thread
+     * @return Sensor trace, nullptr outside any scope
+     */
+    static SensorTrace* current() {
+        return current_;
+    }
+
+private:
+    SensorTrace* previous_;                     ///< Trace current before this scope
+    SensorTrace* previousScoped_;               ///< Trace scoped before this scope
+    static thread_local SensorTrace* current_;  ///< Current trace of this thread, nullptr if not sampled
+    static thread_local SensorTrace* scoped_;   ///< Trace of the innermost scope, sampled or not
+};
+
+/**
+ * @brief Records the lifetime of a block into a stage of the current trace
+ */
+class StageTimer {
+public:
+    /**
+     * @brief Constructor, starts timing
+     * @param stage Trace stage
+     */
+    explicit StageTimer(TraceStage stage)
+        : trace_(TraceScope::current()), stage_(stage), start_(trace_ ? trace_->clock() : 0) {
+    }
+
+    ~StageTimer() {
+        if (trace_) {
+            trace_->stages[static_cast<size_t>(stage_)].record(trace_->clock() - start_);
+        }
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    SensorTrace* trace_;        ///< Trace to record into, nullptr if none
+    TraceStage stage_;          ///< Stage being timed
+    uint32_t start_;            ///< Start time (us)
+};
+
+/**
+ * @brief Times back-to-back stages of the current trace
+ *
+ * Each split records the time since the previous split (or construction)
+ * into a stage, so N adjacent stages cost N + 1 clock reads instead of 2N.
+ */
+class StageSplitTimer {
+public:
+    /**
+     * @brief Constructor, starts timing the first stage
+     */
+    StageSplitTimer() : trace_(TraceScope::current()), mark_(trace_ ? trace_->clock() : 0) {
+    }
+
+    /**
+     * @brief End the running stage and start the next one
+     * @param stage Stage that just ended
+     */
+    void split(TraceStage stage) {
+        if (trace_) {
+            uint32_t now = trace_->clock();
+            trace_->stages[static_cast<size_t>(stage)].record(now - mark_);
+            mark_ = now;
+        }
+    }
+
+    StageSplitTimer(const StageSplitTimer&) = delete;
+    StageSplitTimer& operator=(const StageSplitTimer&) = delete;
+
+private:
+    SensorTrace* trace_;        ///< Trace to record into, nullptr if none
+    uint32_t mark_;             ///< End of the previous stage (us)
+};
+
+} // namespace sensors
+
+#if SENSORHUB_TRACING
+#define SENSORHUB_TRACE_CONCAT_(a, b) a##b
+#define SENSORHUB_TRACE_NAME_(line) SENSORHUB_TRACE_CONCAT_(sensorhubTrace_, line)
+
+/// Trace the rest of the enclosing block into a SensorTrace resolved beforehand
+#define SENSORHUB_TRACE_SCOPE(trace) \
+    ::sensors::TraceScope SENSORHUB_TRACE_NAME_(__LINE__)(trace)
+
+/// Time the rest of the enclosing block as the given TraceStage
+#define SENSORHUB_TRACE_STAGE(stage) \
+    ::sensors::StageTimer SENSORHUB_TRACE_NAME_(__LINE__)(::sensors::TraceStage::stage)
+
+/// Start a split timer for back-to-back stages
+#define SENSORHUB_TRACE_SPLITS(splits) ::sensors::StageSplitTimer splits
+
+/// Record the time since the last split as the given TraceStage
+#define SENSORHUB_TRACE_SPLIT(splits, stage) (splits).split(::sensors::TraceStage::stage)
+#else
+#define SENSORHUB_TRACE_SCOPE(trace) ((void)0)
+#define SENSORHUB_TRACE_STAGE(stage) ((void)0)
+#define SENSORHUB_TRACE_SPLITS(splits) ((void)0)
+#define SENSORHUB_TRACE_SPLIT(splits, stage) ((void)0)
+#endif
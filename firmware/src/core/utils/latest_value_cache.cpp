@@ -0,0 +1,159 @@
+#include "latest_value_cache.hpp"
+#include <cstring>
+#include <thread>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+namespace sensors {
+
+namespace {
+
+const uint32_t SPINS_BEFORE_BACKOFF = 16;   // Retries before giving the CPU to a preempted writer
+const uint32_t MAX_BACKOFFS = 4;            // Backoffs before a busy slot is reported as unavailable
+
+// Payload word offsets
+const size_t VALUE_WORD = 0;
+const size_t RAW_VALUE_WORD = 2;
+const size_t TIMESTAMP_WORD = 4;
+const size_t UPDATED_AT_WORD = 6;
+const size_t VALID_WORD = 7;
+
+template <typename T>
+void storeWords(std::atomic<uint32_t>* words, T value) {
+    static_assert(sizeof(T) == 2 * sizeof(uint32_t), "Two-word field");
+    uint32_t parts[2];
+    std::memcpy(parts, &value, sizeof(parts));
+    words[0].store(parts[0], std::memory_order_relaxed);
+    words[1].store(parts[1], std::memory_order_relaxed);
+}
+
+template <typename T>
+T loadWords(const std::atomic<uint32_t>* words) {
+    uint32_t parts[2] = {
+        words[0].load(std::memory_order_relaxed),
+        words[1].load(std::memory_order_relaxed)
+    };
+    T value;
+    std::memcpy(&value, parts, sizeof(value));
+    return value;
+}
+
+// Let a writer that this task preempted finish. A FreeRTOS task has to block
+// for that, as yielding only hands the CPU to tasks of equal priority.
+void backOff() {
+#ifdef ESP_PLATFORM
+    vTaskDelay(1);
+#else
+    std::this_thread::yield();
+#endif
+}
+
+} // namespace
+
+LatestValueCache::LatestValueCache(size_t capacity)
+    : capacity_(capacity), slots_(new Slot[capacity]()) {
+    handles_.reserve(capacity);
+}
+
+int LatestValueCache::registerSensor(const std::string& sensorId) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    auto it = handles_.find(sensorId);
+    if (it != handles_.end()) return it->second;
+
+    size_t count = count_.load(std::memory_order_relaxed);
+    if (count >= capacity_) return INVALID_HANDLE;
+
+    int handle = static_cast<int>(count);
+    handles_.emplace(sensorId, handle);
+    count_.store(count + 1, std::memory_order_release);
+    return handle;
+}
+
+int LatestValueCache::findHandle(const std::string& sensorId) const {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    auto it = handles_.find(sensorId);
+    return it != handles_.end() ? it->second : INVALID_HANDLE;
+}
+
+size_t LatestValueCache::size() const {
+    return count_.load(std::memory_order_acquire);
+}
+
+bool LatestValueCache::update(int handle, const SensorReading& reading, uint32_t now) {
+    if (handle < 0 || static_cast<size_t>(handle) >= size()) return false;
+    Slot& slot = slots_[handle];
+
+    // Take the slot: move the counter from even to odd
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    for (uint32_t spins = 0;; spins++) {
+        if ((sequence & 1) == 0 &&
+            slot.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) {
+            break;
+        }
+        if (spins >= SPINS_BEFORE_BACKOFF + MAX_BACKOFFS) {
+            busyFailures_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (spins >= SPINS_BEFORE_BACKOFF) backOff();
+        sequence = slot.sequence.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    storeWords(&slot.payload[VALUE_WORD], reading.value);
+    storeWords(&slot.payload[RAW_VALUE_WORD], reading.rawValue);
+    storeWords(&slot.payload[TIMESTAMP_WORD], reading.timestamp);
+    slot.payload[UPDATED_AT_WORD].store(now, std::memory_order_relaxed);
+    slot.payload[VALID_WORD].store(reading.isValid ? 1 : 0, std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+bool LatestValueCache::read(int handle, CachedReading& out) const {
+    if (handle < 0 || static_cast<size_t>(handle) >= size()) return false;
+    const Slot& slot = slots_[handle];
+
+    for (uint32_t spins = 0;; spins++) {
+        uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            CachedReading snapshot;
+            snapshot.value = loadWords<double>(&slot.payload[VALUE_WORD]);
+            snapshot.rawValue = loadWords<double>(&slot.payload[RAW_VALUE_WORD]);
+            snapshot.timestamp = loadWords<int64_t>(&slot.payload[TIMESTAMP_WORD]);
+            snapshot.updatedAt = slot.payload[UPDATED_AT_WORD].load(std::memory_order_relaxed);
+            snapshot.isValid = slot.payload[VALID_WORD].load(std::memory_order_relaxed) != 0;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                if (before == 0) return false;
+                snapshot.sequence = before / 2;
+                out = snapshot;
+                return true;
+            }
+        }
+
+        if (spins >= SPINS_BEFORE_BACKOFF + MAX_BACKOFFS) {
+            busyFailures_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        readRetries_.fetch_add(1, std::memory_order_relaxed);
+        if (spins >= SPINS_BEFORE_BACKOFF) backOff();
+    }
+}
+
+uint32_t LatestValueCache::getReadRetries() const {
+    return readRetries_.load(std::memory_order_relaxed);
+}
+
+uint32_t LatestValueCache::getBusyFailures() const {
+    return busyFailures_.load(std::memory_order_relaxed);
+}
+
+uint32_t LatestValueCache::getRefreshes() const {
+    return refreshes_.load(std::memory_order_relaxed);
+}
+
+} // namespace sensors
@@ -0,0 +1,197 @@
+/**
+ * @file latest_value_cache.hpp
+ * @brief Lock-free cache of each sensor's most recent value
+ *
+ * This file defines the LatestValueCache class, which keeps the last
+ * reading of every sensor in a slot protected by a sequence lock. The
+ * acquisition loop writes the slots; MQTT and BLE handlers, rules and
+ * compensation read them without locks and without touching the bus.
+ */
+
+#pragma once
+
+#include "../sensor_types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace sensors {
+
+/**
+ * @brief Snapshot of a cache slot
+ */
+struct CachedReading {
+    double value{0.0};          ///< Processed/calibrated value
+    double rawValue{0.0};       ///< Raw value before processing
+    int64_t timestamp{0};       ///< Timestamp of the reading in milliseconds
+    uint32_t updatedAt{0};      ///< Time the slot was written (ms since startup)
+    uint32_t sequence{0};       ///< Number of writes to the slot, 0 if never written
+    bool isValid{false};        ///< Validity flag of the reading
+};
+
+/**
+ * @brief Per-sensor latest values behind sequence locks
+ *
+ * Each slot has a sequence counter that is odd while the slot is being
+ * written. A reader copies the slot between two loads of the counter and
+ * retries if the counter was odd or changed, so readers never block the
+ * writer or each other. A writer takes the slot by moving the counter to
+ * odd with a compare-and-swap; normally the acquisition loop is the only
+ * writer, but a stale-value refresh from another task may write too. Both
+ * sides back off after a few spins (vTaskDelay(1) on FreeRTOS, so that a
+ * higher-priority task that preempted a writer on the same core lets it
+ * finish) and give up after a few backoffs: read() then reports the slot as
+ * unavailable and update() as not stored. The payload is stored as 32-bit
+ * atomic words, which are lock-free on every target, including those
+ * without 64-bit atomics.
+ *
+ * Slots are allocated once for a fixed capacity; registerSensor() assigns
+ * them and is the only call that locks.
+ */
+class LatestValueCache {
+public:
+    static const int INVALID_HANDLE = -1;   ///< Handle of an unregistered sensor
+
+    /**
+     * @brief Constructor
+     * @param capacity Maximum number of sensors
+     */
+    explicit LatestValueCache(size_t capacity = 64);
+
+    LatestValueCache(const LatestValueCache&) = delete;
+    LatestValueCache& operator=(const LatestValueCache&) = delete;
+
+    //---------- Registry ----------//
+
+    /**
+     * @brief Assign a slot to a sensor
+     * @param sensorId Sensor ID
+     * @return Sensor handle (the existing one if already registered), or
+     *         INVALID_HANDLE if the cache is full
+     */
+    int registerSensor(const std::string& sensorId);
+
+    /**
+     * @brief Find sensor handle
+     * @param sensorId Sensor ID
+     * @return Sensor handle, or INVALID_HANDLE if not registered
+     */
+    int findHandle(const std::string& sensorId) const;
+
+    /**
+     * @brief Get number of registered sensors
+     * @return Sensor count
+     */
+    size_t size() const;
+
+    //---------- Values ----------//
+
+    /**
+     * @brief Store a reading
+     * @param handle Sensor handle
+     * @param reading Reading to store
+     * @param now Current time (ms since startup)
+     * @return True if stored, false if the handle is invalid or another
+     *         writer kept the slot past the retry limit
+     */
+    bool update(int handle, const SensorReading& reading, uint32_t now);
+
+    /**
+     * @brief Copy the latest value without locking
+     * @param handle Sensor handle
+     * @param out Snapshot to fill
+     * @return True if the slot holds a value, false if the handle is
+     *         invalid, nothing was stored yet, or a writer kept the slot
+     *         past the retry limit (out is left unchanged)
+     */
+    bool read(int handle, CachedReading& out) const;
+
+    /**
+     * @brief Latest value, refreshed if it is too old
+     *
+     * Returns the cached value if it is at most maxAge old. Otherwise
+     * fresh() performs a hardware read; its reading is stored and
+     * returned. A failed fresh read returns the stale value with isValid
+     * false, and leaves the slot as it was.
+     *
+     * @param handle Sensor handle
+     * @param now Current time (ms since startup)
+     * @param maxAge Oldest acceptable value (ms)
+     * @param fresh Callable returning a new SensorReading
+     * @return Snapshot, isValid false if no valid value could be had
+     */
+    template <typename ReadFunction>
+    CachedReading readOrRefresh(int handle, uint32_t now, uint32_t maxAge, ReadFunction&& fresh) {
+        CachedReading cached;
+        if (read(handle, cached) && cached.isValid && now - cached.updatedAt <= maxAge) {
+            return cached;
+        }
+        if (handle < 0 || static_cast<size_t>(handle) >= size()) {
+            return cached;
+        }
+
+        refreshes_.fetch_add(1, std::memory_order_relaxed);
+        SensorReading reading = fresh();
+        if (!reading.isValid) {
+            cached.isValid = false;
+            return cached;
+        }
+
+        // A slot still busy with another writer still gets the fresh value handed out
+        if (!update(handle, reading, now) || !read(handle, cached)) {
+            cached.value = reading.value;
+            cached.rawValue = reading.rawValue;
+            cached.timestamp = reading.timestamp;
+            cached.updatedAt = now;
+            cached.isValid = true;
+        }
+        return cached;
+    }
+
+    //---------- Statistics ----------//
+
+    /**
+     * @brief Get number of reads that raced a write and retried
+     * @return Retry count
+     */
+    uint32_t getReadRetries() const;
+
+    /**
+     * @brief Get number of reads and writes that gave up on a busy slot
+     * @return Failure count
+     */
+    uint32_t getBusyFailures() const;
+
+    /**
+     * @brief Get number of stale values refreshed by readOrRefresh()
+     * @return Refresh count
+     */
+    uint32_t getRefreshes() const;
+
+private:
+    static const size_t PAYLOAD_WORDS = 8;  ///< value, rawValue, timestamp (2 words each), updatedAt, validity
+
+    /**
+     * @brief Sequence-locked slot, on its own cache line
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> sequence{0};                      ///< Odd while being written
+        std::atomic<uint32_t> payload[PAYLOAD_WORDS];           ///< Reading fields as words
+    };
+
+private:
+    size_t capacity_;                                       ///< Number of slots
+    std::unique_ptr<Slot[]> slots_;                         ///< Slots, never reallocated
+    std::atomic<size_t> count_{0};                          ///< Registered sensors
+    std::unordered_map<std::string, int> handles_;          ///< Handle by sensor ID
+    mutable std::mutex registryMutex_;                      ///< Mutex for the registry
+    mutable std::atomic<uint32_t> readRetries_{0};          ///< Reads that raced a write
+    mutable std::atomic<uint32_t> busyFailures_{0};         ///< Reads and writes that gave up on a busy slot
+    std::atomic<uint32_t> refreshes_{0};                    ///< Hardware reads made by readOrRefresh()
+};
+
+} // namespace sensors
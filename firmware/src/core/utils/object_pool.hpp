@@ -0,0 +1,161 @@
+/**
+ * @file object_pool.hpp
+ * @brief Fixed-size pools for readings and outbound frames
+ *
+ * This file defines the ObjectPool and SharedPool class templates, which
+ * hand out a fixed set of preallocated objects again and again. Pooled
+ * objects keep their string and container capacity between uses, so a
+ * steady stream of readings or frames stops allocating once the pool has
+ * warmed up.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace sensors {
+
+/**
+ * @brief Pool of N exclusively owned objects
+ *
+ * acquire() returns an object as it was last released, not a freshly
+ * constructed one; the caller overwrites the fields it uses. When all N
+ * objects are out, acquire() returns an empty handle and counts a miss.
+ */
+template <typename T, size_t N>
+class ObjectPool {
+public:
+    /**
+     * @brief Returns an object to its pool
+     */
+    class Releaser {
+    public:
+        Releaser() = default;
+        explicit Releaser(ObjectPool* pool) : pool_(pool) {
+        }
+
+        void operator()(T* object) const {
+            if (pool_) pool_->release(object);
+        }
+
+    private:
+        ObjectPool* pool_{nullptr};     ///< Owning pool
+    };
+
+    /**
+     * @brief Pooled object, returned to the pool when the handle goes away
+     */
+    using Handle = std::unique_ptr<T, Releaser>;
+
+    ObjectPool() {
+        for (size_t i = 0; i < N; i++) {
+            free_[i] = &objects_[N - 1 - i];
+        }
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    /**
+     * @brief Take an object from the pool
+     * @return Handle, empty if the pool is exhausted
+     */
+    Handle acquire() {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        if (freeCount_ == 0) {
+            misses_++;
+            return Handle(nullptr, Releaser(this));
+        }
+        return Handle(free_[--freeCount_], Releaser(this));
+    }
+
+    /**
+     * @brief Get number of objects in the pool
+     * @return Objects not handed out
+     */
+    size_t available() const {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        return freeCount_;
+    }
+
+    /**
+     * @brief Get number of acquire() calls that found the pool empty
+     * @return Miss count
+     */
+    uint32_t misses() const {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        return misses_;
+    }
+
+private:
+    void release(T* object) {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        free_[freeCount_++] = object;
+    }
+
+private:
+    std::array<T, N> objects_;              ///< Pooled objects
+    std::array<T*, N> free_;                ///< Objects not handed out
+    size_t freeCount_{N};                   ///< Entries in free_
+    uint32_t misses_{0};                    ///< Failed acquisitions
+    mutable std::mutex poolMutex_;          ///< Mutex for thread safety
+};
+
+/**
+ * @brief Pool of N reference-counted objects
+ *
+ * For buffers that several consumers share, such as an encoded frame handed
+ * to every sink. acquire() returns a pooled object that nobody else holds
+ * any more, so sinks may keep the pointer as long as they like; the object
+ * becomes available again once the last copy is dropped. Objects are
+ * created on first use. When every pooled object is still held, acquire()
+ * returns a new, unpooled one and counts a miss.
+ */
+template <typename T, size_t N>
+class SharedPool {
+public:
+    SharedPool() = default;
+
+    SharedPool(const SharedPool&) = delete;
+    SharedPool& operator=(const SharedPool&) = delete;
+
+    /**
+     * @brief Take an object nobody else holds
+     * @return Shared object, as it was last used
+     */
+    std::shared_ptr<T> acquire() {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        for (auto& object : objects_) {
+            if (!object) {
+                object = std::make_shared<T>();
+                return object;
+            }
+            // Only the pool can add references, so a count of 1 stays 1 under the lock
+            if (object.use_count() == 1) {
+                return object;
+            }
+        }
+        misses_++;
+        return std::make_shared<T>();
+    }
+
+    /**
+     * @brief Get number of acquire() calls that found every object held
+     * @return Miss count
+     */
+    uint32_t misses() const {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        return misses_;
+    }
+
+private:
+    std::array<std::shared_ptr<T>, N> objects_;     ///< Pooled objects
+    uint32_t misses_{0};                            ///< Acquisitions served outside the pool
+    mutable std::mutex poolMutex_;                  ///< Mutex for thread safety
+};
+
+} // namespace sensors
@@ -295,6 +295,12 @@ public:
      */
     virtual size_t getFreeHeap() = 0;
     
+    /**
+     * @brief Get largest heap block that can still be allocated
+     * @return Block size in bytes; much smaller than getFreeHeap() when fragmented
+     */
+    virtual size_t getLargestFreeBlock() = 0;
+    
     /**
      * @brief Get hardware ID (MAC address, chip ID, etc.)
      * @return Hardware ID as string
@@ -9,23 +9,47 @@
 
 #include "core/sensor_types.hpp"
 #include "core/isensor.hpp"
+#include "core/boot/boot_sequencer.hpp"
+#include "core/utils/latency_trace.hpp"
+#include "core/utils/alloc_tracker.hpp"
+#include "core/utils/object_pool.hpp"
 #include "hal/esp32_hal.hpp"
 #include "core/managers/sensor_manager/sensor_manager.hpp"
 #include "core/managers/calibration_manager/calibration_manager.hpp"
+#include "core/managers/calibration_manager/compensation_table.hpp"
 #include "core/managers/config_manager/config_manager.hpp"
+#include "core/managers/config_manager/config_store.hpp"
 #include "core/managers/protocol_manager/protocol_manager.hpp"
 #include "core/managers/discovery_manager/discovery_manager.hpp"
+#include "core/managers/discovery_manager/i2c_topology_scanner.hpp"
+#include "core/managers/discovery_manager/i2c_rediscovery.hpp"
 #include "communication/mqtt/mqtt_client.hpp"
+#include "communication/mqtt/mqtt_outbox.hpp"
+#include "communication/mqtt/topic_registry.hpp"
 #include "communication/ble/ble_manager.hpp"
 #include "communication/espnow/espnow_manager.hpp"
+#include "communication/espnow/espnow_frame.hpp"
+#include "communication/espnow/espnow_frame_receiver.hpp"
+#include "communication/gateway/publish_bus.hpp"
+#include "communication/gateway/command_parser.hpp"
 #include "communication/wireless/wireless_node_manager.hpp"
+#include "communication/wireless/async_node_requester.hpp"
+#include "communication/wireless/node_table.hpp"
+#include "communication/wireless/node_liveness.hpp"
+#include "communication/wireless/discovery_scheduler.hpp"
 #include "storage/nvs_storage.hpp"
+#include "storage/config_cache.hpp"
 #include <memory>
 #include <vector>
+#include <map>
+#include <set>
+#include <atomic>
+#include <mutex>
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <functional>
+#include <cstring>
 
 // Arduino includes
 #include <Arduino.h>
@@ -35,6 +59,7 @@
 #include <esp_task_wdt.h>
 #else
 #include <esp_system.h>
+#include <esp_now.h>
 #endif
 
 // Application constants
@@ -47,59 +72,281 @@ const char* MQTT_PASSWORD = "mqttpassword";
 const char* CONFIG_PATH = "/config";
 const char* PROTOCOL_PATH = "/protocols";
 const char* CALIBRATION_PATH = "/calibration";
+const char* CONFIG_CACHE_PATH = "/config.cache";
+const char* TOPOLOGY_PATH = "/i2c_topology.json";
+const char* MQTT_OUTBOX_PATH = "/mqtt_outbox.bin";
+const char* SPIFFS_MOUNT_POINT = "/spiffs";  // VFS prefix for stdio access to SPIFFS
+const uint32_t CONFIG_SAVE_DEBOUNCE = 2000; // ms
+const uint32_t CONFIG_SAVE_MAX_DELAY = 10000; // ms
 const int READING_INTERVAL = 5000; // ms
 const bool ENABLE_BLE = true;
 const bool ENABLE_MQTT = true;
 const bool ENABLE_ESPNOW = true;
+const bool ENABLE_ESPNOW_RELAY = true;     // Rebroadcast local readings to ESP-NOW peers
 const bool ENABLE_AUTO_DISCOVERY = true;
+const size_t BOOT_WORKER_COUNT = 3;          // Concurrent boot stages
+const size_t BOOT_WORKER_STACK_SIZE = 12288; // Bytes; stages parse JSON and start BLE and WiFi
+const std::vector<uint8_t> I2C_DISCOVERY_BUSES = {0, 1};
+const uint8_t REDISCOVERY_BUS_BUDGET = 2;     // % of I2C bus time for background rediscovery
+const uint32_t REDISCOVERY_INTERVAL = 30000;  // ms between rediscovery passes
+const uint32_t COMPANION_MAX_AGE = 10000;     // Oldest companion temperature used for compensation (ms)
+const uint32_t ESPNOW_RELAY_INTERVAL = 10000; // ms between relayed readings of one sensor
+const uint32_t ESPNOW_RELAY_ANNOUNCE_INTERVAL = 60000; // ms between relay channel table announcements
+const uint16_t ESPNOW_RELAY_HANDLE_BASE = 0x8000; // Relay handles; lower handles are assigned to local nodes
+const size_t MQTT_OUTBOX_RAM_LIMIT = 64;     // Messages held in RAM before spilling to flash
+const size_t MQTT_OUTBOX_SPOOL_LIMIT = 64 * 1024; // Bytes of spooled messages kept on flash
+const size_t MQTT_INFLIGHT_WINDOW = 8;       // Unacknowledged QoS 1 publishes
+const uint32_t MQTT_REPLAY_RATE = 20;        // Messages per second when draining a backlog
+const uint32_t NODE_POLL_INTERVAL = 5000;    // ms between wireless node polls
+const uint32_t NODE_REQUEST_TIMEOUT = 2000;  // ms before a node request is abandoned
+const size_t NODE_REQUEST_WINDOW = 8;        // Outstanding node requests per protocol
+const uint32_t NODE_HEARTBEAT_INTERVAL = 15000; // ms, for node types not listed below
+const uint8_t NODE_MISSED_HEARTBEATS = 3;    // Heartbeats missed before a node is disconnected
+const uint32_t DISCOVERY_MIN_INTERVAL = 30000;   // ms between discovery rounds after churn
+const uint32_t DISCOVERY_MAX_INTERVAL = 600000;  // ms between rounds once the node set is stable
+const uint32_t DISCOVERY_WINDOW = 1000;      // ms per scan window, interleaved with data traffic
+const uint32_t AIRTIME_REPORT_INTERVAL = 600000; // ms between airtime reports
+const uint32_t LATENCY_REPORT_INTERVAL = 60000; // ms between latency histogram exports
+const uint32_t LATENCY_SAMPLE_INTERVAL = 4;     // Readings per sensor for each traced one
+const char* LATENCY_TOPIC = "sensors/diagnostics/latency";
+const uint32_t HEAP_REPORT_INTERVAL = 60000; // ms between heap accounting exports
+const char* HEAP_TOPIC = "sensors/diagnostics/heap";
+const size_t NODE_READING_POOL_SIZE = 4;     // Pooled readings for wireless node reports, one per receiving task
+const std::vector<std::pair<std::string, uint32_t>> NODE_HEARTBEAT_INTERVALS = {
+    {"mains", 5000},                         // Mains-powered nodes report often
+    {"battery", 60000}                       // Battery nodes sleep between reports
+};
 
 // Global objects
 std::shared_ptr<hal::ESP32HAL> g_hal;
 std::shared_ptr<sensors::SensorManager> g_sensorManager;
 std::shared_ptr<sensors::CalibrationManager> g_calibrationManager;
+std::shared_ptr<sensors::TemperatureCompensator> g_compensator;
 std::shared_ptr<sensors::ConfigManager> g_configManager;
+std::shared_ptr<sensors::ConfigStore> g_configStore;
 std::shared_ptr<sensors::ProtocolManager> g_protocolManager;
 std::shared_ptr<sensors::DiscoveryManager> g_discoveryManager;
+std::shared_ptr<sensors::I2CTopologyScanner> g_topologyScanner;
+std::shared_ptr<sensors::I2CRediscovery> g_rediscovery;
 std::shared_ptr<sensors::communication::MQTTClient> g_mqttClient;
+std::shared_ptr<sensors::communication::MQTTOutbox> g_mqttOutbox;
 std::shared_ptr<sensors::communication::BLEManager> g_bleManager;
 std::shared_ptr<sensors::communication::ESPNowManager> g_espnowManager;
+std::shared_ptr<sensors::communication::ESPNowFrameReceiver> g_espnowReceiver;
 std::shared_ptr<sensors::communication::WirelessNodeManager> g_wirelessNodeManager;
+std::shared_ptr<sensors::communication::AsyncNodeRequester> g_nodeRequester;
+std::shared_ptr<sensors::communication::NodeLivenessTracker> g_nodeLiveness;
+// Created up front: radio callbacks use these before the wireless stage has run
+std::shared_ptr<sensors::communication::NodeTable> g_nodeTable = std::make_shared<sensors::communication::NodeTable>();
+std::shared_ptr<sensors::communication::PublishBus> g_publishBus = std::make_shared<sensors::communication::PublishBus>();
+std::shared_ptr<sensors::communication::TopicRegistry> g_topicRegistry = std::make_shared<sensors::communication::TopicRegistry>();
+std::shared_ptr<sensors::LatencyTracer> g_latencyTracer = std::make_shared<sensors::LatencyTracer>(
+    []() -> uint32_t { return g_hal ? g_hal->micros() : 0; }, LATENCY_SAMPLE_INTERVAL);
+std::shared_ptr<sensors::communication::DiscoveryScheduler> g_discoveryScheduler =
+    std::make_shared<sensors::communication::DiscoveryScheduler>(sensors::communication::DiscoverySchedule{
+        DISCOVERY_MIN_INTERVAL, DISCOVERY_MAX_INTERVAL, DISCOVERY_WINDOW
+    });
 std::shared_ptr<storage::NVSStorage> g_nvsStorage;
+std::shared_ptr<storage::ConfigCache> g_configCache;
+std::shared_ptr<sensors::BootSequencer> g_bootSequencer;
+bool g_configCacheValid = false;
+std::vector<sensors::I2CDetectionRule> g_detectionRules;
+uint32_t g_bootStartTime = 0;
+
+// Allocations made while publishing local readings, for the heap report
+std::atomic<uint32_t> g_readingAllocations{0};
+std::atomic<uint32_t> g_readingCount{0};
+
+// Wireless node readings reuse these, and their string capacity, instead of allocating per sample
+sensors::ObjectPool<sensors::SensorReading, NODE_READING_POOL_SIZE> g_nodeReadingPool;
+
+// MQTT comes up in the background; messages published before then wait in g_mqttOutbox
+std::atomic<bool> g_mqttReady{false};
+
+// Source directories covered by the configuration cache
+std::vector<std::string> configCacheSources() {
+    return {
+        std::string(SPIFFS_MOUNT_POINT) + PROTOCOL_PATH,
+        std::string(SPIFFS_MOUNT_POINT) + CONFIG_PATH,
+        std::string(SPIFFS_MOUNT_POINT) + CALIBRATION_PATH
+    };
+}
+
+// Trace of a sensor for SensorReading::trace, resolved when the sensor is registered
+sensors::SensorTrace* sensorTrace(const std::string& sensorId) {
+#if SENSORHUB_TRACING
+    return g_latencyTracer->sensor(sensorId);
+#else
+    (void)sensorId;
+    return nullptr;
+#endif
+}
+
+// Channel table of the readings this gateway relays, announced to peer gateways
+struct RelayChannelTable {
+    std::mutex mutex;
+    uint16_t handle{ESPNOW_RELAY_HANDLE_BASE};              // Frame handle, derived from our MAC
+    std::map<std::string, uint8_t> indices;                 // Sensor ID to channel
+    std::vector<std::pair<std::string, std::string>> channels; // Sensor ID and unit by channel
+    uint8_t sequence{0};
+    bool announced{false};                                  // Peers know the current table
+    uint32_t lastAnnounce{0};
+};
+RelayChannelTable g_relayChannels;
+
+// Encode a local reading as a one-sample ESP-NOW reading frame for relaying
+bool encodeRelayFrame(const sensors::SensorReading& reading, std::string& out) {
+    sensors::communication::ReadingFrame frame;
+    {
+        std::lock_guard<std::mutex> lock(g_relayChannels.mutex);
+        auto it = g_relayChannels.indices.find(reading.sensorId);
+        if (it == g_relayChannels.indices.end()) {
+            if (g_relayChannels.channels.size() >= sensors::communication::ESPNOW_FRAME_MAX_CHANNELS) return false;
+            it = g_relayChannels.indices.emplace(reading.sensorId, static_cast<uint8_t>(g_relayChannels.channels.size())).first;
+            g_relayChannels.channels.emplace_back(reading.sensorId, reading.unit);
+            g_relayChannels.announced = false;
+        }
+        frame.nodeHandle = g_relayChannels.handle;
+        frame.samples[0].channel = it->second;
+        frame.sequence = g_relayChannels.sequence++;
+    }
+    
+    // Receivers rebase frame times onto their own clock, so the low 32 bits of
+    // the epoch time are all a frame needs
+    frame.sampleCount = 1;
+    frame.samples[0].timestamp = static_cast<uint32_t>(reading.timestamp);
+    frame.samples[0].raw = frame.toRaw(reading.value);
+    
+    uint8_t buffer[sensors::communication::ESPNOW_MAX_FRAME_SIZE];
+    size_t length = sensors::communication::encodeReadingFrame(frame, buffer, sizeof(buffer));
+    if (length == 0) return false;
+    
+    out.assign(reinterpret_cast<const char*>(buffer), length);
+    return true;
+}
+
+// Broadcast the relay channel table when it changed or is due, split into
+// descriptors that each fit one ESP-NOW payload
+void announceRelayChannels(uint32_t now) {
+    uint16_t handle;
+    std::vector<std::pair<std::string, std::string>> channels;
+    {
+        std::lock_guard<std::mutex> lock(g_relayChannels.mutex);
+        if (g_relayChannels.announced && now - g_relayChannels.lastAnnounce < ESPNOW_RELAY_ANNOUNCE_INTERVAL) return;
+        g_relayChannels.announced = true;
+        g_relayChannels.lastAnnounce = now;
+        handle = g_relayChannels.handle;
+        channels = g_relayChannels.channels;
+    }
+    
+    static const uint8_t broadcast[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    size_t first = 0;
+    while (first < channels.size()) {
+        sensors::json descriptor;
+        descriptor["relayHandle"] = handle;
+        descriptor["first"] = first;
+        descriptor["count"] = channels.size();
+        descriptor["channels"] = sensors::json::array();
+        
+        std::string payload;
+        size_t next = first;
+        for (; next < channels.size(); next++) {
+            descriptor["channels"].push_back({{"id", channels[next].first}, {"unit", channels[next].second}});
+            std::string candidate = descriptor.dump();
+            if (candidate.size() > sensors::communication::ESPNOW_MAX_FRAME_SIZE) break;
+            payload.swap(candidate);
+        }
+        if (next == first) {
+            Serial.printf("Relay channel %s does not fit a descriptor\n", channels[first].first.c_str());
+            return;
+        }
+        
+        esp_now_send(broadcast, reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+        first = next;
+    }
+}
+
+// Register the channel table a peer gateway announces for its relayed readings (receiver worker)
+void registerRelayChannels(const std::string& gatewayId, const sensors::json& descriptor) {
+    // Tables are assembled from descriptors, which all arrive on the receiver worker
+    static std::map<uint16_t, std::vector<sensors::communication::FrameChannel>> tables;
+    
+    uint16_t handle = descriptor["relayHandle"];
+    size_t first = descriptor["first"];
+    size_t count = descriptor["count"];
+    if (handle < ESPNOW_RELAY_HANDLE_BASE || count > sensors::communication::ESPNOW_FRAME_MAX_CHANNELS || first >= count) {
+        return;
+    }
+    
+    auto& table = tables[handle];
+    table.resize(count);
+    for (const auto& channel : descriptor["channels"]) {
+        if (first >= count) break;
+        std::string sensorId = gatewayId + "_" + channel.value("id", "");
+        table[first++] = {sensorId, channel.value("unit", ""), sensorTrace(sensorId)};
+    }
+    
+    // Readings are decoded only once every descriptor of the table has arrived
+    for (const auto& channel : table) {
+        if (channel.sensorId.empty()) return;
+    }
+    g_espnowReceiver->registerNode(handle, gatewayId, table);
+}
+
+// Compensation tables are applied to readings; other calibration data goes to the sensor
+void applyCalibration(const std::string& sensorId) {
+    sensors::json calibrationData = g_calibrationManager->getCalibrationData(sensorId);
+    if (sensors::TemperatureCompensator::isTableData(calibrationData)) {
+        if (!g_compensator->setTable(sensorId, calibrationData)) {
+            Serial.printf("Invalid compensation table: %s\n", g_compensator->getLastError().c_str());
+        }
+        return;
+    }
+    
+    g_compensator->removeTable(sensorId);
+    auto sensor = g_sensorManager->getSensor(sensorId);
+    if (sensor) {
+        g_calibrationManager->calibrateSensor(sensor.get());
+    }
+}
 
 // Callback functions
 void onSensorReading(const sensors::SensorReading& reading) {
-    Serial.printf("Sensor %s reading: %.2f %s (time: %lld)\n", 
-                  reading.sensorId.c_str(), 
-                  reading.value, 
-                  reading.unit.c_str(), 
-                  reading.timestamp);
-    
-    // Publish to MQTT if enabled
-    if (ENABLE_MQTT && g_mqttClient && g_mqttClient->isConnected()) {
-        char topic[128];
-        char payload[256];
-        
-        snprintf(topic, sizeof(topic), "sensors/%s/reading", reading.sensorId.c_str());
-        snprintf(payload, sizeof(payload), 
-                 "{\"value\":%.2f,\"unit\":\"%s\",\"timestamp\":%lld,\"raw\":%.2f}",
-                 reading.value, 
-                 reading.unit.c_str(), 
-                 reading.timestamp,
-                 reading.rawValue);
+    static bool firstReading = true;
+    if (firstReading) {
+        firstReading = false;
+        Serial.printf("Time to first reading: %lu ms\n", millis() - g_bootStartTime);
+    }
+    
+    // Encoded once per wire format and fanned out to log, MQTT and radio sinks
+    SENSORHUB_ALLOC_SCOPE(SENSOR_MANAGER);
+    sensors::AllocCycle cycle;
+    {
+        SENSORHUB_TRACE_SCOPE(reading.trace);
         
-        g_mqttClient->publish(topic, payload);
+        // Temperature-compensated sensors are recalibrated from their companion's value
+        const sensors::SensorReading* published = &reading;
+        sensors::SensorReading compensated;
+        if (g_compensator && g_compensator->hasTable(reading.sensorId)) {
+            compensated = reading;
+            if (g_compensator->apply(compensated)) {
+                published = &compensated;
+            }
+        }
+        g_publishBus->publish(*published, millis());
     }
+    g_readingAllocations += cycle.allocations();
+    g_readingCount++;
 }
 
 void onSensorError(const std::string& sensorId, const std::string& errorMessage) {
     Serial.printf("Sensor %s error: %s\n", sensorId.c_str(), errorMessage.c_str());
     
-    // Publish to MQTT if enabled
-    if (ENABLE_MQTT && g_mqttClient && g_mqttClient->isConnected()) {
-        char topic[128];
+    // Queue for MQTT if enabled
+    if (ENABLE_MQTT && g_mqttOutbox) {
+        SENSORHUB_ALLOC_SCOPE(MQTT);
         char payload[256];
         
-        snprintf(topic, sizeof(topic), "sensors/%s/error", sensorId.c_str());
         snprintf(payload, sizeof(payload), 
                  "{\"error\":\"%s\",\"timestamp\":%lld}",
                  errorMessage.c_str(), 
@@ -107,11 +354,12 @@ void onSensorError(const std::string& sensorId, const std::string& errorMessage)
                      std::chrono::system_clock::now().time_since_epoch()
                  ).count());
         
-        g_mqttClient->publish(topic, payload);
+        g_mqttOutbox->enqueue(g_topicRegistry->topicsFor(sensorId).error, payload);
     }
 }
 
 void onConfigChanged(const std::string& sensorId, const sensors::SensorConfig& config) {
+    SENSORHUB_ALLOC_SCOPE(CONFIG);
     Serial.printf("Sensor %s configuration changed\n", sensorId.c_str());
     
     // Update sensor configuration
@@ -120,71 +368,92 @@ void onConfigChanged(const std::string& sensorId, const sensors::SensorConfig& c
         sensor->configure(config);
     }
     
-    // Save configuration
-    g_configManager->saveConfigurations();
+    // Queue only this sensor's record; bursts are coalesced and written from loop()
+    g_configStore->markDirty(config, millis());
 }
 
 void onMQTTMessage(const std::string& topic, const std::string& payload) {
+    SENSORHUB_ALLOC_SCOPE(MQTT);
     Serial.printf("MQTT message received: %s - %s\n", topic.c_str(), payload.c_str());
     
+    sensors::communication::TopicRoute route;
+    if (!g_topicRegistry->route(topic, route)) {
+        return;
+    }
+    
+    // Registered sensors reuse their interned ID; only unknown IDs are copied out of the topic
+    const auto* topics = g_topicRegistry->getTopics(route.handle);
+    std::string unregisteredId;
+    if (!topics) {
+        unregisteredId.assign(route.sensorId.data(), route.sensorId.size());
+    }
+    const std::string& sensorId = topics ? topics->sensorId : unregisteredId;
+    
     // Handle configuration updates
-    if (topic.find("/config/") != std::string::npos) {
-        try {
-            auto configJson = sensors::json::parse(payload);
-            std::string sensorId = topic.substr(topic.find("/config/") + 8);
+    if (route.action == sensors::communication::TopicAction::CONFIG) {
+        // Decoded in place, no JSON document; static keeps the 1.3 KB struct off the MQTT task stack
+        static sensors::communication::ConfigMessage message;
+        if (!sensors::communication::parseConfigMessage(payload, message)) {
+            Serial.println("Error parsing configuration JSON");
+            return;
+        }
+        
+        if (g_configManager->hasConfig(sensorId)) {
+            auto config = g_configManager->getConfig(sensorId);
             
-            if (g_configManager->hasConfig(sensorId)) {
-                auto config = g_configManager->getConfig(sensorId);
-                
-                // Update with new values
-                if (configJson.contains("sensorConfig")) {
-                    config.sensorConfig = configJson["sensorConfig"];
-                }
-                
-                if (configJson.contains("calibrationConfig")) {
-                    config.calibrationConfig = configJson["calibrationConfig"];
-                }
-                
-                // Apply changes
-                g_configManager->setConfig(sensorId, config);
+            // Update with new values
+            if (!sensors::communication::applyConfigMessage(message, config)) {
+                Serial.println("Error applying configuration JSON");
+                return;
             }
-        } catch (const std::exception& e) {
-            Serial.printf("Error parsing configuration JSON: %s\n", e.what());
+            
+            // Apply changes
+            g_configManager->setConfig(sensorId, config);
         }
     }
     
     // Handle command messages
-    if (topic.find("/command/") != std::string::npos) {
-        try {
-            auto commandJson = sensors::json::parse(payload);
-            std::string sensorId = topic.substr(topic.find("/command/") + 9);
-            
-            if (commandJson.contains("action")) {
-                std::string action = commandJson["action"];
+    if (route.action == sensors::communication::TopicAction::COMMAND) {
+        sensors::communication::SensorCommand command;
+        if (!sensors::communication::parseSensorCommand(payload, command)) {
+            Serial.println("Error parsing command JSON");
+            return;
+        }
+        
+        switch (command.action) {
+            case sensors::communication::CommandAction::CALIBRATE: {
+                if (command.calibrationData.empty()) break;
                 
-                if (action == "calibrate" && commandJson.contains("calibrationData")) {
-                    g_calibrationManager->setCalibrationData(sensorId, commandJson["calibrationData"]);
-                    auto sensor = g_sensorManager->getSensor(sensorId);
-                    if (sensor) {
-                        g_calibrationManager->calibrateSensor(sensor.get());
-                    }
-                }
-                else if (action == "sleep") {
-                    g_sensorManager->sleep(sensorId);
-                }
-                else if (action == "wake") {
-                    g_sensorManager->wake(sensorId);
+                // Calibration data is only turned into JSON for the calibration manager
+                auto calibrationData = sensors::json::parse(command.calibrationData.begin(),
+                                                            command.calibrationData.end(), nullptr, false);
+                if (calibrationData.is_discarded()) {
+                    Serial.printf("Invalid calibration data for %s\n", sensorId.c_str());
+                    break;
                 }
-                else if (action == "reset") {
-                    auto sensor = g_sensorManager->getSensor(sensorId);
-                    if (sensor) {
-                        sensor->end();
-                        sensor->begin(g_hal.get());
-                    }
+                g_calibrationManager->setCalibrationData(sensorId, calibrationData);
+                applyCalibration(sensorId);
+                break;
+            }
+            case sensors::communication::CommandAction::SLEEP:
+                g_sensorManager->sleep(sensorId);
+                break;
+            case sensors::communication::CommandAction::WAKE:
+                g_sensorManager->wake(sensorId);
+                break;
+            case sensors::communication::CommandAction::DISCOVER:
+                g_discoveryScheduler->trigger();
+                break;
+            case sensors::communication::CommandAction::RESET: {
+                auto sensor = g_sensorManager->getSensor(sensorId);
+                if (sensor) {
+                    sensor->end();
+                    sensor->begin(g_hal.get());
                 }
+                break;
             }
-        } catch (const std::exception& e) {
-            Serial.printf("Error parsing command JSON: %s\n", e.what());
+            default:
+                break;
         }
     }
 }
@@ -197,53 +466,125 @@ void onBLEDeviceDisconnected(const std::string& deviceId) {
     Serial.printf("BLE device disconnected: %s\n", deviceId.c_str());
 }
 
+// Feed readings reported by a wireless node into the local reading path
+void handleNodeReadings(const std::string& nodeId, const sensors::json& readings) {
+    SENSORHUB_ALLOC_SCOPE(WIRELESS);
+    auto pooled = g_nodeReadingPool.acquire();
+    sensors::SensorReading fallback;    // Only used if every pooled reading is taken
+    sensors::SensorReading& sensorReading = pooled ? *pooled : fallback;
+    
+    for (const auto& reading : readings) {
+        sensorReading.sensorId.assign(nodeId).append("_").append(reading["id"].get_ref<const std::string&>());
+        sensorReading.timestamp = reading["time"];
+        sensorReading.value = reading["value"];
+        sensorReading.rawValue = sensorReading.value;
+        sensorReading.unit.assign(reading["unit"].get_ref<const std::string&>());
+        sensorReading.isValid = true;
+        sensorReading.metadata = nullptr;
+        // JSON reports name their sensors per message; the lookup is small next to the parse
+        sensorReading.trace = sensorTrace(sensorReading.sensorId);
+        
+        // Handle as if it was a local sensor reading
+        onSensorReading(sensorReading);
+    }
+}
+
+// Runs in the radio task: only queue the payload, decoding happens on the receiver worker
 void onESPNowMessage(const uint8_t* mac, const uint8_t* data, size_t length) {
+    SENSORHUB_ALLOC_SCOPE(WIRELESS);
+    uint32_t now = millis();
+    g_nodeTable->touch(mac, sensors::communication::NodeProtocol::ESPNOW, now);
+    g_discoveryScheduler->recordDataFrame(sensors::communication::NodeProtocol::ESPNOW, length, now);
+    g_espnowReceiver->push(mac, data, length);
+}
+
+// JSON messages from nodes that do not send binary reading frames (receiver worker)
+void onESPNowLegacyMessage(const uint8_t* mac, const uint8_t* data, size_t length) {
+    SENSORHUB_ALLOC_SCOPE(WIRELESS);
     char macStr[18];
     snprintf(macStr, sizeof(macStr), "%02X:%02X:%02X:%02X:%02X:%02X",
              mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
     
     Serial.printf("ESP-NOW message from %s, length: %d\n", macStr, length);
     
-    // Process message (convert to string for easier parsing)
-    std::string message((char*)data, length);
+    // Parsed straight from the receive buffer, without copying it into a string
     try {
-        auto msgJson = sensors::json::parse(message);
+        auto msgJson = sensors::json::parse(data, data + length);
         
         // Handle node readings
         if (msgJson.contains("nodeId") && msgJson.contains("readings")) {
-            std::string nodeId = msgJson["nodeId"];
-            auto readings = msgJson["readings"];
+            const std::string& nodeId = msgJson["nodeId"].get_ref<const std::string&>();
             
             Serial.printf("Received readings from node %s\n", nodeId.c_str());
-            
-            // Process readings
-            for (const auto& reading : readings) {
-                sensors::SensorReading sensorReading;
-                sensorReading.sensorId = nodeId + "_" + reading["id"].get<std::string>();
-                sensorReading.timestamp = reading["time"];
-                sensorReading.value = reading["value"];
-                sensorReading.unit = reading["unit"];
-                sensorReading.isValid = true;
-                
-                // Handle as if it was a local sensor reading
-                onSensorReading(sensorReading);
-            }
+            handleNodeReadings(nodeId, msgJson["readings"]);
+        } else if (msgJson.contains("relayHandle") && msgJson.contains("channels")) {
+            // Channel table of readings relayed by a peer gateway, named after its MAC
+            char gatewayId[16];
+            snprintf(gatewayId, sizeof(gatewayId), "gw_%02X%02X%02X%02X%02X%02X",
+                     mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+            registerRelayChannels(gatewayId, msgJson);
         }
     } catch (const std::exception& e) {
         Serial.printf("Error parsing ESP-NOW message: %s\n", e.what());
     }
 }
 
+// Give an ESP-NOW node a frame handle and register its channel table
+void registerFrameNode(const sensors::communication::NodeInfo& nodeInfo) {
+    SENSORHUB_ALLOC_SCOPE(WIRELESS);
+    static uint16_t nextHandle = 1;
+    
+    if (!g_espnowReceiver || !nodeInfo.capabilities.contains("channels")) return;
+    
+    std::vector<sensors::communication::FrameChannel> channels;
+    for (const auto& channel : nodeInfo.capabilities["channels"]) {
+        std::string sensorId = nodeInfo.nodeId + "_" + channel.value("id", "");
+        channels.push_back({sensorId, channel.value("unit", ""), sensorTrace(sensorId)});
+    }
+    
+    uint16_t handle;
+    if (!g_espnowReceiver->findHandle(nodeInfo.nodeId, handle)) {
+        handle = nextHandle++;
+    }
+    if (!g_espnowReceiver->registerNode(handle, nodeInfo.nodeId, channels)) {
+        Serial.printf("Node %s has too many channels for binary frames\n", nodeInfo.nodeId.c_str());
+        return;
+    }
+    
+    // The node switches from JSON to binary frames once it knows its handle
+    sensors::json config;
+    config["frameHandle"] = handle;
+    g_wirelessNodeManager->configureNode(nodeInfo.nodeId, config);
+}
+
 void onNodeDiscovered(const sensors::communication::NodeInfo& nodeInfo) {
+    SENSORHUB_ALLOC_SCOPE(WIRELESS);
     Serial.printf("Wireless node discovered: %s (%s)\n", 
                   nodeInfo.nodeId.c_str(), 
                   nodeInfo.name.c_str());
     
+    // A node not seen before speeds discovery up again
+    if (g_nodeTable->findByNodeId(nodeInfo.nodeId) == sensors::communication::NodeTable::INVALID_HANDLE) {
+        g_discoveryScheduler->notifyChurn();
+    }
+    
     // Register node
     g_wirelessNodeManager->registerNode(nodeInfo);
+    g_nodeRequester->registerNode(nodeInfo.nodeId, nodeInfo.protocol);
+    int handle = g_nodeTable->registerNode(nodeInfo);
+    if (handle == sensors::communication::NodeTable::INVALID_HANDLE) {
+        Serial.printf("Node %s not added to node table\n", nodeInfo.nodeId.c_str());
+    } else {
+        g_nodeLiveness->track(handle, nodeInfo.type, millis());
+    }
+    
+    if (nodeInfo.protocol == "espnow") {
+        registerFrameNode(nodeInfo);
+    }
 }
 
 void onNodeStatusChanged(const std::string& nodeId, sensors::communication::NodeStatus status) {
+    SENSORHUB_ALLOC_SCOPE(WIRELESS);
     const char* statusStr = "Unknown";
     switch (status) {
         case sensors::communication::NodeStatus::CONNECTING: statusStr = "Connecting"; break;
@@ -254,6 +595,85 @@ void onNodeStatusChanged(const std::string& nodeId, sensors::communication::Node
     }
     
     Serial.printf("Node %s status changed: %s\n", nodeId.c_str(), statusStr);
+    g_nodeTable->setStatus(g_nodeTable->findByNodeId(nodeId), status);
+}
+
+// Responses to pending requests complete them; anything else is unsolicited node data
+void onNodeData(const std::string& nodeId, const sensors::json& data) {
+    SENSORHUB_ALLOC_SCOPE(WIRELESS);
+    g_nodeTable->touch(g_nodeTable->findByNodeId(nodeId), millis());
+    if (g_nodeRequester->handleResponse(nodeId, data)) return;
+    
+    if (data.contains("readings")) {
+        handleNodeReadings(nodeId, data["readings"]);
+    }
+}
+
+// Nodes whose heartbeats stopped or resumed, reported in batches by the timer wheel
+void onNodeLivenessChanged(const std::vector<int>& handles, sensors::communication::NodeStatus status) {
+    SENSORHUB_ALLOC_SCOPE(WIRELESS);
+    g_discoveryScheduler->notifyChurn();
+    for (int handle : handles) {
+        g_wirelessNodeManager->updateNodeStatus(g_nodeTable->getNodeId(handle), status);
+    }
+    
+    auto stats = g_nodeLiveness->getStats();
+    Serial.printf("%zu wireless nodes %s (expiry jitter avg %u ms, max %u ms, busiest wheel slot %zu)\n",
+                  handles.size(),
+                  status == sensors::communication::NodeStatus::DISCONNECTED ? "timed out" : "back",
+                  stats.averageJitter, stats.maxJitter, stats.maxSlotOccupancy);
+}
+
+// Ask every connected node that does not stream frames for its readings; the
+// requests are pipelined, so the whole fleet answers within about one round trip
+void pollWirelessNodes() {
+    SENSORHUB_ALLOC_SCOPE(WIRELESS);
+    // Nodes whose last poll is still outstanding; completions run on other tasks
+    static std::mutex pollingMutex;
+    static std::set<std::string> polling;
+    
+    uint32_t skipped = 0;
+    uint32_t rejected = 0;
+    g_nodeTable->forEachNode([&](const sensors::communication::NodeHotInfo& node) {
+        if (node.status != sensors::communication::NodeStatus::CONNECTED) return;
+        
+        uint16_t frameHandle;
+        std::string nodeId = g_nodeTable->getNodeId(node.handle);
+        if (g_espnowReceiver && g_espnowReceiver->findHandle(nodeId, frameHandle)) return;
+        
+        {
+            std::lock_guard<std::mutex> lock(pollingMutex);
+            if (!polling.insert(nodeId).second) {
+                skipped++;
+                return;
+            }
+        }
+        
+        bool accepted = g_nodeRequester->requestData(nodeId, {{"type", "read"}},
+            [nodeId](sensors::communication::RequestStatus status, const sensors::json& response) {
+                {
+                    std::lock_guard<std::mutex> lock(pollingMutex);
+                    polling.erase(nodeId);
+                }
+                if (status != sensors::communication::RequestStatus::COMPLETED) {
+                    Serial.printf("Node %s did not answer poll\n", nodeId.c_str());
+                } else if (response.contains("readings")) {
+                    handleNodeReadings(nodeId, response["readings"]);
+                }
+            });
+        if (!accepted) {
+            std::lock_guard<std::mutex> lock(pollingMutex);
+            polling.erase(nodeId);
+            rejected++;
+        }
+    });
+    
+    if (skipped > 0 || rejected > 0) {
+        Serial.printf("Node poll: %u nodes still answering the last poll, %u requests rejected "
+                      "(%u rejected in total)\n",
+                      static_cast<unsigned>(skipped), static_cast<unsigned>(rejected),
+                      static_cast<unsigned>(g_nodeRequester->getStats().rejected));
+    }
 }
 
 // Initialization functions
@@ -267,12 +687,15 @@ bool initFileSystem() {
     return true;
 }
 
-bool initWiFi() {
+bool startWiFi() {
     Serial.printf("Connecting to WiFi SSID: %s\n", WIFI_SSID);
     
     WiFi.mode(WIFI_STA);
     WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    
+    return true;
+}
+
+bool initWiFi() {
     // Wait for connection
     int retries = 0;
     while (WiFi.status() != WL_CONNECTED && retries < 20) {
@@ -329,17 +752,34 @@ bool initProtocolManager() {
 }
 
 bool initConfigManager() {
+    SENSORHUB_ALLOC_SCOPE(CONFIG);
+    g_configStore = std::make_shared<sensors::ConfigStore>(
+        std::string(SPIFFS_MOUNT_POINT) + CONFIG_PATH,
+        CONFIG_SAVE_DEBOUNCE,
+        CONFIG_SAVE_MAX_DELAY
+    );
+    if (!g_configStore->init()) {
+        Serial.println("Config store not available, changes will not be persisted");
+    }
+    
     g_configManager = std::make_shared<sensors::ConfigManager>();
     if (!g_configManager->init(CONFIG_PATH)) {
         Serial.println("Failed to initialize config manager");
         return false;
     }
     
-    // Set config changed callback
-    g_configManager->setConfigChangedCallback(onConfigChanged);
+    unsigned long loadStart = millis();
     
-    // Load configurations from SPIFFS
-    if (!g_configManager->loadConfigurations()) {
+    // Load compiled configurations from the cache image, or parse them from SPIFFS
+    std::vector<sensors::SensorConfig> cachedConfigs;
+    if (g_configCacheValid && g_configCache->getConfigs("configs", cachedConfigs)) {
+        for (const auto& config : cachedConfigs) {
+            g_configManager->setConfig(config.id, config);
+        }
+        Serial.printf("Configurations loaded from cache in %lu ms\n", millis() - loadStart);
+    } else if (g_configManager->loadConfigurations()) {
+        Serial.printf("Configurations parsed in %lu ms\n", millis() - loadStart);
+    } else {
         Serial.println("Failed to load configurations, creating default");
         
         // Create default configuration if not found
@@ -351,28 +791,48 @@ bool initConfigManager() {
         defaultConfig.id = "default_temp_sensor";
         defaultConfig.name = "Default Temperature Sensor";
         g_configManager->setConfig(defaultConfig.id, defaultConfig);
-        g_configManager->saveConfigurations();
+        g_configStore->markDirty(defaultConfig, millis());
+        g_configStore->flushAll();
     }
     
+    // Set config changed callback once the initial load is done
+    g_configManager->setConfigChangedCallback(onConfigChanged);
+    
     Serial.printf("Config manager initialized with %zu configurations\n", 
                   g_configManager->getAllConfigs().size());
     return true;
 }
 
 bool initCalibrationManager() {
+    SENSORHUB_ALLOC_SCOPE(CALIBRATION);
     g_calibrationManager = std::make_shared<sensors::CalibrationManager>();
     if (!g_calibrationManager->init(CALIBRATION_PATH)) {
         Serial.println("Failed to initialize calibration manager");
         return false;
     }
     
+    // Compensation tables take the companion temperature from the latest-value cache
+    g_compensator = std::make_shared<sensors::TemperatureCompensator>();
+    g_compensator->setCompanionSource([](const std::string& sensorId, double& value) {
+        if (!g_sensorManager) return false;
+        sensors::CachedReading reading =
+            g_sensorManager->readCached(g_sensorManager->getHandle(sensorId), COMPANION_MAX_AGE);
+        value = reading.value;
+        return reading.isValid;
+    });
+    
     // Register calibration methods
     g_calibrationManager->registerCalibrationMethod("linear", sensors::CalibrationManager::getLinearCalibrationMethod());
     g_calibrationManager->registerCalibrationMethod("polynomial", sensors::CalibrationManager::getPolynomialCalibrationMethod());
     g_calibrationManager->registerCalibrationMethod("point", sensors::CalibrationManager::getPointCalibrationMethod());
     
-    // Load calibration data from SPIFFS
-    if (!g_calibrationManager->loadCalibrationData()) {
+    // Load calibration data from the cache image, or parse it from SPIFFS
+    std::map<std::string, sensors::json> cachedCalibration;
+    if (g_configCacheValid && g_configCache->getCalibration("calibration", cachedCalibration)) {
+        for (const auto& pair : cachedCalibration) {
+            g_calibrationManager->setCalibrationData(pair.first, pair.second);
+        }
+    } else if (!g_calibrationManager->loadCalibrationData()) {
         Serial.println("No calibration data found, using defaults");
     }
     
@@ -380,6 +840,48 @@ bool initCalibrationManager() {
     return true;
 }
 
+bool initConfigCache() {
+    SENSORHUB_ALLOC_SCOPE(CONFIG);
+    g_configCache = std::make_shared<storage::ConfigCache>(
+        std::string(SPIFFS_MOUNT_POINT) + CONFIG_CACHE_PATH
+    );
+    
+    unsigned long start = millis();
+    uint64_t sourceHash = storage::ConfigCache::computeSourceHash(configCacheSources());
+    g_configCacheValid = g_configCache->load(sourceHash);
+    
+    Serial.printf("Config cache %s (%lu ms)\n", 
+                  g_configCacheValid ? "valid" : "stale, reparsing JSON", 
+                  millis() - start);
+    return true;
+}
+
+// Rebuild the cache image after configurations were parsed from JSON
+void updateConfigCache() {
+    SENSORHUB_ALLOC_SCOPE(CONFIG);
+    if (g_configCacheValid) return;
+    
+    std::vector<sensors::SensorConfig> configs;
+    std::map<std::string, sensors::json> calibration;
+    for (const auto& pair : g_configManager->getAllConfigs()) {
+        configs.push_back(pair.second);
+        if (g_calibrationManager->hasCalibrationData(pair.first)) {
+            calibration[pair.first] = g_calibrationManager->getCalibrationData(pair.first);
+        }
+    }
+    
+    g_configCache->setDetectionRules("protocols", g_detectionRules);
+    g_configCache->setConfigs("configs", configs);
+    g_configCache->setCalibration("calibration", calibration);
+    
+    // Hash again: the default configuration may have been written meanwhile
+    if (g_configCache->save(storage::ConfigCache::computeSourceHash(configCacheSources()))) {
+        Serial.println("Config cache updated");
+    } else {
+        Serial.println("Failed to write config cache");
+    }
+}
+
 bool initSensorManager() {
     g_sensorManager = std::make_shared<sensors::SensorManager>(g_hal);
     if (!g_sensorManager->init()) {
@@ -389,6 +891,7 @@ bool initSensorManager() {
     
     // Set callbacks
     g_sensorManager->setErrorCallback(onSensorError);
+    g_sensorManager->setLatencyTracer(g_latencyTracer);
     
     Serial.println("Sensor manager initialized");
     return true;
@@ -405,7 +908,68 @@ bool initDiscoveryManager() {
     return true;
 }
 
+// I2C detection rules for discovery, from the cache image or compiled from the SPIFFS protocols
+void loadDetectionRules() {
+    SENSORHUB_ALLOC_SCOPE(CONFIG);
+    if (g_configCacheValid && g_configCache->getDetectionRules("protocols", g_detectionRules)) {
+        return;
+    }
+    
+    auto documents = sensors::json::array();
+    File root = SPIFFS.open(PROTOCOL_PATH);
+    if (root) {
+        File file = root.openNextFile();
+        while (file) {
+            auto document = sensors::json::parse(file.readString().c_str(), nullptr, false);
+            if (!document.is_discarded()) {
+                documents.push_back(document);
+            }
+            file = root.openNextFile();
+        }
+    }
+    g_detectionRules = sensors::I2CTopologyScanner::compileProtocols(documents);
+}
+
+bool initTopologyScanner() {
+    loadDetectionRules();
+    
+    g_topologyScanner = std::make_shared<sensors::I2CTopologyScanner>(g_hal);
+    size_t count = g_topologyScanner->loadRules(g_detectionRules);
+    
+    Serial.printf("I2C topology scanner initialized with %zu detectable protocols\n", count);
+    return true;
+}
+
+bool initMQTTOutbox() {
+    SENSORHUB_ALLOC_SCOPE(MQTT);
+    if (!ENABLE_MQTT) return true;
+    
+    g_mqttOutbox = std::make_shared<sensors::communication::MQTTOutbox>(
+        std::string(SPIFFS_MOUNT_POINT) + MQTT_OUTBOX_PATH,
+        MQTT_OUTBOX_RAM_LIMIT,
+        MQTT_OUTBOX_SPOOL_LIMIT,
+        MQTT_INFLIGHT_WINDOW,
+        MQTT_REPLAY_RATE
+    );
+    if (!g_mqttOutbox->init()) {
+        Serial.println("Failed to resume MQTT outbox spool");
+    }
+    
+    // Readings are queued for MQTT; the outbox forwards them once the broker is reachable
+    sensors::communication::SubscriberOptions options;
+    options.format = sensors::communication::WireFormat::JSON;
+    g_publishBus->subscribe("mqtt", options,
+        [](const sensors::SensorReading& reading, const sensors::communication::EncodedPayload& payload) {
+            SENSORHUB_ALLOC_SCOPE(MQTT);
+            g_mqttOutbox->enqueue(g_topicRegistry->topicsFor(reading.sensorId).reading, *payload);
+        });
+    
+    Serial.printf("MQTT outbox initialized with %zu pending messages\n", g_mqttOutbox->getPendingCount());
+    return true;
+}
+
 bool initMQTT() {
+    SENSORHUB_ALLOC_SCOPE(MQTT);
     if (!ENABLE_MQTT) return true;
     
     g_mqttClient = std::make_shared<sensors::communication::MQTTClient>();
@@ -417,15 +981,25 @@ bool initMQTT() {
     // Set message callback
     g_mqttClient->setMessageCallback(onMQTTMessage);
     
+    // The client reports no PUBACKs, so a successful publish completes a message
+    g_mqttOutbox->setPublishFunction(
+        [](const sensors::communication::OutboxMessage& message, uint16_t, bool) {
+            return g_mqttClient->publish(message.topic.c_str(), message.payload.c_str());
+        },
+        true
+    );
+    
     // Connect to broker
     if (!g_mqttClient->connect("ESP32-SensorFramework")) {
         Serial.println("Failed to connect to MQTT broker");
+        g_mqttReady = true;  // loop() keeps retrying the connection
         return false;
     }
     
     // Subscribe to configuration and command topics
     g_mqttClient->subscribe("sensors/+/config/#");
     g_mqttClient->subscribe("sensors/+/command/#");
+    g_mqttReady = true;
     
     Serial.println("MQTT client initialized and connected");
     return true;
@@ -451,6 +1025,38 @@ bool initBLE() {
     return true;
 }
 
+// Rebroadcast local readings as binary frames; readings received from nodes are not relayed
+void initESPNowRelay() {
+    esp_now_peer_info_t broadcastPeer = {};
+    memset(broadcastPeer.peer_addr, 0xFF, ESP_NOW_ETH_ALEN);
+    if (!esp_now_is_peer_exist(broadcastPeer.peer_addr) && esp_now_add_peer(&broadcastPeer) != ESP_OK) {
+        Serial.println("Failed to add ESP-NOW broadcast peer, relay disabled");
+        return;
+    }
+    
+    // Relay handles sit above the ones gateways assign to nodes; our MAC keeps peers' handles apart
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    WiFi.macAddress(mac);
+    g_relayChannels.handle = ESPNOW_RELAY_HANDLE_BASE | (((mac[4] << 8) | mac[5]) & (ESPNOW_RELAY_HANDLE_BASE - 1));
+    
+    g_publishBus->setEncoder(sensors::communication::WireFormat::BINARY, encodeRelayFrame);
+    
+    sensors::communication::SubscriberOptions options;
+    options.format = sensors::communication::WireFormat::BINARY;
+    options.minInterval = ESPNOW_RELAY_INTERVAL;
+    options.filter = [](const sensors::SensorReading& reading) {
+        return g_sensorManager->getSensor(reading.sensorId) != nullptr;
+    };
+    g_publishBus->subscribe("espnow_relay", options,
+        [](const sensors::SensorReading&, const sensors::communication::EncodedPayload& payload) {
+            SENSORHUB_ALLOC_SCOPE(WIRELESS);
+            // Peers need the channel table before they can decode the frame
+            announceRelayChannels(millis());
+            static const uint8_t broadcast[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+            esp_now_send(broadcast, reinterpret_cast<const uint8_t*>(payload->data()), payload->size());
+        });
+}
+
 bool initESPNow() {
     if (!ENABLE_ESPNOW) return true;
     
@@ -460,9 +1066,17 @@ bool initESPNow() {
         return false;
     }
     
+    // Decode frames off the radio task
+    g_espnowReceiver = std::make_shared<sensors::communication::ESPNowFrameReceiver>();
+    g_espnowReceiver->start(onSensorReading, onESPNowLegacyMessage);
+    
     // Set callback
     g_espnowManager->setReceiveCallback(onESPNowMessage);
     
+    if (ENABLE_ESPNOW_RELAY) {
+        initESPNowRelay();
+    }
+    
     Serial.println("ESP-NOW manager initialized");
     return true;
 }
@@ -474,9 +1088,29 @@ bool initWirelessNodeManager() {
         return false;
     }
     
+    // Requests to nodes are pipelined and matched back by correlation ID
+    g_nodeRequester = std::make_shared<sensors::communication::AsyncNodeRequester>(
+        [](const std::string& nodeId, const sensors::json& request) {
+            return g_wirelessNodeManager->sendCommand(nodeId, request);
+        },
+        []() { return static_cast<uint32_t>(millis()); },
+        NODE_REQUEST_TIMEOUT,
+        NODE_REQUEST_WINDOW
+    );
+    
+    // Nodes are disconnected when their heartbeats stop
+    g_nodeLiveness = std::make_shared<sensors::communication::NodeLivenessTracker>(
+        g_nodeTable, 250, NODE_HEARTBEAT_INTERVAL, NODE_MISSED_HEARTBEATS
+    );
+    for (const auto& interval : NODE_HEARTBEAT_INTERVALS) {
+        g_nodeLiveness->setHeartbeatInterval(interval.first, interval.second);
+    }
+    g_nodeLiveness->setCallback(onNodeLivenessChanged);
+    
     // Set callbacks
     g_wirelessNodeManager->setNodeDiscoveryCallback(onNodeDiscovered);
     g_wirelessNodeManager->setNodeStatusCallback(onNodeStatusChanged);
+    g_wirelessNodeManager->setNodeDataCallback(onNodeData);
     
     // Register communication protocols
     if (ENABLE_BLE && g_bleManager) {
@@ -512,13 +1146,11 @@ bool loadSensors() {
             Serial.printf("Failed to add sensor %s\n", config.id.c_str());
             continue;
         }
+        g_topicRegistry->intern(config.id);
         
         // Apply calibration if available
         if (g_calibrationManager->hasCalibrationData(config.id)) {
-            auto sensor = g_sensorManager->getSensor(config.id);
-            if (sensor) {
-                g_calibrationManager->calibrateSensor(sensor.get());
-            }
+            applyCalibration(config.id);
         }
     }
     
@@ -526,111 +1158,366 @@ bool loadSensors() {
     return true;
 }
 
+// Addresses owned by registered I2C sensors; rediscovery never probes them
+std::set<std::pair<uint8_t, uint8_t>> occupiedI2CAddresses() {
+    std::set<std::pair<uint8_t, uint8_t>> occupied;
+    
+    for (const auto& pair : g_sensorManager->getAllSensors()) {
+        if (pair.second->getBusType() != sensors::SensorBus::I2C) continue;
+        
+        const auto& busConfig = pair.second->getConfig().busConfig;
+        int address = -1;
+        if (busConfig.contains("address") && busConfig["address"].is_string()) {
+            address = (int)strtol(busConfig["address"].get<std::string>().c_str(), nullptr, 0);
+        } else if (busConfig.contains("address") && busConfig["address"].is_number_integer()) {
+            address = busConfig["address"].get<int>();
+        }
+        if (address < 0 || address > 0x7F) continue;
+        
+        occupied.insert({busConfig.value("bus", (uint8_t)0), (uint8_t)address});
+    }
+    
+    return occupied;
+}
+
+// Create and register a sensor found by discovery
+void addDiscoveredSensor(const std::string& protocolName, 
+                         sensors::SensorType type, 
+                         sensors::SensorBus bus, 
+                         const std::string& uniqueId, 
+                         const sensors::json& busParams) {
+    Serial.printf("Discovered sensor: %s (%s on %s bus)\n", 
+                  protocolName.c_str(), 
+                  sensors::sensorTypeToString(type).c_str(),
+                  sensors::sensorBusToString(bus).c_str());
+    
+    // Check if sensor already configured
+    std::string sensorId = protocolName + "_" + uniqueId;
+    if (g_configManager->hasConfig(sensorId)) {
+        // A hot-plugged sensor that was removed earlier keeps its configuration
+        if (!g_sensorManager->getSensor(sensorId) && 
+            g_sensorManager->addSensor(g_configManager->getConfig(sensorId))) {
+            g_topicRegistry->intern(sensorId);
+            Serial.printf("Re-attached sensor %s\n", sensorId.c_str());
+        } else {
+            Serial.printf("Sensor %s already configured\n", sensorId.c_str());
+        }
+        return;
+    }
+    
+    // Generate configuration from protocol
+    auto config = g_configManager->generateConfigFromProtocol(
+        protocolName, 
+        sensorId,
+        busParams
+    );
+    
+    // Add sensor to manager
+    if (g_sensorManager->addSensor(config)) {
+        // Save configuration
+        g_configManager->setConfig(sensorId, config);
+        g_topicRegistry->intern(sensorId);
+        Serial.printf("Added new sensor %s\n", sensorId.c_str());
+    } else {
+        Serial.printf("Failed to add sensor %s\n", sensorId.c_str());
+    }
+}
+
 // Auto-discovery of sensors
 bool discoverSensors() {
     if (!ENABLE_AUTO_DISCOVERY) return true;
     
     Serial.println("Starting sensor auto-discovery...");
     
-    // Run discovery process
-    auto discoveredSensors = g_discoveryManager->detectSensors();
+    // Without I2C identifier definitions, fall back to the discovery manager
+    if (!g_topologyScanner || !g_topologyScanner->hasProbePlan()) {
+        auto discoveredSensors = g_discoveryManager->detectSensors();
+        
+        Serial.printf("Discovered %zu sensors\n", discoveredSensors.size());
+        
+        for (const auto& sensorInfo : discoveredSensors) {
+            addDiscoveredSensor(sensorInfo.protocolName, 
+                                sensorInfo.type, 
+                                sensorInfo.bus, 
+                                sensorInfo.uniqueId, 
+                                sensorInfo.busParams);
+        }
+        return true;
+    }
     
-    Serial.printf("Discovered %zu sensors\n", discoveredSensors.size());
+    // Verify the topology of the previous boot with one probe per device
+    std::string topologyPath = std::string(SPIFFS_MOUNT_POINT) + TOPOLOGY_PATH;
+    std::vector<sensors::I2CDeviceInfo> devices;
+    unsigned long start = millis();
     
-    for (const auto& sensorInfo : discoveredSensors) {
-        Serial.printf("Discovered sensor: %s (%s on %s bus)\n", 
-                      sensorInfo.protocolName.c_str(), 
-                      sensors::sensorTypeToString(sensorInfo.type).c_str(),
-                      sensors::sensorBusToString(sensorInfo.bus).c_str());
+    if (sensors::I2CTopologyScanner::loadTopology(topologyPath, devices) && 
+        g_topologyScanner->verify(devices)) {
+        Serial.printf("Cached I2C topology verified (%zu devices, %lu ms)\n", 
+                      devices.size(), millis() - start);
+    } else {
+        devices = g_topologyScanner->scan(I2C_DISCOVERY_BUSES);
+        sensors::I2CTopologyScanner::saveTopology(topologyPath, devices);
+        Serial.printf("I2C buses scanned (%zu devices, %u probes, %lu ms)\n", 
+                      devices.size(), g_topologyScanner->getProbeCount(), millis() - start);
+    }
+    
+    for (const auto& device : devices) {
+        if (device.protocolName.empty()) continue;
         
-        // Check if sensor already configured
-        std::string sensorId = sensorInfo.protocolName + "_" + sensorInfo.uniqueId;
-        if (g_configManager->hasConfig(sensorId)) {
-            Serial.printf("Sensor %s already configured\n", sensorId.c_str());
-            continue;
+        addDiscoveredSensor(device.protocolName, 
+                            device.type, 
+                            sensors::SensorBus::I2C, 
+                            device.getUniqueId(), 
+                            device.getBusParams());
+    }
+    
+    // Keep watching the free addresses for hot-plugged sensors
+    g_rediscovery = std::make_shared<sensors::I2CRediscovery>(
+        g_hal, g_topologyScanner, I2C_DISCOVERY_BUSES, 
+        REDISCOVERY_BUS_BUDGET, REDISCOVERY_INTERVAL);
+    g_rediscovery->setKnownDevices(devices);
+    g_rediscovery->setOccupiedAddresses(occupiedI2CAddresses());
+    
+    return true;
+}
+
+// Sensor ID of a discovered I2C device
+std::string discoveredSensorId(const sensors::I2CDeviceInfo& device) {
+    return device.protocolName + "_" + device.getUniqueId();
+}
+
+// Apply the result of a rediscovery pass to the sensor registry
+void applyTopologyDiff(const sensors::I2CTopologyDiff& diff) {
+    for (const auto& device : diff.removed) {
+        std::string sensorId = discoveredSensorId(device);
+        if (g_sensorManager->removeSensor(sensorId)) {
+            Serial.printf("Sensor %s removed from bus %u\n", sensorId.c_str(), device.busNum);
         }
-        
-        // Generate configuration from protocol
-        auto config = g_configManager->generateConfigFromProtocol(
-            sensorInfo.protocolName, 
-            sensorId,
-            sensorInfo.busParams
-        );
-        
-        // Add sensor to manager
-        if (g_sensorManager->addSensor(config)) {
-            // Save configuration
-            g_configManager->setConfig(sensorId, config);
-            Serial.printf("Added new sensor %s\n", sensorId.c_str());
-        } else {
-            Serial.printf("Failed to add sensor %s\n", sensorId.c_str());
+    }
+    
+    for (const auto& change : diff.changed) {
+        std::string sensorId = discoveredSensorId(change.first);
+        g_sensorManager->removeSensor(sensorId);
+        Serial.printf("Sensor %s replaced by %s\n", sensorId.c_str(), change.second.protocolName.c_str());
+        addDiscoveredSensor(change.second.protocolName, 
+                            change.second.type, 
+                            sensors::SensorBus::I2C, 
+                            change.second.getUniqueId(), 
+                            change.second.getBusParams());
+    }
+    
+    for (const auto& device : diff.added) {
+        addDiscoveredSensor(device.protocolName, 
+                            device.type, 
+                            sensors::SensorBus::I2C, 
+                            device.getUniqueId(), 
+                            device.getBusParams());
+    }
+    
+    // Update the topology fingerprint for the next boot
+    std::string topologyPath = std::string(SPIFFS_MOUNT_POINT) + TOPOLOGY_PATH;
+    sensors::I2CTopologyScanner::saveTopology(topologyPath, g_rediscovery->getKnownDevices());
+}
+
+// Background rediscovery, a few probes per call within the bus time budget
+void updateRediscovery() {
+    if (!g_rediscovery->step()) return;
+    
+    auto diff = g_rediscovery->takeDiff();
+    if (!diff.empty()) {
+        applyTopologyDiff(diff);
+    }
+    
+    // Refresh the registry view for the next pass
+    g_rediscovery->setOccupiedAddresses(occupiedI2CAddresses());
+    auto errors = g_sensorManager->getErrors();
+    for (const auto& device : g_rediscovery->getKnownDevices()) {
+        if (errors.count(discoveredSensorId(device))) {
+            g_rediscovery->markSuspect(device.busNum, device.address);
         }
     }
+}
+
+void onBootStageFinished(const sensors::BootStageInfo& stage) {
+    const char* stateStr = "Unknown";
+    switch (stage.state) {
+        case sensors::BootStageState::DONE: stateStr = "done"; break;
+        case sensors::BootStageState::FAILED: stateStr = "failed"; break;
+        case sensors::BootStageState::SKIPPED: stateStr = "skipped"; break;
+        default: break;
+    }
     
-    return true;
+    Serial.printf("[boot] %-16s %-7s start: %5lu ms  duration: %5lu ms\n", 
+                  stage.name.c_str(), 
+                  stateStr, 
+                  (unsigned long)stage.startTime, 
+                  (unsigned long)stage.duration);
+}
+
+bool isBootStageDone(const char* name) {
+    return g_bootSequencer && g_bootSequencer->isDone(name);
+}
+
+// Start continuous reading as soon as local sensors are loaded
+bool startAcquisition() {
+    if (!loadSensors()) {
+        Serial.println("Failed to load sensors");
+        return false;
+    }
+    
+    return g_sensorManager->startReading(READING_INTERVAL, onSensorReading);
+}
+
+// Print the latency histograms and publish them on the diagnostics topic, then start a new interval
+void reportLatency() {
+    auto snapshots = g_latencyTracer->snapshot(true);
+    if (snapshots.empty()) return;
+    
+    std::string report;
+    sensors::LatencyTracer::formatText(snapshots, report);
+    Serial.printf("Reading path latency (us):\n%s", report.c_str());
+    
+    if (ENABLE_MQTT && g_mqttOutbox) {
+        sensors::LatencyTracer::formatJson(snapshots, report);
+        g_mqttOutbox->enqueue(LATENCY_TOPIC, report, 0);
+    }
+}
+
+// Print per-subsystem allocation counters and publish them on the diagnostics topic
+void reportHeap() {
+    auto stats = sensors::AllocTracker::snapshot(g_hal->getFreeHeap(), g_hal->getLargestFreeBlock());
+    sensors::AllocTracker::resetPeaks();
+    
+    uint32_t readings = g_readingCount.exchange(0);
+    uint32_t allocations = g_readingAllocations.exchange(0);
+    if (readings > 0) {
+        stats.cycleAllocations = static_cast<double>(allocations) / readings;
+    }
+    
+    std::string report;
+    sensors::AllocTracker::formatText(stats, report);
+    Serial.printf("Heap by subsystem (bytes):\n%s", report.c_str());
+    Serial.printf("Pool misses: publish payloads %u, node readings %u\n",
+                  static_cast<unsigned>(g_publishBus->getStats().poolMisses),
+                  static_cast<unsigned>(g_nodeReadingPool.misses()));
+    
+    if (ENABLE_MQTT && g_mqttOutbox) {
+        SENSORHUB_ALLOC_SCOPE(MQTT);
+        sensors::AllocTracker::formatJson(stats, report);
+        g_mqttOutbox->enqueue(HEAP_TOPIC, report, 0);
+    }
 }
 
 void setup() {
+    g_bootStartTime = millis();
+    
     // Initialize serial
     Serial.begin(115200);
     while (!Serial) delay(10);
     
     Serial.println("\n\n==== ESP32 Modular Sensor Framework ====\n");
     
-    // Initialize components
-    if (!initFileSystem()) return;
-    if (!initHAL()) return;
-    if (!initStorage()) return;
-    if (!initProtocolManager()) return;
-    if (!initConfigManager()) return;
-    if (!initCalibrationManager()) return;
-    if (!initSensorManager()) return;
-    if (!initDiscoveryManager()) return;
-    
-    // Initialize networking
-    bool wifiConnected = initWiFi();
-    if (wifiConnected) {
-        if (!initMQTT()) {
-            Serial.println("MQTT initialization failed, continuing without MQTT");
-        }
-    } else {
-        Serial.println("WiFi connection failed, continuing without MQTT");
-    }
+    // Every reading is logged; further sinks subscribe as their transports come up
+    sensors::communication::SubscriberOptions logOptions;
+    logOptions.format = sensors::communication::WireFormat::TEXT;
+    g_publishBus->subscribe("log", logOptions,
+        [](const sensors::SensorReading&, const sensors::communication::EncodedPayload& line) {
+            Serial.printf("%s\n", line->c_str());
+        });
     
-    // Initialize wireless communications
-    if (!initBLE()) {
-        Serial.println("BLE initialization failed, continuing without BLE");
-    }
+    g_bootSequencer = std::make_shared<sensors::BootSequencer>(
+        []() { return static_cast<uint32_t>(millis()); }, 
+        BOOT_WORKER_COUNT,
+        BOOT_WORKER_STACK_SIZE
+    );
+    g_bootSequencer->setStageCallback(onBootStageFinished);
     
-    if (!initESPNow()) {
-        Serial.println("ESP-NOW initialization failed, continuing without ESP-NOW");
-    }
+    // Local acquisition path
+    g_bootSequencer->addStage("filesystem", {}, initFileSystem);
+    g_bootSequencer->addStage("hal", {}, initHAL);
+    g_bootSequencer->addStage("storage", {}, initStorage);
+    g_bootSequencer->addStage("config_cache", {"filesystem"}, initConfigCache);
+    g_bootSequencer->addStage("config", {"config_cache"}, initConfigManager);
+    g_bootSequencer->addStage("calibration", {"config_cache"}, initCalibrationManager);
+    g_bootSequencer->addStage("sensor_manager", {"hal"}, initSensorManager);
+    g_bootSequencer->addStage("mqtt_outbox", {"filesystem"}, initMQTTOutbox);
+    g_bootSequencer->addStage("acquisition", {"sensor_manager", "config", "calibration", "mqtt_outbox"}, startAcquisition);
+    g_bootSequencer->addStage("topology_scanner", {"hal", "config_cache"}, initTopologyScanner);
+    g_bootSequencer->addStage("config_cache_update", {"config", "calibration", "topology_scanner"}, []() {
+        updateConfigCache();
+        return true;
+    });
+    // ProtocolManager parses its JSON definitions itself; only discovery needs it
+    g_bootSequencer->addStage("protocols", {"filesystem", "acquisition"}, initProtocolManager);
+    g_bootSequencer->addStage("discovery_manager", {"hal", "protocols"}, initDiscoveryManager);
+    g_bootSequencer->addStage("discovery", {"discovery_manager", "topology_scanner", "acquisition"}, []() {
+        if (!discoverSensors()) {
+            Serial.println("Sensor discovery failed");
+        }
+        return true;
+    });
     
-    if (!initWirelessNodeManager()) {
-        Serial.println("Wireless node manager initialization failed, continuing without wireless nodes");
-    }
+    // Networking comes up in the background
+    g_bootSequencer->addStage("wifi_start", {}, startWiFi);
+    g_bootSequencer->addStage("wifi", {"wifi_start"}, initWiFi);
+    g_bootSequencer->addStage("mqtt", {"wifi", "acquisition"}, []() {
+        if (!initMQTT()) {
+            Serial.println("MQTT initialization failed, continuing without MQTT");
+        }
+        return true;
+    });
+    g_bootSequencer->addStage("ble", {}, []() {
+        if (!initBLE()) {
+            Serial.println("BLE initialization failed, continuing without BLE");
+        }
+        return true;
+    });
+    g_bootSequencer->addStage("espnow", {"wifi_start", "acquisition"}, []() {
+        if (!initESPNow()) {
+            Serial.println("ESP-NOW initialization failed, continuing without ESP-NOW");
+        }
+        return true;
+    });
+    g_bootSequencer->addStage("wireless", {"ble", "espnow"}, []() {
+        if (!initWirelessNodeManager()) {
+            Serial.println("Wireless node manager initialization failed, continuing without wireless nodes");
+        }
+        return true;
+    });
     
-    // Load sensors from configuration
-    if (!loadSensors()) {
-        Serial.println("Failed to load sensors");
+    if (!g_bootSequencer->start()) {
+        Serial.println("Invalid boot stage graph");
         return;
     }
     
-    // Discover sensors
-    if (!discoverSensors()) {
-        Serial.println("Sensor discovery failed");
+    // Only local acquisition is waited for; the rest finishes from loop()
+    if (!g_bootSequencer->waitFor("acquisition")) {
+        Serial.println("Sensor acquisition could not be started");
+        return;
     }
     
-    // Start continuous reading
-    g_sensorManager->startReading(READING_INTERVAL, onSensorReading);
-    
-    Serial.println("\nSystem initialization complete");
+    Serial.printf("\nLocal acquisition started after %lu ms\n", millis() - g_bootStartTime);
     Serial.println("====================================");
 }
 
 void loop() {
+    // Report boot once every stage has finished
+    static bool bootReported = false;
+    if (!bootReported && g_bootSequencer && g_bootSequencer->isFinished()) {
+        bootReported = true;
+        g_bootSequencer->join();
+        Serial.printf("System initialization complete after %lu ms\n", millis() - g_bootStartTime);
+    }
+    
+    // Persist configuration changes once they settle
+    if (isBootStageDone("config") && g_configStore) {
+        SENSORHUB_ALLOC_SCOPE(CONFIG);
+        g_configStore->flush(millis());
+    }
+    
     // Handle MQTT client
-    if (ENABLE_MQTT && g_mqttClient) {
+    if (ENABLE_MQTT && g_mqttReady) {
+        SENSORHUB_ALLOC_SCOPE(MQTT);
         g_mqttClient->loop();
         
         // Check connection status
@@ -638,26 +1525,69 @@ void loop() {
             Serial.println("MQTT disconnected, reconnecting...");
             g_mqttClient->connect("ESP32-SensorFramework");
         }
+        
+        // Forward queued messages, paced and in order
+        g_mqttOutbox->service(millis(), g_mqttClient->isConnected());
     }
     
     // Handle BLE events
-    if (ENABLE_BLE && g_bleManager) {
+    if (ENABLE_BLE && isBootStageDone("ble") && g_bleManager) {
         g_bleManager->update();
     }
     
     // Handle ESP-NOW events
-    if (ENABLE_ESPNOW && g_espnowManager) {
+    if (ENABLE_ESPNOW && isBootStageDone("espnow") && g_espnowManager) {
         g_espnowManager->update();
     }
     
-    // Check for wireless nodes
-    static unsigned long lastDiscoveryTime = 0;
+    // Look for hot-plugged I2C sensors without pausing acquisition
+    if (isBootStageDone("discovery") && g_rediscovery) {
+        updateRediscovery();
+    }
+    
+    // Run short discovery windows; the scheduler backs off while the node set is stable
     unsigned long currentTime = millis();
-    if (currentTime - lastDiscoveryTime > 60000) { // Every minute
-        if (g_wirelessNodeManager && !g_wirelessNodeManager->isDiscoveryRunning()) {
-            g_wirelessNodeManager->startDiscovery("all", 10000);
-            lastDiscoveryTime = currentTime;
+    if (isBootStageDone("wireless") && g_wirelessNodeManager) {
+        uint32_t window;
+        if (g_discoveryScheduler->update(currentTime, g_wirelessNodeManager->isDiscoveryRunning(), window)) {
+            g_wirelessNodeManager->startDiscovery("all", window);
+        }
+        
+        static unsigned long lastAirtimeReport = 0;
+        if (currentTime - lastAirtimeReport >= AIRTIME_REPORT_INTERVAL) {
+            auto stats = g_discoveryScheduler->getStats();
+            Serial.printf("Wireless airtime: discovery %llu ms in %u windows, data %llu ms in %u frames, "
+                          "round interval %u s\n",
+                          static_cast<unsigned long long>(stats.discoveryAirtime), stats.windows,
+                          static_cast<unsigned long long>(stats.dataAirtime), stats.dataFrames,
+                          stats.currentInterval / 1000);
+            lastAirtimeReport = currentTime;
+        }
+    }
+    
+    // Export per-stage latency percentiles for the last interval
+    static unsigned long lastLatencyReport = 0;
+    if (SENSORHUB_TRACING && currentTime - lastLatencyReport >= LATENCY_REPORT_INTERVAL) {
+        reportLatency();
+        lastLatencyReport = currentTime;
+    }
+    
+    // Export allocation accounting and heap fragmentation
+    static unsigned long lastHeapReport = 0;
+    if (SENSORHUB_ALLOC_TRACKING && currentTime - lastHeapReport >= HEAP_REPORT_INTERVAL) {
+        reportHeap();
+        lastHeapReport = currentTime;
+    }
+    
+    // Poll wireless nodes and complete or expire outstanding requests
+    static unsigned long lastPollTime = 0;
+    if (isBootStageDone("wireless") && g_nodeRequester) {
+        if (currentTime - lastPollTime >= NODE_POLL_INTERVAL) {
+            pollWirelessNodes();
+            lastPollTime = currentTime;
         }
+        g_nodeRequester->update();
+        g_nodeLiveness->advance(currentTime);
     }
     
     // Sleep to prevent watchdog triggers
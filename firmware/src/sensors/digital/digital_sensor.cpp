@@ -1,4 +1,6 @@
 #include "digital_sensor.hpp"
+#include "../../core/utils/latency_trace.hpp"
+#include <chrono>
 #include <thread>
 
 namespace sensors {
@@ -83,9 +85,8 @@ SensorReading DigitalSensor::read() {
     }
 
     // Check sampling period
-    auto now = std::chrono::steady_clock::now();
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - lastReadTime_).count() < protocol_.minSamplingPeriodMs) {
+    uint32_t now = hal_->millis();
+    if (hasRead_ && now - lastReadTime_ < protocol_.minSamplingPeriodMs) {
         lastError_ = "Reading too frequently";
         return reading;
     }
@@ -95,11 +96,15 @@ SensorReading DigitalSensor::read() {
     }
 
     // Convert primary reading
-    reading.value = convertReading(data_.data(), 0, config_.type);
-    reading.isValid = true;
     reading.unit = getSupportedUnits()[0];
+    {
+        SENSORHUB_TRACE_STAGE(CALIBRATE);
+        reading.value = convertReading(data_.data(), 0, reading.unit);
+    }
+    reading.isValid = true;
 
     lastReadTime_ = now;
+    hasRead_ = true;
     return reading;
 }
 
@@ -112,9 +117,8 @@ std::vector<SensorReading> DigitalSensor::readAll() {
     }
 
     // Check sampling period
-    auto now = std::chrono::steady_clock::now();
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - lastReadTime_).count() < protocol_.minSamplingPeriodMs) {
+    uint32_t now = hal_->millis();
+    if (hasRead_ && now - lastReadTime_ < protocol_.minSamplingPeriodMs) {
         lastError_ = "Reading too frequently";
         return readings;
     }
@@ -131,13 +135,17 @@ std::vector<SensorReading> DigitalSensor::readAll() {
         reading.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch()
         ).count();
-        reading.value = convertReading(data_.data(), i, units[i]);
+        {
+            SENSORHUB_TRACE_STAGE(CALIBRATE);
+            reading.value = convertReading(data_.data(), i, units[i]);
+        }
         reading.unit = units[i];
         reading.isValid = true;
         readings.push_back(reading);
     }
 
     lastReadTime_ = now;
+    hasRead_ = true;
     return readings;
 }
 
@@ -189,10 +197,15 @@ std::string DigitalSensor::getDescription() const {
 }
 
 std::vector<std::string> DigitalSensor::getSupportedUnits() const {
-    if (getName() == "DHT11" || getName() == "DHT22") {
-        return {"°C", "%"};
+    if (protocol_.channelCount == 0) {
+        return {"raw"};
+    }
+    
+    std::vector<std::string> units;
+    for (size_t i = 0; i < protocol_.channelCount; i++) {
+        units.push_back(protocol_.channels[i].unit);
     }
-    return {"raw"};
+    return units;
 }
 
 bool DigitalSensor::hasError() const {
@@ -212,31 +225,31 @@ bool DigitalSensor::wake() {
 }
 
 float DigitalSensor::getPowerConsumption() const {
-    // Return typical values based on sensor type
-    if (getName() == "DHT11") return 2.5f;
-    if (getName() == "DHT22") return 1.5f;
-    return 0.0f;
+    return protocol_.powerConsumption;
 }
 
 // Protected methods
 bool DigitalSensor::readRaw() {
     if (!hal_) return false;
 
-    startSignal();
-    
-    if (!waitForResponse()) {
+    bool responded;
+    {
+        SENSORHUB_TRACE_STAGE(BUS_TRANSFER);
+        responded = singleWireReadFrame(hal_, dataPin_, protocol_, data_.data(), data_.size());
+    }
+    if (!responded) {
         lastError_ = "No response from sensor";
         errorCount_++;
         return false;
     }
 
-    // Read all data bits
-    for (size_t i = 0; i < data_.size(); i++) {
-        data_[i] = readByte();
-    }
-
     // Verify checksum if required
-    if (protocol_.hasCRC && !checkCRC(data_.data(), data_.size())) {
+    bool valid = true;
+    if (protocol_.hasCRC) {
+        SENSORHUB_TRACE_STAGE(DECODE);
+        valid = checkCRC(data_.data(), data_.size());
+    }
+    if (!valid) {
         lastError_ = "CRC check failed";
         errorCount_++;
         return false;
@@ -249,90 +262,14 @@ bool DigitalSensor::readRaw() {
 
 bool DigitalSensor::checkCRC(const uint8_t* data, size_t length) {
     if (length < 5) return false;
-    
-    // Default DHT11/DHT22 CRC check
-    uint8_t sum = 0;
-    for (size_t i = 0; i < length - 1; i++) {
-        sum += data[i];
-    }
-    return (data[length - 1] == (sum & 0xFF));
-}
-
-void DigitalSensor::startSignal() {
-    hal_->pinMode(dataPin_, hal::PinMode::OUTPUT);
-    hal_->digitalWrite(dataPin_, false);
-    hal_->delay(protocol_.startSignalLowMs);
-    hal_->digitalWrite(dataPin_, true);
-    hal_->delayMicroseconds(protocol_.startSignalHighUs);
-    hal_->pinMode(dataPin_, protocol_.usePullup ? hal::PinMode::INPUT_PULLUP : hal::PinMode::INPUT);
-}
-
-bool DigitalSensor::waitForResponse() {
-    uint32_t timeout = 0;
-    
-    // Wait for low
-    while (hal_->digitalRead(dataPin_) == true) {
-        hal_->delayMicroseconds(1);
-        if (++timeout > protocol_.bitTimeoutUs) return false;
-    }
-    
-    timeout = 0;
-    // Wait for high
-    while (hal_->digitalRead(dataPin_) == false) {
-        hal_->delayMicroseconds(1);
-        if (++timeout > protocol_.bitTimeoutUs) return false;
-    }
-    
-    timeout = 0;
-    // Wait for low
-    while (hal_->digitalRead(dataPin_) == true) {
-        hal_->delayMicroseconds(1);
-        if (++timeout > protocol_.bitTimeoutUs) return false;
-    }
-    
-    return true;
-}
-
-bool DigitalSensor::readBit() {
-    uint32_t timeout = 0;
-    
-    // Wait for high
-    while (hal_->digitalRead(dataPin_) == false) {
-        hal_->delayMicroseconds(1);
-        if (++timeout > protocol_.bitTimeoutUs) return false;
-    }
-    
-    hal_->delayMicroseconds(protocol_.bitThresholdUs);
-    
-    // If still high after threshold time, it's a 1
-    return hal_->digitalRead(dataPin_);
-}
-
-uint8_t DigitalSensor::readByte() {
-    uint8_t byte = 0;
-    for (int i = 0; i < 8; i++) {
-        byte <<= 1;
-        byte |= readBit();
-    }
-    return byte;
+    return singleWireChecksum(data, length);
 }
 
 float DigitalSensor::convertReading(uint8_t* data, size_t index, const std::string& type) {
-    // Default conversion for DHT11/DHT22
-    if (getName() == "DHT11") {
-        if (type == "°C") {
-            return (static_cast<float>(data[2]) * calibration_.scale) + calibration_.offset;
-        } else if (type == "%") {
-            return (static_cast<float>(data[0]) * calibration_.scale) + calibration_.offset;
-        }
-    } else if (getName() == "DHT22") {
-        if (type == "°C") {
-            uint16_t raw = (data[2] << 8) | data[3];
-            return ((static_cast<float>(raw) / 10.0f) * calibration_.scale) + calibration_.offset;
-        } else if (type == "%") {
-            uint16_t raw = (data[0] << 8) | data[1];
-            return ((static_cast<float>(raw) / 10.0f) * calibration_.scale) + calibration_.offset;
-        }
+    // Channels are decoded by the protocol, in the order of getSupportedUnits()
+    (void)type;
+    if (protocol_.decode && index < protocol_.channelCount) {
+        return (protocol_.decode(data, index) * calibration_.scale) + calibration_.offset;
     }
     
     return static_cast<float>(data[index]);
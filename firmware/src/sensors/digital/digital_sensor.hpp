@@ -1,50 +1,20 @@
 #pragma once
 
-#include "../base/isensor.hpp"
-#include "../../hal/ihal.hpp"
-#include <chrono>
+#include "single_wire_protocol.hpp"
 #include <vector>
 #include <map>
 
 namespace sensors {
 
-// Protocol definitions for different digital sensors
-struct DigitalProtocol {
-    uint32_t startSignalLowMs;     // Start signal low time in ms
-    uint32_t startSignalHighUs;    // Start signal high time in μs
-    uint32_t bitTimeoutUs;         // Bit read timeout in μs
-    uint32_t bitThresholdUs;       // Threshold to determine 0/1 in μs
-    uint32_t minSamplingPeriodMs;  // Minimum time between readings
-    uint8_t numDataBits;           // Number of data bits to read
-    bool hasCRC;                   // Whether sensor uses CRC
-    bool usePullup;                // Whether to use internal pullup
-};
-
-// Known sensor protocols
+// Known sensor protocols, built from the traits used by SingleWireSensor
 const std::map<std::string, DigitalProtocol> SENSOR_PROTOCOLS = {
-    {"DHT11", {
-        18,    // 18ms start signal low
-        40,    // 40μs start signal high
-        100,   // 100μs bit timeout
-        30,    // 30μs bit threshold
-        2000,  // 2s minimum sampling period
-        40,    // 40 bits (5 bytes)
-        true,  // Has CRC
-        true   // Uses pullup
-    }},
-    {"DHT22", {
-        1,     // 1ms start signal low
-        30,    // 30μs start signal high
-        100,   // 100μs bit timeout
-        28,    // 28μs bit threshold
-        2000,  // 2s minimum sampling period
-        40,    // 40 bits (5 bytes)
-        true,  // Has CRC
-        true   // Uses pullup
-    }}
+    {DHT11Protocol::name, makeDigitalProtocol<DHT11Protocol>()},
+    {DHT22Protocol::name, makeDigitalProtocol<DHT22Protocol>()}
     // Add more sensor protocols here
 };
 
+// Single-wire sensor whose protocol is chosen by name in its configuration.
+// Protocols known at compile time are faster as SingleWireSensor<Protocol>.
 class DigitalSensor : public ISensor {
 public:
     DigitalSensor();
@@ -78,10 +48,6 @@ protected:
     // Protocol handling methods
     bool readRaw();
     bool checkCRC(const uint8_t* data, size_t length);
-    void startSignal();
-    bool waitForResponse();
-    bool readBit();
-    uint8_t readByte();
 
     // Data conversion methods
     virtual float convertReading(uint8_t* data, size_t index, const std::string& type);
@@ -93,8 +59,9 @@ private:
     std::string lastError_;
     uint32_t errorCount_;
     SensorConfig config_;
-    DigitalProtocol protocol_;
-    std::chrono::steady_clock::time_point lastReadTime_;
+    DigitalProtocol protocol_{};
+    uint32_t lastReadTime_{0};     // HAL time of the last successful read (ms)
+    bool hasRead_{false};          // A read has succeeded since begin()
 
     struct {
         bool isCalibrated{false};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "../base/isensor.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace sensors {
+
+// One value carried in a single-wire data frame
+struct SingleWireChannel {
+    const char* unit;            // Unit of measurement
+    const char* idSuffix;        // Appended to the sensor ID by readAll()
+    const char* calibrationKey;  // Key of the channel's calibration data
+};
+
+// Decodes the raw (uncalibrated) value of a channel from the data frame
+using SingleWireDecoder = float (*)(const uint8_t* data, size_t channel);
+
+// Protocol traits for SingleWireSensor. Every member is constexpr, so the
+// driver built on them has its timings and decode folded in at compile time.
+// The timing members carry the names of the DigitalProtocol fields, which
+// lets the bus routines below serve both the traits and runtime protocols.
+struct DHT11Protocol {
+    static constexpr const char* name = "DHT11";
+    static constexpr const char* description = "DHT11 Temperature and Humidity Sensor";
+    static constexpr SensorType type = SensorType::TEMPERATURE;  // Primary type
+    static constexpr uint32_t startSignalLowMs = 18;      // At least 18ms low
+    static constexpr uint32_t startSignalHighUs = 40;     // 20-40μs high
+    static constexpr uint32_t bitTimeoutUs = 100;
+    static constexpr uint32_t bitThresholdUs = 30;        // Still high after 30μs: a 1
+    static constexpr uint32_t minSamplingPeriodMs = 2000;
+    static constexpr uint8_t numDataBits = 40;            // 5 bytes, the last is the checksum
+    static constexpr bool hasCRC = true;
+    static constexpr bool usePullup = true;
+    static constexpr float powerConsumption = 2.5f;       // Typical current in mA
+
+    static constexpr size_t channelCount = 2;
+    static constexpr SingleWireChannel channels[channelCount] = {
+        {"°C", "_temp", "temperature"},
+        {"%", "_humidity", "humidity"}
+    };
+
+    // Integral parts only; the decimal bytes are always zero on the DHT11
+    static constexpr float decode(const uint8_t* data, size_t channel) {
+        return channel == 0 ? static_cast<float>(data[2]) : static_cast<float>(data[0]);
+    }
+};
+
+struct DHT22Protocol {
+    static constexpr const char* name = "DHT22";
+    static constexpr const char* description = "DHT22 Temperature and Humidity Sensor";
+    static constexpr SensorType type = SensorType::TEMPERATURE;  // Primary type
+    static constexpr uint32_t startSignalLowMs = 1;
+    static constexpr uint32_t startSignalHighUs = 30;
+    static constexpr uint32_t bitTimeoutUs = 100;
+    static constexpr uint32_t bitThresholdUs = 28;
+    static constexpr uint32_t minSamplingPeriodMs = 2000;
+    static constexpr uint8_t numDataBits = 40;
+    static constexpr bool hasCRC = true;
+    static constexpr bool usePullup = true;
+    static constexpr float powerConsumption = 1.5f;
+
+    static constexpr size_t channelCount = 2;
+    static constexpr SingleWireChannel channels[channelCount] = {
+        {"°C", "_temp", "temperature"},
+        {"%", "_humidity", "humidity"}
+    };
+
+    // Tenths of a unit; the temperature's top bit is its sign
+    static constexpr float decode(const uint8_t* data, size_t channel) {
+        if (channel == 0) {
+            float magnitude = static_cast<float>(((data[2] & 0x7F) << 8) | data[3]) / 10.0f;
+            return (data[2] & 0x80) ? -magnitude : magnitude;
+        }
+        return static_cast<float>((data[0] << 8) | data[1]) / 10.0f;
+    }
+};
+
+// Runtime form of the protocol traits, for sensors whose protocol is only
+// known from their configuration
+struct DigitalProtocol {
+    uint32_t startSignalLowMs;     // Start signal low time in ms
+    uint32_t startSignalHighUs;    // Start signal high time in μs
+    uint32_t bitTimeoutUs;         // Bit read timeout in μs
+    uint32_t bitThresholdUs;       // Threshold to determine 0/1 in μs
+    uint32_t minSamplingPeriodMs;  // Minimum time between readings
+    uint8_t numDataBits;           // Number of data bits to read
+    bool hasCRC;                   // Whether sensor uses CRC
+    bool usePullup;                // Whether to use internal pullup
+    float powerConsumption;        // Typical current in mA
+    const SingleWireChannel* channels;  // Values carried in a frame
+    size_t channelCount;           // Number of channels
+    SingleWireDecoder decode;      // Raw channel value from a frame
+};
+
+// Runtime protocol with the values of a traits struct
+template <typename Protocol>
+constexpr DigitalProtocol makeDigitalProtocol() {
+    return {
+        Protocol::startSignalLowMs,
+        Protocol::startSignalHighUs,
+        Protocol::bitTimeoutUs,
+        Protocol::bitThresholdUs,
+        Protocol::minSamplingPeriodMs,
+        Protocol::numDataBits,
+        Protocol::hasCRC,
+        Protocol::usePullup,
+        Protocol::powerConsumption,
+        Protocol::channels,
+        Protocol::channelCount,
+        Protocol::decode
+    };
+}
+
+//---------- Bus Routines ----------//
+
+// Shared by SingleWireSensor (Timing is a traits struct, timings are
+// constants) and DigitalSensor (Timing is a DigitalProtocol)
+
+template <typename Timing>
+void singleWireStart(hal::IHAL* io, uint8_t pin, const Timing& timing) {
+    io->pinMode(pin, hal::PinMode::OUTPUT);
+    io->digitalWrite(pin, false);
+    io->delay(timing.startSignalLowMs);
+    io->digitalWrite(pin, true);
+    io->delayMicroseconds(timing.startSignalHighUs);
+    io->pinMode(pin, timing.usePullup ? hal::PinMode::INPUT_PULLUP : hal::PinMode::INPUT);
+}
+
+// Wait while the line is at level; false on timeout
+template <typename Timing>
+bool singleWireWhile(hal::IHAL* io, uint8_t pin, const Timing& timing, bool level) {
+    uint32_t timeout = 0;
+    while (io->digitalRead(pin) == level) {
+        io->delayMicroseconds(1);
+        if (++timeout > timing.bitTimeoutUs) return false;
+    }
+    return true;
+}
+
+template <typename Timing>
+bool singleWireWaitForResponse(hal::IHAL* io, uint8_t pin, const Timing& timing) {
+    return singleWireWhile(io, pin, timing, true) &&
+           singleWireWhile(io, pin, timing, false) &&
+           singleWireWhile(io, pin, timing, true);
+}
+
+template <typename Timing>
+bool singleWireReadBit(hal::IHAL* io, uint8_t pin, const Timing& timing) {
+    // Wait for high
+    if (!singleWireWhile(io, pin, timing, false)) return false;
+
+    io->delayMicroseconds(timing.bitThresholdUs);
+
+    // If still high after threshold time, it's a 1
+    bool bit = io->digitalRead(pin);
+
+    // Let a 1 finish, otherwise the next bit starts inside its high phase
+    singleWireWhile(io, pin, timing, true);
+    return bit;
+}
+
+template <typename Timing>
+uint8_t singleWireReadByte(hal::IHAL* io, uint8_t pin, const Timing& timing) {
+    uint8_t byte = 0;
+    for (int i = 0; i < 8; i++) {
+        byte <<= 1;
+        byte |= singleWireReadBit(io, pin, timing);
+    }
+    return byte;
+}
+
+// Start signal, response and data bytes; false if the sensor does not answer
+template <typename Timing>
+bool singleWireReadFrame(hal::IHAL* io, uint8_t pin, const Timing& timing, uint8_t* data, size_t length) {
+    singleWireStart(io, pin, timing);
+    if (!singleWireWaitForResponse(io, pin, timing)) return false;
+
+    for (size_t i = 0; i < length; i++) {
+        data[i] = singleWireReadByte(io, pin, timing);
+    }
+    return true;
+}
+
+// DHT-style checksum: the last byte is the sum of the others
+inline bool singleWireChecksum(const uint8_t* data, size_t length) {
+    if (length < 2) return false;
+
+    uint8_t sum = 0;
+    for (size_t i = 0; i < length - 1; i++) {
+        sum += data[i];
+    }
+    return data[length - 1] == sum;
+}
+
+} // namespace sensors
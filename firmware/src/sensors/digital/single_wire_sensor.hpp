@@ -0,0 +1,352 @@
+#pragma once
+
+#include "single_wire_protocol.hpp"
+#include "../../core/utils/latency_trace.hpp"
+#include <array>
+#include <chrono>
+
+namespace sensors {
+
+// Single-wire (DHT-style) sensor specialized on a constexpr protocol traits
+// struct, see single_wire_protocol.hpp. Timings, frame length, checksum and
+// channel decode are compile-time constants, so the bit loop and conversion
+// carry no protocol lookups or name comparisons. Sensors whose protocol is
+// only known at runtime use DigitalSensor, which runs the same bus routines
+// on a DigitalProtocol.
+template <typename Protocol>
+class SingleWireSensor : public ISensor {
+public:
+    SingleWireSensor();
+    ~SingleWireSensor() override = default;
+
+    // ISensor interface implementation
+    bool begin(hal::IHAL* hal) override;
+    void end() override;
+    bool configure(const SensorConfig& config) override;
+    SensorConfig getConfig() const override;
+    bool isConnected() override;
+    SensorReading read() override;
+    std::vector<SensorReading> readAll() override;
+    bool requiresCalibration() const override;
+    bool isCalibrated() const override;
+    bool calibrate(const json& calibrationData) override;
+    json getCalibrationData() const override;
+    std::string getName() const override;
+    std::string getId() const override;
+    SensorType getType() const override;
+    SensorBus getBusType() const override;
+    std::string getDescription() const override;
+    std::vector<std::string> getSupportedUnits() const override;
+    bool hasError() const override;
+    std::string getLastError() const override;
+    bool sleep() override;
+    bool wake() override;
+    float getPowerConsumption() const override;
+
+protected:
+    // Protocol handling methods
+    bool checkSamplingPeriod(uint32_t now);
+    bool readRaw();
+
+    // Calibrated value of a channel from the last frame
+    float convertReading(size_t channel) const;
+
+private:
+    static constexpr size_t FRAME_BYTES = Protocol::numDataBits / 8;
+
+    uint8_t dataPin_ = 0;
+    uint8_t data_[FRAME_BYTES] = {};  // Raw data buffer
+    uint32_t lastReadTime_ = 0;       // HAL time of the last successful read (ms)
+    bool hasRead_ = false;            // A read has succeeded since begin()
+
+    // Calibration data per channel
+    struct ChannelCalibration {
+        float offset = 0.0f;
+        float scale = 1.0f;
+    };
+    std::array<ChannelCalibration, Protocol::channelCount> calibration_;
+    bool isCalibrated_ = false;
+
+    // Error tracking
+    uint32_t errorCount_ = 0;
+};
+
+template <typename Protocol>
+SingleWireSensor<Protocol>::SingleWireSensor() {
+    config_.type = Protocol::type;  // Primary type
+    config_.bus = SensorBus::GPIO_DIGITAL;
+}
+
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::begin(hal::IHAL* hal) {
+    if (!hal) {
+        lastError_ = "Invalid HAL pointer";
+        return false;
+    }
+
+    hal_ = hal;
+    dataPin_ = config_.busConfig["pin"].template get<uint8_t>();
+
+    // Configure pin as output initially
+    hal_->pinMode(dataPin_, hal::PinMode::OUTPUT);
+    hal_->digitalWrite(dataPin_, true);
+
+    // Wait for sensor to stabilize
+    hal_->delay(1000);
+
+    return true;
+}
+
+template <typename Protocol>
+void SingleWireSensor<Protocol>::end() {
+    if (hal_) {
+        hal_->pinMode(dataPin_, hal::PinMode::INPUT);
+    }
+    hal_ = nullptr;
+}
+
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::configure(const SensorConfig& config) {
+    if (!config.busConfig.contains("pin")) {
+        lastError_ = "Missing pin configuration";
+        return false;
+    }
+
+    config_ = config;
+    return true;
+}
+
+template <typename Protocol>
+SensorConfig SingleWireSensor<Protocol>::getConfig() const {
+    return config_;
+}
+
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::isConnected() {
+    if (!hal_) return false;
+
+    // Try to read data - if successful, sensor is connected
+    return readRaw();
+}
+
+template <typename Protocol>
+SensorReading SingleWireSensor<Protocol>::read() {
+    SensorReading reading;
+    reading.sensorId = getId();
+    reading.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+    reading.isValid = false;
+
+    if (!hal_) {
+        lastError_ = "HAL not initialized";
+        return reading;
+    }
+
+    uint32_t now = hal_->millis();
+    if (!checkSamplingPeriod(now) || !readRaw()) {
+        return reading;
+    }
+
+    // Primary channel
+    reading.rawValue = static_cast<double>(Protocol::decode(data_, 0));
+    {
+        SENSORHUB_TRACE_STAGE(CALIBRATE);
+        reading.value = convertReading(0);
+    }
+    reading.unit = Protocol::channels[0].unit;
+    reading.isValid = true;
+
+    lastReadTime_ = now;
+    hasRead_ = true;
+    return reading;
+}
+
+template <typename Protocol>
+std::vector<SensorReading> SingleWireSensor<Protocol>::readAll() {
+    std::vector<SensorReading> readings;
+
+    if (!hal_) {
+        lastError_ = "HAL not initialized";
+        return readings;
+    }
+
+    uint32_t now = hal_->millis();
+    if (!checkSamplingPeriod(now) || !readRaw()) {
+        return readings;
+    }
+
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+
+    readings.reserve(Protocol::channelCount);
+    for (size_t i = 0; i < Protocol::channelCount; i++) {
+        SensorReading reading;
+        reading.sensorId = getId() + Protocol::channels[i].idSuffix;
+        reading.timestamp = timestamp;
+        reading.rawValue = static_cast<double>(Protocol::decode(data_, i));
+        {
+            SENSORHUB_TRACE_STAGE(CALIBRATE);
+            reading.value = convertReading(i);
+        }
+        reading.unit = Protocol::channels[i].unit;
+        reading.isValid = true;
+        readings.push_back(std::move(reading));
+    }
+
+    lastReadTime_ = now;
+    hasRead_ = true;
+    return readings;
+}
+
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::requiresCalibration() const {
+    return true;
+}
+
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::isCalibrated() const {
+    return isCalibrated_;
+}
+
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::calibrate(const json& calibrationData) {
+    try {
+        for (size_t i = 0; i < Protocol::channelCount; i++) {
+            const char* key = Protocol::channels[i].calibrationKey;
+            if (calibrationData.contains(key)) {
+                auto& channel = calibrationData[key];
+                calibration_[i].offset = channel["offset"].template get<float>();
+                calibration_[i].scale = channel["scale"].template get<float>();
+            }
+        }
+
+        isCalibrated_ = true;
+        return true;
+    } catch (const std::exception& e) {
+        lastError_ = "Calibration data error: " + std::string(e.what());
+        return false;
+    }
+}
+
+template <typename Protocol>
+json SingleWireSensor<Protocol>::getCalibrationData() const {
+    json data;
+    for (size_t i = 0; i < Protocol::channelCount; i++) {
+        const char* key = Protocol::channels[i].calibrationKey;
+        data[key]["offset"] = calibration_[i].offset;
+        data[key]["scale"] = calibration_[i].scale;
+    }
+    return data;
+}
+
+template <typename Protocol>
+std::string SingleWireSensor<Protocol>::getName() const {
+    return Protocol::name;
+}
+
+template <typename Protocol>
+std::string SingleWireSensor<Protocol>::getId() const {
+    return config_.id;
+}
+
+template <typename Protocol>
+SensorType SingleWireSensor<Protocol>::getType() const {
+    return Protocol::type;
+}
+
+template <typename Protocol>
+SensorBus SingleWireSensor<Protocol>::getBusType() const {
+    return SensorBus::GPIO_DIGITAL;
+}
+
+template <typename Protocol>
+std::string SingleWireSensor<Protocol>::getDescription() const {
+    return Protocol::description;
+}
+
+template <typename Protocol>
+std::vector<std::string> SingleWireSensor<Protocol>::getSupportedUnits() const {
+    std::vector<std::string> units;
+    for (const auto& channel : Protocol::channels) {
+        units.push_back(channel.unit);
+    }
+    return units;
+}
+
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::hasError() const {
+    return !lastError_.empty();
+}
+
+template <typename Protocol>
+std::string SingleWireSensor<Protocol>::getLastError() const {
+    return lastError_;
+}
+
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::sleep() {
+    return true;  // DHT-style sensors have no sleep mode
+}
+
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::wake() {
+    return true;  // DHT-style sensors have no sleep mode
+}
+
+template <typename Protocol>
+float SingleWireSensor<Protocol>::getPowerConsumption() const {
+    return Protocol::powerConsumption;
+}
+
+// Protected methods
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::checkSamplingPeriod(uint32_t now) {
+    if (hasRead_ && now - lastReadTime_ < Protocol::minSamplingPeriodMs) {
+        lastError_ = "Reading too frequently";
+        return false;
+    }
+    return true;
+}
+
+template <typename Protocol>
+bool SingleWireSensor<Protocol>::readRaw() {
+    if (!hal_) return false;
+
+    bool responded;
+    {
+        SENSORHUB_TRACE_STAGE(BUS_TRANSFER);
+        responded = singleWireReadFrame(hal_, dataPin_, Protocol{}, data_, FRAME_BYTES);
+    }
+    if (!responded) {
+        lastError_ = "No response from sensor";
+        errorCount_++;
+        return false;
+    }
+
+    // Verify checksum
+    if (Protocol::hasCRC) {
+        bool valid;
+        {
+            SENSORHUB_TRACE_STAGE(DECODE);
+            valid = singleWireChecksum(data_, FRAME_BYTES);
+        }
+        if (!valid) {
+            lastError_ = "CRC check failed";
+            errorCount_++;
+            return false;
+        }
+    }
+
+    errorCount_ = 0;
+    lastError_.clear();
+    return true;
+}
+
+template <typename Protocol>
+float SingleWireSensor<Protocol>::convertReading(size_t channel) const {
+    return (Protocol::decode(data_, channel) * calibration_[channel].scale) + calibration_[channel].offset;
+}
+
+} // namespace sensors
@@ -0,0 +1,170 @@
+#include "i2c_bus_scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace sensors {
+
+I2CBusScheduler::I2CBusScheduler(hal::IHAL* hal, uint8_t sdaPin, uint8_t sclPin, hal::I2CSpeed maxSpeed)
+    : hal_(hal), sdaPin_(sdaPin), sclPin_(sclPin), maxSpeed_(maxSpeed) {
+}
+
+bool I2CBusScheduler::addSensor(I2CRegisterSensor* sensor) {
+    if (!sensor) return false;
+
+    std::lock_guard<std::mutex> busLock(busMutex_);
+    std::lock_guard<std::mutex> statsLock(statsMutex_);
+    for (const auto& device : devices_) {
+        if (device.sensor == sensor || device.sensor->getAddress() == sensor->getAddress()) {
+            return false;
+        }
+    }
+
+    Device device;
+    device.sensor = sensor;
+    device.speed = speedFor(sensor->getReadPlan().maxClock, maxSpeed_);
+    device.timing = I2CDeviceTiming{sensor->getId(), sensor->getAddress(),
+                                    static_cast<uint32_t>(device.speed), 0, 0, 0, 0, 0, 0};
+    devices_.push_back(std::move(device));
+    sortSchedule();
+    return true;
+}
+
+bool I2CBusScheduler::removeSensor(const std::string& sensorId) {
+    std::lock_guard<std::mutex> busLock(busMutex_);
+    std::lock_guard<std::mutex> statsLock(statsMutex_);
+    auto it = std::find_if(devices_.begin(), devices_.end(),
+                           [&](const Device& device) { return device.sensor->getId() == sensorId; });
+    if (it == devices_.end()) return false;
+
+    devices_.erase(it);
+    return true;
+}
+
+size_t I2CBusScheduler::getSensorCount() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return devices_.size();
+}
+
+std::vector<SensorReading> I2CBusScheduler::readAll() {
+    std::vector<SensorReading> readings;
+    if (!hal_) return readings;
+
+    std::lock_guard<std::mutex> lock(busMutex_);
+    if (devices_.empty()) return readings;
+
+    size_t fieldCount = 0;
+    for (const auto& device : devices_) {
+        fieldCount += device.sensor->getReadPlan().fields.size();
+    }
+    readings.reserve(fieldCount);
+
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+
+    // Start from the end of the schedule already at the current clock
+    bool reverse = clock_ != static_cast<uint32_t>(devices_.front().speed) &&
+                   clock_ == static_cast<uint32_t>(devices_.back().speed);
+
+    uint32_t windowStart = hal_->micros();
+    uint32_t clockChanges = 0;
+    uint64_t busTime = 0;
+
+    for (size_t i = 0; i < devices_.size(); i++) {
+        Device& device = devices_[reverse ? devices_.size() - 1 - i : i];
+
+        if (clock_ != static_cast<uint32_t>(device.speed)) {
+            setClock(device.speed);
+            clockChanges++;
+        }
+
+        uint32_t start = hal_->micros();
+        bool ok = device.sensor->readFrame();
+        uint32_t end = hal_->micros();
+
+        // Timings are kept with the device and reported below, under the stats lock
+        device.windowBusUs = end - start;
+        device.windowLatencyUs = end - windowStart;
+        device.windowOk = ok;
+        busTime += end - start;
+
+        if (ok) {
+            device.sensor->appendReadings(readings, timestamp);
+        }
+    }
+
+    uint32_t windowEnd = hal_->micros();
+
+    std::lock_guard<std::mutex> statsLock(statsMutex_);
+    for (auto& device : devices_) {
+        I2CDeviceTiming& timing = device.timing;
+        timing.busTimeUs += device.windowBusUs;
+        if (!device.windowOk) {
+            timing.failures++;
+            continue;
+        }
+        timing.reads++;
+        timing.lastLatencyUs = device.windowLatencyUs;
+        timing.maxLatencyUs = std::max(timing.maxLatencyUs, device.windowLatencyUs);
+        timing.totalLatencyUs += device.windowLatencyUs;
+    }
+    if (!statsStarted_) {
+        statsStart_ = windowStart;
+        statsStarted_ = true;
+    }
+    stats_.cycles++;
+    stats_.clockChanges += clockChanges;
+    stats_.busTimeUs += busTime;
+    stats_.windowTimeUs += windowEnd - windowStart;
+    stats_.elapsedUs = windowEnd - statsStart_;
+    return readings;
+}
+
+std::mutex& I2CBusScheduler::getBusMutex() {
+    return busMutex_;
+}
+
+I2CBusReport I2CBusScheduler::getReport() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    I2CBusReport report = stats_;
+    report.utilization = report.elapsedUs > 0
+        ? static_cast<float>(report.busTimeUs) / static_cast<float>(report.elapsedUs)
+        : 0.0f;
+    report.devices.reserve(devices_.size());
+    for (const auto& device : devices_) {
+        report.devices.push_back(device.timing);
+    }
+    return report;
+}
+
+void I2CBusScheduler::resetStats() {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats_ = I2CBusReport();
+    statsStarted_ = false;
+    for (auto& device : devices_) {
+        device.timing = I2CDeviceTiming{device.timing.sensorId, device.timing.address,
+                                        device.timing.clock, 0, 0, 0, 0, 0, 0};
+    }
+}
+
+hal::I2CSpeed I2CBusScheduler::speedFor(uint32_t maxClock, hal::I2CSpeed busLimit) {
+    uint32_t limit = std::min(maxClock, static_cast<uint32_t>(busLimit));
+    if (limit >= static_cast<uint32_t>(hal::I2CSpeed::FAST_MODE_PLUS)) return hal::I2CSpeed::FAST_MODE_PLUS;
+    if (limit >= static_cast<uint32_t>(hal::I2CSpeed::FAST_MODE)) return hal::I2CSpeed::FAST_MODE;
+    return hal::I2CSpeed::STANDARD_MODE;
+}
+
+// Private methods
+void I2CBusScheduler::sortSchedule() {
+    std::sort(devices_.begin(), devices_.end(), [](const Device& a, const Device& b) {
+        if (a.speed != b.speed) return static_cast<uint32_t>(a.speed) > static_cast<uint32_t>(b.speed);
+        return a.sensor->getAddress() < b.sensor->getAddress();
+    });
+}
+
+void I2CBusScheduler::setClock(hal::I2CSpeed speed) {
+    hal_->i2cInit(sdaPin_, sclPin_, speed);
+    clock_ = static_cast<uint32_t>(speed);
+}
+
+} // namespace sensors
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "i2c_register_sensor.hpp"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sensors {
+
+// Scheduling statistics of one device on the bus
+struct I2CDeviceTiming {
+    std::string sensorId;        // Sensor read from the device
+    uint8_t address;             // Device address
+    uint32_t clock;              // Bus clock the device is read at (Hz)
+    uint32_t reads;              // Successful scheduled reads
+    uint32_t failures;           // Failed scheduled reads
+    uint32_t lastLatencyUs;      // Window start to the device's last byte, last read
+    uint32_t maxLatencyUs;       // Worst latency seen
+    uint64_t totalLatencyUs;     // Sum over successful reads, for the mean
+    uint64_t busTimeUs;          // Time spent in the device's transactions
+};
+
+// Bus utilization and per-device latency since the first cycle or resetStats()
+struct I2CBusReport {
+    uint32_t cycles = 0;             // Windows run
+    uint32_t clockChanges = 0;       // Bus clock reconfigurations
+    uint64_t busTimeUs = 0;          // Time inside device transactions
+    uint64_t windowTimeUs = 0;       // Time the scheduler held the bus
+    uint64_t elapsedUs = 0;          // Time covered by the report
+    float utilization = 0.0f;        // busTimeUs / elapsedUs
+    std::vector<I2CDeviceTiming> devices;  // In schedule order
+};
+
+// Reads every I2CRegisterSensor on one I2C bus in a single bus-lock window.
+// The sensors' read plans run back to back, grouped by clock: each device is
+// read at the fastest standard speed both it (the protocol's clockSpeed) and
+// the bus wiring allow. Each window starts from whichever end of the
+// schedule runs at the current clock, so a bus with two speed classes
+// changes clock once per window rather than twice. Code that shares the
+// bus outside the scheduler takes getBusMutex() around its transactions.
+// Only bench_sensors constructs a scheduler so far; no firmware read path
+// creates I2CRegisterSensor instances to hand to it.
+class I2CBusScheduler {
+public:
+    I2CBusScheduler(hal::IHAL* hal, uint8_t sdaPin, uint8_t sclPin,
+                    hal::I2CSpeed maxSpeed = hal::I2CSpeed::FAST_MODE_PLUS);
+
+    // Add a configured sensor that has been started with begin(); false if
+    // another sensor already uses its address
+    bool addSensor(I2CRegisterSensor* sensor);
+    bool removeSensor(const std::string& sensorId);
+    size_t getSensorCount() const;
+
+    // Read every sensor in one window; sensors that fail are left out and
+    // counted in the report
+    std::vector<SensorReading> readAll();
+
+    // Held for the whole of every window
+    std::mutex& getBusMutex();
+
+    I2CBusReport getReport() const;
+    void resetStats();
+
+    // Fastest standard speed within both limits
+    static hal::I2CSpeed speedFor(uint32_t maxClock, hal::I2CSpeed busLimit);
+
+private:
+    struct Device {
+        I2CRegisterSensor* sensor;
+        hal::I2CSpeed speed;
+        I2CDeviceTiming timing;        // Report entry, under statsMutex_
+        uint32_t windowBusUs = 0;      // Last window's transfer time, under busMutex_
+        uint32_t windowLatencyUs = 0;  // Last window's latency, under busMutex_
+        bool windowOk = false;         // Last window's read succeeded, under busMutex_
+    };
+
+    void sortSchedule();
+    void setClock(hal::I2CSpeed speed);
+
+    hal::IHAL* hal_;
+    uint8_t sdaPin_;
+    uint8_t sclPin_;
+    hal::I2CSpeed maxSpeed_;
+    std::vector<Device> devices_;      // Fastest clock first, then by address
+    uint32_t clock_ = 0;               // Current bus clock (Hz), 0 if unknown
+
+    I2CBusReport stats_;
+    uint32_t statsStart_ = 0;          // HAL time the report starts at (us)
+    bool statsStarted_ = false;
+
+    std::mutex busMutex_;              // Held for every window
+    mutable std::mutex statsMutex_;    // Guards the report; devices_ changes under both mutexes
+};
+
+} // namespace sensors
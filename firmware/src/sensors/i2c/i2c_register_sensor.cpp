@@ -0,0 +1,796 @@
+#include "i2c_register_sensor.hpp"
+#include "../../core/utils/latency_trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+
+namespace sensors {
+
+namespace {
+
+const json NONE;
+
+// Member of an object, or null if absent
+const json& member(const json& object, const char* key) {
+    if (!object.is_object()) return NONE;
+    auto it = object.find(key);
+    return it != object.end() ? *it : NONE;
+}
+
+// Protocol files keep everything under a top-level "protocol" key
+const json& protocolRoot(const json& document) {
+    const json& root = member(document, "protocol");
+    return root.is_object() ? root : document;
+}
+
+// Byte from a number or a "0x.." string
+bool parseByte(const json& value, uint8_t& out) {
+    long parsed;
+    if (value.is_number_unsigned() || value.is_number_integer()) {
+        parsed = value.get<long>();
+    } else if (value.is_string()) {
+        const std::string& text = value.get_ref<const std::string&>();
+        char* end = nullptr;
+        parsed = strtol(text.c_str(), &end, 0);
+        if (text.empty() || *end != '\0') return false;
+    } else {
+        return false;
+    }
+
+    if (parsed < 0 || parsed > 0xFF) return false;
+    out = static_cast<uint8_t>(parsed);
+    return true;
+}
+
+// Bit position from a number, or a "low-high" range from a string
+bool parseBitRange(const json& value, uint8_t& low, uint8_t& width) {
+    unsigned first, last;
+    if (value.is_number_unsigned() || value.is_number_integer()) {
+        first = last = value.get<unsigned>();
+    } else if (value.is_string()) {
+        if (sscanf(value.get_ref<const std::string&>().c_str(), "%u-%u", &first, &last) != 2) return false;
+    } else {
+        return false;
+    }
+
+    if (first > last || last > 31) return false;
+    low = static_cast<uint8_t>(first);
+    width = static_cast<uint8_t>(last - first + 1);
+    return true;
+}
+
+bool parseType(const std::string& type, uint8_t& bytes, bool& isSigned) {
+    static const std::map<std::string, std::pair<uint8_t, bool>> TYPES = {
+        {"uint8", {1, false}}, {"int8", {1, true}},
+        {"uint16", {2, false}}, {"int16", {2, true}},
+        {"uint24", {3, false}}, {"int24", {3, true}},
+        {"uint32", {4, false}}, {"int32", {4, true}}
+    };
+
+    auto it = TYPES.find(type);
+    if (it == TYPES.end()) return false;
+    bytes = it->second.first;
+    isSigned = it->second.second;
+    return true;
+}
+
+// Register address and length from an address or a register name
+bool findRegister(const json& registers, const json& ref, uint8_t& address, uint8_t& length) {
+    const json* entry = nullptr;
+    if (ref.is_string() && registers.contains(ref.get_ref<const std::string&>())) {
+        entry = &registers[ref.get_ref<const std::string&>()];
+        if (!parseByte(member(*entry, "address"), address)) return false;
+    } else {
+        if (!parseByte(ref, address)) return false;
+        for (const auto& candidate : registers) {
+            uint8_t candidateAddress;
+            if (parseByte(member(candidate, "address"), candidateAddress) && candidateAddress == address) {
+                entry = &candidate;
+                break;
+            }
+        }
+    }
+
+    const json& registerLength = entry ? member(*entry, "length") : NONE;
+    length = registerLength.is_number() ? registerLength.get<uint8_t>() : 0;
+    return true;
+}
+
+// Bitfield value of a setting: booleans, option indices or numbers
+bool encodeSetting(const json& setting, const json& option, uint32_t& value) {
+    if (setting.is_boolean()) {
+        value = setting.get<bool>() ? 1 : 0;
+        return true;
+    }
+    if (setting.is_string()) {
+        const json& options = member(option, "options");
+        if (!options.is_array()) return false;
+        auto it = std::find(options.begin(), options.end(), setting);
+        if (it == options.end()) return false;
+        value = static_cast<uint32_t>(it - options.begin());
+        return true;
+    }
+    if (setting.is_number()) {
+        double number = setting.get<double>();
+        if (number < 0) return false;
+        value = static_cast<uint32_t>(number);
+        return true;
+    }
+    return false;
+}
+
+std::vector<uint8_t> bigEndian(uint32_t value, uint8_t length) {
+    std::vector<uint8_t> bytes(length);
+    for (uint8_t i = 0; i < length; i++) {
+        bytes[length - 1 - i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    return bytes;
+}
+
+std::string hexByte(uint8_t value) {
+    char text[5];
+    snprintf(text, sizeof(text), "0x%02X", value);
+    return text;
+}
+
+SensorType sensorTypeFromName(const std::string& name) {
+    static const std::map<std::string, SensorType> TYPES = {
+        {"temperature", SensorType::TEMPERATURE},
+        {"humidity", SensorType::HUMIDITY},
+        {"pressure", SensorType::PRESSURE},
+        {"co2", SensorType::CO2},
+        {"voc", SensorType::VOC},
+        {"light", SensorType::LIGHT},
+        {"motion", SensorType::MOTION}
+    };
+
+    auto it = TYPES.find(name);
+    return it != TYPES.end() ? it->second : SensorType::CUSTOM;
+}
+
+} // namespace
+
+I2CRegisterSensor::I2CRegisterSensor(const json& protocol) : protocol_(protocolRoot(protocol)) {
+    config_.bus = SensorBus::I2C;
+    config_.type = SensorType::CUSTOM;
+
+    const json& types = member(member(protocol_, "capabilities"), "sensorTypes");
+    if (types.is_array() && !types.empty() && types[0].is_string()) {
+        config_.type = sensorTypeFromName(types[0].get<std::string>());
+    }
+
+    pointerWrite_.resize(1);
+    burst_.reserve(MAX_BURST);
+}
+
+bool I2CRegisterSensor::begin(hal::IHAL* hal) {
+    if (!hal) {
+        lastError_ = "Invalid HAL pointer";
+        return false;
+    }
+
+    hal_ = hal;
+    pointer_ = -1;
+
+    const json& sda = member(config_.busConfig, "sdaPin");
+    const json& scl = member(config_.busConfig, "sclPin");
+    if (sda.is_number() && scl.is_number()) {
+        uint32_t frequency = member(config_.busConfig, "frequency").is_number()
+            ? config_.busConfig["frequency"].get<uint32_t>()
+            : 100000;
+        hal::I2CSpeed speed = frequency >= 1000000 ? hal::I2CSpeed::FAST_MODE_PLUS
+                            : frequency >= 400000 ? hal::I2CSpeed::FAST_MODE
+                            : hal::I2CSpeed::STANDARD_MODE;
+        hal_->i2cInit(sda.get<uint8_t>(), scl.get<uint8_t>(), speed);
+    }
+
+    if (!runInitSequence()) {
+        return false;
+    }
+
+    for (const auto& write : configWrites_) {
+        if (!writeRegister(write.reg, write.bytes)) {
+            lastError_ = "Failed to write register " + hexByte(write.reg);
+            return false;
+        }
+    }
+    return true;
+}
+
+void I2CRegisterSensor::end() {
+    hal_ = nullptr;
+    pointer_ = -1;
+}
+
+bool I2CRegisterSensor::configure(const SensorConfig& config) {
+    uint8_t address;
+    const json& configured = member(config.busConfig, "address");
+    const json& fallback = member(member(member(protocol_, "communication"), "i2c"), "defaultAddress");
+    if (!parseByte(configured.is_null() ? fallback : configured, address)) {
+        lastError_ = "Missing or invalid I2C address";
+        return false;
+    }
+
+    RegisterReadPlan plan;
+    std::string error;
+    if (!compileReadPlan(protocol_, plan, error)) {
+        lastError_ = error;
+        return false;
+    }
+
+    std::vector<RegisterWrite> writes;
+    const json& settings = member(config.busConfig, "settings");
+    if (!compileConfigWrites(protocol_, settings.is_object() ? settings : json::object(), writes, error)) {
+        lastError_ = error;
+        return false;
+    }
+
+    plan_ = std::move(plan);
+    configWrites_ = std::move(writes);
+    address_ = address;
+    config_ = config;
+    config_.bus = SensorBus::I2C;
+    frame_.assign(plan_.frameBytes, 0);
+
+    if (config.calibration.is_object() && !config.calibration.empty()) {
+        return calibrate(config.calibration);
+    }
+    applyCalibration();
+    return true;
+}
+
+SensorConfig I2CRegisterSensor::getConfig() const {
+    return config_;
+}
+
+bool I2CRegisterSensor::isConnected() {
+    if (!hal_) return false;
+
+    // Check the identification registers if the protocol has any
+    const json& identifiers = member(member(protocol_, "discovery"), "uniqueIdentifiers");
+    if (identifiers.is_array() && !identifiers.empty()) {
+        for (const auto& identifier : identifiers) {
+            uint8_t reg, expected, value;
+            if (!parseByte(member(identifier, "register"), reg) ||
+                !parseByte(member(identifier, "value"), expected)) {
+                continue;
+            }
+            if (!readRegister(reg, value) || value != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return readFrame();
+}
+
+SensorReading I2CRegisterSensor::read() {
+    SensorReading reading;
+    reading.sensorId = getId();
+    reading.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+    reading.isValid = false;
+
+    if (!hal_) {
+        lastError_ = "HAL not initialized";
+        return reading;
+    }
+
+    if (plan_.fields.empty() || !readFrame()) {
+        return reading;
+    }
+
+    // Primary field
+    const RegisterField& field = plan_.fields[0];
+    double raw = decodeField(field);
+    reading.rawValue = raw * field.scale + field.offset;
+    {
+        SENSORHUB_TRACE_STAGE(CALIBRATE);
+        reading.value = raw * field.gain + field.bias;
+    }
+    reading.unit = field.unit;
+    reading.isValid = true;
+    return reading;
+}
+
+std::vector<SensorReading> I2CRegisterSensor::readAll() {
+    std::vector<SensorReading> readings;
+
+    if (!hal_) {
+        lastError_ = "HAL not initialized";
+        return readings;
+    }
+
+    if (!readFrame()) {
+        return readings;
+    }
+
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+
+    readings.reserve(plan_.fields.size());
+    appendReadings(readings, timestamp);
+    return readings;
+}
+
+void I2CRegisterSensor::appendReadings(std::vector<SensorReading>& readings, uint64_t timestamp) const {
+    for (const auto& field : plan_.fields) {
+        SensorReading reading;
+        reading.sensorId = getId() + "_" + field.name;
+        reading.timestamp = timestamp;
+        double raw = decodeField(field);
+        reading.rawValue = raw * field.scale + field.offset;
+        {
+            SENSORHUB_TRACE_STAGE(CALIBRATE);
+            reading.value = raw * field.gain + field.bias;
+        }
+        reading.unit = field.unit;
+        reading.isValid = true;
+        readings.push_back(std::move(reading));
+    }
+}
+
+bool I2CRegisterSensor::requiresCalibration() const {
+    return member(protocol_, "calibration").is_object();
+}
+
+bool I2CRegisterSensor::isCalibrated() const {
+    return calibration_.isCalibrated;
+}
+
+bool I2CRegisterSensor::calibrate(const json& calibrationData) {
+    try {
+        calibration_.offset = calibrationData.value("offset", 0.0);
+        calibration_.scale = calibrationData.value("scale", 1.0);
+        calibration_.isCalibrated = true;
+        applyCalibration();
+        return true;
+    } catch (const std::exception& e) {
+        lastError_ = "Calibration data error: " + std::string(e.what());
+        return false;
+    }
+}
+
+json I2CRegisterSensor::getCalibrationData() const {
+    json data;
+    data["offset"] = calibration_.offset;
+    data["scale"] = calibration_.scale;
+    return data;
+}
+
+std::string I2CRegisterSensor::getName() const {
+    const json& name = member(protocol_, "name");
+    return name.is_string() ? name.get<std::string>() : "I2C register sensor";
+}
+
+std::string I2CRegisterSensor::getId() const {
+    return config_.id;
+}
+
+SensorType I2CRegisterSensor::getType() const {
+    return config_.type;
+}
+
+SensorBus I2CRegisterSensor::getBusType() const {
+    return SensorBus::I2C;
+}
+
+std::string I2CRegisterSensor::getDescription() const {
+    const json& description = member(protocol_, "description");
+    return description.is_string() ? description.get<std::string>() : getName();
+}
+
+std::vector<std::string> I2CRegisterSensor::getSupportedUnits() const {
+    std::vector<std::string> units;
+    for (const auto& field : plan_.fields) {
+        units.push_back(field.unit);
+    }
+    return units;
+}
+
+bool I2CRegisterSensor::hasError() const {
+    return !lastError_.empty();
+}
+
+std::string I2CRegisterSensor::getLastError() const {
+    return lastError_;
+}
+
+bool I2CRegisterSensor::sleep() {
+    return setBit("sleep", true);
+}
+
+bool I2CRegisterSensor::wake() {
+    return setBit("sleep", false);
+}
+
+float I2CRegisterSensor::getPowerConsumption() const {
+    const json& active = member(member(member(protocol_, "capabilities"), "powerConsumption"), "active");
+    return active.is_number() ? active.get<float>() : 0.0f;
+}
+
+const RegisterReadPlan& I2CRegisterSensor::getReadPlan() const {
+    return plan_;
+}
+
+uint8_t I2CRegisterSensor::getAddress() const {
+    return address_;
+}
+
+bool I2CRegisterSensor::readFrame() {
+    if (!hal_) return false;
+
+    // A pointer-addressed device is read starting from the register it points at
+    size_t first = 0;
+    if (!plan_.autoIncrement) {
+        while (first < plan_.bursts.size() && plan_.bursts[first].startRegister != pointer_) first++;
+        if (first == plan_.bursts.size()) first = 0;
+    }
+
+    SENSORHUB_TRACE_STAGE(BUS_TRANSFER);
+    for (size_t i = 0; i < plan_.bursts.size(); i++) {
+        const RegisterBurst& burst = plan_.bursts[(first + i) % plan_.bursts.size()];
+        // A pointer-addressed device still points at the register it was last read from
+        if (plan_.autoIncrement || pointer_ != burst.startRegister) {
+            pointerWrite_[0] = burst.startRegister;
+            if (!hal_->i2cWrite(address_, pointerWrite_)) {
+                lastError_ = "No response from sensor";
+                errorCount_++;
+                pointer_ = -1;
+                return false;
+            }
+        }
+        pointer_ = plan_.autoIncrement ? -1 : burst.startRegister;
+
+        if (!hal_->i2cRead(address_, burst_, burst.length) || burst_.size() < burst.length) {
+            lastError_ = "Short read from register " + hexByte(burst.startRegister);
+            errorCount_++;
+            return false;
+        }
+        std::copy(burst_.begin(), burst_.begin() + burst.length, frame_.begin() + burst.frameOffset);
+    }
+
+    errorCount_ = 0;
+    lastError_.clear();
+    return true;
+}
+
+bool I2CRegisterSensor::compileReadPlan(const json& protocol, RegisterReadPlan& plan, std::string& error) {
+    const json& root = protocolRoot(protocol);
+    const json& registers = member(root, "registers");
+    const json& dataFormat = member(root, "dataFormat");
+    const json& fields = member(dataFormat, "fields");
+    const json& conversion = member(dataFormat, "conversion");
+
+    plan = RegisterReadPlan();
+    if (!fields.is_array() || fields.empty()) {
+        error = "Protocol has no dataFormat fields";
+        return false;
+    }
+
+    const json& i2c = member(member(root, "communication"), "i2c");
+    const json& autoIncrement = member(i2c, "autoIncrement");
+    plan.autoIncrement = autoIncrement.is_boolean() ? autoIncrement.get<bool>() : true;
+    const json& clockSpeed = member(i2c, "clockSpeed");
+    plan.maxClock = clockSpeed.is_number() ? clockSpeed.get<uint32_t>() : 100000;
+
+    // Resolve each field and the register span it needs
+    struct Span {
+        int start;
+        int end;
+    };
+    std::vector<Span> spans;
+    std::vector<uint8_t> fieldRegisters;
+
+    for (const auto& entry : fields) {
+        RegisterField field;
+        const json& name = member(entry, "name");
+        field.name = name.is_string() ? name.get<std::string>() : "value";
+        const json& unit = member(entry, "unit");
+        field.unit = unit.is_string() ? unit.get<std::string>() : "";
+
+        const json& type = member(entry, "type");
+        const json& defaultType = member(conversion, "dataType");
+        std::string typeName = type.is_string() ? type.get<std::string>()
+                             : defaultType.is_string() ? defaultType.get<std::string>() : "uint16";
+        if (!parseType(typeName, field.length, field.isSigned)) {
+            error = "Unsupported type " + typeName + " for field " + field.name;
+            return false;
+        }
+
+        const json& bits = member(entry, "length");
+        if (bits.is_number() && bits.get<unsigned>() != field.length * 8u) {
+            error = "Length of field " + field.name + " does not match its type";
+            return false;
+        }
+
+        uint8_t reg, registerLength;
+        if (!findRegister(registers, member(entry, "register"), reg, registerLength)) {
+            error = "Invalid register for field " + field.name;
+            return false;
+        }
+
+        const json& scaling = member(entry, "scaling");
+        const json& factor = member(conversion, "factor");
+        field.scale = scaling.is_number() ? scaling.get<double>() : factor.is_number() ? factor.get<double>() : 1.0;
+        const json& offset = member(entry, "offset");
+        field.offset = offset.is_number() ? offset.get<double>() : 0.0;
+        const json& byteOrder = member(entry, "byteOrder");
+        field.littleEndian = byteOrder.is_string() && byteOrder.get<std::string>() == "little";
+        field.gain = field.scale;
+        field.bias = field.offset;
+
+        // Without auto-increment a transaction always returns the whole register
+        int length = plan.autoIncrement ? field.length : std::max<int>(field.length, registerLength);
+        if (length > static_cast<int>(MAX_BURST) || reg + (plan.autoIncrement ? length : 1) > 0x100) {
+            error = "Field " + field.name + " does not fit the register map";
+            return false;
+        }
+
+        spans.push_back({reg, reg + length});
+        fieldRegisters.push_back(reg);
+        plan.fields.push_back(field);
+    }
+
+    // Merge spans into bursts, reading across gaps that cost less than a transaction
+    std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) { return a.start < b.start; });
+    std::vector<Span> merged;
+    for (const auto& span : spans) {
+        if (!merged.empty()) {
+            Span& last = merged.back();
+            bool mergeable = plan.autoIncrement
+                ? span.start <= last.end + static_cast<int>(MAX_GAP) &&
+                  std::max(last.end, span.end) - last.start <= static_cast<int>(MAX_BURST)
+                : span.start == last.start;
+            if (mergeable) {
+                last.end = std::max(last.end, span.end);
+                continue;
+            }
+        }
+        merged.push_back(span);
+    }
+
+    for (const auto& span : merged) {
+        plan.bursts.push_back({static_cast<uint8_t>(span.start),
+                               static_cast<uint8_t>(span.end - span.start),
+                               static_cast<uint16_t>(plan.frameBytes)});
+        plan.frameBytes += span.end - span.start;
+    }
+
+    // Place every field in the frame
+    for (size_t i = 0; i < plan.fields.size(); i++) {
+        int reg = fieldRegisters[i];
+        for (const auto& burst : plan.bursts) {
+            bool inBurst = plan.autoIncrement
+                ? reg >= burst.startRegister && reg + plan.fields[i].length <= burst.startRegister + burst.length
+                : reg == burst.startRegister;
+            if (inBurst) {
+                plan.fields[i].frameOffset = static_cast<uint16_t>(burst.frameOffset + (reg - burst.startRegister));
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+bool I2CRegisterSensor::compileConfigWrites(const json& protocol, const json& settings,
+                                            std::vector<RegisterWrite>& writes, std::string& error) {
+    const json& root = protocolRoot(protocol);
+    const json& registers = member(root, "registers");
+    const json& options = member(root, "configuration");
+
+    writes.clear();
+    if (!registers.is_object()) {
+        return true;
+    }
+
+    // Bitfields start from the value the init sequence writes
+    std::map<uint8_t, uint32_t> initial;
+    const json& initSequence = member(root, "initSequence");
+    if (initSequence.is_array()) {
+        for (const auto& step : initSequence) {
+            uint8_t reg, value;
+            if (member(step, "type") == "write" &&
+                parseByte(member(step, "register"), reg) && parseByte(member(step, "value"), value)) {
+                initial[reg] = value;
+            }
+        }
+    }
+
+    // Setting given for the instance, or the protocol default
+    auto settingFor = [&](const std::string& name) -> const json& {
+        const json& setting = member(settings, name.c_str());
+        return setting.is_null() ? member(member(options, name.c_str()), "default") : setting;
+    };
+
+    for (auto it = registers.begin(); it != registers.end(); ++it) {
+        const json& entry = it.value();
+        const json& access = member(entry, "access");
+        if (!access.is_string() || access.get<std::string>().find("write") == std::string::npos) continue;
+
+        uint8_t reg;
+        if (!parseByte(member(entry, "address"), reg)) {
+            error = "Invalid address for register " + it.key();
+            return false;
+        }
+        const json& lengthEntry = member(entry, "length");
+        uint8_t length = lengthEntry.is_number() ? lengthEntry.get<uint8_t>() : 1;
+        if (length < 1 || length > 4) {
+            error = "Unsupported length for register " + it.key();
+            return false;
+        }
+
+        const json& bits = member(entry, "bits");
+        if (bits.is_array()) {
+            bool touched = initial.count(reg) > 0;
+            uint32_t value = touched ? initial[reg] : 0;
+
+            for (const auto& bit : bits) {
+                const json& nameEntry = member(bit, "name");
+                if (!nameEntry.is_string()) continue;
+                const std::string& name = nameEntry.get_ref<const std::string&>();
+
+                const json& setting = settingFor(name);
+                if (setting.is_null()) continue;
+
+                uint8_t low, width;
+                if (!parseBitRange(member(bit, "bit"), low, width)) {
+                    error = "Invalid bit range for " + name;
+                    return false;
+                }
+
+                uint32_t field;
+                uint32_t mask = width >= 32 ? 0xFFFFFFFFu : (1u << width) - 1;
+                if (!encodeSetting(setting, member(options, name.c_str()), field) || field > mask) {
+                    error = "Invalid value for setting " + name;
+                    return false;
+                }
+
+                value = (value & ~(mask << low)) | (field << low);
+                touched = true;
+            }
+
+            if (touched) {
+                writes.push_back({reg, bigEndian(value, length)});
+            }
+            continue;
+        }
+
+        // Scaled value registers, such as alarm limits
+        const json& scaling = member(entry, "scaling");
+        const json& setting = settingFor(it.key());
+        if (scaling.is_number() && setting.is_number()) {
+            long raw = lround(setting.get<double>() / scaling.get<double>());
+            writes.push_back({reg, bigEndian(static_cast<uint32_t>(raw), length)});
+        }
+    }
+    return true;
+}
+
+// Protected methods
+bool I2CRegisterSensor::writeRegister(uint8_t reg, const std::vector<uint8_t>& bytes) {
+    std::vector<uint8_t> data;
+    data.reserve(bytes.size() + 1);
+    data.push_back(reg);
+    data.insert(data.end(), bytes.begin(), bytes.end());
+
+    bool written = hal_->i2cWrite(address_, data);
+    pointer_ = written && !plan_.autoIncrement ? reg : -1;
+    return written;
+}
+
+bool I2CRegisterSensor::readRegister(uint8_t reg, uint8_t& value) {
+    pointerWrite_[0] = reg;
+    if (!hal_->i2cWrite(address_, pointerWrite_) || !hal_->i2cRead(address_, burst_, 1) || burst_.empty()) {
+        lastError_ = "Failed to read register " + hexByte(reg);
+        pointer_ = -1;
+        return false;
+    }
+
+    pointer_ = plan_.autoIncrement ? -1 : reg;
+    value = burst_[0];
+    return true;
+}
+
+bool I2CRegisterSensor::runInitSequence() {
+    const json& initSequence = member(protocol_, "initSequence");
+    if (!initSequence.is_array()) return true;
+
+    for (const auto& step : initSequence) {
+        const json& type = member(step, "type");
+        uint8_t reg, value;
+
+        if (type == "delay") {
+            const json& delay = member(step, "value");
+            hal_->delay(delay.is_number() ? delay.get<uint32_t>() : 0);
+        } else if (type == "write") {
+            if (!parseByte(member(step, "register"), reg) || !parseByte(member(step, "value"), value) ||
+                !writeRegister(reg, {value})) {
+                lastError_ = "Init sequence write failed";
+                return false;
+            }
+        } else if (type == "read") {
+            if (!parseByte(member(step, "register"), reg) || !readRegister(reg, value)) {
+                lastError_ = "Init sequence read failed";
+                return false;
+            }
+            uint8_t expected;
+            if (parseByte(member(step, "expectedValue"), expected) && value != expected) {
+                lastError_ = "Unexpected value " + hexByte(value) + " in register " + hexByte(reg);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool I2CRegisterSensor::setBit(const std::string& name, bool value) {
+    if (!hal_) {
+        lastError_ = "HAL not initialized";
+        return false;
+    }
+
+    const json& registers = member(protocol_, "registers");
+    if (!registers.is_object()) return false;
+
+    for (const auto& entry : registers) {
+        const json& bits = member(entry, "bits");
+        if (!bits.is_array()) continue;
+
+        for (const auto& bit : bits) {
+            uint8_t reg, low, width;
+            if (member(bit, "name") != name || !parseBitRange(member(bit, "bit"), low, width) ||
+                !parseByte(member(entry, "address"), reg)) {
+                continue;
+            }
+
+            // Update the compiled write so begin() restores the current state
+            auto write = std::find_if(configWrites_.begin(), configWrites_.end(),
+                                      [reg](const RegisterWrite& w) { return w.reg == reg; });
+            if (write == configWrites_.end()) {
+                const json& length = member(entry, "length");
+                configWrites_.push_back({reg, std::vector<uint8_t>(length.is_number() ? length.get<uint8_t>() : 1)});
+                write = configWrites_.end() - 1;
+            }
+
+            uint8_t byte = static_cast<uint8_t>(write->bytes.size() - 1 - low / 8);
+            uint8_t mask = static_cast<uint8_t>(1u << (low % 8));
+            write->bytes[byte] = value ? (write->bytes[byte] | mask) : (write->bytes[byte] & ~mask);
+            return writeRegister(reg, write->bytes);
+        }
+    }
+
+    lastError_ = "Register bit " + name + " not supported";
+    return false;
+}
+
+double I2CRegisterSensor::decodeField(const RegisterField& field) const {
+    uint32_t raw = 0;
+    for (uint8_t i = 0; i < field.length; i++) {
+        uint8_t byte = frame_[field.frameOffset + (field.littleEndian ? field.length - 1 - i : i)];
+        raw = (raw << 8) | byte;
+    }
+
+    if (field.isSigned && field.length < 4) {
+        uint32_t sign = 1u << (field.length * 8 - 1);
+        return static_cast<double>(static_cast<int32_t>((raw ^ sign) - sign));
+    }
+    return field.isSigned ? static_cast<double>(static_cast<int32_t>(raw)) : static_cast<double>(raw);
+}
+
+// Private methods
+void I2CRegisterSensor::applyCalibration() {
+    // value = (raw * scale + offset) * calScale + calOffset, as one multiply-add
+    for (auto& field : plan_.fields) {
+        field.gain = field.scale * calibration_.scale;
+        field.bias = field.offset * calibration_.scale + calibration_.offset;
+    }
+}
+
+} // namespace sensors
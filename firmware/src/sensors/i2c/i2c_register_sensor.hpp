@@ -0,0 +1,143 @@
+#pragma once
+
+#include "../base/isensor.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sensors {
+
+// One burst read of the plan: register pointer write, then length bytes
+struct RegisterBurst {
+    uint8_t startRegister;   // First register read
+    uint8_t length;          // Bytes read
+    uint16_t frameOffset;    // Position of the bytes in the frame buffer
+};
+
+// A dataFormat field, with its conversion resolved
+struct RegisterField {
+    std::string name;        // Field name, appended to the sensor ID by readAll()
+    std::string unit;        // Unit of measurement
+    uint16_t frameOffset;    // Position of the field in the frame buffer
+    uint8_t length;          // Field size in bytes (1-4)
+    bool isSigned;           // Two's complement value
+    bool littleEndian;       // Least significant byte first
+    double scale;            // Raw to unit factor
+    double offset;           // Added after scaling
+    double gain;             // scale with calibration folded in
+    double bias;             // offset with calibration folded in
+};
+
+// Register write run by begin(), sleep() or wake()
+struct RegisterWrite {
+    uint8_t reg;                 // Register
+    std::vector<uint8_t> bytes;  // Value, most significant byte first
+};
+
+// Everything a reading needs, compiled from the protocol JSON
+struct RegisterReadPlan {
+    std::vector<RegisterBurst> bursts;   // Burst reads, in register order
+    std::vector<RegisterField> fields;   // Fields decoded from the frame
+    size_t frameBytes = 0;               // Total bytes read per reading
+    bool autoIncrement = true;           // Device advances its register pointer while reading
+    uint32_t maxClock = 100000;          // Fastest bus clock the device supports (Hz)
+};
+
+// Generic I2C sensor driven by a protocol file (data/protocols/*.json).
+// configure() compiles the register map into a read plan: the registers
+// behind every dataFormat field are merged into the fewest burst reads,
+// reading across small gaps where another transaction would cost more, and
+// each field's scaling and calibration are folded into one gain and bias.
+// The configuration register bitfields are compiled the same way from the
+// instance settings (busConfig.settings) into the writes begin() performs.
+// Devices without auto-increment ("autoIncrement": false under
+// communication.i2c) get one transaction per register, and the register
+// pointer is not rewritten while it already points at a register the plan
+// reads: the bursts are run starting from that register.
+class I2CRegisterSensor : public ISensor {
+public:
+    // protocol is a protocol file, with or without its top-level "protocol" key
+    explicit I2CRegisterSensor(const json& protocol);
+    ~I2CRegisterSensor() override = default;
+
+    // ISensor interface implementation
+    bool begin(hal::IHAL* hal) override;
+    void end() override;
+    bool configure(const SensorConfig& config) override;
+    SensorConfig getConfig() const override;
+    bool isConnected() override;
+    SensorReading read() override;
+    std::vector<SensorReading> readAll() override;
+    bool requiresCalibration() const override;
+    bool isCalibrated() const override;
+    bool calibrate(const json& calibrationData) override;
+    json getCalibrationData() const override;
+    std::string getName() const override;
+    std::string getId() const override;
+    SensorType getType() const override;
+    SensorBus getBusType() const override;
+    std::string getDescription() const override;
+    std::vector<std::string> getSupportedUnits() const override;
+    bool hasError() const override;
+    std::string getLastError() const override;
+    bool sleep() override;
+    bool wake() override;
+    float getPowerConsumption() const override;
+
+    // Compiled read plan, empty before configure()
+    const RegisterReadPlan& getReadPlan() const;
+
+    // Configured I2C address
+    uint8_t getAddress() const;
+
+    // Run the read plan's bursts into the frame buffer; readAll() is
+    // readFrame() followed by appendReadings(). I2CBusScheduler calls the
+    // two separately to read a whole bus in one window.
+    bool readFrame();
+
+    // Append one reading per field, decoded from the last frame
+    void appendReadings(std::vector<SensorReading>& readings, uint64_t timestamp) const;
+
+    // Compile the read plan of a protocol; false with error set if the
+    // register map or data format is invalid
+    static bool compileReadPlan(const json& protocol, RegisterReadPlan& plan, std::string& error);
+
+    // Compile the configuration register writes for a set of instance
+    // settings; protocol defaults fill in settings that are not given
+    static bool compileConfigWrites(const json& protocol, const json& settings,
+                                    std::vector<RegisterWrite>& writes, std::string& error);
+
+    static constexpr size_t MAX_BURST = 32;  // Bytes per burst, the Wire buffer size
+    static constexpr size_t MAX_GAP = 3;     // Unneeded bytes read to save a transaction
+
+protected:
+    // Bus methods
+    bool writeRegister(uint8_t reg, const std::vector<uint8_t>& bytes);
+    bool readRegister(uint8_t reg, uint8_t& value);
+    bool runInitSequence();
+    bool setBit(const std::string& name, bool value);
+
+    // Field value from the frame buffer, before calibration
+    double decodeField(const RegisterField& field) const;
+
+private:
+    void applyCalibration();
+
+    json protocol_;
+    RegisterReadPlan plan_;
+    std::vector<RegisterWrite> configWrites_;
+    std::vector<uint8_t> frame_;       // Bytes of the last reading, laid out by the plan
+    std::vector<uint8_t> burst_;       // Scratch buffer for one burst
+    std::vector<uint8_t> pointerWrite_;  // Register pointer write, reused by every reading
+    uint8_t address_ = 0;
+    int pointer_ = -1;                 // Register pointer of a pointer-addressed device, -1 if unknown
+    uint32_t errorCount_ = 0;
+
+    struct {
+        bool isCalibrated{false};
+        double offset{0.0};
+        double scale{1.0};
+    } calibration_;
+};
+
+} // namespace sensors
@@ -0,0 +1,575 @@
+#include "config_cache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+
+namespace storage {
+
+namespace {
+
+const uint32_t IMAGE_MAGIC = 0x49434353;  // "SCCI"
+const uint16_t IMAGE_VERSION = 3;
+const size_t HEADER_SIZE = 24;
+
+const uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+uint64_t fnv1a(uint64_t hash, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// Byte-wise CRC-32 lookup table, built on first use
+struct Crc32Table {
+    uint32_t entries[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+uint32_t crc32(const uint8_t* data, size_t length) {
+    static const Crc32Table table;
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void putLE(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint64_t getLE(const uint8_t* data, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+void putString(std::vector<uint8_t>& out, const std::string& value) {
+    putLE(out, value.size(), 2);
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+void putDouble(std::vector<uint8_t>& out, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putLE(out, bits, 8);
+}
+
+void putBytes(std::vector<uint8_t>& out, const std::vector<uint8_t>& values) {
+    putLE(out, values.size(), 1);
+    out.insert(out.end(), values.begin(), values.end());
+}
+
+// Calibration parameter shapes with a binary encoding
+enum class ParameterKind : uint8_t {
+    NUMBER = 0,         ///< Single number
+    NUMBERS = 1,        ///< Array of numbers
+    PAIRS = 2           ///< Array of [x, y] number pairs
+};
+
+// Calibration entry forms: a compiled method/parameters record or JSON text
+const uint8_t CALIBRATION_COMPILED = 0;
+const uint8_t CALIBRATION_TEXT = 1;
+
+bool classifyParameter(const json& value, ParameterKind& kind) {
+    if (value.is_number()) {
+        kind = ParameterKind::NUMBER;
+        return true;
+    }
+    if (!value.is_array() || value.empty() || value.size() > 0xFFFF) {
+        return false;
+    }
+    if (value[0].is_number()) {
+        kind = ParameterKind::NUMBERS;
+        return std::all_of(value.begin(), value.end(), [](const json& v) { return v.is_number(); });
+    }
+    kind = ParameterKind::PAIRS;
+    return std::all_of(value.begin(), value.end(), [](const json& v) {
+        return v.is_array() && v.size() == 2 && v[0].is_number() && v[1].is_number();
+    });
+}
+
+// Whether calibration data fits the compiled form
+bool isCompilable(const json& data) {
+    if (!data.is_object() || data.size() > 2) {
+        return false;
+    }
+    for (auto it = data.begin(); it != data.end(); ++it) {
+        if (it.key() == "method") {
+            if (!it.value().is_string()) return false;
+        } else if (it.key() == "parameters") {
+            if (!it.value().is_object() || it.value().size() > 0xFF) return false;
+            for (auto param = it.value().begin(); param != it.value().end(); ++param) {
+                ParameterKind kind;
+                if (param.key().size() > 0xFFFF || !classifyParameter(param.value(), kind)) return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void putCalibration(std::vector<uint8_t>& out, const json& data) {
+    if (!isCompilable(data)) {
+        out.push_back(CALIBRATION_TEXT);
+        std::string text = data.dump();
+        putLE(out, text.size(), 4);
+        out.insert(out.end(), text.begin(), text.end());
+        return;
+    }
+
+    out.push_back(CALIBRATION_COMPILED);
+    out.push_back(static_cast<uint8_t>((data.contains("method") ? 1 : 0) | (data.contains("parameters") ? 2 : 0)));
+    putString(out, data.value("method", ""));
+
+    const json& parameters = data.contains("parameters") ? data["parameters"] : json::object();
+    putLE(out, parameters.size(), 1);
+    for (auto it = parameters.begin(); it != parameters.end(); ++it) {
+        ParameterKind kind;
+        classifyParameter(it.value(), kind);
+        putString(out, it.key());
+        out.push_back(static_cast<uint8_t>(kind));
+        if (kind == ParameterKind::NUMBER) {
+            putDouble(out, it.value().get<double>());
+            continue;
+        }
+        putLE(out, it.value().size(), 2);
+        for (const auto& element : it.value()) {
+            if (kind == ParameterKind::NUMBERS) {
+                putDouble(out, element.get<double>());
+            } else {
+                putDouble(out, element[0].get<double>());
+                putDouble(out, element[1].get<double>());
+            }
+        }
+    }
+}
+
+// Nested objects as MessagePack; null is stored as an empty blob
+void putBlob(std::vector<uint8_t>& out, const json& value) {
+    if (value.is_null()) {
+        putLE(out, 0, 4);
+        return;
+    }
+    std::vector<uint8_t> data = json::to_msgpack(value);
+    putLE(out, data.size(), 4);
+    out.insert(out.end(), data.begin(), data.end());
+}
+
+// Bounds-checked reader over a compiled section
+struct RecordReader {
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool ok;
+
+    bool take(size_t bytes) {
+        ok = ok && static_cast<size_t>(end - pos) >= bytes;
+        return ok;
+    }
+
+    uint64_t number(size_t bytes) {
+        if (!take(bytes)) return 0;
+        uint64_t value = getLE(pos, bytes);
+        pos += bytes;
+        return value;
+    }
+
+    std::string string() {
+        size_t length = static_cast<size_t>(number(2));
+        if (!take(length)) return std::string();
+        std::string value(reinterpret_cast<const char*>(pos), length);
+        pos += length;
+        return value;
+    }
+
+    double real() {
+        uint64_t bits = number(8);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::vector<uint8_t> bytes() {
+        size_t length = static_cast<size_t>(number(1));
+        if (!take(length)) return std::vector<uint8_t>();
+        std::vector<uint8_t> value(pos, pos + length);
+        pos += length;
+        return value;
+    }
+
+    json blob() {
+        size_t length = static_cast<size_t>(number(4));
+        if (length == 0 || !take(length)) return json();
+        json value = json::from_msgpack(pos, pos + length, true, false);
+        pos += length;
+        ok = ok && !value.is_discarded();
+        return value;
+    }
+
+    json calibration() {
+        uint8_t form = static_cast<uint8_t>(number(1));
+        if (form == CALIBRATION_TEXT) {
+            size_t length = static_cast<size_t>(number(4));
+            if (!take(length)) return json();
+            json value = json::parse(pos, pos + length, nullptr, false);
+            pos += length;
+            ok = ok && !value.is_discarded();
+            return value;
+        }
+        ok = ok && form == CALIBRATION_COMPILED;
+
+        uint8_t fields = static_cast<uint8_t>(number(1));
+        std::string method = string();
+        json data = json::object();
+        if (fields & 1) {
+            data["method"] = std::move(method);
+        }
+
+        json parameters = json::object();
+        size_t count = static_cast<size_t>(number(1));
+        for (size_t i = 0; i < count && ok; i++) {
+            std::string key = string();
+            uint8_t kind = static_cast<uint8_t>(number(1));
+            if (kind == static_cast<uint8_t>(ParameterKind::NUMBER)) {
+                parameters[key] = real();
+                continue;
+            }
+            ok = ok && (kind == static_cast<uint8_t>(ParameterKind::NUMBERS) ||
+                        kind == static_cast<uint8_t>(ParameterKind::PAIRS));
+            size_t length = static_cast<size_t>(number(2));
+            json values = json::array();
+            for (size_t j = 0; j < length && ok; j++) {
+                if (kind == static_cast<uint8_t>(ParameterKind::NUMBERS)) {
+                    values.push_back(real());
+                } else {
+                    double x = real();
+                    values.push_back(json::array({x, real()}));
+                }
+            }
+            parameters[key] = std::move(values);
+        }
+        if (fields & 2) {
+            data["parameters"] = std::move(parameters);
+        }
+        return data;
+    }
+};
+
+} // namespace
+
+ConfigCache::ConfigCache(const std::string& imagePath) :
+    imagePath_(imagePath) {
+}
+
+uint64_t ConfigCache::computeSourceHash(const std::vector<std::string>& directories) {
+    uint64_t hash = FNV_OFFSET;
+    uint8_t buffer[512];
+
+    for (const auto& directory : directories) {
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) {
+            continue;
+        }
+
+        // Sort names so the hash does not depend on directory order
+        std::vector<std::string> names;
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            std::string name = entry->d_name;
+            if (name.size() > 5 && name.compare(name.size() - 5, 5, ".json") == 0) {
+                names.push_back(name);
+            }
+        }
+        closedir(dir);
+        std::sort(names.begin(), names.end());
+
+        for (const auto& name : names) {
+            std::string path = directory + "/" + name;
+            hash = fnv1a(hash, reinterpret_cast<const uint8_t*>(path.c_str()), path.size() + 1);
+
+            FILE* file = fopen(path.c_str(), "rb");
+            if (!file) {
+                continue;
+            }
+
+            size_t count;
+            while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+                hash = fnv1a(hash, buffer, count);
+            }
+            fclose(file);
+        }
+    }
+
+    return hash;
+}
+
+bool ConfigCache::load(uint64_t sourceHash) {
+    sections_.clear();
+
+    FILE* file = fopen(imagePath_.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (fileSize < static_cast<long>(HEADER_SIZE)) {
+        fclose(file);
+        return false;
+    }
+
+    // The whole image is read in one go
+    std::vector<uint8_t> image(static_cast<size_t>(fileSize));
+    size_t read = fread(image.data(), 1, image.size(), file);
+    fclose(file);
+    if (read != image.size()) {
+        return false;
+    }
+
+    const uint8_t* header = image.data();
+    if (getLE(header, 4) != IMAGE_MAGIC ||
+        getLE(header + 4, 2) != IMAGE_VERSION ||
+        getLE(header + 8, 8) != sourceHash) {
+        return false;
+    }
+
+    uint16_t sectionCount = static_cast<uint16_t>(getLE(header + 6, 2));
+    uint32_t payloadSize = static_cast<uint32_t>(getLE(header + 16, 4));
+    uint32_t payloadCrc = static_cast<uint32_t>(getLE(header + 20, 4));
+    if (payloadSize != image.size() - HEADER_SIZE ||
+        crc32(image.data() + HEADER_SIZE, payloadSize) != payloadCrc) {
+        return false;
+    }
+
+    const uint8_t* pos = image.data() + HEADER_SIZE;
+    const uint8_t* end = image.data() + image.size();
+    for (uint16_t i = 0; i < sectionCount; i++) {
+        if (pos + 1 > end) break;
+        uint8_t nameLength = *pos++;
+        if (pos + nameLength + 4 > end) break;
+        std::string name(reinterpret_cast<const char*>(pos), nameLength);
+        pos += nameLength;
+        uint32_t dataLength = static_cast<uint32_t>(getLE(pos, 4));
+        pos += 4;
+        if (pos + dataLength > end) break;
+        sections_[name].assign(pos, pos + dataLength);
+        pos += dataLength;
+    }
+
+    if (sections_.size() != sectionCount) {
+        sections_.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool ConfigCache::save(uint64_t sourceHash) {
+    std::vector<uint8_t> payload;
+    for (const auto& pair : sections_) {
+        if (pair.first.size() > 255) {
+            return false;
+        }
+        payload.push_back(static_cast<uint8_t>(pair.first.size()));
+        payload.insert(payload.end(), pair.first.begin(), pair.first.end());
+        putLE(payload, pair.second.size(), 4);
+        payload.insert(payload.end(), pair.second.begin(), pair.second.end());
+    }
+
+    std::vector<uint8_t> header;
+    putLE(header, IMAGE_MAGIC, 4);
+    putLE(header, IMAGE_VERSION, 2);
+    putLE(header, sections_.size(), 2);
+    putLE(header, sourceHash, 8);
+    putLE(header, payload.size(), 4);
+    putLE(header, crc32(payload.data(), payload.size()), 4);
+
+    // A torn write fails the CRC check and is rebuilt on the next boot
+    FILE* file = fopen(imagePath_.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool success = fwrite(header.data(), 1, header.size(), file) == header.size();
+    success = success && fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+    success = success && fflush(file) == 0;
+    success = success && fsync(fileno(file)) == 0;
+    fclose(file);
+
+    if (!success) {
+        std::remove(imagePath_.c_str());
+    }
+    return success;
+}
+
+bool ConfigCache::hasSection(const std::string& name) const {
+    return sections_.find(name) != sections_.end();
+}
+
+json ConfigCache::getSection(const std::string& name) const {
+    auto it = sections_.find(name);
+    if (it == sections_.end()) {
+        return json();
+    }
+    json data = json::from_msgpack(it->second, true, false);
+    return data.is_discarded() ? json() : data;
+}
+
+void ConfigCache::setSection(const std::string& name, const json& data) {
+    sections_[name] = json::to_msgpack(data);
+}
+
+void ConfigCache::setConfigs(const std::string& name, const std::vector<sensors::SensorConfig>& configs) {
+    std::vector<uint8_t> data;
+    putLE(data, configs.size(), 4);
+    for (const auto& config : configs) {
+        putString(data, config.id);
+        putString(data, config.name);
+        data.push_back(static_cast<uint8_t>(config.type));
+        data.push_back(static_cast<uint8_t>(config.bus));
+        data.push_back(static_cast<uint8_t>((config.enabled ? 1 : 0) | (config.wireless.isWireless ? 2 : 0)));
+        putString(data, config.wireless.nodeId);
+        putString(data, config.wireless.communicationType);
+        putBlob(data, config.busConfig);
+        putBlob(data, config.sensorConfig);
+        putBlob(data, config.calibrationConfig);
+        putBlob(data, config.wireless.communicationConfig);
+    }
+    sections_[name] = std::move(data);
+}
+
+bool ConfigCache::getConfigs(const std::string& name, std::vector<sensors::SensorConfig>& configs) const {
+    auto it = sections_.find(name);
+    if (it == sections_.end()) {
+        return false;
+    }
+
+    RecordReader reader{it->second.data(), it->second.data() + it->second.size(), true};
+    size_t count = static_cast<size_t>(reader.number(4));
+    std::vector<sensors::SensorConfig> result;
+    result.reserve(std::min<size_t>(count, it->second.size()));
+
+    for (size_t i = 0; i < count && reader.ok; i++) {
+        sensors::SensorConfig config;
+        config.id = reader.string();
+        config.name = reader.string();
+        config.type = static_cast<sensors::SensorType>(reader.number(1));
+        config.bus = static_cast<sensors::SensorBus>(reader.number(1));
+        uint8_t flags = static_cast<uint8_t>(reader.number(1));
+        config.enabled = (flags & 1) != 0;
+        config.wireless.isWireless = (flags & 2) != 0;
+        config.wireless.nodeId = reader.string();
+        config.wireless.communicationType = reader.string();
+        config.busConfig = reader.blob();
+        config.sensorConfig = reader.blob();
+        config.calibrationConfig = reader.blob();
+        config.wireless.communicationConfig = reader.blob();
+        result.push_back(std::move(config));
+    }
+
+    if (!reader.ok || reader.pos != reader.end) {
+        return false;
+    }
+    configs = std::move(result);
+    return true;
+}
+
+void ConfigCache::setDetectionRules(const std::string& name, const std::vector<sensors::I2CDetectionRule>& rules) {
+    std::vector<uint8_t> data;
+    putLE(data, rules.size(), 4);
+    for (const auto& rule : rules) {
+        putString(data, rule.protocolName);
+        data.push_back(static_cast<uint8_t>(rule.type));
+        putBytes(data, rule.addresses);
+        putBytes(data, rule.registers);
+        putBytes(data, rule.values);
+    }
+    sections_[name] = std::move(data);
+}
+
+bool ConfigCache::getDetectionRules(const std::string& name, std::vector<sensors::I2CDetectionRule>& rules) const {
+    auto it = sections_.find(name);
+    if (it == sections_.end()) {
+        return false;
+    }
+
+    RecordReader reader{it->second.data(), it->second.data() + it->second.size(), true};
+    size_t count = static_cast<size_t>(reader.number(4));
+    std::vector<sensors::I2CDetectionRule> result;
+    result.reserve(std::min<size_t>(count, it->second.size()));
+
+    for (size_t i = 0; i < count && reader.ok; i++) {
+        sensors::I2CDetectionRule rule;
+        rule.protocolName = reader.string();
+        rule.type = static_cast<sensors::SensorType>(reader.number(1));
+        rule.addresses = reader.bytes();
+        rule.registers = reader.bytes();
+        rule.values = reader.bytes();
+        result.push_back(std::move(rule));
+    }
+
+    if (!reader.ok || reader.pos != reader.end) {
+        return false;
+    }
+    rules = std::move(result);
+    return true;
+}
+
+void ConfigCache::setCalibration(const std::string& name, const std::map<std::string, json>& calibration) {
+    std::vector<uint8_t> data;
+    putLE(data, calibration.size(), 4);
+    for (const auto& pair : calibration) {
+        putString(data, pair.first);
+        putCalibration(data, pair.second);
+    }
+    sections_[name] = std::move(data);
+}
+
+bool ConfigCache::getCalibration(const std::string& name, std::map<std::string, json>& calibration) const {
+    auto it = sections_.find(name);
+    if (it == sections_.end()) {
+        return false;
+    }
+
+    RecordReader reader{it->second.data(), it->second.data() + it->second.size(), true};
+    size_t count = static_cast<size_t>(reader.number(4));
+    std::map<std::string, json> result;
+
+    for (size_t i = 0; i < count && reader.ok; i++) {
+        std::string sensorId = reader.string();
+        result[sensorId] = reader.calibration();
+    }
+
+    if (!reader.ok || reader.pos != reader.end) {
+        return false;
+    }
+    calibration = std::move(result);
+    return true;
+}
+
+void ConfigCache::invalidate() {
+    sections_.clear();
+    std::remove(imagePath_.c_str());
+}
+
+} // namespace storage
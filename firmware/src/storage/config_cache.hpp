@@ -0,0 +1,159 @@
+/**
+ * @file config_cache.hpp
+ * @brief Binary image of parsed configuration data
+ *
+ * This file defines the ConfigCache class, which stores already-parsed
+ * configuration data as a compact binary image so that the next boot can
+ * skip parsing the source JSON files.
+ */
+
+#pragma once
+
+#include "../core/sensor_types.hpp"
+#include "../core/managers/discovery_manager/i2c_topology_scanner.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace storage {
+
+using json = nlohmann::json;
+
+/**
+ * @brief Compiled configuration image keyed by a hash of its sources
+ *
+ * The image holds named sections behind a header carrying the hash of the
+ * source JSON files it was built from. Loading is a single sequential read
+ * and a table-driven CRC check; sections are decoded only when they are
+ * asked for. Sensor configurations are compiled into fixed records that
+ * decode straight into SensorConfig, keeping only the fields acquisition
+ * uses, so only their small bus, sensor and calibration objects become
+ * JSON values. Protocols are stored as the I2C detection rules discovery
+ * compiles from them, and calibration data as the method name plus
+ * numeric parameters, rebuilt into small JSON objects without a parser.
+ * Generic sections are MessagePack, whose decoding into a JSON DOM is no
+ * cheaper than parsing the text. When the source hash no longer matches,
+ * load() fails and the caller falls back to parsing the JSON files and
+ * saving a fresh image.
+ *
+ * Image layout (little endian):
+ *   magic u32 | version u16 | sectionCount u16 | sourceHash u64 |
+ *   payloadSize u32 | payloadCrc u32 | sections...
+ * Each section is: nameLength u8 | name | dataLength u32 | data
+ */
+class ConfigCache {
+public:
+    /**
+     * @brief Constructor
+     * @param imagePath Filesystem path of the image file
+     */
+    explicit ConfigCache(const std::string& imagePath = "/spiffs/config.cache");
+
+    //---------- Source Tracking ----------//
+
+    /**
+     * @brief Compute content hash of all files in the source directories
+     * @param directories Source directories
+     * @return 64-bit FNV-1a hash over file names and contents
+     */
+    static uint64_t computeSourceHash(const std::vector<std::string>& directories);
+
+    //---------- Image Access ----------//
+
+    /**
+     * @brief Load image if it was built from the given sources
+     * @param sourceHash Hash of the current source files
+     * @return True if a valid, matching image was loaded, false otherwise
+     */
+    bool load(uint64_t sourceHash);
+
+    /**
+     * @brief Save sections as a new image
+     * @param sourceHash Hash of the source files the sections came from
+     * @return True if successful, false otherwise
+     */
+    bool save(uint64_t sourceHash);
+
+    /**
+     * @brief Check if section exists
+     * @param name Section name
+     * @return True if section exists, false otherwise
+     */
+    bool hasSection(const std::string& name) const;
+
+    /**
+     * @brief Get section data
+     * @param name Section name
+     * @return Section data or null JSON if not found or corrupt
+     */
+    json getSection(const std::string& name) const;
+
+    /**
+     * @brief Set section data
+     * @param name Section name
+     * @param data Section data
+     */
+    void setSection(const std::string& name, const json& data);
+
+    /**
+     * @brief Set section of compiled sensor configurations
+     * @param name Section name
+     * @param configs Sensor configurations
+     */
+    void setConfigs(const std::string& name, const std::vector<sensors::SensorConfig>& configs);
+
+    /**
+     * @brief Get section of compiled sensor configurations
+     * @param name Section name
+     * @param configs Configurations to fill
+     * @return True if the section exists and is intact, false otherwise
+     */
+    bool getConfigs(const std::string& name, std::vector<sensors::SensorConfig>& configs) const;
+
+    /**
+     * @brief Set section of compiled I2C detection rules
+     * @param name Section name
+     * @param rules Detection rules
+     */
+    void setDetectionRules(const std::string& name, const std::vector<sensors::I2CDetectionRule>& rules);
+
+    /**
+     * @brief Get section of compiled I2C detection rules
+     * @param name Section name
+     * @param rules Rules to fill
+     * @return True if the section exists and is intact, false otherwise
+     */
+    bool getDetectionRules(const std::string& name, std::vector<sensors::I2CDetectionRule>& rules) const;
+
+    /**
+     * @brief Set section of compiled calibration data
+     *
+     * Entries of the form {"method": ..., "parameters": {...}} whose
+     * parameters are numbers, number arrays or arrays of number pairs are
+     * stored as binary records; any other entry is kept as JSON text.
+     *
+     * @param name Section name
+     * @param calibration Map of sensor ID to calibration data
+     */
+    void setCalibration(const std::string& name, const std::map<std::string, json>& calibration);
+
+    /**
+     * @brief Get section of compiled calibration data
+     * @param name Section name
+     * @param calibration Map of sensor ID to calibration data to fill
+     * @return True if the section exists and is intact, false otherwise
+     */
+    bool getCalibration(const std::string& name, std::map<std::string, json>& calibration) const;
+
+    /**
+     * @brief Remove image file and all sections
+     */
+    void invalidate();
+
+private:
+    std::string imagePath_;                                  ///< Image file path
+    std::map<std::string, std::vector<uint8_t>> sections_;   ///< Map of section name to encoded data
+};
+
+} // namespace storage
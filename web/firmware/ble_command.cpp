@@ -0,0 +1,141 @@
+#include "ble_command.h"
+
+#include <string.h>
+
+#define BLE_COMMAND_MAX_DEPTH 8
+
+struct Cursor {
+  const char* data;
+  size_t length;
+  size_t pos;
+};
+
+static void skipSpace(Cursor* c) {
+  while (c->pos < c->length &&
+         (c->data[c->pos] == ' ' || c->data[c->pos] == '\t' ||
+          c->data[c->pos] == '\n' || c->data[c->pos] == '\r')) {
+    c->pos++;
+  }
+}
+
+static bool consume(Cursor* c, char expected) {
+  skipSpace(c);
+  if (c->pos < c->length && c->data[c->pos] == expected) {
+    c->pos++;
+    return true;
+  }
+  return false;
+}
+
+// Read a string; *start and *len give the characters between the quotes
+static bool readString(Cursor* c, const char** start, size_t* len) {
+  if (!consume(c, '"')) {
+    return false;
+  }
+  size_t begin = c->pos;
+  while (c->pos < c->length) {
+    char ch = c->data[c->pos];
+    if (ch == '"') {
+      *start = c->data + begin;
+      *len = c->pos - begin;
+      c->pos++;
+      return true;
+    }
+    c->pos += ch == '\\' ? 2 : 1;
+  }
+  return false;
+}
+
+static bool equals(const char* s, size_t len, const char* literal) {
+  return strlen(literal) == len && memcmp(s, literal, len) == 0;
+}
+
+// Skip a value of any type, including nested objects and arrays
+static bool skipValue(Cursor* c, int depth) {
+  skipSpace(c);
+  if (c->pos >= c->length || depth > BLE_COMMAND_MAX_DEPTH) {
+    return false;
+  }
+
+  char ch = c->data[c->pos];
+  if (ch == '"') {
+    const char* s;
+    size_t len;
+    return readString(c, &s, &len);
+  }
+
+  if (ch == '{' || ch == '[') {
+    char close = ch == '{' ? '}' : ']';
+    c->pos++;
+    if (consume(c, close)) {
+      return true;
+    }
+    do {
+      if (ch == '{') {
+        const char* key;
+        size_t keyLen;
+        if (!readString(c, &key, &keyLen) || !consume(c, ':')) {
+          return false;
+        }
+      }
+      if (!skipValue(c, depth + 1)) {
+        return false;
+      }
+    } while (consume(c, ','));
+    return consume(c, close);
+  }
+
+  // Number or literal
+  size_t begin = c->pos;
+  while (c->pos < c->length && strchr(",}] \t\r\n", c->data[c->pos]) == NULL) {
+    c->pos++;
+  }
+  return c->pos > begin;
+}
+
+static BleCommandType commandType(const char* s, size_t len) {
+  if (equals(s, len, "START_STREAMING")) return BLE_COMMAND_START_STREAMING;
+  if (equals(s, len, "STOP_STREAMING")) return BLE_COMMAND_STOP_STREAMING;
+  if (equals(s, len, "CALIBRATE")) return BLE_COMMAND_CALIBRATE;
+  if (equals(s, len, "REBOOT")) return BLE_COMMAND_REBOOT;
+  return BLE_COMMAND_UNKNOWN;
+}
+
+bool parseBleCommand(const char* data, size_t length, BleCommand* command) {
+  command->type = BLE_COMMAND_NONE;
+  command->binaryFormat = false;  // "format" defaults to json
+
+  Cursor c = {data, length, 0};
+  if (!consume(&c, '{')) {
+    return false;
+  }
+  if (consume(&c, '}')) {
+    return true;
+  }
+
+  do {
+    const char* key;
+    size_t keyLen;
+    if (!readString(&c, &key, &keyLen) || !consume(&c, ':')) {
+      return false;
+    }
+
+    const char* value;
+    size_t valueLen;
+    if (equals(key, keyLen, "command")) {
+      if (!readString(&c, &value, &valueLen)) {
+        return false;
+      }
+      command->type = commandType(value, valueLen);
+    } else if (equals(key, keyLen, "format")) {
+      if (!readString(&c, &value, &valueLen)) {
+        return false;
+      }
+      command->binaryFormat = equals(value, valueLen, "binary");
+    } else if (!skipValue(&c, 1)) {
+      return false;
+    }
+  } while (consume(&c, ','));
+
+  return consume(&c, '}');
+}
@@ -0,0 +1,36 @@
+/**
+ * Decoder for writes to the BLE command characteristic
+ *
+ * Commands are small JSON objects:
+ *
+ *   {"command": "START_STREAMING", "format": "binary"}
+ *
+ * The decoder reads the payload in place into a BleCommand, without a JSON
+ * document or heap allocation, and skips members it does not know. This
+ * file has no Arduino dependencies and builds on the host.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Command written by the central
+enum BleCommandType : uint8_t {
+  BLE_COMMAND_NONE = 0,
+  BLE_COMMAND_START_STREAMING,
+  BLE_COMMAND_STOP_STREAMING,
+  BLE_COMMAND_CALIBRATE,
+  BLE_COMMAND_REBOOT,
+  BLE_COMMAND_UNKNOWN
+};
+
+// Decoded command; binaryFormat is only meaningful for START_STREAMING
+struct BleCommand {
+  BleCommandType type;
+  bool binaryFormat;
+};
+
+// Decode one command write. Returns false if the payload is not a JSON
+// object; a missing "command" member decodes as BLE_COMMAND_NONE.
+bool parseBleCommand(const char* data, size_t length, BleCommand* command);
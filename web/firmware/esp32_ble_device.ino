@@ -5,7 +5,7 @@
  * - Device advertisement and basic metadata
  * - Sensor auto-detection and reporting
  * - Profile flashing capability
- * - Live sensor data streaming
+ * - Live sensor data streaming (binary packets sized to the MTU, JSON fallback)
  * 
  * Compatible sensors:
  * - BME280 (Temperature, Humidity, Pressure)
@@ -28,6 +28,9 @@
 #include <Adafruit_CCS811.h>
 #include <BH1750.h>
 
+#include "live_data_codec.h"
+#include "ble_command.h"
+
 // GATT Service and Characteristics UUIDs - must match frontend
 #define SERVICE_UUID              "4fafc201-1fb5-459e-8fcc-c5c9c331914b"
 #define DEVICE_INFO_UUID          "beb5483e-36e1-4688-b7f5-ea07361b26a8"
@@ -53,6 +56,33 @@
 #define CCS811_ADDR 0x5A
 #define BH1750_ADDR 0x23
 
+// Preferred ATT MTU offered to the central
+#define PREFERRED_MTU 185
+
+// Live data channels, indexed by position; published in the sensor info
+enum LiveChannel : uint8_t {
+  CH_BME280_TEMP,
+  CH_BME280_HUMID,
+  CH_BME280_PRESS,
+  CH_HDC1080_TEMP,
+  CH_HDC1080_HUMID,
+  CH_CCS811_ECO2,
+  CH_CCS811_TVOC,
+  CH_BH1750_LIGHT,
+  LIVE_CHANNEL_COUNT
+};
+
+const LiveDataChannel liveChannels[LIVE_CHANNEL_COUNT] = {
+  {"bme280_temp",   LIVE_DATA_INT16,   -2},  // 0.01 C
+  {"bme280_humid",  LIVE_DATA_INT16,   -2},  // 0.01 %RH
+  {"bme280_press",  LIVE_DATA_INT16,   -1},  // 0.1 hPa
+  {"hdc1080_temp",  LIVE_DATA_INT16,   -2},
+  {"hdc1080_humid", LIVE_DATA_INT16,   -2},
+  {"ccs811_eco2",   LIVE_DATA_INT16,    0},  // ppm
+  {"ccs811_tvoc",   LIVE_DATA_INT16,    0},  // ppb
+  {"bh1750_light",  LIVE_DATA_FLOAT32,  0}   // lx, exceeds int16
+};
+
 // Global variables
 BLEServer *pServer = NULL;
 BLECharacteristic *pDeviceInfoCharacteristic = NULL;
@@ -66,6 +96,9 @@ bool oldDeviceConnected = false;
 bool isStreaming = false;
 unsigned long lastStreamTime = 0;
 int streamInterval = 30000; // Default 30 seconds
+bool binaryLiveData = false; // Set by START_STREAMING {"format": "binary"}
+uint16_t liveDataSequence = 0;
+uint16_t negotiatedMtu = ATT_DEFAULT_MTU;
 
 // Sensor objects
 Adafruit_BME280 bme;
@@ -91,6 +124,12 @@ class ServerCallbacks: public BLEServerCallbacks {
   void onDisconnect(BLEServer* pServer) {
     deviceConnected = false;
     isStreaming = false;
+    binaryLiveData = false;
+    negotiatedMtu = ATT_DEFAULT_MTU;
+  }
+
+  void onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+    negotiatedMtu = param->mtu.mtu;
   }
 };
 
@@ -99,25 +138,29 @@ class CommandCallbacks: public BLECharacteristicCallbacks {
   void onWrite(BLECharacteristic *pCharacteristic) {
     std::string value = pCharacteristic->getValue();
     
-    if (value.length() > 0) {
-      StaticJsonDocument<200> doc;
-      DeserializationError error = deserializeJson(doc, value);
-      
-      if (!error) {
-        const char* command = doc["command"];
-        
-        if (strcmp(command, "START_STREAMING") == 0) {
+    // Decoded in place; no JSON document is built for a command write
+    BleCommand command;
+    if (value.length() > 0 && parseBleCommand(value.data(), value.length(), &command)) {
+      switch (command.type) {
+        case BLE_COMMAND_START_STREAMING:
+          binaryLiveData = command.binaryFormat;
+          liveDataSequence = 0;
           isStreaming = true;
           lastStreamTime = millis();
-        } else if (strcmp(command, "STOP_STREAMING") == 0) {
+          break;
+        case BLE_COMMAND_STOP_STREAMING:
           isStreaming = false;
-        } else if (strcmp(command, "CALIBRATE") == 0) {
+          break;
+        case BLE_COMMAND_CALIBRATE:
           // Start sensor calibration process
           // Implementation depends on sensor types
           calibrateSensors();
-        } else if (strcmp(command, "REBOOT") == 0) {
+          break;
+        case BLE_COMMAND_REBOOT:
           ESP.restart();
-        }
+          break;
+        default:
+          break;
       }
     }
   }
@@ -212,6 +255,7 @@ void initBLE() {
   
   // Initialize BLE
   BLEDevice::init(deviceName.c_str());
+  BLEDevice::setMTU(PREFERRED_MTU);
   
   // Create the BLE Server
   pServer = BLEDevice::createServer();
@@ -316,7 +360,7 @@ void updateDeviceInfo() {
 }
 
 void updateSensorInfo() {
-  StaticJsonDocument<512> doc;
+  StaticJsonDocument<1536> doc;
   JsonArray sensors = doc.createNestedArray("sensors");
   
   int sensorIndex = 0;
@@ -353,6 +397,15 @@ void updateSensorInfo() {
     sensor["isActive"] = true;
   }
   
+  // Channel table for binary live data: samples refer to channels by index
+  JsonArray channels = doc.createNestedArray("channels");
+  for (int i = 0; i < LIVE_CHANNEL_COUNT; i++) {
+    JsonObject channel = channels.createNestedObject();
+    channel["id"] = liveChannels[i].id;
+    channel["format"] = liveChannels[i].format == LIVE_DATA_INT16 ? "int16" : "float32";
+    channel["scale"] = liveChannels[i].scale;
+  }
+  
   // Create string from JSON
   String sensorInfo;
   serializeJson(doc, sensorInfo);
@@ -361,62 +414,74 @@ void updateSensorInfo() {
 }
 
 void streamSensorData() {
-  StaticJsonDocument<512> doc;
-  
-  doc["deviceId"] = BLEDevice::getName();
-  doc["timestamp"] = millis();
-  JsonArray sensors = doc.createNestedArray("sensors");
+  LiveDataSample samples[LIVE_CHANNEL_COUNT];
+  size_t sampleCount = 0;
   
   if (hasBME280 && isSensorActive("BME280")) {
-    // Temperature
-    JsonObject tempSensor = sensors.createNestedObject();
-    tempSensor["id"] = "bme280_temp";
-    tempSensor["value"] = bme.readTemperature();
-    
-    // Humidity
-    JsonObject humidSensor = sensors.createNestedObject();
-    humidSensor["id"] = "bme280_humid";
-    humidSensor["value"] = bme.readHumidity();
-    
-    // Pressure
-    JsonObject pressSensor = sensors.createNestedObject();
-    pressSensor["id"] = "bme280_press";
-    pressSensor["value"] = bme.readPressure() / 100.0F; // hPa
+    samples[sampleCount++] = {CH_BME280_TEMP, bme.readTemperature()};
+    samples[sampleCount++] = {CH_BME280_HUMID, bme.readHumidity()};
+    samples[sampleCount++] = {CH_BME280_PRESS, bme.readPressure() / 100.0F}; // hPa
   }
   
   if (hasHDC1080 && isSensorActive("HDC1080")) {
-    // Temperature
-    JsonObject tempSensor = sensors.createNestedObject();
-    tempSensor["id"] = "hdc1080_temp";
-    tempSensor["value"] = hdc.readTemperature();
-    
-    // Humidity
-    JsonObject humidSensor = sensors.createNestedObject();
-    humidSensor["id"] = "hdc1080_humid";
-    humidSensor["value"] = hdc.readHumidity();
+    samples[sampleCount++] = {CH_HDC1080_TEMP, (float)hdc.readTemperature()};
+    samples[sampleCount++] = {CH_HDC1080_HUMID, (float)hdc.readHumidity()};
   }
   
   if (hasCCS811 && isSensorActive("CCS811")) {
     if (ccs.available()) {
       if (ccs.readData()) {
-        // eCO2
-        JsonObject eco2Sensor = sensors.createNestedObject();
-        eco2Sensor["id"] = "ccs811_eco2";
-        eco2Sensor["value"] = ccs.geteCO2();
-        
-        // TVOC
-        JsonObject tvocSensor = sensors.createNestedObject();
-        tvocSensor["id"] = "ccs811_tvoc";
-        tvocSensor["value"] = ccs.getTVOC();
+        samples[sampleCount++] = {CH_CCS811_ECO2, (float)ccs.geteCO2()};
+        samples[sampleCount++] = {CH_CCS811_TVOC, (float)ccs.getTVOC()};
       }
     }
   }
   
   if (hasBH1750 && isSensorActive("BH1750")) {
-    // Light
-    JsonObject lightSensor = sensors.createNestedObject();
-    lightSensor["id"] = "bh1750_light";
-    lightSensor["value"] = lightMeter.readLightLevel();
+    samples[sampleCount++] = {CH_BH1750_LIGHT, lightMeter.readLightLevel()};
+  }
+  
+  if (binaryLiveData) {
+    notifyBinaryLiveData(samples, sampleCount);
+  } else {
+    notifyJsonLiveData(samples, sampleCount);
+  }
+}
+
+// Split samples into as many packets as the negotiated MTU requires
+void notifyBinaryLiveData(const LiveDataSample* samples, size_t sampleCount) {
+  uint8_t packet[PREFERRED_MTU];
+  size_t payloadSize = min(liveDataPayloadSize(negotiatedMtu), sizeof(packet));
+  uint32_t timestamp = millis();
+  size_t sent = 0;
+  
+  while (sent < sampleCount) {
+    size_t consumed;
+    size_t length = encodeLiveDataPacket(liveChannels, LIVE_CHANNEL_COUNT,
+                                         samples + sent, sampleCount - sent, &consumed,
+                                         liveDataSequence++, timestamp, packet, payloadSize);
+    if (length == 0) {
+      break;
+    }
+    
+    pLiveDataCharacteristic->setValue(packet, length);
+    pLiveDataCharacteristic->notify();
+    sent += consumed;
+  }
+}
+
+// Fallback for clients that did not ask for binary packets
+void notifyJsonLiveData(const LiveDataSample* samples, size_t sampleCount) {
+  StaticJsonDocument<512> doc;
+  
+  doc["deviceId"] = BLEDevice::getName();
+  doc["timestamp"] = millis();
+  JsonArray sensors = doc.createNestedArray("sensors");
+  
+  for (size_t i = 0; i < sampleCount; i++) {
+    JsonObject sensor = sensors.createNestedObject();
+    sensor["id"] = liveChannels[samples[i].channel].id;
+    sensor["value"] = samples[i].value;
   }
   
   // Create string from JSON
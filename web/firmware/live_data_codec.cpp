@@ -0,0 +1,112 @@
+#include "live_data_codec.h"
+
+#include <math.h>
+#include <string.h>
+
+static int32_t scaleToRaw(float value, int8_t scale) {
+  return (int32_t)lroundf(value * powf(10.0f, -scale));
+}
+
+size_t liveDataPayloadSize(uint16_t mtu) {
+  if (mtu < ATT_DEFAULT_MTU) {
+    mtu = ATT_DEFAULT_MTU;
+  }
+  return mtu - ATT_NOTIFY_OVERHEAD;
+}
+
+size_t encodeLiveDataPacket(const LiveDataChannel* channels, size_t channelCount,
+                            const LiveDataSample* samples, size_t sampleCount,
+                            size_t* consumed, uint16_t sequence, uint32_t timestamp,
+                            uint8_t* out, size_t outSize) {
+  *consumed = 0;
+  if (outSize < LIVE_DATA_HEADER_SIZE) {
+    return 0;
+  }
+
+  out[0] = LIVE_DATA_PACKET_TYPE;
+  out[1] = sequence & 0xFF;
+  out[2] = sequence >> 8;
+  for (int i = 0; i < 4; i++) {
+    out[3 + i] = (timestamp >> (8 * i)) & 0xFF;
+  }
+  size_t pos = LIVE_DATA_HEADER_SIZE;
+
+  for (size_t i = 0; i < sampleCount; i++) {
+    const LiveDataSample& sample = samples[i];
+    if (sample.channel >= channelCount || sample.channel >= LIVE_DATA_MAX_CHANNELS) {
+      break;
+    }
+    const LiveDataChannel& channel = channels[sample.channel];
+
+    // int16 channels fall back to float32 when the scaled value overflows
+    bool isFloat = channel.format == LIVE_DATA_FLOAT32;
+    int32_t raw = 0;
+    if (!isFloat) {
+      raw = scaleToRaw(sample.value, channel.scale);
+      isFloat = raw < INT16_MIN || raw > INT16_MAX || isnan(sample.value);
+    }
+
+    size_t needed = isFloat ? 5 : 3;
+    if (pos + needed > outSize) {
+      break;
+    }
+
+    if (isFloat) {
+      uint32_t bits;
+      memcpy(&bits, &sample.value, sizeof(bits));
+      out[pos++] = sample.channel | LIVE_DATA_FLOAT_FLAG;
+      for (int b = 0; b < 4; b++) {
+        out[pos++] = (bits >> (8 * b)) & 0xFF;
+      }
+    } else {
+      uint16_t bits = (uint16_t)(int16_t)raw;
+      out[pos++] = sample.channel;
+      out[pos++] = bits & 0xFF;
+      out[pos++] = bits >> 8;
+    }
+    (*consumed)++;
+  }
+
+  return *consumed > 0 ? pos : 0;
+}
+
+int decodeLiveDataPacket(const uint8_t* data, size_t length,
+                         const LiveDataChannel* channels, size_t channelCount,
+                         uint16_t* sequence, uint32_t* timestamp,
+                         LiveDataSample* samples, size_t maxSamples) {
+  if (length < LIVE_DATA_HEADER_SIZE || data[0] != LIVE_DATA_PACKET_TYPE) {
+    return -1;
+  }
+
+  *sequence = data[1] | (data[2] << 8);
+  *timestamp = data[3] | (data[4] << 8) | (data[5] << 16) | ((uint32_t)data[6] << 24);
+
+  size_t pos = LIVE_DATA_HEADER_SIZE;
+  size_t count = 0;
+  while (pos < length) {
+    if (count >= maxSamples) {
+      return -1;
+    }
+
+    uint8_t channel = data[pos] & ~LIVE_DATA_FLOAT_FLAG;
+    bool isFloat = data[pos] & LIVE_DATA_FLOAT_FLAG;
+    pos++;
+    if (channel >= channelCount || pos + (isFloat ? 4 : 2) > length) {
+      return -1;
+    }
+
+    LiveDataSample& sample = samples[count++];
+    sample.channel = channel;
+    if (isFloat) {
+      uint32_t bits = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | ((uint32_t)data[pos + 3] << 24);
+      memcpy(&sample.value, &bits, sizeof(bits));
+      pos += 4;
+    } else {
+      int16_t raw = (int16_t)(data[pos] | (data[pos + 1] << 8));
+      sample.value = raw * powf(10.0f, channels[channel].scale);
+      pos += 2;
+    }
+  }
+
+  return (int)count;
+}
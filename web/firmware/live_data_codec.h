@@ -0,0 +1,66 @@
+/**
+ * Binary live-data packet format for the BLE live data characteristic
+ *
+ * Packets are self-contained so they can be sized to the negotiated ATT MTU:
+ *
+ *   type u8 (0xB1) | sequence u16 | timestamp u32 | samples...
+ *
+ * Each sample is a channel byte followed by the value. The low 7 bits of the
+ * channel byte index the channel table published in the sensor-info
+ * characteristic. If bit 7 is clear the value is an int16 scaled by the
+ * channel's decimal exponent (value = raw * 10^scale). If it is set, the
+ * value is a float32, used for float channels and for int16 overflow. All
+ * fields are little endian.
+ *
+ * The first byte is never '{', so receivers can tell binary packets from the
+ * JSON fallback. This file has no Arduino dependencies and builds on the host.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LIVE_DATA_PACKET_TYPE   0xB1
+#define LIVE_DATA_HEADER_SIZE   7
+#define LIVE_DATA_FLOAT_FLAG    0x80
+#define LIVE_DATA_MAX_CHANNELS  128
+#define ATT_DEFAULT_MTU         23
+#define ATT_NOTIFY_OVERHEAD     3
+
+// Wire format of a channel
+enum LiveDataFormat : uint8_t {
+  LIVE_DATA_INT16 = 0,
+  LIVE_DATA_FLOAT32 = 1
+};
+
+// Entry of the channel table; the index in the table is the channel number
+struct LiveDataChannel {
+  const char* id;
+  LiveDataFormat format;
+  int8_t scale;
+};
+
+// Sample to send or a decoded sample
+struct LiveDataSample {
+  uint8_t channel;
+  float value;
+};
+
+// Notification payload available at the given ATT MTU
+size_t liveDataPayloadSize(uint16_t mtu);
+
+// Encode as many samples as fit into one packet, starting at samples[0].
+// Sets *consumed to the number of samples encoded and returns the packet
+// length, or 0 if not even one sample fits.
+size_t encodeLiveDataPacket(const LiveDataChannel* channels, size_t channelCount,
+                            const LiveDataSample* samples, size_t sampleCount,
+                            size_t* consumed, uint16_t sequence, uint32_t timestamp,
+                            uint8_t* out, size_t outSize);
+
+// Decode one packet. Returns the number of samples written, or -1 if the
+// packet is malformed or refers to an unknown channel.
+int decodeLiveDataPacket(const uint8_t* data, size_t length,
+                         const LiveDataChannel* channels, size_t channelCount,
+                         uint16_t* sequence, uint32_t* timestamp,
+                         LiveDataSample* samples, size_t maxSamples);
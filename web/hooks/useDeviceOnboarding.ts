@@ -1,9 +1,10 @@
 'use client';
 
-import { useState, useEffect, useCallback } from 'react';
+import { useState, useEffect, useCallback, useRef } from 'react';
 import { useToast } from '../components/ui/use-toast';
 import { useRouter } from 'next/navigation';
 import { registerDevice, configureSensor, startStream } from '../lib/api';
+import { LiveDataChannel, decodeLiveDataPacket, isBinaryLiveData } from '../lib/live-data';
 
 // GATT Service and Characteristics UUIDs - must match ESP32 firmware
 const SERVICE_UUID = '4fafc201-1fb5-459e-8fcc-c5c9c331914b';
@@ -67,6 +68,7 @@ export function useDeviceOnboarding() {
   const [bluetoothAvailable, setBluetoothAvailable] = useState(false);
   const [liveData, setLiveData] = useState<any>(null);
   const [liveDataSubscription, setLiveDataSubscription] = useState<any>(null);
+  const liveChannels = useRef<LiveDataChannel[]>([]);
 
   // Check if Web Bluetooth is available
   useEffect(() => {
@@ -335,6 +337,9 @@ export function useDeviceOnboarding() {
         console.log('Setting sensor info:', sensorInfoJson.sensors);
         setSensorInfo(sensorInfoJson.sensors);
 
+        // Channel table for binary live data; older firmware only streams JSON
+        liveChannels.current = Array.isArray(sensorInfoJson.channels) ? sensorInfoJson.channels : [];
+
         console.log('Connection process completed successfully');
         toast({
           title: 'Connected',
@@ -442,7 +447,9 @@ export function useDeviceOnboarding() {
     const value = event.target.value;
     const decoder = new TextDecoder('utf-8');
     try {
-      const data = JSON.parse(decoder.decode(value));
+      const data = isBinaryLiveData(value)
+        ? decodeLiveDataPacket(value, liveChannels.current)
+        : JSON.parse(decoder.decode(value));
       setLiveData(data);
       
       // In a real app, we would send this data to the backend
@@ -603,7 +610,9 @@ export function useDeviceOnboarding() {
       await subscribeLiveData();
       
       console.log('Sending START_STREAMING command...');
-      const streamStarted = await sendCommand('START_STREAMING');
+      const streamStarted = await sendCommand('START_STREAMING', {
+        format: liveChannels.current.length > 0 ? 'binary' : 'json',
+      });
       if (!streamStarted) {
         throw new Error('Failed to start data streaming');
       }
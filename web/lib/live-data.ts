@@ -0,0 +1,52 @@
+// Decoder for binary live-data notifications, see web/firmware/live_data_codec.h
+
+export const LIVE_DATA_PACKET_TYPE = 0xb1;
+const HEADER_SIZE = 7;
+const FLOAT_FLAG = 0x80;
+
+export interface LiveDataChannel {
+  id: string;
+  format: 'int16' | 'float32';
+  scale: number;
+}
+
+export interface LiveDataPacket {
+  sequence: number;
+  timestamp: number;
+  sensors: { id: string; value: number }[];
+}
+
+export function isBinaryLiveData(value: DataView): boolean {
+  return value.byteLength >= HEADER_SIZE && value.getUint8(0) === LIVE_DATA_PACKET_TYPE;
+}
+
+export function decodeLiveDataPacket(value: DataView, channels: LiveDataChannel[]): LiveDataPacket {
+  if (!isBinaryLiveData(value)) {
+    throw new Error('Not a live data packet');
+  }
+
+  const packet: LiveDataPacket = {
+    sequence: value.getUint16(1, true),
+    timestamp: value.getUint32(3, true),
+    sensors: [],
+  };
+
+  let pos = HEADER_SIZE;
+  while (pos < value.byteLength) {
+    const header = value.getUint8(pos++);
+    const channel = channels[header & ~FLOAT_FLAG];
+    if (!channel) {
+      throw new Error(`Unknown live data channel ${header & ~FLOAT_FLAG}`);
+    }
+
+    if (header & FLOAT_FLAG) {
+      packet.sensors.push({ id: channel.id, value: value.getFloat32(pos, true) });
+      pos += 4;
+    } else {
+      packet.sensors.push({ id: channel.id, value: value.getInt16(pos, true) * Math.pow(10, channel.scale) });
+      pos += 2;
+    }
+  }
+
+  return packet;
+}